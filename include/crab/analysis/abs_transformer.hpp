@@ -36,6 +36,8 @@
 #include <crab/support/debug.hpp>
 #include <crab/support/stats.hpp>
 
+#include <type_traits>
+
 namespace crab {
 namespace analyzer {
 
@@ -903,6 +905,19 @@ public:
 
 };
 
+/**
+ * Whether copies of an abstract transformer can execute statements
+ * concurrently, one copy per thread. This is the case if the
+ * transformer only modifies its own abstract value. Transformers
+ * that share state (e.g., the inter-procedural ones) are not.
+ **/
+template <class AbsTr>
+struct abs_transformer_per_thread_copy : std::false_type {};
+
+template <class BasicBlock, class AbsD>
+struct abs_transformer_per_thread_copy<
+    intra_abs_transformer<BasicBlock, AbsD>> : std::true_type {};
+
 ///////////////////////////////////////
 /// For inter-procedural analysis
 ///////////////////////////////////////
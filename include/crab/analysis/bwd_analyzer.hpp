@@ -554,7 +554,7 @@ public:
       const invariant_map_t &fwd_invariants = F.get_pre_invariants();
       crab::CrabStats::resume("CombinedForwardBackward.MinimizeInvariants");
       // Important for apron and elina domains.
-      invariant_map_t minimized_fwd_invariants;
+      assumption_map_t minimized_fwd_invariants;
       for (auto &kv : fwd_invariants) {
         AbsDom dom(kv.second);
         dom.minimize();
@@ -57,7 +57,7 @@ public:
   const statement_t &get() const {
     return *m_assert;
   }
-  virtual ikos::index_t index() const override {
+  ikos::index_t index() const {
     return m_id;
   }
   bool operator==(this_type o) const {
@@ -66,7 +66,7 @@ public:
   bool operator<(this_type o) const {
     return m_id < o.m_id;
   }
-  virtual void write(crab::crab_os &o) const override {
+  void write(crab::crab_os &o) const {
     o << "\"" << *m_assert << "\"";
   }
 };
@@ -8,8 +8,10 @@
 #include <crab/support/debug.hpp>
 #include <crab/support/stats.hpp>
 
+#include <boost/optional.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <unordered_map>
+#include <vector>
 
 namespace crab {
 namespace analyzer {
@@ -101,15 +103,97 @@ public:
   virtual std::string name() override { return "Liveness"; }
 };
 
+/**
+ * Same as liveness_analysis_operations but the sets of variables are
+ * bit vectors over the variables of the CFG.
+ **/
+template <class CFG>
+class bitvector_liveness_analysis_operations
+    : public bitvector_killgen_operations_api<CFG> {
+
+  using parent_type = bitvector_killgen_operations_api<CFG>;
+
+public:
+  using basic_block_t = typename CFG::basic_block_t;
+  using basic_block_label_t = typename CFG::basic_block_label_t;
+  using typename parent_type::variable_index_t;
+
+  bitvector_liveness_analysis_operations(CFG cfg) : parent_type(cfg) {}
+
+  virtual bool is_forward() override { return false; }
+
+  virtual void collect_variables(variable_index_t &vars) override {
+    if (this->m_cfg.has_func_decl()) {
+      auto const &fdecl = this->m_cfg.get_func_decl();
+      for (unsigned i = 0, e = fdecl.get_num_outputs(); i < e; ++i) {
+        vars.insert(fdecl.get_output_name(i));
+      }
+    }
+    for (auto &b :
+         boost::make_iterator_range(this->m_cfg.begin(), this->m_cfg.end())) {
+      for (auto &s : b) {
+        auto const &live = s.get_live();
+        for (auto d :
+             boost::make_iterator_range(live.defs_begin(), live.defs_end())) {
+          vars.insert(d);
+        }
+        for (auto u :
+             boost::make_iterator_range(live.uses_begin(), live.uses_end())) {
+          vars.insert(u);
+        }
+      }
+    }
+  }
+
+  virtual void entry(const variable_index_t &vars, bit_vector &res) override {
+    if (this->m_cfg.has_func_decl()) {
+      auto const &fdecl = this->m_cfg.get_func_decl();
+      for (unsigned i = 0, e = fdecl.get_num_outputs(); i < e; ++i) {
+        unsigned id;
+        if (vars.find(fdecl.get_output_name(i), id)) {
+          res.set(id);
+        }
+      }
+    }
+  }
+
+  virtual bool kill_gen(const basic_block_t &b, const variable_index_t &vars,
+                        bit_vector &kill, bit_vector &gen) override {
+    for (auto &s : boost::make_iterator_range(b.rbegin(), b.rend())) {
+      if (s.is_unreachable()) {
+        return false;
+      }
+      auto const &live = s.get_live();
+      unsigned id;
+      for (auto d :
+           boost::make_iterator_range(live.defs_begin(), live.defs_end())) {
+        vars.find(d, id);
+        kill.set(id);
+        gen.reset(id);
+      }
+      for (auto u :
+           boost::make_iterator_range(live.uses_begin(), live.uses_end())) {
+        vars.find(u, id);
+        gen.set(id);
+      }
+    }
+    return true;
+  }
+
+  virtual std::string name() override { return "Liveness"; }
+};
+
 /** Live variable analysis **/
 template <typename CFG>
-class liveness_analysis : public killgen_fixpoint_iterator<
-                              CFG, liveness_analysis_operations<CFG>> {
+class liveness_analysis
+    : public bitvector_killgen_fixpoint_iterator<
+          CFG, bitvector_liveness_analysis_operations<CFG>> {
 
-  using liveness_analysis_operations_t = liveness_analysis_operations<CFG>;
+  using liveness_analysis_operations_t =
+      bitvector_liveness_analysis_operations<CFG>;
   using killgen_fixpoint_iterator_t =
-      killgen_fixpoint_iterator<
-          CFG, liveness_analysis_operations_t>;
+      bitvector_killgen_fixpoint_iterator<CFG,
+                                          liveness_analysis_operations_t>;
 
   liveness_analysis(const liveness_analysis<CFG> &other) = delete;
   liveness_analysis<CFG> &
@@ -121,13 +205,18 @@ public:
   using basic_block_label_t = typename CFG::basic_block_label_t;
   using statement_t = typename CFG::statement_t;
   using varname_t = typename CFG::varname_t;
-  typedef
-      typename liveness_analysis_operations_t::varset_domain_t varset_domain_t;
+  using varset_domain_t = varset_domain<typename CFG::variable_t>;
 
 private:
   liveness_analysis_operations_t m_liveness_op;  
   bool m_release_in;
-  
+
+  varset_domain_t to_varset(const bit_vector &bits) const {
+    varset_domain_t res = varset_domain_t::bottom();
+    bits.for_each([&](std::size_t id) { res += this->m_vars[id]; });
+    return res;
+  }
+
 public:
   liveness_analysis(CFG cfg, bool release_in = true)
     : killgen_fixpoint_iterator_t(cfg, m_liveness_op),
@@ -136,28 +225,39 @@ public:
   void exec() {
     this->run();
 
-    CRAB_LOG("liveness-live", for (auto p
+    CRAB_LOG("liveness-live", for (auto const &bb
                                    : boost::make_iterator_range(
-                                       this->out_begin(), this->out_end())) {
-      crab::outs() << basic_block_traits<basic_block_t>::to_string(p.first)
-                   << " OUT live variables=" << p.second << "\n";
+                                       this->m_cfg.begin(), this->m_cfg.end())) {
+      crab::outs() << basic_block_traits<basic_block_t>::to_string(bb.label())
+                   << " OUT live variables=" << get(bb.label()) << "\n";
       ;
     });
 
     if (m_release_in) {
-      this->m_in_map.clear();
+      this->m_in.clear();
     }
   }
 
+  // Return the set of live variables at the exit of bb
   varset_domain_t get(const basic_block_label_t &bb) const {
-    auto it = this->m_out_map.find(bb);
-    if (it != this->m_out_map.end()) {
-      return it->second;
+    if (const bit_vector *bits = this->get_out(bb)) {
+      return to_varset(*bits);
     } else {
       return varset_domain_t::bottom();
     }
   }
 
+  // Return the set of live variables at the entry of bb, if the IN
+  // sets have been kept
+  boost::optional<varset_domain_t>
+  get_live_in(const basic_block_label_t &bb) const {
+    if (const bit_vector *bits = this->get_in(bb)) {
+      return to_varset(*bits);
+    } else {
+      return boost::none;
+    }
+  }
+
   void write(crab_os &o) const {
     o << "TODO: print liveness analysis results\n";
   }
@@ -193,12 +293,96 @@ private:
   // map basic blocks to set of dead variables at the end of the
   // blocks
   std::unordered_map<basic_block_label_t, varset_domain_t> m_dead_map;
+  // same as m_dead_map but indexed by the dense id of the blocks if
+  // the liveness analysis used the block index of the cfg. Then,
+  // m_dead_map is empty.
+  std::vector<varset_domain_t> m_dead_by_id;
 
   // statistics
   unsigned m_max_live;
   unsigned m_total_live;
   unsigned m_total_blocks;
 
+  // Compute the dead variables at the exit of bb. Return false if
+  // no variable is live there.
+  bool dead_variables(const basic_block_t &bb, const bit_vector *live_set,
+                      varset_domain_t &dead_set) {
+    if (!live_set || live_set->empty())
+      return false;
+
+    // dead variables = (USE(bb) U DEF(bb)) \ live_out(bb)
+    auto const &vars = m_live->get_variables();
+    dead_set = varset_domain_t::bottom();
+    for (auto const &v : bb.live()) {
+      unsigned id;
+      if (!vars.find(v, id) || !live_set->test(id)) {
+        dead_set += v;
+      }
+    }
+    CRAB_LOG("liveness",
+             crab::outs()
+                 << basic_block_traits<basic_block_t>::to_string(bb.label())
+                 << " dead variables=" << dead_set << "\n";);
+    // update statistics
+    unsigned num_live = live_set->count();
+    m_total_live += num_live;
+    if (num_live > m_max_live) {
+      m_max_live = num_live;
+    }
+    m_total_blocks++;
+    return true;
+  }
+
+  void precompute_dead_variables(std::false_type) {
+    for (auto &bb : boost::make_iterator_range(m_cfg.begin(), m_cfg.end())) {
+      varset_domain_t dead_set;
+      if (dead_variables(bb, m_live->get_out(bb.label()), dead_set)) {
+        m_dead_map.insert(std::make_pair(bb.label(), std::move(dead_set)));
+      }
+    }
+  }
+
+  void precompute_dead_variables(std::true_type) {
+    if (!m_live->has_block_ids()) {
+      precompute_dead_variables(std::false_type());
+      return;
+    }
+    m_dead_by_id.assign(m_cfg.size(), varset_domain_t());
+    for (unsigned id = 0, n = m_dead_by_id.size(); id < n; ++id) {
+      dead_variables(m_cfg.get_node_by_id(id), m_live->get_out_by_id(id),
+                     m_dead_by_id[id]);
+    }
+  }
+
+  varset_domain_t dead_exit(const basic_block_label_t &bb,
+                            std::false_type) const {
+    auto it = m_dead_map.find(bb);
+    if (it == m_dead_map.end()) {
+      return varset_domain_t();
+    } else {
+      return it->second;
+    }
+  }
+
+  varset_domain_t dead_exit(const basic_block_label_t &bb,
+                            std::true_type) const {
+    if (m_dead_by_id.empty()) {
+      return dead_exit(bb, std::false_type());
+    }
+    return m_dead_by_id[m_cfg.block_id(bb)];
+  }
+
+  varset_domain_t dead_exit_by_id(unsigned id, std::false_type) const {
+    CRAB_ERROR("live_and_dead_analysis: the cfg has no block index");
+  }
+
+  varset_domain_t dead_exit_by_id(unsigned id, std::true_type) const {
+    if (m_dead_by_id.empty()) {
+      return dead_exit(m_cfg.block_label(id), std::false_type());
+    }
+    return m_dead_by_id[id];
+  }
+
 public:
   // for backward compatibility
   // XXX: maybe unused already
@@ -220,26 +404,7 @@ public:
     if (!m_ignore_dead) {
       crab::ScopedCrabStats __st__("Liveness.precompute_dead_variables");
       /** Remove dead variables locally **/
-      for (auto &bb : boost::make_iterator_range(m_cfg.begin(), m_cfg.end())) {
-        varset_domain_t live_set = m_live->get(bb.label());
-        if (live_set.is_bottom())
-          continue;
-
-        varset_domain_t dead_set = m_cfg.get_node(bb.label()).live();
-        // dead variables = (USE(bb) U DEF(bb)) \ live_out(bb)
-        dead_set -= live_set;
-        CRAB_LOG("liveness",
-                 crab::outs()
-                     << basic_block_traits<basic_block_t>::to_string(bb.label())
-                     << " dead variables=" << dead_set << "\n";);
-        m_dead_map.insert(std::make_pair(bb.label(), std::move(dead_set)));
-        // update statistics
-        m_total_live += live_set.size();
-	if (live_set.size() > m_max_live) {
-	  m_max_live = live_set.size();
-	}
-        m_total_blocks++;
-      }
+      precompute_dead_variables(ikos::wto_impl::has_block_index<CFG>());
     }
   }
 
@@ -253,12 +418,16 @@ public:
     if (m_ignore_dead) {
       CRAB_WARN("Dead variables were not precomputed during liveness analysis");
     }
-    auto it = m_dead_map.find(bb);
-    if (it == m_dead_map.end()) {
-      return varset_domain_t();
-    } else {
-      return it->second;
+    return dead_exit(bb, ikos::wto_impl::has_block_index<CFG>());
+  }
+
+  // Same as dead_exit but for the block with dense id id. The cfg
+  // must have a block index.
+  varset_domain_t dead_exit_by_id(unsigned id) const {
+    if (m_ignore_dead) {
+      CRAB_WARN("Dead variables were not precomputed during liveness analysis");
     }
+    return dead_exit_by_id(id, ikos::wto_impl::has_block_index<CFG>());
   }
 
   void get_stats(unsigned &total_live, unsigned &max_live_per_blk,
@@ -0,0 +1,187 @@
+#pragma once
+
+/**
+ * Syntactic variable packing in the style of Astrée.
+ *
+ * Compute a partition of the numerical variables of a CFG into packs
+ * of bounded size. Two variables are candidates to be in the same
+ * pack if they occur together in an assignment, arithmetic
+ * operation, cast, select, assume or assert. Since a statement
+ * relates the variables it defines with the ones it uses, chains of
+ * definitions and uses are also captured. Pairs of variables are
+ * considered by decreasing number of co-occurrences and their packs
+ * are merged only if the resulting pack has at most max_pack_size
+ * variables.
+ *
+ * The result can be passed to numerical_packing_domain as a fixed
+ * partition.
+ **/
+
+#include <crab/domains/numerical_packing.hpp>
+#include <crab/support/debug.hpp>
+#include <crab/support/stats.hpp>
+
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace crab {
+namespace analyzer {
+
+template <typename CFG> class var_packing_analysis {
+public:
+  using variable_t = typename CFG::variable_t;
+  using statement_t = typename CFG::statement_t;
+  using variable_packs_t = crab::domains::variable_packs<variable_t>;
+
+private:
+  using var_pair_t = std::pair<variable_t, variable_t>;
+
+  CFG m_cfg;
+  // 0 means no limit
+  unsigned m_max_pack_size;
+  std::shared_ptr<const variable_packs_t> m_packs;
+
+  static bool is_numerical(const variable_t &v) {
+    return v.get_type().is_integer() || v.get_type().is_real();
+  }
+
+  static bool is_relational(const statement_t &s) {
+    return s.is_bin_op() || s.is_assign() || s.is_assume() || s.is_select() ||
+           s.is_assert() || s.is_int_cast();
+  }
+
+  // Union-find over the variables that occur in some pair
+  struct partition {
+    std::unordered_map<variable_t, variable_t> m_parent;
+    std::unordered_map<variable_t, unsigned> m_size;
+
+    variable_t find(const variable_t &v) {
+      auto it = m_parent.find(v);
+      if (it == m_parent.end()) {
+        m_parent.insert({v, v});
+        m_size.insert({v, 1});
+        return v;
+      }
+      if (it->second == v) {
+        return v;
+      }
+      variable_t root = find(it->second);
+      m_parent.at(v) = root;
+      return root;
+    }
+  };
+
+public:
+  var_packing_analysis(CFG cfg, unsigned max_pack_size)
+      : m_cfg(cfg), m_max_pack_size(max_pack_size) {}
+
+  var_packing_analysis(const var_packing_analysis<CFG> &o) = delete;
+  var_packing_analysis<CFG> &
+  operator=(const var_packing_analysis<CFG> &o) = delete;
+
+  void exec() {
+    crab::CrabStats::count("Packing.count");
+    crab::ScopedCrabStats __st__("Packing");
+
+    // count co-occurrences. std::map so that ties are broken
+    // deterministically.
+    std::map<var_pair_t, unsigned> weights;
+    for (auto const &bb :
+         boost::make_iterator_range(m_cfg.begin(), m_cfg.end())) {
+      for (auto const &s : bb) {
+        if (!is_relational(s)) {
+          continue;
+        }
+        auto const &live = s.get_live();
+        std::vector<variable_t> vars;
+        for (auto const &v :
+             boost::make_iterator_range(live.defs_begin(), live.defs_end())) {
+          vars.push_back(v);
+        }
+        for (auto const &v :
+             boost::make_iterator_range(live.uses_begin(), live.uses_end())) {
+          vars.push_back(v);
+        }
+        vars.erase(std::remove_if(vars.begin(), vars.end(),
+                                  [](const variable_t &v) {
+                                    return !is_numerical(v);
+                                  }),
+                   vars.end());
+        std::sort(vars.begin(), vars.end());
+        vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+        for (unsigned i = 0, sz = vars.size(); i < sz; ++i) {
+          for (unsigned j = i + 1; j < sz; ++j) {
+            weights[{vars[i], vars[j]}]++;
+          }
+        }
+      }
+    }
+
+    std::vector<std::pair<var_pair_t, unsigned>> pairs(weights.begin(),
+                                                       weights.end());
+    std::stable_sort(pairs.begin(), pairs.end(),
+                     [](const std::pair<var_pair_t, unsigned> &p1,
+                        const std::pair<var_pair_t, unsigned> &p2) {
+                       return p1.second > p2.second;
+                     });
+
+    partition uf;
+    for (auto const &kv : pairs) {
+      variable_t x = uf.find(kv.first.first);
+      variable_t y = uf.find(kv.first.second);
+      if (x == y) {
+        continue;
+      }
+      unsigned size = uf.m_size.at(x) + uf.m_size.at(y);
+      if (m_max_pack_size > 0 && size > m_max_pack_size) {
+        continue;
+      }
+      uf.m_parent.at(y) = x;
+      uf.m_size.at(x) = size;
+    }
+
+    // singleton packs are implicit
+    std::map<variable_t, std::vector<variable_t>> packs_map;
+    for (auto const &kv : uf.m_parent) {
+      packs_map[uf.find(kv.first)].push_back(kv.first);
+    }
+    std::vector<std::vector<variable_t>> packs;
+    for (auto &kv : packs_map) {
+      if (kv.second.size() > 1) {
+        std::sort(kv.second.begin(), kv.second.end());
+        packs.push_back(std::move(kv.second));
+      }
+    }
+    std::sort(packs.begin(), packs.end());
+    m_packs = std::make_shared<const variable_packs_t>(std::move(packs));
+
+    CRAB_LOG("packing", crab::outs() << "Variable packs: " << *m_packs << "\n";);
+  }
+
+  // Return the packs computed by exec()
+  std::shared_ptr<const variable_packs_t> get_packs() const {
+    if (!m_packs) {
+      CRAB_ERROR("var_packing_analysis::get_packs called before exec");
+    }
+    return m_packs;
+  }
+
+  void write(crab_os &o) const {
+    if (m_packs) {
+      o << *m_packs;
+    }
+  }
+};
+
+template <typename CFG>
+inline crab_os &operator<<(crab_os &o, const var_packing_analysis<CFG> &a) {
+  a.write(o);
+  return o;
+}
+
+} // end namespace analyzer
+} // end namespace crab
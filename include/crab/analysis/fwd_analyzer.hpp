@@ -9,6 +9,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
 
 namespace crab {
 namespace analyzer {
@@ -53,13 +56,17 @@ private:
   abs_tr_t *m_abs_tr; // the abstract transformer owned by the caller
   const liveness_t *m_live;
   live_set_t m_formals;
+  // one copy of m_abs_tr per worker if the fixpoint runs in parallel
+  std::vector<std::unique_ptr<abs_tr_t>> m_worker_abs_tr;
 
   inline abs_dom_t make_top() const {
     auto const &top_dom = m_abs_tr->get_abs_value();
     return top_dom.make_top();
   }
 
-  void prune_dead_variables(const basic_block_label_t &node, abs_dom_t &inv) {
+  // id is the dense id of node or no_vertex_id
+  void prune_dead_variables(const basic_block_label_t &node, unsigned id,
+                            abs_dom_t &inv) {
     if (!m_live) {
       return;
     }
@@ -67,25 +74,90 @@ private:
     if (inv.is_bottom() || inv.is_top()) {
       return;
     }
-    auto dead = m_live->dead_exit(node);
+    auto dead = (id == ikos::wto_impl::no_vertex_id)
+                    ? m_live->dead_exit(node)
+                    : m_live->dead_exit_by_id(id);
     dead -= m_formals;
     std::vector<variable_t> dead_vec(dead.begin(), dead.end());
     inv.forget(dead_vec);
   }
 
-  //! Given a basic block and the invariant at the entry it produces
-  //! the invariant at the exit of the block.
-  abs_dom_t analyze(const basic_block_label_t &node, abs_dom_t &&inv) override {
-    auto &b = get_cfg().get_node(node);
-    m_abs_tr->set_abs_value(std::move(inv));
+  bool prepare_parallel_analysis(unsigned num_workers) override {
+    return prepare_parallel_analysis(
+        num_workers,
+        std::integral_constant<
+            bool, abs_transformer_per_thread_copy<abs_tr_t>::value>());
+  }
+
+  bool prepare_parallel_analysis(unsigned num_workers, std::true_type) {
+    m_worker_abs_tr.clear();
+    for (unsigned i = 0; i < num_workers; ++i) {
+      m_worker_abs_tr.emplace_back(new abs_tr_t(*m_abs_tr));
+    }
+    return true;
+  }
+
+  bool prepare_parallel_analysis(unsigned num_workers, std::false_type) {
+    return false;
+  }
+
+  abs_tr_t &get_worker_abs_tr() {
+    if (auto id = this->current_worker()) {
+      return *m_worker_abs_tr[*id];
+    }
+    return *m_abs_tr;
+  }
+
+  // The block index must be built before the fixpoint computes the
+  // wto so that the fixpoint can use the block ids.
+  static CFG build_block_index(CFG cfg, std::true_type) {
+    cfg.build_index();
+    return cfg;
+  }
+
+  static CFG build_block_index(CFG cfg, std::false_type) { return cfg; }
+
+  static CFG build_block_index(CFG cfg) {
+    return build_block_index(cfg, ikos::wto_impl::has_block_index<CFG>());
+  }
+
+  const basic_block_t &get_block(const basic_block_label_t &node, unsigned id,
+                                 std::true_type) const {
+    return (id == ikos::wto_impl::no_vertex_id)
+               ? this->m_cfg.get_node(node)
+               : this->m_cfg.get_node_by_id(id);
+  }
+
+  const basic_block_t &get_block(const basic_block_label_t &node, unsigned id,
+                                 std::false_type) const {
+    return this->m_cfg.get_node(node);
+  }
+
+  abs_dom_t transfer(const basic_block_label_t &node, unsigned id,
+                     abs_dom_t &&inv) {
+    auto &b =
+        get_block(node, id, ikos::wto_impl::has_block_index<CFG>());
+    abs_tr_t &abs_tr = get_worker_abs_tr();
+    abs_tr.set_abs_value(std::move(inv));
     for (auto &s : b) {
-      s.accept(&*m_abs_tr);
+      s.accept(&abs_tr);
     }
-    abs_dom_t &res = m_abs_tr->get_abs_value();
-    prune_dead_variables(node, res);
+    abs_dom_t &res = abs_tr.get_abs_value();
+    prune_dead_variables(node, id, res);
     return res;
   }
 
+  //! Given a basic block and the invariant at the entry it produces
+  //! the invariant at the exit of the block.
+  abs_dom_t analyze(const basic_block_label_t &node, abs_dom_t &&inv) override {
+    return transfer(node, ikos::wto_impl::no_vertex_id, std::move(inv));
+  }
+
+  abs_dom_t analyze_block(const basic_block_label_t &node, unsigned id,
+                          abs_dom_t &&inv) override {
+    return transfer(node, id, std::move(inv));
+  }
+
   void process_pre(const basic_block_label_t &node, abs_dom_t inv) override {}
 
   void process_post(const basic_block_label_t &node, abs_dom_t inv) override {}
@@ -110,7 +182,7 @@ private:
                                << "Live symbols sanity check ... ";);
         liveness_analysis<CFG> live_symbols(get_cfg(), false /* keep IN sets*/);
         live_symbols.exec();
-        if (auto const *entry_ls = live_symbols.get_in(get_cfg().entry())) {
+        if (auto entry_ls = live_symbols.get_live_in(get_cfg().entry())) {
           auto const &fdecl = get_cfg().get_func_decl();
           typename liveness_analysis<CFG>::varset_domain_t suspicious_vars(
               *entry_ls);
@@ -152,7 +224,7 @@ public:
                // live can be nullptr if no live info is available
                const liveness_t *live_and_dead_symbols,
 	       const fixpoint_parameters &params)
-    : fixpo_iterator_t(cfg, absval_fac, params,
+    : fixpo_iterator_t(build_block_index(cfg), absval_fac, params,
 		       false /*disable processor*/),
       m_abs_tr(abs_tr), m_live(live_and_dead_symbols) {
     init_fwd_analyzer();
@@ -165,6 +237,7 @@ public:
   //! Trigger the fixpoint computation
   void run_forward(abs_dom_t init) {
     this->run(init);
+    m_worker_abs_tr.clear();
   }
 
   void run_forward(const basic_block_label_t &entry,
@@ -173,6 +246,15 @@ public:
     this->run(entry, init, assumptions);
   }
 
+  //! Trigger the fixpoint computation after some blocks have been
+  //! edited, reusing the invariants of a previous run.
+  void run_forward_incremental(
+      abs_dom_t init, invariant_map_t prev_pre, invariant_map_t prev_post,
+      const std::unordered_set<basic_block_label_t> &changed) {
+    this->run_incremental(init, std::move(prev_pre), std::move(prev_post),
+                          changed);
+  }
+
   //! Return the invariants that hold at the entry of b
   inline abs_dom_t operator[](const basic_block_label_t &b) const {
     return get_pre(b);
@@ -188,6 +270,12 @@ public:
     return fixpo_iterator_t::get_post(b);
   }
 
+  //! Return the invariants that hold at the entry of the block with
+  //! dense id id. The block index of the CFG must be built.
+  abs_dom_t get_pre_by_id(unsigned id) const {
+    return fixpo_iterator_t::get_pre_by_id(id);
+  }
+
   //! Return the WTO of the CFG. The WTO contains also how many
   //! times each head was visited by the fixpoint iterator.
   wto_t &get_wto() { return fixpo_iterator_t::get_wto(); }
@@ -284,6 +372,13 @@ public:
     m_analyzer.run_forward(entry, init, assumptions);
   }
 
+  void run_incremental(abs_dom_t init, invariant_map_t prev_pre,
+                       invariant_map_t prev_post,
+                       const std::unordered_set<basic_block_label_t> &changed) {
+    m_analyzer.run_forward_incremental(init, std::move(prev_pre),
+                                       std::move(prev_post), changed);
+  }
+
   iterator pre_begin() { return m_analyzer.pre_begin(); }
   iterator pre_end() { return m_analyzer.pre_end(); }
   const_iterator pre_begin() const { return m_analyzer.pre_begin(); }
@@ -314,6 +409,18 @@ public:
     return m_analyzer.get_post(b);
   }
 
+  abs_dom_t get_pre_by_id(unsigned id) const {
+    return m_analyzer.get_pre_by_id(id);
+  }
+
+  void keep_invariants_at(const basic_block_label_t &b) {
+    m_analyzer.keep_invariants_at(b);
+  }
+
+  // Return true if some budget of the fixpoint parameters was
+  // exceeded so that the invariants can be less precise.
+  bool is_degraded() const { return m_analyzer.is_degraded(); }
+
   wto_t &get_wto() { return m_analyzer.get_wto(); }
   const wto_t &get_wto() const { return m_analyzer.get_wto(); }
 
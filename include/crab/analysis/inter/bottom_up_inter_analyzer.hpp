@@ -12,16 +12,20 @@
 #include <crab/analysis/graphs/topo_order.hpp>
 #include <crab/analysis/inter/inter_analyzer_api.hpp>
 #include <crab/analysis/inter/inter_params.hpp>
+#include <crab/analysis/inter/summary_cache.hpp>
 #include <crab/cfg/cfg.hpp>   // callsite_or_fdecl wrapper
 #include <crab/cg/cg_bgl.hpp> // for sccg.hpp
 #include <crab/domains/generic_abstract_domain.hpp>
 #include <crab/support/debug.hpp>
 #include <crab/support/stats.hpp>
+#include <crab/support/thread_pool.hpp>
 
 #include <boost/range/iterator_range.hpp>
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -52,11 +56,14 @@ private:
   using call_table_t = crab::cfg::callsite_or_fdecl_map<CFG, abs_domain_t>;
   call_table_t m_call_table;
   AbsDomain m_top;
+  // callers can be analyzed concurrently
+  mutable std::mutex m_mutex;
 
   // XXX: assume context-insensitive analysis so it will merge all
   // calling contexts using abstract domain's join keeping a
   // single calling context per function.
   void insert_helper(callsite_or_fdecl_t key, AbsDomain inv) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_call_table.find(key);
     if (it != m_call_table.end()) {
       it->second = it->second | inv;
@@ -82,6 +89,7 @@ public:
   }
 
   AbsDomain get_call_ctx(const fdecl_t &d) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_call_table.find(&d);
     if (it != m_call_table.end()) {
       return it->second;
@@ -91,6 +99,7 @@ public:
   }
   
   void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_call_table.clear();
   }
 };
@@ -250,6 +259,8 @@ public:
 private:
   using summary_table_t = crab::cfg::callsite_or_fdecl_map<CFG, summary_t>;
   summary_table_t m_sum_table;
+  // summaries can be computed concurrently
+  mutable std::mutex m_mutex;
 
 public:
   summary_table() {}
@@ -266,38 +277,45 @@ public:
     std::vector<variable_t> ins(inputs.begin(), inputs.end());
     std::vector<variable_t> outs(outputs.begin(), outputs.end());
     summary_t sum_tuple(d, sum, ins, outs);
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_sum_table.insert(std::make_pair(callsite_or_fdecl_t(&d),std::move(sum_tuple)));
   }
 
   // return true if there is a summary
   bool has_summary(const callsite_t &cs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_sum_table.find(&cs);
     return (it != m_sum_table.end());
   }
 
   bool has_summary(const fdecl_t &d) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_sum_table.find(&d);
     return (it != m_sum_table.end());
   }
 
   // get the summary
   summary_t get(const callsite_t &cs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_sum_table.find(&cs);
     assert(it != m_sum_table.end());
     return (it->second);
   }
 
   summary_t get(const fdecl_t &d) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_sum_table.find(&d);
     assert(it != m_sum_table.end());
     return (it->second);
   }
 
   void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_sum_table.clear();
   }
   
   void write(crab_os &o) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     o << "--- Begin summary table ---\n";
     for (auto const &p : m_sum_table) {
       p.second.write(o);
@@ -634,6 +652,13 @@ public:
 };
 } // namespace inter_analyzer_impl
 
+// The tables shared by the copies of a top-down transformer are
+// protected by their own mutex.
+template <class SumTable, class CallCtxTable>
+struct abs_transformer_per_thread_copy<
+    inter_analyzer_impl::td_summ_abs_transformer<SumTable, CallCtxTable>>
+    : std::true_type {};
+
 template <typename CallGraph,
           // abstract domain used for the bottom-up phase
           typename BU_Dom,
@@ -659,8 +684,10 @@ public:
   
 private:
   using summ_tbl_t = inter_analyzer_impl::summary_table<cfg_t, BU_Dom>;
+  using summ_cache_t = inter_analyzer_impl::summary_cache<cfg_t, BU_Dom>;
   using call_tbl_t = inter_analyzer_impl::call_ctx_table<cfg_t, TD_Dom>;
   using cg_ref_t = crab::cg::call_graph_ref<cg_t>;
+  using scc_graph_t = graph_algo::scc_graph<cg_ref_t>;
   using callsite_or_fdecl_t = crab::cfg::callsite_or_fdecl<cfg_t>;  
 public:
   using bu_abs_tr = inter_analyzer_impl::bu_summ_abs_transformer<summ_tbl_t>;
@@ -685,9 +712,20 @@ private:
   const liveness_map_t *m_live;
   invariant_map_t m_inv_map;
   summ_tbl_t m_summ_tbl;
+  // null if summaries are not cached between runs
+  std::unique_ptr<summ_cache_t> m_summ_cache;
   call_tbl_t m_call_tbl;
   fixpoint_parameters m_fixpo_params;
+  // time budget of the whole analysis and degraded functions
+  analysis_budget m_budget;
   std::unique_ptr<abs_tr_t> m_abs_tr;
+  // number of threads to analyze independent SCCs
+  unsigned m_num_threads;
+  // one top-down transformer per thread if SCCs are analyzed in
+  // parallel. They must outlive the analyzers stored in m_inv_map.
+  std::vector<std::unique_ptr<abs_tr_t>> m_worker_abs_tr;
+  // protect m_inv_map if SCCs are analyzed in parallel
+  std::mutex m_inv_map_mutex;
 
   const liveness_t *get_live(const cfg_t &c) {
     if (m_live) {
@@ -703,18 +741,235 @@ private:
   inline BU_Dom make_bu_bottom() const { return m_bu_absval_fac.make_bottom(); }
   inline BU_Dom make_bu_top() const { return m_bu_absval_fac.make_top(); }
 
+  // Return the name and the encoded summary of each callee of m
+  // sorted by name. The encoding is empty if the callee has no
+  // summary yet.
+  std::vector<std::pair<std::string, binary_output>>
+  callee_summaries(const cg_node_t &m) const {
+    std::map<std::string, binary_output> callees;
+    for (auto const &e : boost::make_iterator_range(m_cg.succs(m))) {
+      auto callee_cfg = e.dest().get_cfg();
+      auto const &callee_fdecl = callee_cfg.get_func_decl();
+      auto res = callees.insert({callee_fdecl.get_func_name(), binary_output()});
+      if (res.second && m_summ_tbl.has_summary(callee_fdecl)) {
+        summ_cache_t::encode(callee_fdecl,
+                             m_summ_tbl.get(callee_fdecl).get_sum(),
+                             res.first->second);
+      }
+    }
+    return std::vector<std::pair<std::string, binary_output>>(callees.begin(),
+                                                              callees.end());
+  }
+
+  // Compute the summary of the function of m
+  void compute_summary(const cg_node_t &m) {
+    auto cfg = m.get_cfg();
+    assert(cfg.has_func_decl());
+    auto const &fdecl = cfg.get_func_decl();
+    const std::string &fun_name = fdecl.get_func_name();
+    if (fun_name == "main") {
+      return;
+    }
+    CRAB_VERBOSE_IF(1, get_msg_stream() << "++ Computing summary for "
+                                        << fun_name << "...\n";);
+
+    // --- collect inputs and outputs
+    std::vector<variable_t> formals, inputs, outputs;
+    formals.reserve(fdecl.get_num_inputs() + fdecl.get_num_outputs());
+    inputs.reserve(fdecl.get_num_inputs());
+    outputs.reserve(fdecl.get_num_outputs());
+
+    for (unsigned i = 0; i < fdecl.get_num_inputs(); i++) {
+      inputs.push_back(fdecl.get_input_name(i));
+      formals.push_back(fdecl.get_input_name(i));
+    }
+    for (unsigned i = 0; i < fdecl.get_num_outputs(); i++) {
+      outputs.push_back(fdecl.get_output_name(i));
+      formals.push_back(fdecl.get_output_name(i));
+    }
+
+    if (outputs.empty()) {
+      BU_Dom summary = make_bu_top();
+      m_summ_tbl.insert(fdecl, summary, inputs, outputs);
+      CRAB_WARN("Skipped summary because function ", fun_name,
+                " has no output parameters");
+    } else if (!cfg.has_exit()) {
+      CRAB_WARN("Skipped summary because function ", fun_name,
+                " has no exit block");
+    } else {
+      // --- reuse the summary from a previous run
+      uint64_t key = 0;
+      if (m_summ_cache) {
+        key = m_summ_cache->make_key(cfg, callee_summaries(m));
+        BU_Dom summary = make_bu_top();
+        if (m_summ_cache->lookup(key, fdecl, summary)) {
+          CRAB_VERBOSE_IF(1, get_msg_stream() << "++ Reused cached summary for "
+                                              << fun_name << "\n";);
+          m_summ_tbl.insert(fdecl, summary, inputs, outputs);
+          return;
+        }
+      }
+
+      // --- run the analysis
+      bu_abs_tr abs_tr(std::move(make_bu_top()), &m_summ_tbl);
+      bu_analyzer a(cfg, &abs_tr, m_bu_absval_fac, get_live(cfg), m_fixpo_params);
+      a.run_forward(make_bu_top());
+
+      // --- project onto formal parameters and return values
+      BU_Dom summary = a.get_post(cfg.exit());
+      // crab::CrabStats::count(BU_Dom::getDomainName() +
+      // ".count.project");
+      summary.project(formals);
+      m_summ_tbl.insert(fdecl, summary, inputs, outputs);
+
+      // --- a summary computed with a time budget depends on the
+      // --- machine load so it is not cached
+      if (m_summ_cache && !a.is_degraded()) {
+        m_summ_cache->store(key, fdecl, summary);
+      }
+    }
+  }
+
+  // Run the top-down analysis of the function of m using abs_tr.
+  // The analysis starts from init if is_root is true, otherwise from
+  // the calling context of the function.
+  void analyze_top_down(const cg_node_t &m, bool is_recursive, bool is_root,
+                        const TD_Dom &init, abs_tr_t &abs_tr) {
+    auto cfg = m.get_cfg();
+    assert(cfg.has_func_decl());
+    auto const &fdecl = cfg.get_func_decl();
+    CRAB_VERBOSE_IF(1, get_msg_stream() << "++ Analyzing function "
+                                        << fdecl.get_func_name() << "\n";);
+    if (is_recursive) {
+      // If the SCC is recursive then what we have in
+      // m_call_tbl is incomplete and therefore it is unsound
+      // to use it. To remedy it, we insert another calling
+      // context with top value that approximates all the
+      // possible calling contexts during the recursive calls.
+      m_call_tbl.insert(fdecl, make_td_top());
+    }
+
+    auto init_inv = is_root ? init : m_call_tbl.get_call_ctx(fdecl);
+
+    CRAB_LOG("inter", crab::outs() << "    Starting analysis of " << fdecl
+                                   << " with " << init_inv << "\n");
+
+    if (init_inv.is_bottom()) {
+      crab::outs() << "Top-down analysis for " << fdecl.get_func_name()
+                   << " started with bottom (i.e., dead function).\n";
+    }
+    td_analyzer_ptr a(new td_analyzer(cfg, &abs_tr, m_td_absval_fac, get_live(cfg), 
+                                      m_fixpo_params));
+    a->run_forward(init_inv);
+    std::lock_guard<std::mutex> lock(m_inv_map_mutex);
+    m_inv_map.insert(std::make_pair(callsite_or_fdecl_t(&fdecl), std::move(a))); 
+  }
+
+  // The SCC is recursive if it has more than one element or
+  // there is only one that calls directly to itself.
+  bool is_recursive_scc(const cg_node_t &n,
+                        const std::vector<cg_node_t> &scc_mems) const {
+    return (scc_mems.size() > 1) ||
+           std::any_of(m_cg.succs(n).first, m_cg.succs(n).second,
+                       [n](const cg_edge_t &e) { return (n == e.dest()); });
+  }
+
+  // Analyze concurrently the SCCs that do not depend on each other.
+  //
+  // In the bottom-up phase, an SCC is analyzed once the summaries of
+  // all its callees are available. In the top-down phase, an SCC is
+  // analyzed once all its callers have been analyzed so that its
+  // calling contexts are complete. The members of an SCC are
+  // analyzed sequentially in the same order as in the sequential
+  // analysis.
+  void run_parallel(scc_graph_t &scc_g, const std::vector<cg_node_t> &rev_order,
+                    const TD_Dom &init) {
+    const unsigned num_sccs = rev_order.size();
+    std::map<cg_node_t, unsigned> scc_index;
+    for (unsigned i = 0; i < num_sccs; ++i) {
+      scc_index.insert(std::make_pair(rev_order[i], i));
+    }
+    std::vector<std::vector<cg_node_t>> scc_mems(num_sccs);
+    std::vector<bool> is_recursive(num_sccs);
+    std::vector<std::vector<unsigned>> callers(num_sccs), callees(num_sccs);
+    for (unsigned i = 0; i < num_sccs; ++i) {
+      const cg_node_t &n = rev_order[i];
+      scc_mems[i] = scc_g.get_component_members(n);
+      is_recursive[i] = is_recursive_scc(n, scc_mems[i]);
+      for (auto const &e : boost::make_iterator_range(scc_g.succs(n))) {
+        auto it = scc_index.find(e.Dest());
+        assert(it != scc_index.end());
+        if (it->second != i) {
+          callees[i].push_back(it->second);
+          callers[it->second].push_back(i);
+        }
+      }
+    }
+
+    crab::thread_pool pool(m_num_threads);
+
+    // Each phase is timed as a whole by the calling thread: the
+    // workers only run the analyses.
+    CRAB_VERBOSE_IF(1, get_msg_stream() << "== Bottom-up phase ...\n";);
+    {
+      crab::ScopedCrabStats __st__("Inter.BottomUp");
+      crab::run_dag(pool, callers, [this, &scc_mems](unsigned i) {
+        for (auto const &m : scc_mems[i]) {
+          compute_summary(m);
+        }
+      });
+    }
+
+    CRAB_VERBOSE_IF(1, get_msg_stream() << "== Top-down phase ...\n";);
+    m_worker_abs_tr.clear();
+    for (unsigned i = 0; i < pool.size(); ++i) {
+      m_worker_abs_tr.emplace_back(
+          new abs_tr_t(make_td_top(), &m_summ_tbl, &m_call_tbl));
+    }
+    // The root is the first SCC in topological order
+    const unsigned root = num_sccs - 1;
+    {
+      crab::ScopedCrabStats __st__("Inter.TopDown");
+      crab::run_dag(pool, callees, [&, this](unsigned i) {
+        abs_tr_t &abs_tr = *m_worker_abs_tr[pool.worker_id()];
+        bool is_root = (i == root);
+        for (auto const &m : scc_mems[i]) {
+          analyze_top_down(m, is_recursive[i], is_root, init, abs_tr);
+          is_root = false;
+        }
+      });
+    }
+  }
+
 public:
   bottom_up_inter_analyzer(CallGraph &cg,
                            TD_Dom td_absval_fac, BU_Dom bu_absval_fac,
 			   const params_t &params = params_t())
     : m_cg(cg), m_td_absval_fac(td_absval_fac), m_bu_absval_fac(bu_absval_fac),
       m_live(params.live_map),
-      m_call_tbl(make_td_top()),
-      m_abs_tr(new abs_tr_t(make_td_top(), &m_summ_tbl, &m_call_tbl)) {
+      m_call_tbl(make_td_top()), m_budget(params.max_total_time),
+      m_abs_tr(new abs_tr_t(make_td_top(), &m_summ_tbl, &m_call_tbl)),
+      m_num_threads(params.num_threads) {
     
     m_fixpo_params.get_widening_delay() = params.widening_delay;
     m_fixpo_params.get_descending_iterations() = params.descending_iters;
     m_fixpo_params.get_max_thresholds() = params.thresholds_size;
+    m_fixpo_params.get_max_time() = params.max_time_per_function;
+    m_fixpo_params.get_max_cycle_iterations() = params.max_cycle_iterations;
+    m_fixpo_params.get_max_state_size() = params.max_state_size;
+    m_fixpo_params.get_global_budget() = &m_budget;
+
+    if (!params.summary_cache_dir.empty()) {
+      // everything that can change a summary except the CFGs
+      std::string config = m_bu_absval_fac.domain_name() + ";" +
+                           std::to_string(params.widening_delay) + ";" +
+                           std::to_string(params.descending_iters) + ";" +
+                           std::to_string(params.thresholds_size) + ";" +
+                           std::to_string(params.max_cycle_iterations) + ";" +
+                           std::to_string(params.max_state_size) + ";" +
+                           std::to_string(params.live_map != nullptr);
+      m_summ_cache.reset(new summ_cache_t(params.summary_cache_dir, config));
+    }
       
     CRAB_VERBOSE_IF(1, get_msg_stream() << "Type checking call graph ... ";);
     crab::CrabStats::resume("CallGraph type checking");
@@ -751,6 +1006,7 @@ public:
     CRAB_LOG("inter", m_cg.write(crab::outs()); crab::outs() << "\n");
 
     crab::ScopedCrabStats __st__("Inter");
+    m_budget.start();
 
     bool has_noedges = true;
     for (auto const &n : boost::make_iterator_range(m_cg.nodes())) {
@@ -790,110 +1046,32 @@ public:
 
     // -- General case
     std::vector<cg_node_t> rev_order;
-    graph_algo::scc_graph<cg_ref_t> Scc_g(m_cg);
+    scc_graph_t Scc_g(m_cg);
     graph_algo::rev_topo_sort(Scc_g, rev_order);
 
-    CRAB_VERBOSE_IF(1, get_msg_stream() << "== Bottom-up phase ...\n";);
-    for (auto const &n : rev_order) {
-      crab::ScopedCrabStats __st__("Inter.BottomUp");
-      std::vector<cg_node_t> &scc_mems = Scc_g.get_component_members(n);
-      for (auto m : scc_mems) {
-
-        auto cfg = m.get_cfg();
-        assert(cfg.has_func_decl());
-        auto const &fdecl = cfg.get_func_decl();
-        const std::string &fun_name = fdecl.get_func_name();
-        if (fun_name != "main") {
-          CRAB_VERBOSE_IF(1, get_msg_stream() << "++ Computing summary for "
-                                              << fun_name << "...\n";);
-
-          // --- collect inputs and outputs
-          std::vector<variable_t> formals, inputs, outputs;
-          formals.reserve(fdecl.get_num_inputs() + fdecl.get_num_outputs());
-          inputs.reserve(fdecl.get_num_inputs());
-          outputs.reserve(fdecl.get_num_outputs());
-
-          for (unsigned i = 0; i < fdecl.get_num_inputs(); i++) {
-            inputs.push_back(fdecl.get_input_name(i));
-            formals.push_back(fdecl.get_input_name(i));
-          }
-          for (unsigned i = 0; i < fdecl.get_num_outputs(); i++) {
-            outputs.push_back(fdecl.get_output_name(i));
-            formals.push_back(fdecl.get_output_name(i));
-          }
-
-          if (outputs.empty()) {
-            BU_Dom summary = make_bu_top();
-            m_summ_tbl.insert(fdecl, summary, inputs, outputs);
-            CRAB_WARN("Skipped summary because function ", fun_name,
-                      " has no output parameters");
-          } else if (!cfg.has_exit()) {
-            CRAB_WARN("Skipped summary because function ", fun_name,
-                      " has no exit block");
-          } else {
-            // --- run the analysis
-            bu_abs_tr abs_tr(std::move(make_bu_top()), &m_summ_tbl);
-            bu_analyzer a(cfg, &abs_tr, m_bu_absval_fac, get_live(cfg), m_fixpo_params);
-            a.run_forward(make_bu_top());
-
-            // --- project onto formal parameters and return values
-            BU_Dom summary = a.get_post(cfg.exit());
-            // crab::CrabStats::count(BU_Dom::getDomainName() +
-            // ".count.project");
-            summary.project(formals);
-            m_summ_tbl.insert(fdecl, summary, inputs, outputs);
-          }
+    if (m_num_threads > 1) {
+      run_parallel(Scc_g, rev_order, init);
+    } else {
+      CRAB_VERBOSE_IF(1, get_msg_stream() << "== Bottom-up phase ...\n";);
+      for (auto const &n : rev_order) {
+        crab::ScopedCrabStats __st__("Inter.BottomUp");
+        std::vector<cg_node_t> &scc_mems = Scc_g.get_component_members(n);
+        for (auto m : scc_mems) {
+          compute_summary(m);
         }
       }
-    }
-
-    CRAB_VERBOSE_IF(1, get_msg_stream() << "== Top-down phase ...\n";);
-    bool is_root = true;
-    for (auto n :
-         boost::make_iterator_range(rev_order.rbegin(), rev_order.rend())) {
-      crab::ScopedCrabStats __st__("Inter.TopDown");
-      std::vector<cg_node_t> &scc_mems = Scc_g.get_component_members(n);
-
-      // The SCC is recursive if it has more than one element or
-      // there is only one that calls directly to itself.
-      bool is_recursive =
-          (scc_mems.size() > 1) ||
-          std::any_of(m_cg.succs(n).first, m_cg.succs(n).second,
-                      [n](const cg_edge_t &e) { return (n == e.dest()); });
-
-      for (auto m : scc_mems) {
-        auto cfg = m.get_cfg();
-        assert(cfg.has_func_decl());
-        auto const &fdecl = cfg.get_func_decl();
-        CRAB_VERBOSE_IF(1, get_msg_stream() << "++ Analyzing function "
-                                            << fdecl.get_func_name() << "\n";);
-        if (is_recursive) {
-          // If the SCC is recursive then what we have in
-          // m_call_tbl is incomplete and therefore it is unsound
-          // to use it. To remedy it, we insert another calling
-          // context with top value that approximates all the
-          // possible calling contexts during the recursive calls.
-          m_call_tbl.insert(fdecl, make_td_top());
-        }
 
-        auto init_inv = init;
-        if (is_root) {
+      CRAB_VERBOSE_IF(1, get_msg_stream() << "== Top-down phase ...\n";);
+      bool is_root = true;
+      for (auto n :
+           boost::make_iterator_range(rev_order.rbegin(), rev_order.rend())) {
+        crab::ScopedCrabStats __st__("Inter.TopDown");
+        std::vector<cg_node_t> &scc_mems = Scc_g.get_component_members(n);
+        bool is_recursive = is_recursive_scc(n, scc_mems);
+        for (auto m : scc_mems) {
+          analyze_top_down(m, is_recursive, is_root, init, *m_abs_tr);
           is_root = false;
-        } else {
-          init_inv = m_call_tbl.get_call_ctx(fdecl);
         }
-
-        CRAB_LOG("inter", crab::outs() << "    Starting analysis of " << fdecl
-                                       << " with " << init_inv << "\n");
-
-        if (init_inv.is_bottom()) {
-          crab::outs() << "Top-down analysis for " << fdecl.get_func_name()
-                       << " started with bottom (i.e., dead function).\n";
-        }
-        td_analyzer_ptr a(new td_analyzer(cfg, &*m_abs_tr, m_td_absval_fac, get_live(cfg), 
-                                          m_fixpo_params));
-        a->run_forward(init_inv);
-        m_inv_map.insert(std::make_pair(callsite_or_fdecl_t(&fdecl), std::move(a))); 
       }
     }
     CRAB_VERBOSE_IF(1, get_msg_stream()
@@ -932,11 +1110,25 @@ public:
   // clear all the analysis' state
   void clear() override {
     m_inv_map.clear();
+    m_worker_abs_tr.clear();
     m_summ_tbl.clear();
     m_call_tbl.clear();
     m_abs_tr->get_abs_value().set_to_top();
   }
 
+  std::vector<std::string> get_degraded_functions() const override {
+    return m_budget.get_degraded();
+  }
+
+  // Return the number of summaries found (hits) and not found
+  // (misses) in the summary cache
+  unsigned get_num_summary_cache_hits() const {
+    return m_summ_cache ? m_summ_cache->num_hits() : 0;
+  }
+  unsigned get_num_summary_cache_misses() const {
+    return m_summ_cache ? m_summ_cache->num_misses() : 0;
+  }
+
   summary_t get_summary(const cfg_t &cfg) const override {
     // TODO: caching
 
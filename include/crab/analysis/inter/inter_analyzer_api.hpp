@@ -1,6 +1,7 @@
 #pragma once
 
 #include <crab/support/debug.hpp>
+#include <string>
 #include <vector>
 
 namespace crab{
@@ -32,6 +33,9 @@ public:
   virtual invariant_abs_dom_t
   get_post(const cfg_t &cfg, const basic_block_label_t &bb) const = 0;
   virtual summary_t get_summary(const cfg_t &cfg) const = 0;
+  // Return the names of the functions whose analysis exceeded some
+  // budget during the last run
+  virtual std::vector<std::string> get_degraded_functions() const = 0;
   virtual void clear() = 0;
 };
 
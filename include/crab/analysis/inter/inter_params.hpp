@@ -2,6 +2,7 @@
 
 #include <crab/analysis/dataflow/liveness.hpp>
 #include <crab/fixpoint/wto.hpp>
+#include <string>
 #include <unordered_map>
 
 namespace crab {
@@ -21,7 +22,10 @@ struct inter_analyzer_parameters {
         live_map(nullptr), 
 	run_checker(true), checker_verbosity(0), keep_cc_invariants(false),
         keep_invariants(true), max_call_contexts(UINT_MAX),
-        analyze_recursive_functions(false), exact_summary_reuse(true) {}
+        analyze_recursive_functions(false), exact_summary_reuse(true),
+        num_threads(1), summary_cache_dir(""), max_time_per_function(0),
+        max_total_time(0),
+        max_cycle_iterations(0), max_state_size(0) {}
 
   // Start the analysis from main
   bool only_main_as_entry;
@@ -47,7 +51,31 @@ struct inter_analyzer_parameters {
   // reuse summaries without losing precision
   bool exact_summary_reuse;
   // -- End parameters for top-down analysis -- //
-  
+
+  // number of threads. The bottom-up analysis uses them to analyze
+  // call graph SCCs that do not depend on each other and the
+  // top-down analysis to analyze the call graph entries.
+  unsigned num_threads;
+
+  // -- Begin parameters for bottom-up analysis -- //
+  // directory where summaries are cached between runs (see
+  // summary_cache.hpp). The directory must exist. Empty means no
+  // cache.
+  std::string summary_cache_dir;
+  // -- End parameters for bottom-up analysis -- //
+
+  // Budgets (0 means no limit). A function whose analysis exceeds
+  // some budget is still analyzed soundly but with less precision.
+  // See crab::fixpoint_parameters.
+  //
+  // maximum time in milliseconds to analyze one function
+  unsigned max_time_per_function;
+  // maximum time in milliseconds for the whole analysis
+  unsigned max_total_time;
+  // maximum number of increasing iterations over a loop
+  unsigned max_cycle_iterations;
+  // maximum number of linear constraints of a loop invariant
+  unsigned max_state_size;
 };
 
 } // namespace analyzer
@@ -0,0 +1,270 @@
+#pragma once
+
+/**
+ * Persistent cache of the summaries computed by
+ * bottom_up_inter_analyzer.
+ *
+ * A summary is stored in the file <dir>/<key>.sum where key is a
+ * 64-bit hash of everything the summary depends on:
+ *
+ *   - the CFG of the function in the CrabIR binary format (see
+ *     crab/cfg/cfg_serialization.hpp),
+ *   - the encoded summaries of its callees when it was analyzed, and
+ *   - the abstract domain and the analysis parameters.
+ *
+ * Layout of a file:
+ *
+ *   magic "CRABSUM" | checksum (8 bytes) | payload
+ *   payload: version key #formals #csts (kind lin-exp)*
+ *
+ * The checksum is the hash of the payload so truncated or corrupted
+ * files are ignored. Variables in the linear expressions are indices
+ * of the formal parameters (inputs followed by outputs) so that a
+ * summary can be read by a process whose variables are different.
+ *
+ * A summary is stored as the linear constraints returned by
+ * to_linear_constraint_system so a cached summary can be less
+ * precise, but never less sound, than the one computed from scratch
+ * if the domain is not convex.
+ **/
+
+#include <crab/cfg/cfg_serialization.hpp>
+#include <crab/support/binary_io.hpp>
+#include <crab/support/debug.hpp>
+#include <crab/support/stats.hpp>
+#include <crab/types/linear_constraints.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace crab {
+namespace analyzer {
+namespace inter_analyzer_impl {
+
+namespace summary_cache_impl {
+static const char magic[] = {'C', 'R', 'A', 'B', 'S', 'U', 'M'};
+static const unsigned version = 1;
+static const std::size_t header_size = sizeof(magic) + 8;
+
+// 64-bit FNV-1a. Unlike std::hash, it is the same across runs and
+// platforms.
+inline uint64_t hash_bytes(const char *data, std::size_t size,
+                           uint64_t h = 14695981039346656037ULL) {
+  for (std::size_t i = 0; i < size; ++i) {
+    h ^= static_cast<uint8_t>(data[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+inline uint64_t hash_bytes(const binary_output &out) {
+  return hash_bytes(out.data(), out.size());
+}
+} // namespace summary_cache_impl
+
+template <typename CFG, typename AbsDomain> class summary_cache {
+public:
+  using fdecl_t = typename CFG::fdecl_t;
+  using number_t = typename CFG::number_t;
+  using varname_t = typename CFG::varname_t;
+  using variable_t = typename CFG::variable_t;
+  using linear_expression_t = ikos::linear_expression<number_t, varname_t>;
+  using linear_constraint_t = ikos::linear_constraint<number_t, varname_t>;
+  using linear_constraint_system_t =
+      ikos::linear_constraint_system<number_t, varname_t>;
+
+private:
+  // directory where summaries are stored. Empty if disabled.
+  std::string m_dir;
+  // abstract domain and analysis parameters
+  std::string m_config;
+  std::atomic<unsigned> m_hits;
+  std::atomic<unsigned> m_misses;
+
+  std::string filename(uint64_t key) const {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx",
+                  static_cast<unsigned long long>(key));
+    return m_dir + "/" + buf + ".sum";
+  }
+
+  static std::vector<variable_t> formals(const fdecl_t &fdecl) {
+    std::vector<variable_t> res;
+    res.reserve(fdecl.get_num_inputs() + fdecl.get_num_outputs());
+    for (unsigned i = 0; i < fdecl.get_num_inputs(); ++i) {
+      res.push_back(fdecl.get_input_name(i));
+    }
+    for (unsigned i = 0; i < fdecl.get_num_outputs(); ++i) {
+      res.push_back(fdecl.get_output_name(i));
+    }
+    return res;
+  }
+
+public:
+  summary_cache(std::string dir, std::string config)
+      : m_dir(dir), m_config(config), m_hits(0), m_misses(0) {}
+
+  summary_cache(const summary_cache<CFG, AbsDomain> &o) = delete;
+  summary_cache<CFG, AbsDomain> &
+  operator=(const summary_cache<CFG, AbsDomain> &o) = delete;
+
+  bool is_enabled() const { return !m_dir.empty(); }
+
+  // Encode sum, a summary of fdecl, into out. Return false if sum
+  // refers to a variable that is not a formal parameter.
+  static bool encode(const fdecl_t &fdecl, const AbsDomain &sum,
+                     binary_output &out) {
+    std::vector<variable_t> params = formals(fdecl);
+    std::unordered_map<variable_t, unsigned> param_ids;
+    for (unsigned i = 0, sz = params.size(); i < sz; ++i) {
+      param_ids.insert({params[i], i});
+    }
+    linear_constraint_system_t csts = sum.to_linear_constraint_system();
+    out.put_varint(params.size());
+    out.put_varint(csts.size());
+    for (auto const &cst : csts) {
+      const linear_expression_t &e = cst.expression();
+      out.put_u8(cst.kind());
+      crab::cfg::cfg_serialization_impl::write_number(out, e.constant());
+      out.put_varint(e.size());
+      for (auto const &kv : e) {
+        auto it = param_ids.find(kv.second);
+        if (it == param_ids.end()) {
+          return false;
+        }
+        out.put_varint(it->second);
+        crab::cfg::cfg_serialization_impl::write_number(out, kv.first);
+      }
+    }
+    return true;
+  }
+
+  // Inverse of encode. sum must be top.
+  static void decode(const fdecl_t &fdecl, binary_input &in, AbsDomain &sum) {
+    std::vector<variable_t> params = formals(fdecl);
+    if (in.get_varint() != params.size()) {
+      CRAB_ERROR("summary_cache: unexpected number of parameters");
+    }
+    linear_constraint_system_t csts;
+    for (uint64_t i = 0, n = in.get_varint(); i < n; ++i) {
+      auto kind = static_cast<typename linear_constraint_t::kind_t>(in.get_u8());
+      number_t k;
+      crab::cfg::cfg_serialization_impl::read_number(in, k);
+      linear_expression_t e(k);
+      for (uint64_t j = 0, m = in.get_varint(); j < m; ++j) {
+        uint64_t id = in.get_varint();
+        number_t coef;
+        crab::cfg::cfg_serialization_impl::read_number(in, coef);
+        if (id >= params.size()) {
+          CRAB_ERROR("summary_cache: unexpected parameter ", id);
+        }
+        e = e + linear_expression_t(coef, params[id]);
+      }
+      csts += linear_constraint_t(e, kind);
+    }
+    sum += csts;
+  }
+
+  // Return the key of the summary of cfg. callees contains the name
+  // and the encoded summary of each callee (empty if the callee had
+  // no summary when cfg was analyzed).
+  uint64_t make_key(
+      const CFG &cfg,
+      const std::vector<std::pair<std::string, binary_output>> &callees) const {
+    using namespace summary_cache_impl;
+    binary_output out;
+    out.put_varint(version);
+    out.put_string(m_config);
+    crab::cfg::cfg_binary_writer<CFG> writer;
+    writer.add(cfg);
+    writer.write(out);
+    out.put_varint(callees.size());
+    for (auto const &kv : callees) {
+      out.put_string(kv.first);
+      out.put_varint(kv.second.size());
+      out.put_varint(hash_bytes(kv.second));
+    }
+    return hash_bytes(out);
+  }
+
+  // Return true and set sum if there is a summary for key
+  bool lookup(uint64_t key, const fdecl_t &fdecl, AbsDomain &sum) {
+    using namespace summary_cache_impl;
+    mapped_file file;
+    bool found = false;
+    if (file.open(filename(key)) && file.size() >= header_size &&
+        std::equal(magic, magic + sizeof(magic), file.data())) {
+      const char *payload = file.data() + header_size;
+      std::size_t payload_size = file.size() - header_size;
+      uint64_t checksum = 0;
+      for (unsigned i = 0; i < 8; ++i) {
+        checksum |= static_cast<uint64_t>(
+                        static_cast<uint8_t>(file.data()[sizeof(magic) + i]))
+                    << (8 * i);
+      }
+      if (checksum == hash_bytes(payload, payload_size)) {
+        binary_input in(payload, payload_size);
+        if (in.get_varint() == version && in.get_varint() == key) {
+          decode(fdecl, in, sum);
+          found = true;
+        }
+      }
+    }
+    if (found) {
+      ++m_hits;
+      crab::CrabStats::count("Inter.SummaryCache.hit");
+    } else {
+      ++m_misses;
+      crab::CrabStats::count("Inter.SummaryCache.miss");
+    }
+    return found;
+  }
+
+  // Store sum as the summary for key. The file is written under a
+  // temporary name and then renamed so that concurrent analyses
+  // never read a partial file.
+  void store(uint64_t key, const fdecl_t &fdecl, const AbsDomain &sum) const {
+    using namespace summary_cache_impl;
+    binary_output payload;
+    payload.put_varint(version);
+    payload.put_varint(key);
+    if (!encode(fdecl, sum, payload)) {
+      return;
+    }
+    binary_output out;
+    out.put_bytes(magic, sizeof(magic));
+    uint64_t checksum = hash_bytes(payload);
+    for (unsigned i = 0; i < 8; ++i) {
+      out.put_u8(static_cast<uint8_t>(checksum >> (8 * i)));
+    }
+    out.append(payload);
+
+    std::string name = filename(key);
+    std::string tmp_name =
+        name + ".tmp" +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                       static_cast<std::size_t>(std::chrono::steady_clock::now()
+                                                    .time_since_epoch()
+                                                    .count()));
+    if (!out.write_to_file(tmp_name) ||
+        std::rename(tmp_name.c_str(), name.c_str()) != 0) {
+      std::remove(tmp_name.c_str());
+      CRAB_WARN("summary_cache: cannot write ", name);
+    }
+  }
+
+  unsigned num_hits() const { return m_hits; }
+  unsigned num_misses() const { return m_misses; }
+};
+
+} // end namespace inter_analyzer_impl
+} // end namespace analyzer
+} // end namespace crab
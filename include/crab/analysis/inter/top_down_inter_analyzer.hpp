@@ -31,11 +31,14 @@
 #include <crab/fixpoint/fixpoint_params.hpp>
 #include <crab/support/debug.hpp>
 #include <crab/support/stats.hpp>
+#include <crab/support/thread_pool.hpp>
 
 #include <crab/checkers/assertion.hpp>
 #include <crab/checkers/base_property.hpp>
 #include <crab/checkers/checker.hpp>
 
+#include <boost/functional/hash.hpp>
+
 #include <algorithm> // sort, set_difference
 #include <climits>
 #include <deque>
@@ -64,6 +67,72 @@ static const std::string TimerInterExtend =
 
 namespace top_down_inter_impl {
 
+/**
+ * A cheap abstraction of an abstract state projected onto the inputs
+ * of a function: the interval of each numerical input and a hash of
+ * these intervals.
+ *
+ * It is used to discard stored calling contexts without calling the
+ * abstract domain's inclusion check. If d <= pre then the box of d is
+ * included in the box of pre and if d and pre are equivalent then
+ * their boxes are equal. A domain that cannot project precisely onto
+ * intervals might make the key reject a context that the inclusion
+ * check would accept. This only causes the callee to be reanalyzed.
+ **/
+template <typename FDecl, typename AbsDom> class calling_context_key {
+  using this_type = calling_context_key<FDecl, AbsDom>;
+  using interval_t = typename AbsDom::interval_t;
+  using bound_t = typename interval_t::bound_t;
+
+  std::vector<interval_t> m_box;
+  std::size_t m_hash;
+
+  static std::size_t hash_bound(const bound_t &b) {
+    if (boost::optional<typename AbsDom::number_t> n = b.number()) {
+      return hash_value(*n);
+    } else {
+      return b.is_plus_infinity() ? 1 : 2;
+    }
+  }
+
+public:
+  calling_context_key(const FDecl &fdecl, const AbsDom &d) : m_hash(0) {
+    m_box.reserve(fdecl.get_num_inputs());
+    for (auto const &v : fdecl.get_inputs()) {
+      if (v.get_type().is_integer() || v.get_type().is_real()) {
+        interval_t i = d.at(v);
+        if (i.is_bottom()) {
+          boost::hash_combine(m_hash, 0);
+        } else {
+          boost::hash_combine(m_hash, hash_bound(i.lb()));
+          boost::hash_combine(m_hash, hash_bound(i.ub()));
+        }
+        m_box.push_back(i);
+      }
+    }
+  }
+
+  std::size_t hash() const { return m_hash; }
+
+  // Return false if the state of this cannot be included in the state
+  // of o.
+  bool may_be_leq(const this_type &o) const {
+    assert(m_box.size() == o.m_box.size());
+    for (unsigned i = 0, e = m_box.size(); i < e; ++i) {
+      if (!(m_box[i] <= o.m_box[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Return false if the state of this cannot be equivalent to the
+  // state of o.
+  bool may_be_equal(const this_type &o) const {
+    return m_hash == o.m_hash && m_box == o.m_box;
+  }
+};
+
 /**
  *  This class represents the calling context of a function F. A
  *  calling context C consists of a summary (pair of pre/post
@@ -83,6 +152,7 @@ public:
   using fdecl_t = typename cfg_t::fdecl_t;
   using abs_dom_t = AbsDom;
   using invariant_map_t = InvariantMap;
+  using key_t = calling_context_key<fdecl_t, abs_dom_t>;
 
 private:
   static_assert(
@@ -109,6 +179,8 @@ private:
   const fdecl_t &m_fdecl;
   abs_dom_t m_pre_summary;  // must be projected on m_fdecl inputs
   abs_dom_t m_post_summary; // must be projected on m_fdecl inputs and outputs
+  // to discard quickly m_pre_summary during subsumption checks
+  key_t m_key;
 
   // invariants that hold at the entry of each function's block
   invariant_map_t m_pre_invariants;
@@ -146,6 +218,7 @@ private:
                   invariant_map_t &&pre_invariants,
                   invariant_map_t &&post_invariants)
       : m_fdecl(fdecl), m_pre_summary(pre_summary), m_post_summary(post_summary),
+        m_key(fdecl, m_pre_summary),
         m_pre_invariants(std::move(pre_invariants)),
         m_post_invariants(std::move(post_invariants)), m_exact(false),
         m_keep_invariants(true) {}
@@ -155,7 +228,7 @@ private:
   calling_context(const fdecl_t &fdecl, abs_dom_t pre_summary,
 		  abs_dom_t post_summary)
       : m_fdecl(fdecl), m_pre_summary(pre_summary),
-	m_post_summary(post_summary), m_exact(false),
+	m_post_summary(post_summary), m_key(fdecl, m_pre_summary), m_exact(false),
         m_keep_invariants(false) {}
 
 public:
@@ -163,6 +236,7 @@ public:
                   bool keep_invariants, invariant_map_t &&pre_invariants,
                   invariant_map_t &&post_invariants)
       : m_fdecl(fdecl), m_pre_summary(pre_summary), m_post_summary(post_summary),
+        m_key(fdecl, m_pre_summary),
         m_pre_invariants(std::move(pre_invariants)),
         m_post_invariants(std::move(post_invariants)), m_exact(true),
         m_keep_invariants(keep_invariants) {
@@ -183,6 +257,20 @@ public:
 
   const abs_dom_t &get_post_summary() const { return m_post_summary; }
 
+  const key_t &get_key() const { return m_key; }
+
+  bool is_exact() const { return m_exact; }
+
+  // Return false if is_subsumed(d, exact_check) cannot succeed where
+  // d_key is the key of d. This check is much cheaper than is_subsumed.
+  bool may_be_subsumed(const key_t &d_key, bool exact_check) const {
+    if (m_exact && exact_check) {
+      return d_key.may_be_equal(m_key);
+    } else {
+      return d_key.may_be_leq(m_key);
+    }
+  }
+
   // Check if d entails the summary precondition
   bool is_subsumed(const abs_dom_t &d, bool exact_check) const {
     const abs_dom_t &pre_summary = get_pre_summary();
@@ -406,6 +494,16 @@ public:
   using calling_context_collection_t = std::deque<calling_context_ptr>;
   using calling_context_table_t =
       std::unordered_map<cfg_t, calling_context_collection_t>;
+  // Positions of the calling contexts of a function in its
+  // collection: the exact contexts are indexed by the hash of their
+  // keys so that exact reuse only probes the contexts with the same
+  // key.
+  struct calling_context_index_t {
+    std::unordered_multimap<std::size_t, unsigned> exact;
+    std::vector<unsigned> inexact;
+  };
+  using calling_context_index_table_t =
+      std::unordered_map<cfg_t, calling_context_index_t>;
   using liveness_map_t =
       std::unordered_map<cfg_t, const live_and_dead_analysis<cfg_t> *>;
   using wto_cg_t = ikos::wto<crab::cg::call_graph_ref<CallGraph>>;
@@ -451,6 +549,7 @@ private:
   bool m_is_checking_phase;
   // -- all calling contexts
   calling_context_table_t m_cc_table;
+  calling_context_index_table_t m_cc_index;
   // -- keep context-sensitive invariants
   bool m_keep_cc_invariants;
   // -- keep context-insensitive invariants: used to populate
@@ -466,9 +565,14 @@ private:
   bool m_only_main_as_entry;
   // -- fixpoint parameters
   fixpoint_parameters m_fixpo_params;
+  // -- time budget of the whole analysis and degraded functions
+  analysis_budget m_budget;
 
+  // other maps block labels to invariants (e.g., the invariant table
+  // of a fixpoint)
+  template <typename OtherMap>
   void join_with(global_invariant_map_t &global_table, cfg_t cfg,
-                 invariant_map_t &other) {
+                 const OtherMap &other) {
     assert(m_keep_invariants);
 
     auto it = global_table.find(cfg);
@@ -562,7 +666,9 @@ public:
                  bool keep_invariants, unsigned int max_call_contexts,
                  bool analyze_recursive_functions, bool exact_summary_reuse,
                  bool only_main_as_entry, unsigned int widening_delay,
-                 unsigned int descending_iters, unsigned int thresholds_size)
+                 unsigned int descending_iters, unsigned int thresholds_size,
+                 unsigned max_time_per_function, unsigned max_total_time,
+                 unsigned max_cycle_iterations, unsigned max_state_size)
       : m_live_map(live_map), 
         m_cs_policy(
             new default_context_sensitivity_policy_t(max_call_contexts)),
@@ -573,10 +679,14 @@ public:
         m_max_call_contexts(max_call_contexts),
         m_analyze_recursive_functions(analyze_recursive_functions),
         m_exact_summary_reuse(exact_summary_reuse),
-        m_only_main_as_entry(only_main_as_entry) {
+        m_only_main_as_entry(only_main_as_entry), m_budget(max_total_time) {
     m_fixpo_params.get_widening_delay() = widening_delay;
     m_fixpo_params.get_descending_iterations() = descending_iters;
     m_fixpo_params.get_max_thresholds() = thresholds_size;
+    m_fixpo_params.get_max_time() = max_time_per_function;
+    m_fixpo_params.get_max_cycle_iterations() = max_cycle_iterations;
+    m_fixpo_params.get_max_state_size() = max_state_size;
+    m_fixpo_params.get_global_budget() = &m_budget;
   }
 
   global_context(const this_type &o) = delete;
@@ -661,6 +771,10 @@ public:
     return m_cc_table;
   }
 
+  calling_context_index_table_t &get_calling_context_index_table() {
+    return m_cc_index;
+  }
+
   func_fixpoint_map_t &get_func_fixpoint_table() {
     return m_func_fixpoint_table;
   }
@@ -681,6 +795,16 @@ public:
 
   const fixpoint_parameters& get_fixpo_params() const { return m_fixpo_params;}
 
+  analysis_budget &get_budget() { return m_budget; }
+
+  // Use budget instead of the budget of this context for the whole
+  // analysis
+  void share_budget(analysis_budget &budget) {
+    m_fixpo_params.get_global_budget() = &budget;
+  }
+
+  const analysis_budget &get_budget() const { return m_budget; }
+
   // context-insensitive invariants for each function (if
   // m_keep_invariants enabled)
 
@@ -700,9 +824,51 @@ public:
     return m_post_invariants;
   }
 
+  // Rebuild the index of the calling contexts of fun. The context
+  // sensitivity policy can join and remove contexts so this is done
+  // after each change of the contexts of fun.
+  void reindex_calling_contexts(cfg_t fun) {
+    const calling_context_collection_t &ccs = m_cc_table[fun];
+    calling_context_index_t &index = m_cc_index[fun];
+    index.exact.clear();
+    index.inexact.clear();
+    for (unsigned i = 0, e = ccs.size(); i < e; ++i) {
+      if (ccs[i]->is_exact()) {
+        index.exact.insert({ccs[i]->get_key().hash(), i});
+      } else {
+        index.inexact.push_back(i);
+      }
+    }
+  }
+
+  // Add the results of other, computed from another call graph
+  // entry, to this context. The calling contexts of other are moved
+  // into this context.
+  void merge(this_type &other) {
+    if (m_keep_invariants) {
+      for (auto &kv : other.m_pre_invariants) {
+        join_with(m_pre_invariants, kv.first, kv.second);
+      }
+      for (auto &kv : other.m_post_invariants) {
+        join_with(m_post_invariants, kv.first, kv.second);
+      }
+    }
+    for (auto &kv : other.m_cc_table) {
+      calling_context_collection_t &ccs = m_cc_table[kv.first];
+      for (auto &cc : kv.second) {
+        m_cs_policy->add(ccs, std::move(cc));
+      }
+      reindex_calling_contexts(kv.first);
+    }
+    other.m_cc_table.clear();
+    other.m_cc_index.clear();
+    m_checks_db += other.m_checks_db;
+  }
+
+  template <typename OtherMap>
   void join_invariants_with(callgraph_node_t cg_node,
-                            invariant_map_t &pre_invariants,
-                            invariant_map_t &post_invariants) {
+                            const OtherMap &pre_invariants,
+                            const OtherMap &post_invariants) {
     if (m_keep_invariants) {
       join_with(get_global_pre_invariants(), cg_node.get_cfg(), pre_invariants);
       join_with(get_global_post_invariants(), cg_node.get_cfg(),
@@ -958,6 +1124,8 @@ public:
       typename global_context_t::calling_context_collection_t;
   using calling_context_table_t =
       typename global_context_t::calling_context_table_t;
+  using calling_context_index_t =
+      typename global_context_t::calling_context_index_t;
   using func_fixpoint_map_entry_t =
       typename global_context_t::func_fixpoint_map_entry_t;
 
@@ -1003,6 +1171,9 @@ private:
       calling_context_collection_t &ccs = it->second;
       cs_policy.add(ccs, std::move(cc));
     }
+    // This is linear in the number of contexts but it only happens
+    // after the callee has been analyzed.
+    m_ctx.reindex_calling_contexts(fun);
     // crab::CrabStats::count("Interprocedural.num_calling_contexts");
   }
 
@@ -1267,15 +1438,21 @@ private:
       CRAB_LOG("inter-subsume", if (call_contexts.empty()) {
 	  crab::outs() << "[INTER] There is no call contexts stored.\n";
 	});
-      for (unsigned i = 0, e = call_contexts.size(); i < e; ++i) {
-        // If the call is recursive then we cannot use exact
-        // subsumption. Otherwise, it's very likely that subsumption
-        // never succeeds. Apart from not having reusing, it will
-        // create problems during the checking phase which assumes
-        // that all function calls are always cached.
-        const bool use_exact_subsumption =
-            (!recursive_call_being_analyzed && m_ctx.exact_summary_reuse());
-
+      // If the call is recursive then we cannot use exact
+      // subsumption. Otherwise, it's very likely that subsumption
+      // never succeeds. Apart from not having reusing, it will
+      // create problems during the checking phase which assumes
+      // that all function calls are always cached.
+      const bool use_exact_subsumption =
+          (!recursive_call_being_analyzed && m_ctx.exact_summary_reuse());
+      const typename calling_context_t::key_t callee_entry_key(fdecl,
+                                                               callee_entry);
+      // contexts already checked with is_subsumed
+      std::vector<bool> probed(call_contexts.size(), false);
+      // Return true if callee_entry is subsumed by the i-th context
+      auto is_subsumed = [&](unsigned i) {
+        probed[i] = true;
+        crab::CrabStats::count("Interprocedural.num_call_context_probes");
         CRAB_LOG("inter-subsume",
 		 if (use_exact_subsumption) {
 		   crab::outs() << "Exact ";
@@ -1286,25 +1463,81 @@ private:
 		              << callee_entry << "\nis subsumed by summary "
 		              << i << "\n";
                  call_contexts[i]->write(crab::outs()); crab::outs() << "\n";);
-	
         if (call_contexts[i]->is_subsumed(callee_entry,
                                           use_exact_subsumption)) {
           CRAB_LOG("inter-subsume", crab::outs() << "succeed!\n";);
-          CRAB_VERBOSE_IF(1, get_msg_stream()
-                                 << "++ Skip redundant analysis of function  "
-                                 << cs.get_func_name() << "\n";);
-
           callee_exit = call_contexts[i]->get_post_summary();
-          call_context_already_seen = true;
-          break;
+          return true;
         } else {
           CRAB_LOG("inter-subsume", crab::outs() << "failed!\n";);
+          return false;
+        }
+      };
+
+      // Return true if the key of the i-th context does not discard
+      // it and callee_entry is subsumed by it.
+      auto probe = [&](unsigned i) {
+        if (!call_contexts[i]->may_be_subsumed(callee_entry_key,
+                                               use_exact_subsumption)) {
+          crab::CrabStats::count("Interprocedural.num_call_context_discarded");
+          CRAB_LOG("inter-subsume", crab::outs() << "Summary " << i
+                                                 << " discarded by its key\n";);
+          return false;
+        }
+        return is_subsumed(i);
+      };
+
+      if (use_exact_subsumption) {
+        // An exact context can only be reused if its key is equal to
+        // callee_entry_key so only the exact contexts with the same
+        // hash and the inexact ones are probed. They are probed in
+        // the same order as they are stored.
+        const calling_context_index_t &index =
+            m_ctx.get_calling_context_index_table()[callee_cfg];
+        std::vector<unsigned> candidates(index.inexact);
+        auto range = index.exact.equal_range(callee_entry_key.hash());
+        for (auto it = range.first; it != range.second; ++it) {
+          candidates.push_back(it->second);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (unsigned i : candidates) {
+          if (probe(i)) {
+            call_context_already_seen = true;
+            break;
+          }
+        }
+      } else {
+        // Inclusion cannot be looked up by hash
+        for (unsigned i = 0, e = call_contexts.size(); i < e; ++i) {
+          if (probe(i)) {
+            call_context_already_seen = true;
+            break;
+          }
+        }
+      }
+      if (!call_context_already_seen && m_ctx.get_is_checking_phase()) {
+        // The checking phase expects all callsites to be cached but
+        // the keys can discard a context that subsumes callee_entry
+        // if the domain does not project precisely onto intervals.
+        for (unsigned i = 0, e = call_contexts.size(); i < e; ++i) {
+          if (!probed[i] && is_subsumed(i)) {
+            call_context_already_seen = true;
+            break;
+          }
         }
       }
     } else {
       CRAB_LOG("inter-subsume", 
 	       crab::outs() << "[INTER] There is no call contexts stored.\n";);
     }
+    if (call_context_already_seen) {
+      crab::CrabStats::count("Interprocedural.num_call_context_hits");
+      CRAB_VERBOSE_IF(1, get_msg_stream()
+                             << "++ Skip redundant analysis of function  "
+                             << cs.get_func_name() << "\n";);
+    } else {
+      crab::CrabStats::count("Interprocedural.num_call_context_misses");
+    }
     crab::CrabStats::stop(TimerInterCheckCache);
 
     if (call_context_already_seen) {
@@ -1699,20 +1932,82 @@ private:
   }
 
   CallGraph &m_cg;
+  params_t m_params;
   global_context_t m_ctx;
   abs_dom_t m_absval_fac;
   std::unique_ptr<td_inter_abs_tr_t> m_abs_tr;
 
+  static global_context_t *make_global_context(const params_t &params) {
+    return new global_context_t(
+        params.live_map, params.run_checker, params.checker_verbosity,
+        params.keep_cc_invariants, params.keep_invariants,
+        params.max_call_contexts, params.analyze_recursive_functions,
+        params.exact_summary_reuse, params.only_main_as_entry,
+        params.widening_delay, params.descending_iters, params.thresholds_size,
+        params.max_time_per_function, params.max_total_time,
+        params.max_cycle_iterations, params.max_state_size);
+  }
+
+  // Analyze the functions reachable from the call graph entry
+  // cg_node, starting with init.
+  void analyze_entry(cg_node_t cg_node, const abs_dom_t &init,
+                     global_context_t &ctx, td_inter_abs_tr_t &abs_tr) {
+    abs_dom_t dom(init);
+    abs_tr.set_abs_value(std::move(dom));
+    ctx.get_call_stack().push_back(cg_node);
+    intra_analyzer_with_call_semantics_t *entry_analysis =
+        top_down_inter_impl::analyze_function<
+            cg_node_t, intra_analyzer_with_call_semantics_t>(
+            cg_node, m_absval_fac, abs_tr, 0);
+    assert(entry_analysis);
+    top_down_inter_impl::check_function(cg_node, *entry_analysis, ctx);
+    ctx.get_call_stack().pop_back();
+    entry_analysis->clear();
+  }
+
+  // Analyze the call graph entries on a pool of threads.
+  //
+  // Each entry is analyzed with its own global context so the
+  // calling contexts computed from one entry are not reused by the
+  // others. The contexts are merged into m_ctx in the order of the
+  // entries so the result does not depend on the schedule.
+  void run_parallel(const std::vector<cg_node_t> &entries,
+                    const abs_dom_t &init) {
+    std::vector<std::unique_ptr<global_context_t>> ctxs(entries.size());
+    {
+      crab::thread_pool pool(m_params.num_threads);
+      for (unsigned i = 0, e = entries.size(); i < e; ++i) {
+        pool.submit([this, i, &entries, &ctxs, &init]() {
+          std::unique_ptr<global_context_t> ctx(
+              make_global_context(m_params));
+          ctx->share_budget(m_ctx.get_budget());
+          ctx->get_widening_set() = m_ctx.get_widening_set();
+          ctx->get_wto_cg_map()[entries[i]].reset(
+              new wto_cg_t(m_cg, entries[i]));
+          td_inter_abs_tr_t abs_tr(m_cg, *ctx, m_absval_fac);
+          analyze_entry(entries[i], init, *ctx, abs_tr);
+          ctxs[i] = std::move(ctx);
+        });
+      }
+      pool.wait();
+    }
+    for (auto &ctx : ctxs) {
+      m_ctx.merge(*ctx);
+    }
+  }
+
 public:
   top_down_inter_analyzer(CallGraph &cg, abs_dom_t absval_fac,
                           const params_t &params = params_t())
-      : m_cg(cg),
+      : m_cg(cg), m_params(params),
         m_ctx(params.live_map, params.run_checker,
               params.checker_verbosity, params.keep_cc_invariants,
               params.keep_invariants, params.max_call_contexts,
               params.analyze_recursive_functions, params.exact_summary_reuse,
               params.only_main_as_entry, params.widening_delay,
-              params.descending_iters, params.thresholds_size),
+              params.descending_iters, params.thresholds_size,
+              params.max_time_per_function, params.max_total_time,
+              params.max_cycle_iterations, params.max_state_size),
 	m_absval_fac(absval_fac),
         m_abs_tr(new td_inter_abs_tr_t(m_cg, m_ctx, m_absval_fac)) {
     crab::CrabStats::start(TimerCallGraphTC);
@@ -1742,6 +2037,7 @@ public:
    **/
   void run(abs_dom_t init) override {
     crab::ScopedCrabStats __st__(TimerInter);
+    m_ctx.get_budget().start();
 
     CRAB_VERBOSE_IF(
         1, get_msg_stream()
@@ -1787,6 +2083,7 @@ public:
 			  << "Started inter-procedural analysis *only* from main.\n";
 		      });
     
+      std::vector<cg_node_t> analyzed_entries;
       for (auto cg_node : entries) {
         if (m_ctx.only_main_as_entry()) {
           if (cg_node.name() != "main") {
@@ -1796,18 +2093,15 @@ public:
             continue;
           }
         }
+        analyzed_entries.push_back(cg_node);
+      }
 
-        abs_dom_t dom(init);
-        m_abs_tr->set_abs_value(std::move(dom));
-        m_ctx.get_call_stack().push_back(cg_node);
-        intra_analyzer_with_call_semantics_t *entry_analysis =
-            top_down_inter_impl::analyze_function<
-                cg_node_t, intra_analyzer_with_call_semantics_t>
-	  (cg_node, m_absval_fac, *m_abs_tr, 0);
-        assert(entry_analysis);
-        top_down_inter_impl::check_function(cg_node, *entry_analysis, m_ctx);
-        m_ctx.get_call_stack().pop_back();
-        entry_analysis->clear();
+      if (m_params.num_threads > 1 && analyzed_entries.size() > 1) {
+        run_parallel(analyzed_entries, init);
+      } else {
+        for (auto cg_node : analyzed_entries) {
+          analyze_entry(cg_node, init, m_ctx, *m_abs_tr);
+        }
       }
       CRAB_VERBOSE_IF(1, get_msg_stream()
                              << "Finished inter-procedural analysis\n";);
@@ -1840,6 +2134,10 @@ public:
         "clear operation of the inter-procedural analysis not implemented yet");
   }
 
+  std::vector<std::string> get_degraded_functions() const override {
+    return m_ctx.get_budget().get_degraded();
+  }
+
   // TODO: caching
   summary_t get_summary(const cfg_t &cfg) const override {
     summary_t summary(cfg.get_func_decl());
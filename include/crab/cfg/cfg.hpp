@@ -109,6 +109,8 @@
 #include <boost/range/iterator_range.hpp>
 #include <boost/variant.hpp>
 #include <boost/optional.hpp>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -285,6 +287,8 @@ inline crab_os &operator<<(crab_os &o, const debug_info &l) {
 template <class BasicBlockLabel, class VariableName, class Number>
 class basic_block;
 
+template <class CFG> class cfg_binary_reader;
+
 template <class BasicBlockLabel, class Number, class VariableName>
 struct statement_visitor;
 
@@ -540,6 +544,8 @@ public:
 
   const variable_t &get_variable() const { return m_lhs; }
 
+  const std::string &get_comment() const { return m_comment; }
+
   virtual void
   accept(statement_visitor<BasicBlockLabel, Number, VariableName> *v) override {
     v->visit(*this);
@@ -2240,6 +2246,7 @@ class cfg;
 template <class BasicBlockLabel, class VariableName, class Number>
 class basic_block {
   friend class cfg<BasicBlockLabel, VariableName, Number>;
+  template <class CFG> friend class cfg_binary_reader;
 
 public:
   using number_t = Number;
@@ -2333,6 +2340,19 @@ private:
   bool m_insert_point_at_front;
   // set of used/def variables
   live_domain_t m_live;
+  // dense id assigned by cfg::build_index
+  unsigned m_block_id;
+  // flag of the owning cfg telling whether its block index is valid
+  // (null if the block is not owned by a cfg)
+  std::atomic<bool> *m_owner_indexed;
+
+  // Any change to the edges or statements of the block drops the
+  // block index of the owning cfg.
+  void invalidate_index() {
+    if (m_owner_indexed) {
+      *m_owner_indexed = false;
+    }
+  }
 
   void insert_adjacent(bb_id_set_t &c, BasicBlockLabel e) {
     if (std::find(c.begin(), c.end(), e) == c.end()) {
@@ -2348,7 +2368,8 @@ private:
 
   basic_block(BasicBlockLabel bb_id)
       : m_bb_id(bb_id), m_insert_point_at_front(false),
-        m_live(live_domain_t::bottom()) {}
+        m_live(live_domain_t::bottom()), m_block_id(0),
+        m_owner_indexed(nullptr) {}
 
   static basic_block_t *create(BasicBlockLabel bb_id) {
     return new basic_block_t(bb_id);
@@ -2365,6 +2386,7 @@ private:
   }
 
   const statement_t *insert(statement_t *stmt) {
+    invalidate_index();
     if (m_insert_point_at_front) {
       m_stmts.insert(m_stmts.begin(), stmt);
       m_insert_point_at_front = false;
@@ -2411,6 +2433,10 @@ public:
 
   const BasicBlockLabel &label() const { return m_bb_id; }
 
+  // Dense id of the block. Only meaningful if the block index of the
+  // owning cfg is built (see cfg::build_index).
+  unsigned block_id() const { return m_block_id; }
+
   std::string name() const {
     return basic_block_traits<basic_block_t>::to_string(m_bb_id);
   }
@@ -2493,12 +2519,16 @@ public:
 
   // Add a cfg edge from *this to b
   void add_succ(basic_block_t &b) {
+    invalidate_index();
+    b.invalidate_index();
     insert_adjacent(m_next, b.m_bb_id);
     insert_adjacent(b.m_prev, m_bb_id);
   }
 
   // Remove a cfg edge from *this to b
   void operator-=(basic_block_t &b) {
+    invalidate_index();
+    b.invalidate_index();
     remove_adjacent(m_next, b.m_bb_id);
     remove_adjacent(b.m_prev, m_bb_id);
   }
@@ -2511,6 +2541,7 @@ public:
                    std::back_inserter(cloned_stmts),
                    [this](const statement_t *s) { return s->clone(this); });
 
+    invalidate_index();
     m_stmts.insert(m_stmts.begin(), cloned_stmts.begin(), cloned_stmts.end());
     m_live = m_live | other.m_live;
   }
@@ -2523,12 +2554,15 @@ public:
                    std::back_inserter(cloned_stmts),
                    [this](const statement_t *s) { return s->clone(this); });
 
+    invalidate_index();
     m_stmts.insert(m_stmts.end(), cloned_stmts.begin(), cloned_stmts.end());
     m_live = m_live | other.m_live;
   }
 
   // insert all statements of other at the back
   void move_back(basic_block_t &other) {
+    invalidate_index();
+    other.invalidate_index();
     m_stmts.reserve(m_stmts.size() + other.m_stmts.size());
     std::move(other.m_stmts.begin(), other.m_stmts.end(),
               std::back_inserter(m_stmts));
@@ -2536,6 +2570,7 @@ public:
 
   // Remove s (and free) from this
   void remove(const statement_t *s, bool must_update_uses_and_defs = true) {
+    invalidate_index();
     // remove statement using the remove-erase idiom
     m_stmts.erase(
         std::remove_if(m_stmts.begin(), m_stmts.end(),
@@ -2553,6 +2588,7 @@ public:
   // Post: old is deleted (and freed) and new is at position i in
   //       the basic block.
   void replace(statement_t *old_s, statement_t *new_s) {
+    invalidate_index();
     std::replace(m_stmts.begin(), m_stmts.end(), old_s, new_s);
     delete old_s;
   }
@@ -3330,11 +3366,22 @@ public:
   using var_iterator = typename std::vector<varname_t>::iterator;
   using const_var_iterator = typename std::vector<varname_t>::const_iterator;
 
+  using id_range =
+      boost::iterator_range<typename std::vector<unsigned>::const_iterator>;
+
 private:
   BasicBlockLabel m_entry;
   boost::optional<BasicBlockLabel> m_exit;
   basic_block_map_t m_blocks;
   fdecl_t m_func_decl;
+  // Dense block ids built by build_index. m_index_blocks maps each id
+  // to its block and the successors (predecessors) of block i are
+  // m_succ_ids[m_succ_offsets[i]..m_succ_offsets[i+1]).
+  std::atomic<bool> m_indexed;
+  std::mutex m_index_mutex;
+  std::vector<basic_block_t *> m_index_blocks;
+  std::vector<unsigned> m_succ_offsets, m_succ_ids;
+  std::vector<unsigned> m_pred_offsets, m_pred_ids;
 
   using visited_t = std::unordered_set<BasicBlockLabel>;
   template <typename T>
@@ -3354,6 +3401,12 @@ private:
     dfs_rec(m_entry, visited, f);
   }
 
+  // The cfg takes ownership of bb: later edits of bb drop the index.
+  void insert_block(basic_block_t *bb) {
+    bb->m_owner_indexed = &m_indexed;
+    m_blocks.insert(binding_t(bb->label(), bb));
+  }
+
   struct print_block {
     crab_os &m_o;
     print_block(crab_os &o) : m_o(o) {}
@@ -3362,24 +3415,26 @@ private:
 
 public:
   // --- needed by crab::cg::call_graph<CFG>::cg_node
-  cfg() {}
+  cfg() : m_indexed(false) {}
 
   cfg(const cfg_t &o) = delete;
 
   cfg_t &operator=(const cfg_t &o) = delete;
 
-  cfg(BasicBlockLabel entry) : m_entry(entry), m_exit(boost::none) {
-    m_blocks.insert(binding_t(m_entry, basic_block_t::create(m_entry)));
+  cfg(BasicBlockLabel entry)
+      : m_entry(entry), m_exit(boost::none), m_indexed(false) {
+    insert_block(basic_block_t::create(m_entry));
   }
 
   cfg(BasicBlockLabel entry, BasicBlockLabel exit)
-      : m_entry(entry), m_exit(exit) {
-    m_blocks.insert(binding_t(m_entry, basic_block_t::create(m_entry)));
+      : m_entry(entry), m_exit(exit), m_indexed(false) {
+    insert_block(basic_block_t::create(m_entry));
   }
 
   cfg(BasicBlockLabel entry, BasicBlockLabel exit, fdecl_t func_decl)
-      : m_entry(entry), m_exit(exit), m_func_decl(func_decl) {
-    m_blocks.insert(binding_t(m_entry, basic_block_t::create(m_entry)));
+      : m_entry(entry), m_exit(exit), m_func_decl(func_decl),
+        m_indexed(false) {
+    insert_block(basic_block_t::create(m_entry));
   }
 
   // The cfg owns the basic blocks
@@ -3396,8 +3451,7 @@ public:
     copy_cfg->m_func_decl = m_func_decl;
 
     for (auto const &bb : boost::make_iterator_range(begin(), end())) {
-      basic_block_t *copy_bb = bb.clone();
-      copy_cfg->m_blocks.insert(binding_t(copy_bb->label(), copy_bb));
+      copy_cfg->insert_block(bb.clone());
     }
     return copy_cfg;
   }
@@ -3469,14 +3523,117 @@ public:
   }
 
   // --- End ikos fixpoint API
-  
+
+  // --- Begin block index API
+  //
+  // Assign to each block a dense id in [0, size()) and store the
+  // successors and predecessors of each block as arrays of ids so
+  // that analyses can keep per-block data in flat vectors instead of
+  // hash tables keyed by label. The entry gets id 0, then the blocks
+  // reachable from it and finally the unreachable ones.
+  //
+  // The index is dropped by any change to the blocks of the cfg or
+  // to their edges and statements (e.g., insert, remove, >> and -=)
+  // and build_index must be called again before using it. The
+  // analyses call it before they start, it does nothing if the index
+  // is already built. It can be called concurrently by analyses that
+  // share the cfg but not while the cfg is modified.
+  void build_index() {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    if (m_indexed) {
+      return;
+    }
+    m_index_blocks.clear();
+    m_index_blocks.reserve(m_blocks.size());
+    visited_t visited;
+    std::vector<basic_block_t *> stack;
+    auto visit = [&](basic_block_t *bb) {
+      if (visited.insert(bb->label()).second) {
+        bb->m_block_id = m_index_blocks.size();
+        m_index_blocks.push_back(bb);
+        stack.push_back(bb);
+      }
+    };
+    auto number_from = [&](basic_block_t *root) {
+      visit(root);
+      while (!stack.empty()) {
+        basic_block_t *bb = stack.back();
+        stack.pop_back();
+        for (auto const &l : boost::make_iterator_range(bb->next_blocks())) {
+          visit(&get_node(l));
+        }
+      }
+    };
+    number_from(&get_node(m_entry));
+    for (auto &kv : m_blocks) {
+      number_from(kv.second);
+    }
+
+    const unsigned n = m_index_blocks.size();
+    m_succ_offsets.assign(1, 0);
+    m_pred_offsets.assign(1, 0);
+    m_succ_ids.clear();
+    m_pred_ids.clear();
+    for (unsigned i = 0; i < n; ++i) {
+      basic_block_t &bb = *m_index_blocks[i];
+      for (auto const &l : boost::make_iterator_range(bb.next_blocks())) {
+        m_succ_ids.push_back(get_node(l).m_block_id);
+      }
+      for (auto const &l : boost::make_iterator_range(bb.prev_blocks())) {
+        m_pred_ids.push_back(get_node(l).m_block_id);
+      }
+      m_succ_offsets.push_back(m_succ_ids.size());
+      m_pred_offsets.push_back(m_pred_ids.size());
+    }
+    m_indexed = true;
+  }
+
+  bool is_indexed() const { return m_indexed; }
+
+  unsigned block_id(BasicBlockLabel bb_id) const {
+    assert(m_indexed);
+    return get_node(bb_id).m_block_id;
+  }
+
+  const BasicBlockLabel &block_label(unsigned id) const {
+    assert(m_indexed && id < m_index_blocks.size());
+    return m_index_blocks[id]->label();
+  }
+
+  basic_block_t &get_node_by_id(unsigned id) {
+    assert(m_indexed && id < m_index_blocks.size());
+    return *m_index_blocks[id];
+  }
+
+  const basic_block_t &get_node_by_id(unsigned id) const {
+    assert(m_indexed && id < m_index_blocks.size());
+    return *m_index_blocks[id];
+  }
+
+  id_range next_ids(unsigned id) const {
+    assert(m_indexed && id < m_index_blocks.size());
+    return boost::make_iterator_range(m_succ_ids.begin() + m_succ_offsets[id],
+                                      m_succ_ids.begin() +
+                                          m_succ_offsets[id + 1]);
+  }
+
+  id_range prev_ids(unsigned id) const {
+    assert(m_indexed && id < m_index_blocks.size());
+    return boost::make_iterator_range(m_pred_ids.begin() + m_pred_offsets[id],
+                                      m_pred_ids.begin() +
+                                          m_pred_offsets[id + 1]);
+  }
+
+  // --- End block index API
+
   basic_block_t &insert(BasicBlockLabel bb_id) {
     auto it = m_blocks.find(bb_id);
     if (it != m_blocks.end())
       return *(it->second);
 
+    m_indexed = false;
     basic_block_t *block = basic_block_t::create(bb_id);
-    m_blocks.insert(binding_t(bb_id, block));
+    insert_block(block);
     return *block;
   }
 
@@ -3510,6 +3667,7 @@ public:
       (*p.first) -= (*p.second);
     }
 
+    m_indexed = false;
     m_blocks.erase(bb_id);
     delete bb;
   }
@@ -3816,6 +3974,7 @@ public:
   using const_label_iterator = typename CFG::const_label_iterator;
   using var_iterator = typename CFG::var_iterator;
   using const_var_iterator = typename CFG::const_var_iterator;
+  using id_range = typename CFG::id_range;
 
 private:
   CFG* m_ref;
@@ -3869,6 +4028,38 @@ public:
     return get().get_node(bb);
   }
 
+  void build_index() {
+    get().build_index();
+  }
+
+  bool is_indexed() const {
+    return get().is_indexed();
+  }
+
+  unsigned block_id(basic_block_label_t bb) const {
+    return get().block_id(bb);
+  }
+
+  const basic_block_label_t &block_label(unsigned id) const {
+    return get().block_label(id);
+  }
+
+  basic_block_t &get_node_by_id(unsigned id) {
+    return get().get_node_by_id(id);
+  }
+
+  const basic_block_t &get_node_by_id(unsigned id) const {
+    return get().get_node_by_id(id);
+  }
+
+  id_range next_ids(unsigned id) const {
+    return get().next_ids(id);
+  }
+
+  id_range prev_ids(unsigned id) const {
+    return get().prev_ids(id);
+  }
+
   size_t size() const {
     return get().size();
   }
@@ -3954,6 +4145,7 @@ public:
   using succ_range = typename CFGRef::pred_range;
   using const_pred_range = typename CFGRef::const_succ_range;
   using const_succ_range = typename CFGRef::const_pred_range;
+  using id_range = typename CFGRef::id_range;
 
   // For BGL
   using succ_iterator = typename basic_block_t::succ_iterator;
@@ -4069,6 +4261,22 @@ public:
 
   pred_range prev_nodes(basic_block_label_t bb) { return _cfg.next_nodes(bb); }
 
+  void build_index() { _cfg.build_index(); }
+
+  bool is_indexed() const { return _cfg.is_indexed(); }
+
+  unsigned block_id(basic_block_label_t bb) const { return _cfg.block_id(bb); }
+
+  const basic_block_label_t &block_label(unsigned id) const {
+    return _cfg.block_label(id);
+  }
+
+  id_range next_ids(unsigned id) const { return _cfg.prev_ids(id); }
+
+  id_range prev_ids(unsigned id) const { return _cfg.next_ids(id); }
+
+  size_t size() const { return _cfg.size(); }
+
   basic_block_t &get_node(basic_block_label_t bb_id) {
     auto it = _rev_bbs.find(bb_id);
     if (it == _rev_bbs.end())
@@ -0,0 +1,1049 @@
+#pragma once
+
+/**
+ * Binary format for CrabIR.
+ *
+ * A file contains a sequence of CFGs, e.g., all the functions of a
+ * program, so that they can be cached between runs instead of being
+ * rebuilt by the front-end. The call graph of the program is not
+ * stored since it is built from its CFGs.
+ *
+ * Layout (integers are LEB128 varints, see crab/support/binary_io.hpp):
+ *
+ *   magic "CRABIR" | version
+ *   string table:   #strings  (length bytes)*
+ *   variable table: #vars     (name type-kind bitwidth)*
+ *   #cfgs cfg*
+ *
+ * Variable names, block labels, function names and file names are
+ * indices into the string table and variables are indices into the
+ * variable table. Each statement is its stmt_code followed by its
+ * debug info and its operands.
+ *
+ * The reader decodes the file in place from a memory-mapped view.
+ * Each string and variable is converted only once into a label or a
+ * variable name of the client, no matter how many times it occurs.
+ **/
+
+#include <crab/cfg/basic_block_traits.hpp>
+#include <crab/cfg/cfg.hpp>
+#include <crab/numbers/bignums.hpp>
+#include <crab/support/binary_io.hpp>
+#include <crab/support/debug.hpp>
+#include <crab/types/tag.hpp>
+
+#include <boost/optional.hpp>
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crab {
+namespace cfg {
+
+namespace cfg_serialization_impl {
+
+static const char magic[] = {'C', 'R', 'A', 'B', 'I', 'R'};
+static const unsigned version = 1;
+
+inline void write_number(binary_output &out, const ikos::z_number &n) {
+  if (n.fits_int64()) {
+    out.put_u8(0);
+    out.put_svarint(static_cast<int64_t>(n));
+  } else {
+    out.put_u8(1);
+    out.put_string(n.get_str());
+  }
+}
+
+inline void read_number(binary_input &in, ikos::z_number &n) {
+  if (in.get_u8() == 0) {
+    n = ikos::z_number(in.get_svarint());
+  } else {
+    n = ikos::z_number(in.get_string());
+  }
+}
+
+inline void write_number(binary_output &out, const ikos::q_number &n) {
+  write_number(out, n.numerator());
+  write_number(out, n.denominator());
+}
+
+inline void read_number(binary_input &in, ikos::q_number &n) {
+  ikos::z_number num, den;
+  read_number(in, num);
+  read_number(in, den);
+  n = ikos::q_number(num, den);
+}
+
+// Encoding of a reference constraint
+enum ref_cst_form { REF_CST_TRUE, REF_CST_FALSE, REF_CST_UNARY, REF_CST_BINARY };
+enum ref_cst_rel { REL_EQ, REL_DISEQ, REL_LEQ, REL_LT, REL_GEQ, REL_GT };
+
+} // namespace cfg_serialization_impl
+
+/**
+ * Encode CFGs into the binary format.
+ *
+ * CFG can be a cfg, cfg_ref or any other class with the same
+ * interface. Variable names must provide str().
+ **/
+template <class CFG> class cfg_binary_writer {
+public:
+  using basic_block_t = typename CFG::basic_block_t;
+  using basic_block_label_t = typename CFG::basic_block_label_t;
+  using number_t = typename CFG::number_t;
+  using varname_t = typename CFG::varname_t;
+  using variable_t = typename CFG::variable_t;
+  using statement_t = typename basic_block_t::statement_t;
+
+private:
+  using variable_or_constant_t = typename basic_block_t::variable_or_constant_t;
+  using lin_exp_t = typename basic_block_t::lin_exp_t;
+  using lin_cst_t = typename basic_block_t::lin_cst_t;
+  using ref_cst_t = typename basic_block_t::ref_cst_t;
+
+  binary_output m_body;
+  unsigned m_num_cfgs;
+  std::vector<std::string> m_strings;
+  std::unordered_map<std::string, unsigned> m_string_ids;
+  std::vector<variable_t> m_vars;
+  std::unordered_map<ikos::index_t, unsigned> m_var_ids;
+
+  unsigned string_id(const std::string &s) {
+    auto it = m_string_ids.find(s);
+    if (it != m_string_ids.end()) {
+      return it->second;
+    }
+    unsigned id = m_strings.size();
+    m_strings.push_back(s);
+    m_string_ids.insert({s, id});
+    return id;
+  }
+
+  void put_string(const std::string &s) { m_body.put_varint(string_id(s)); }
+
+  void put_label(const basic_block_label_t &l) {
+    put_string(basic_block_traits<basic_block_t>::to_string(l));
+  }
+
+  void put_type(const variable_type &ty, binary_output &out) const {
+    out.put_u8(ty.get_kind());
+    if (ty.is_integer()) {
+      out.put_varint(ty.get_integer_bitwidth());
+    } else if (ty.is_integer_region()) {
+      out.put_varint(ty.get_integer_region_bitwidth());
+    } else {
+      out.put_varint(0);
+    }
+  }
+
+  void put_var(const variable_t &v) {
+    auto it = m_var_ids.find(v.index());
+    unsigned id;
+    if (it != m_var_ids.end()) {
+      id = it->second;
+    } else {
+      id = m_vars.size();
+      m_vars.push_back(v);
+      m_var_ids.insert({v.index(), id});
+      string_id(v.name().str());
+    }
+    m_body.put_varint(id);
+  }
+
+  void put_opt_var(const boost::optional<variable_t> &v) {
+    m_body.put_u8(v ? 1 : 0);
+    if (v) {
+      put_var(*v);
+    }
+  }
+
+  void put_vars(const std::vector<variable_t> &vs) {
+    m_body.put_varint(vs.size());
+    for (auto const &v : vs) {
+      put_var(v);
+    }
+  }
+
+  void put_number(const number_t &n) {
+    cfg_serialization_impl::write_number(m_body, n);
+  }
+
+  void put_var_or_cst(const variable_or_constant_t &v) {
+    if (v.is_variable()) {
+      m_body.put_u8(0);
+      put_var(v.get_variable());
+    } else {
+      m_body.put_u8(1);
+      put_number(v.get_constant());
+      put_type(v.get_type(), m_body);
+    }
+  }
+
+  void put_lin_exp(const lin_exp_t &e) {
+    put_number(e.constant());
+    m_body.put_varint(e.size());
+    for (auto const &kv : e) {
+      put_var(kv.second);
+      put_number(kv.first);
+    }
+  }
+
+  void put_lin_cst(const lin_cst_t &c) {
+    m_body.put_u8(c.kind());
+    put_lin_exp(c.expression());
+  }
+
+  void put_ref_cst(const ref_cst_t &c) {
+    using namespace cfg_serialization_impl;
+    if (c.is_tautology()) {
+      m_body.put_u8(REF_CST_TRUE);
+      return;
+    } else if (c.is_contradiction()) {
+      m_body.put_u8(REF_CST_FALSE);
+      return;
+    }
+    m_body.put_u8(c.is_unary() ? REF_CST_UNARY : REF_CST_BINARY);
+    if (c.is_equality()) {
+      m_body.put_u8(REL_EQ);
+    } else if (c.is_disequality()) {
+      m_body.put_u8(REL_DISEQ);
+    } else if (c.is_less_or_equal_than()) {
+      m_body.put_u8(REL_LEQ);
+    } else if (c.is_less_than()) {
+      m_body.put_u8(REL_LT);
+    } else if (c.is_greater_or_equal_than()) {
+      m_body.put_u8(REL_GEQ);
+    } else {
+      m_body.put_u8(REL_GT);
+    }
+    put_var(c.lhs());
+    if (c.is_binary()) {
+      put_var(c.rhs());
+      put_number(c.offset());
+    }
+  }
+
+  void put_debug_info(const debug_info &dbg) {
+    if (!dbg.has_debug()) {
+      m_body.put_u8(0);
+      return;
+    }
+    m_body.put_u8(1);
+    put_string(dbg.get_file());
+    m_body.put_svarint(dbg.get_line());
+    m_body.put_svarint(dbg.get_column());
+    m_body.put_svarint(dbg.get_id());
+  }
+
+  void put_statement(const statement_t &s) {
+    using B = basic_block_t;
+    if (s.is_bin_op()) {
+      m_body.put_u8(BIN_OP);
+    } else if (s.is_assign()) {
+      m_body.put_u8(ASSIGN);
+    } else if (s.is_assume()) {
+      m_body.put_u8(ASSUME);
+    } else if (s.is_unreachable()) {
+      m_body.put_u8(UNREACH);
+    } else if (s.is_select()) {
+      m_body.put_u8(SELECT);
+    } else if (s.is_assert()) {
+      m_body.put_u8(ASSERT);
+    } else if (s.is_int_cast()) {
+      m_body.put_u8(INT_CAST);
+    } else if (s.is_havoc()) {
+      m_body.put_u8(HAVOC);
+    } else if (s.is_arr_init()) {
+      m_body.put_u8(ARR_INIT);
+    } else if (s.is_arr_write()) {
+      m_body.put_u8(ARR_STORE);
+    } else if (s.is_arr_read()) {
+      m_body.put_u8(ARR_LOAD);
+    } else if (s.is_arr_assign()) {
+      m_body.put_u8(ARR_ASSIGN);
+    } else if (s.is_ref_make()) {
+      m_body.put_u8(REF_MAKE);
+    } else if (s.is_ref_remove()) {
+      m_body.put_u8(REF_REMOVE);
+    } else if (s.is_ref_load()) {
+      m_body.put_u8(REF_LOAD);
+    } else if (s.is_ref_store()) {
+      m_body.put_u8(REF_STORE);
+    } else if (s.is_ref_gep()) {
+      m_body.put_u8(REF_GEP);
+    } else if (s.is_ref_assume()) {
+      m_body.put_u8(REF_ASSUME);
+    } else if (s.is_ref_assert()) {
+      m_body.put_u8(REF_ASSERT);
+    } else if (s.is_ref_select()) {
+      m_body.put_u8(REF_SELECT);
+    } else if (s.is_ref_to_int()) {
+      m_body.put_u8(REF_TO_INT);
+    } else if (s.is_int_to_ref()) {
+      m_body.put_u8(INT_TO_REF);
+    } else if (s.is_region_init()) {
+      m_body.put_u8(REGION_INIT);
+    } else if (s.is_region_copy()) {
+      m_body.put_u8(REGION_COPY);
+    } else if (s.is_region_cast()) {
+      m_body.put_u8(REGION_CAST);
+    } else if (s.is_callsite()) {
+      m_body.put_u8(CALLSITE);
+    } else if (s.is_intrinsic()) {
+      m_body.put_u8(CRAB_INTRINSIC);
+    } else if (s.is_bool_bin_op()) {
+      m_body.put_u8(BOOL_BIN_OP);
+    } else if (s.is_bool_assign_cst()) {
+      m_body.put_u8(BOOL_ASSIGN_CST);
+    } else if (s.is_bool_assign_var()) {
+      m_body.put_u8(BOOL_ASSIGN_VAR);
+    } else if (s.is_bool_assume()) {
+      m_body.put_u8(BOOL_ASSUME);
+    } else if (s.is_bool_select()) {
+      m_body.put_u8(BOOL_SELECT);
+    } else if (s.is_bool_assert()) {
+      m_body.put_u8(BOOL_ASSERT);
+    } else {
+      CRAB_ERROR("cfg_binary_writer: unsupported statement");
+    }
+    put_debug_info(s.get_debug_info());
+
+    if (s.is_bin_op()) {
+      auto const &st = static_cast<const typename B::bin_op_t &>(s);
+      put_var(st.lhs());
+      m_body.put_u8(st.op());
+      put_lin_exp(st.left());
+      put_lin_exp(st.right());
+    } else if (s.is_assign()) {
+      auto const &st = static_cast<const typename B::assign_t &>(s);
+      put_var(st.lhs());
+      put_lin_exp(st.rhs());
+    } else if (s.is_assume()) {
+      auto const &st = static_cast<const typename B::assume_t &>(s);
+      put_lin_cst(st.constraint());
+    } else if (s.is_unreachable()) {
+      // no operands
+    } else if (s.is_select()) {
+      auto const &st = static_cast<const typename B::select_t &>(s);
+      put_var(st.lhs());
+      put_lin_cst(st.cond());
+      put_lin_exp(st.left());
+      put_lin_exp(st.right());
+    } else if (s.is_assert()) {
+      auto const &st = static_cast<const typename B::assert_t &>(s);
+      put_lin_cst(st.constraint());
+    } else if (s.is_int_cast()) {
+      auto const &st = static_cast<const typename B::int_cast_t &>(s);
+      m_body.put_u8(st.op());
+      put_var(st.src());
+      put_var(st.dst());
+    } else if (s.is_havoc()) {
+      auto const &st = static_cast<const typename B::havoc_t &>(s);
+      put_var(st.get_variable());
+      put_string(st.get_comment());
+    } else if (s.is_arr_init()) {
+      auto const &st = static_cast<const typename B::arr_init_t &>(s);
+      put_var(st.array());
+      put_lin_exp(st.elem_size());
+      put_lin_exp(st.lb_index());
+      put_lin_exp(st.ub_index());
+      put_lin_exp(st.val());
+    } else if (s.is_arr_write()) {
+      auto const &st = static_cast<const typename B::arr_store_t &>(s);
+      put_var(st.array());
+      put_lin_exp(st.elem_size());
+      put_lin_exp(st.lb_index());
+      put_lin_exp(st.ub_index());
+      put_lin_exp(st.value());
+      m_body.put_u8(st.is_strong_update() ? 1 : 0);
+    } else if (s.is_arr_read()) {
+      auto const &st = static_cast<const typename B::arr_load_t &>(s);
+      put_var(st.lhs());
+      put_var(st.array());
+      put_lin_exp(st.elem_size());
+      put_lin_exp(st.index());
+    } else if (s.is_arr_assign()) {
+      auto const &st = static_cast<const typename B::arr_assign_t &>(s);
+      put_var(st.lhs());
+      put_var(st.rhs());
+    } else if (s.is_ref_make()) {
+      auto const &st = static_cast<const typename B::make_ref_t &>(s);
+      put_var(st.lhs());
+      put_var(st.region());
+      put_var_or_cst(st.size());
+      m_body.put_varint(st.alloc_site().index());
+    } else if (s.is_ref_remove()) {
+      auto const &st = static_cast<const typename B::remove_ref_t &>(s);
+      put_var(st.region());
+      put_var(st.ref());
+    } else if (s.is_ref_load()) {
+      auto const &st = static_cast<const typename B::load_from_ref_t &>(s);
+      put_var(st.lhs());
+      put_var(st.ref());
+      put_var(st.region());
+    } else if (s.is_ref_store()) {
+      auto const &st = static_cast<const typename B::store_to_ref_t &>(s);
+      put_var(st.ref());
+      put_var(st.region());
+      put_var_or_cst(st.val());
+    } else if (s.is_ref_gep()) {
+      auto const &st = static_cast<const typename B::gep_ref_t &>(s);
+      put_var(st.lhs());
+      put_var(st.lhs_region());
+      put_var(st.rhs());
+      put_var(st.rhs_region());
+      put_lin_exp(st.offset());
+    } else if (s.is_ref_assume()) {
+      auto const &st = static_cast<const typename B::assume_ref_t &>(s);
+      put_ref_cst(st.constraint());
+    } else if (s.is_ref_assert()) {
+      auto const &st = static_cast<const typename B::assert_ref_t &>(s);
+      put_ref_cst(st.constraint());
+    } else if (s.is_ref_select()) {
+      auto const &st = static_cast<const typename B::ref_select_t &>(s);
+      put_var(st.lhs_ref());
+      put_var(st.lhs_rgn());
+      put_var(st.cond());
+      put_var_or_cst(st.left_ref());
+      put_opt_var(st.left_rgn());
+      put_var_or_cst(st.right_ref());
+      put_opt_var(st.right_rgn());
+    } else if (s.is_ref_to_int()) {
+      auto const &st = static_cast<const typename B::ref_to_int_t &>(s);
+      put_var(st.region());
+      put_var(st.ref_var());
+      put_var(st.int_var());
+    } else if (s.is_int_to_ref()) {
+      auto const &st = static_cast<const typename B::int_to_ref_t &>(s);
+      put_var(st.int_var());
+      put_var(st.region());
+      put_var(st.ref_var());
+    } else if (s.is_region_init()) {
+      auto const &st = static_cast<const typename B::region_init_t &>(s);
+      put_var(st.region());
+    } else if (s.is_region_copy()) {
+      auto const &st = static_cast<const typename B::region_copy_t &>(s);
+      put_var(st.lhs_region());
+      put_var(st.rhs_region());
+    } else if (s.is_region_cast()) {
+      auto const &st = static_cast<const typename B::region_cast_t &>(s);
+      put_var(st.src());
+      put_var(st.dst());
+    } else if (s.is_callsite()) {
+      auto const &st = static_cast<const typename B::callsite_t &>(s);
+      put_string(st.get_func_name());
+      put_vars(st.get_lhs());
+      put_vars(st.get_args());
+    } else if (s.is_intrinsic()) {
+      auto const &st = static_cast<const typename B::intrinsic_t &>(s);
+      put_string(st.get_intrinsic_name());
+      put_vars(st.get_lhs());
+      m_body.put_varint(st.get_args().size());
+      for (auto const &arg : st.get_args()) {
+        put_var_or_cst(arg);
+      }
+    } else if (s.is_bool_bin_op()) {
+      auto const &st = static_cast<const typename B::bool_bin_op_t &>(s);
+      put_var(st.lhs());
+      m_body.put_u8(st.op());
+      put_var(st.left());
+      put_var(st.right());
+    } else if (s.is_bool_assign_cst()) {
+      auto const &st = static_cast<const typename B::bool_assign_cst_t &>(s);
+      put_var(st.lhs());
+      if (st.is_rhs_linear_constraint()) {
+        m_body.put_u8(0);
+        put_lin_cst(st.rhs_as_linear_constraint());
+      } else {
+        m_body.put_u8(1);
+        put_ref_cst(st.rhs_as_reference_constraint());
+      }
+    } else if (s.is_bool_assign_var()) {
+      auto const &st = static_cast<const typename B::bool_assign_var_t &>(s);
+      put_var(st.lhs());
+      put_var(st.rhs());
+      m_body.put_u8(st.is_rhs_negated() ? 1 : 0);
+    } else if (s.is_bool_assume()) {
+      auto const &st = static_cast<const typename B::bool_assume_t &>(s);
+      put_var(st.cond());
+      m_body.put_u8(st.is_negated() ? 1 : 0);
+    } else if (s.is_bool_select()) {
+      auto const &st = static_cast<const typename B::bool_select_t &>(s);
+      put_var(st.lhs());
+      put_var(st.cond());
+      put_var(st.left());
+      put_var(st.right());
+    } else if (s.is_bool_assert()) {
+      auto const &st = static_cast<const typename B::bool_assert_t &>(s);
+      put_var(st.cond());
+    }
+  }
+
+public:
+  cfg_binary_writer() : m_num_cfgs(0) {}
+
+  cfg_binary_writer(const cfg_binary_writer &o) = delete;
+
+  cfg_binary_writer &operator=(const cfg_binary_writer &o) = delete;
+
+  //! Encode cfg after the CFGs added so far.
+  void add(const CFG &cfg) {
+    m_num_cfgs++;
+    bool has_decl = cfg.has_func_decl();
+    m_body.put_u8((has_decl ? 1 : 0) | (cfg.has_exit() ? 2 : 0));
+    if (has_decl) {
+      auto const &decl = cfg.get_func_decl();
+      put_string(decl.get_func_name());
+      m_body.put_varint(decl.get_num_inputs());
+      for (unsigned i = 0, e = decl.get_num_inputs(); i < e; ++i) {
+        put_var(decl.get_input_name(i));
+      }
+      m_body.put_varint(decl.get_num_outputs());
+      for (unsigned i = 0, e = decl.get_num_outputs(); i < e; ++i) {
+        put_var(decl.get_output_name(i));
+      }
+    }
+    put_label(cfg.entry());
+    if (cfg.has_exit()) {
+      put_label(cfg.exit());
+    }
+    m_body.put_varint(cfg.size());
+    for (auto const &b : cfg) {
+      put_label(b.label());
+      m_body.put_varint(b.size());
+      for (auto const &s : b) {
+        put_statement(s);
+      }
+      auto succs = b.next_blocks();
+      m_body.put_varint(std::distance(succs.first, succs.second));
+      for (auto it = succs.first; it != succs.second; ++it) {
+        put_label(*it);
+      }
+      auto preds = b.prev_blocks();
+      m_body.put_varint(std::distance(preds.first, preds.second));
+      for (auto it = preds.first; it != preds.second; ++it) {
+        put_label(*it);
+      }
+    }
+  }
+
+  //! Write the CFGs added so far into out.
+  void write(binary_output &out) const {
+    out.put_bytes(cfg_serialization_impl::magic,
+                  sizeof(cfg_serialization_impl::magic));
+    out.put_varint(cfg_serialization_impl::version);
+    out.put_varint(m_strings.size());
+    for (auto const &s : m_strings) {
+      out.put_string(s);
+    }
+    out.put_varint(m_vars.size());
+    for (auto const &v : m_vars) {
+      out.put_varint(m_string_ids.at(v.name().str()));
+      put_type(v.get_type(), out);
+    }
+    out.put_varint(m_num_cfgs);
+    out.append(m_body);
+  }
+
+  //! Write the CFGs added so far into filename. Return false if the
+  //! file cannot be written.
+  bool write(const std::string &filename) const {
+    binary_output out;
+    write(out);
+    return out.write_to_file(filename);
+  }
+};
+
+/**
+ * Decode CFGs from the binary format.
+ *
+ * CFG must be a cfg. The client provides how to create the variable
+ * names and block labels from their strings. Allocation sites are
+ * created by a tag_manager so that two sites are equal iff they were
+ * equal when the CFGs were written.
+ **/
+template <class CFG> class cfg_binary_reader {
+public:
+  using cfg_t = CFG;
+  using basic_block_t = typename CFG::basic_block_t;
+  using basic_block_label_t = typename CFG::basic_block_label_t;
+  using number_t = typename CFG::number_t;
+  using varname_t = typename CFG::varname_t;
+  using variable_t = typename CFG::variable_t;
+  using fdecl_t = typename CFG::fdecl_t;
+  using make_varname_t = std::function<varname_t(const std::string &)>;
+  using make_label_t = std::function<basic_block_label_t(const std::string &)>;
+
+private:
+  using variable_or_constant_t = typename basic_block_t::variable_or_constant_t;
+  using lin_exp_t = typename basic_block_t::lin_exp_t;
+  using lin_cst_t = typename basic_block_t::lin_cst_t;
+  using ref_cst_t = typename basic_block_t::ref_cst_t;
+  using statement_t = typename basic_block_t::statement_t;
+
+  make_varname_t m_make_varname;
+  make_label_t m_make_label;
+  tag_manager *m_tags;
+
+  // string table: views of the input
+  std::vector<std::pair<const char *, std::size_t>> m_strings;
+  std::vector<boost::optional<basic_block_label_t>> m_labels;
+  std::vector<variable_t> m_vars;
+  std::unordered_map<uint64_t, tag> m_alloc_sites;
+  binary_input m_in;
+
+  std::string get_string() {
+    uint64_t id = m_in.get_varint();
+    if (id >= m_strings.size()) {
+      CRAB_ERROR("cfg_binary_reader: string out of range");
+    }
+    return std::string(m_strings[id].first, m_strings[id].second);
+  }
+
+  basic_block_label_t get_label() {
+    uint64_t id = m_in.get_varint();
+    if (id >= m_strings.size()) {
+      CRAB_ERROR("cfg_binary_reader: label out of range");
+    }
+    if (!m_labels[id]) {
+      m_labels[id] = m_make_label(
+          std::string(m_strings[id].first, m_strings[id].second));
+    }
+    return *m_labels[id];
+  }
+
+  variable_type get_type(binary_input &in) {
+    variable_type_kind kind = static_cast<variable_type_kind>(in.get_u8());
+    unsigned bitwidth = in.get_varint();
+    return variable_type(kind, bitwidth);
+  }
+
+  const variable_t &get_var() {
+    uint64_t id = m_in.get_varint();
+    if (id >= m_vars.size()) {
+      CRAB_ERROR("cfg_binary_reader: variable out of range");
+    }
+    return m_vars[id];
+  }
+
+  boost::optional<variable_t> get_opt_var() {
+    if (m_in.get_u8()) {
+      return get_var();
+    }
+    return boost::none;
+  }
+
+  std::vector<variable_t> get_vars() {
+    std::vector<variable_t> res;
+    uint64_t n = m_in.get_varint();
+    res.reserve(n);
+    for (uint64_t i = 0; i < n; ++i) {
+      res.push_back(get_var());
+    }
+    return res;
+  }
+
+  number_t get_number() {
+    number_t n;
+    cfg_serialization_impl::read_number(m_in, n);
+    return n;
+  }
+
+  variable_or_constant_t get_var_or_cst() {
+    if (m_in.get_u8() == 0) {
+      return variable_or_constant_t(get_var());
+    }
+    number_t n = get_number();
+    return variable_or_constant_t(n, get_type(m_in));
+  }
+
+  lin_exp_t get_lin_exp() {
+    lin_exp_t e(get_number());
+    uint64_t n = m_in.get_varint();
+    for (uint64_t i = 0; i < n; ++i) {
+      const variable_t &v = get_var();
+      e = e + lin_exp_t(get_number(), v);
+    }
+    return e;
+  }
+
+  lin_cst_t get_lin_cst() {
+    auto kind = static_cast<typename lin_cst_t::kind_t>(m_in.get_u8());
+    return lin_cst_t(get_lin_exp(), kind);
+  }
+
+  ref_cst_t get_ref_cst() {
+    using namespace cfg_serialization_impl;
+    unsigned form = m_in.get_u8();
+    if (form == REF_CST_TRUE) {
+      return ref_cst_t::mk_true();
+    } else if (form == REF_CST_FALSE) {
+      return ref_cst_t::mk_false();
+    }
+    unsigned rel = m_in.get_u8();
+    variable_t lhs = get_var();
+    if (form == REF_CST_UNARY) {
+      switch (rel) {
+      case REL_EQ:
+        return ref_cst_t::mk_null(lhs);
+      case REL_DISEQ:
+        return ref_cst_t::mk_not_null(lhs);
+      case REL_LEQ:
+        return ref_cst_t::mk_le_null(lhs);
+      case REL_LT:
+        return ref_cst_t::mk_lt_null(lhs);
+      case REL_GEQ:
+        return ref_cst_t::mk_ge_null(lhs);
+      default:
+        return ref_cst_t::mk_gt_null(lhs);
+      }
+    }
+    variable_t rhs = get_var();
+    number_t offset = get_number();
+    switch (rel) {
+    case REL_EQ:
+      return ref_cst_t::mk_eq(lhs, rhs, offset);
+    case REL_DISEQ:
+      return ref_cst_t::mk_not_eq(lhs, rhs, offset);
+    case REL_LEQ:
+      return ref_cst_t::mk_le(lhs, rhs, offset);
+    case REL_LT:
+      return ref_cst_t::mk_lt(lhs, rhs, offset);
+    case REL_GEQ:
+      return ref_cst_t::mk_ge(lhs, rhs, offset);
+    default:
+      return ref_cst_t::mk_gt(lhs, rhs, offset);
+    }
+  }
+
+  debug_info get_debug_info() {
+    if (m_in.get_u8() == 0) {
+      return debug_info();
+    }
+    std::string file = get_string();
+    int64_t line = m_in.get_svarint();
+    int64_t col = m_in.get_svarint();
+    int64_t id = m_in.get_svarint();
+    return debug_info(file, line, col, id);
+  }
+
+  tag get_alloc_site() {
+    uint64_t id = m_in.get_varint();
+    auto it = m_alloc_sites.find(id);
+    if (it != m_alloc_sites.end()) {
+      return it->second;
+    }
+    if (!m_tags) {
+      CRAB_ERROR("cfg_binary_reader: a tag_manager is needed to read "
+                 "allocation sites");
+    }
+    tag t = m_tags->mk_tag();
+    m_alloc_sites.insert({id, t});
+    return t;
+  }
+
+  statement_t *get_statement(basic_block_t *b) {
+    using B = basic_block_t;
+    unsigned code = m_in.get_u8();
+    debug_info dbg = get_debug_info();
+    switch (code) {
+    case BIN_OP: {
+      variable_t lhs = get_var();
+      auto op = static_cast<binary_operation_t>(m_in.get_u8());
+      lin_exp_t op1 = get_lin_exp();
+      lin_exp_t op2 = get_lin_exp();
+      return new typename B::bin_op_t(lhs, op, op1, op2, b, dbg);
+    }
+    case ASSIGN: {
+      variable_t lhs = get_var();
+      return new typename B::assign_t(lhs, get_lin_exp(), b);
+    }
+    case ASSUME:
+      return new typename B::assume_t(get_lin_cst(), b);
+    case UNREACH:
+      return new typename B::unreach_t(b);
+    case SELECT: {
+      variable_t lhs = get_var();
+      lin_cst_t cond = get_lin_cst();
+      lin_exp_t e1 = get_lin_exp();
+      lin_exp_t e2 = get_lin_exp();
+      return new typename B::select_t(lhs, cond, e1, e2, b);
+    }
+    case ASSERT:
+      return new typename B::assert_t(get_lin_cst(), b, dbg);
+    case INT_CAST: {
+      auto op = static_cast<cast_operation_t>(m_in.get_u8());
+      variable_t src = get_var();
+      variable_t dst = get_var();
+      return new typename B::int_cast_t(op, src, dst, b, dbg);
+    }
+    case HAVOC: {
+      variable_t lhs = get_var();
+      return new typename B::havoc_t(lhs, get_string(), b);
+    }
+    case ARR_INIT: {
+      variable_t a = get_var();
+      lin_exp_t elem_size = get_lin_exp();
+      lin_exp_t lb = get_lin_exp();
+      lin_exp_t ub = get_lin_exp();
+      lin_exp_t val = get_lin_exp();
+      return new typename B::arr_init_t(a, elem_size, lb, ub, val, b);
+    }
+    case ARR_STORE: {
+      variable_t a = get_var();
+      lin_exp_t elem_size = get_lin_exp();
+      lin_exp_t lb = get_lin_exp();
+      lin_exp_t ub = get_lin_exp();
+      lin_exp_t val = get_lin_exp();
+      bool is_strong_update = m_in.get_u8();
+      return new typename B::arr_store_t(a, elem_size, lb, ub, val,
+                                         is_strong_update, b);
+    }
+    case ARR_LOAD: {
+      variable_t lhs = get_var();
+      variable_t a = get_var();
+      lin_exp_t elem_size = get_lin_exp();
+      lin_exp_t idx = get_lin_exp();
+      return new typename B::arr_load_t(lhs, a, elem_size, idx, b);
+    }
+    case ARR_ASSIGN: {
+      variable_t lhs = get_var();
+      variable_t rhs = get_var();
+      return new typename B::arr_assign_t(lhs, rhs, b);
+    }
+    case REF_MAKE: {
+      variable_t lhs = get_var();
+      variable_t region = get_var();
+      variable_or_constant_t size = get_var_or_cst();
+      tag as = get_alloc_site();
+      return new typename B::make_ref_t(lhs, region, size, as, b, dbg);
+    }
+    case REF_REMOVE: {
+      variable_t region = get_var();
+      variable_t ref = get_var();
+      return new typename B::remove_ref_t(region, ref, b, dbg);
+    }
+    case REF_LOAD: {
+      variable_t lhs = get_var();
+      variable_t ref = get_var();
+      variable_t region = get_var();
+      return new typename B::load_from_ref_t(lhs, ref, region, b, dbg);
+    }
+    case REF_STORE: {
+      variable_t ref = get_var();
+      variable_t region = get_var();
+      variable_or_constant_t val = get_var_or_cst();
+      return new typename B::store_to_ref_t(ref, region, val, b, dbg);
+    }
+    case REF_GEP: {
+      variable_t lhs = get_var();
+      variable_t lhs_region = get_var();
+      variable_t rhs = get_var();
+      variable_t rhs_region = get_var();
+      lin_exp_t offset = get_lin_exp();
+      return new typename B::gep_ref_t(lhs, lhs_region, rhs, rhs_region,
+                                       offset, b, dbg);
+    }
+    case REF_ASSUME:
+      return new typename B::assume_ref_t(get_ref_cst(), b);
+    case REF_ASSERT:
+      return new typename B::assert_ref_t(get_ref_cst(), b, dbg);
+    case REF_SELECT: {
+      variable_t lhs_ref = get_var();
+      variable_t lhs_rgn = get_var();
+      variable_t cond = get_var();
+      variable_or_constant_t op1_ref = get_var_or_cst();
+      boost::optional<variable_t> op1_rgn = get_opt_var();
+      variable_or_constant_t op2_ref = get_var_or_cst();
+      boost::optional<variable_t> op2_rgn = get_opt_var();
+      return new typename B::ref_select_t(lhs_ref, lhs_rgn, cond, op1_ref,
+                                          op1_rgn, op2_ref, op2_rgn, b);
+    }
+    case REF_TO_INT: {
+      variable_t region = get_var();
+      variable_t ref_var = get_var();
+      variable_t int_var = get_var();
+      return new typename B::ref_to_int_t(region, ref_var, int_var, b, dbg);
+    }
+    case INT_TO_REF: {
+      variable_t int_var = get_var();
+      variable_t region = get_var();
+      variable_t ref_var = get_var();
+      return new typename B::int_to_ref_t(int_var, region, ref_var, b, dbg);
+    }
+    case REGION_INIT:
+      return new typename B::region_init_t(get_var(), b, dbg);
+    case REGION_COPY: {
+      variable_t lhs = get_var();
+      variable_t rhs = get_var();
+      return new typename B::region_copy_t(lhs, rhs, b);
+    }
+    case REGION_CAST: {
+      variable_t src = get_var();
+      variable_t dst = get_var();
+      return new typename B::region_cast_t(src, dst, b);
+    }
+    case CALLSITE: {
+      std::string name = get_string();
+      std::vector<variable_t> lhs = get_vars();
+      std::vector<variable_t> args = get_vars();
+      return new typename B::callsite_t(name, lhs, args, b);
+    }
+    case CRAB_INTRINSIC: {
+      std::string name = get_string();
+      std::vector<variable_t> lhs = get_vars();
+      std::vector<variable_or_constant_t> args;
+      uint64_t n = m_in.get_varint();
+      args.reserve(n);
+      for (uint64_t i = 0; i < n; ++i) {
+        args.push_back(get_var_or_cst());
+      }
+      return new typename B::intrinsic_t(name, lhs, args, b, dbg);
+    }
+    case BOOL_BIN_OP: {
+      variable_t lhs = get_var();
+      auto op = static_cast<bool_binary_operation_t>(m_in.get_u8());
+      variable_t op1 = get_var();
+      variable_t op2 = get_var();
+      return new typename B::bool_bin_op_t(lhs, op, op1, op2, b, dbg);
+    }
+    case BOOL_ASSIGN_CST: {
+      variable_t lhs = get_var();
+      if (m_in.get_u8() == 0) {
+        return new typename B::bool_assign_cst_t(lhs, get_lin_cst(), b);
+      } else {
+        return new typename B::bool_assign_cst_t(lhs, get_ref_cst(), b);
+      }
+    }
+    case BOOL_ASSIGN_VAR: {
+      variable_t lhs = get_var();
+      variable_t rhs = get_var();
+      bool is_not_rhs = m_in.get_u8();
+      return new typename B::bool_assign_var_t(lhs, rhs, is_not_rhs, b);
+    }
+    case BOOL_ASSUME: {
+      variable_t c = get_var();
+      bool is_negated = m_in.get_u8();
+      return new typename B::bool_assume_t(c, is_negated, b);
+    }
+    case BOOL_SELECT: {
+      variable_t lhs = get_var();
+      variable_t cond = get_var();
+      variable_t b1 = get_var();
+      variable_t b2 = get_var();
+      return new typename B::bool_select_t(lhs, cond, b1, b2, b);
+    }
+    case BOOL_ASSERT:
+      return new typename B::bool_assert_t(get_var(), b, dbg);
+    default:
+      CRAB_ERROR("cfg_binary_reader: unexpected statement code ", code);
+    }
+  }
+
+  std::unique_ptr<CFG> get_cfg() {
+    unsigned flags = m_in.get_u8();
+    fdecl_t decl;
+    if (flags & 1) {
+      std::string name = get_string();
+      std::vector<variable_t> inputs = get_vars();
+      std::vector<variable_t> outputs = get_vars();
+      decl = fdecl_t(name, inputs, outputs);
+    }
+    basic_block_label_t entry = get_label();
+    std::unique_ptr<CFG> cfg(new CFG(entry));
+    if (flags & 1) {
+      cfg->set_func_decl(decl);
+    }
+    if (flags & 2) {
+      cfg->set_exit(get_label());
+    }
+    uint64_t num_blocks = m_in.get_varint();
+    for (uint64_t i = 0; i < num_blocks; ++i) {
+      basic_block_t &b = cfg->insert(get_label());
+      uint64_t num_stmts = m_in.get_varint();
+      b.m_stmts.reserve(num_stmts);
+      for (uint64_t j = 0; j < num_stmts; ++j) {
+        b.insert(get_statement(&b));
+      }
+      // The edges are restored as they were, including their order.
+      uint64_t num_succs = m_in.get_varint();
+      b.m_next.reserve(num_succs);
+      for (uint64_t j = 0; j < num_succs; ++j) {
+        b.m_next.push_back(get_label());
+      }
+      uint64_t num_preds = m_in.get_varint();
+      b.m_prev.reserve(num_preds);
+      for (uint64_t j = 0; j < num_preds; ++j) {
+        b.m_prev.push_back(get_label());
+      }
+    }
+    return cfg;
+  }
+
+public:
+  cfg_binary_reader(make_varname_t make_varname, make_label_t make_label,
+                    tag_manager *tags = nullptr)
+      : m_make_varname(make_varname), m_make_label(make_label),
+        m_tags(tags) {}
+
+  cfg_binary_reader(const cfg_binary_reader &o) = delete;
+
+  cfg_binary_reader &operator=(const cfg_binary_reader &o) = delete;
+
+  //! Decode all the CFGs from the size bytes at data.
+  std::vector<std::unique_ptr<CFG>> read(const char *data, std::size_t size) {
+    m_in = binary_input(data, size);
+    const char *magic = m_in.get_bytes(sizeof(cfg_serialization_impl::magic));
+    if (std::memcmp(magic, cfg_serialization_impl::magic,
+                    sizeof(cfg_serialization_impl::magic)) != 0) {
+      CRAB_ERROR("cfg_binary_reader: not a CrabIR file");
+    }
+    if (m_in.get_varint() != cfg_serialization_impl::version) {
+      CRAB_ERROR("cfg_binary_reader: unsupported CrabIR version");
+    }
+    uint64_t num_strings = m_in.get_varint();
+    m_strings.clear();
+    m_strings.reserve(num_strings);
+    for (uint64_t i = 0; i < num_strings; ++i) {
+      m_strings.push_back(m_in.get_string_ref());
+    }
+    m_labels.assign(num_strings, boost::none);
+    uint64_t num_vars = m_in.get_varint();
+    m_vars.clear();
+    m_vars.reserve(num_vars);
+    for (uint64_t i = 0; i < num_vars; ++i) {
+      std::string name = get_string();
+      variable_type ty = get_type(m_in);
+      m_vars.push_back(variable_t(m_make_varname(name), ty));
+    }
+    std::vector<std::unique_ptr<CFG>> cfgs;
+    uint64_t num_cfgs = m_in.get_varint();
+    cfgs.reserve(num_cfgs);
+    for (uint64_t i = 0; i < num_cfgs; ++i) {
+      cfgs.push_back(get_cfg());
+    }
+    if (!m_in.at_end()) {
+      CRAB_ERROR("cfg_binary_reader: unexpected data after the last CFG");
+    }
+    m_strings.clear();
+    m_labels.clear();
+    return cfgs;
+  }
+
+  //! Decode all the CFGs stored in filename.
+  std::vector<std::unique_ptr<CFG>> read(const std::string &filename) {
+    mapped_file file;
+    if (!file.open(filename)) {
+      CRAB_ERROR("cfg_binary_reader: cannot open ", filename);
+    }
+    return read(file.data(), file.size());
+  }
+};
+
+} // end namespace cfg
+} // end namespace crab
@@ -54,6 +54,10 @@ public:
     return "user-defined assertion checker";
   }
 
+  virtual std::shared_ptr<base_checker_t> clone() const override {
+    return std::make_shared<assert_property_checker>(this->m_verbose);
+  }
+
   virtual bool is_interesting(const basic_block_t &bb) const override {
     for (auto &s : bb) {
       if (s.is_assert() || s.is_bool_assert() || s.is_ref_assert()) {
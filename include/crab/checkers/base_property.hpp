@@ -8,6 +8,7 @@
 #include <crab/support/debug.hpp>
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -584,6 +585,25 @@ public:
 
   virtual std::string get_property_name() const { return "dummy property"; }
 
+  // Return a new checker for the same property with an empty
+  // database, or nullptr if the checker cannot be copied. The
+  // checkers use the copies to check blocks in parallel.
+  virtual std::shared_ptr<property_checker<Analyzer>> clone() const {
+    return nullptr;
+  }
+
+  // Append the checks of other after the checks of this.
+  void merge(const property_checker<Analyzer> &other) {
+    m_db += other.m_db;
+    m_safe_checks.insert(m_safe_checks.end(), other.m_safe_checks.begin(),
+                         other.m_safe_checks.end());
+    m_warning_checks.insert(m_warning_checks.end(),
+                            other.m_warning_checks.begin(),
+                            other.m_warning_checks.end());
+    m_error_checks.insert(m_error_checks.end(), other.m_error_checks.begin(),
+                          other.m_error_checks.end());
+  }
+
   void write(crab_os &o) const {
     o << get_property_name() << "\n";
     m_db.write(o);
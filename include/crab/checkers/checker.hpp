@@ -8,8 +8,13 @@
 #include <crab/analysis/inter/bottom_up_inter_analyzer.hpp>
 #include <crab/checkers/base_property.hpp>
 #include <crab/support/stats.hpp>
+#include <crab/support/thread_pool.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <set>
+#include <type_traits>
+#include <vector>
 
 namespace crab {
 
@@ -22,6 +27,14 @@ template <typename Analyzer> class checker {
     checking for the properties. The analysis results are shared by
     all the property checkers so the analysis needs to be run only
     once.
+
+    Once the invariants are known the blocks can be checked
+    independently. If the number of threads is greater than one then
+    the blocks are split into contiguous chunks and each chunk is
+    checked with its own copy of the abstract transformer and of the
+    property checkers. The copies are merged back in the order of the
+    chunks so the results are the same as with one thread. Only the
+    order of the messages printed by verbose checkers can differ.
    */
 
 public:
@@ -29,10 +42,117 @@ public:
   using prop_checker_vector = std::vector<prop_checker_ptr>;
 
 protected:
+  using cfg_t = typename Analyzer::cfg_t;
+  using basic_block_t = typename cfg_t::basic_block_t;
+  using statement_t = typename cfg_t::statement_t;
+  using abs_dom_t = typename Analyzer::abs_dom_t;
+  using abs_tr_t = typename Analyzer::abs_tr_t;
+
   prop_checker_vector m_checkers;
+  // number of threads used to check the blocks
+  unsigned m_num_threads;
+
+  // Check the blocks in [begin, end) where get_pre(i) returns the
+  // invariants that hold at the entry of blocks[i].
+  template <class GetPre>
+  static void check_blocks(const std::vector<basic_block_t *> &blocks,
+                           unsigned begin, unsigned end, const GetPre &get_pre,
+                           abs_tr_t &abs_tr,
+                           const prop_checker_vector &checkers,
+                           const std::set<const statement_t *> &safe_assertions,
+                           bool only_interesting_blocks) {
+    for (unsigned i = begin; i < end; ++i) {
+      basic_block_t &bb = *blocks[i];
+      for (auto checker : checkers) {
+        if (only_interesting_blocks && !checker->is_interesting(bb)) {
+          continue;
+        }
+        crab::ScopedCrabStats __st__("Checker." +
+                                     checker->get_property_name());
+        abs_dom_t inv = get_pre(i);
+        abs_tr.set_abs_value(std::move(inv));
+        // propagate forward the invariants from the block entry
+        // while checking the property
+        checker->set(&abs_tr, safe_assertions);
+        for (auto &stmt : bb) {
+          stmt.accept(&*checker);
+        }
+      }
+    }
+  }
+
+  template <class GetPre>
+  bool check_blocks_in_parallel(
+      const std::vector<basic_block_t *> &blocks, const GetPre &get_pre,
+      abs_tr_t &abs_tr, const std::set<const statement_t *> &safe_assertions,
+      bool only_interesting_blocks, std::false_type) {
+    return false;
+  }
+
+  template <class GetPre>
+  bool check_blocks_in_parallel(
+      const std::vector<basic_block_t *> &blocks, const GetPre &get_pre,
+      abs_tr_t &abs_tr, const std::set<const statement_t *> &safe_assertions,
+      bool only_interesting_blocks, std::true_type) {
+    const unsigned num_blocks = blocks.size();
+    // more chunks than threads so that idle threads can steal work
+    const unsigned num_chunks = std::min(num_blocks, m_num_threads * 4);
+    std::vector<prop_checker_vector> chunk_checkers(num_chunks);
+    std::vector<std::unique_ptr<abs_tr_t>> chunk_abs_tr;
+    for (unsigned c = 0; c < num_chunks; ++c) {
+      for (auto checker : m_checkers) {
+        prop_checker_ptr copy = checker->clone();
+        if (!copy) {
+          return false;
+        }
+        chunk_checkers[c].push_back(copy);
+      }
+      chunk_abs_tr.emplace_back(new abs_tr_t(abs_tr));
+    }
+
+    crab::thread_pool pool(m_num_threads);
+    for (unsigned c = 0; c < num_chunks; ++c) {
+      unsigned begin = (uint64_t)num_blocks * c / num_chunks;
+      unsigned end = (uint64_t)num_blocks * (c + 1) / num_chunks;
+      pool.submit([&, c, begin, end] {
+        check_blocks(blocks, begin, end, get_pre, *chunk_abs_tr[c],
+                     chunk_checkers[c], safe_assertions,
+                     only_interesting_blocks);
+      });
+    }
+    pool.wait();
+
+    for (unsigned c = 0; c < num_chunks; ++c) {
+      for (unsigned k = 0, e = m_checkers.size(); k < e; ++k) {
+        m_checkers[k]->merge(*chunk_checkers[c][k]);
+      }
+    }
+    return true;
+  }
+
+  template <class GetPre>
+  void check_blocks(const std::vector<basic_block_t *> &blocks,
+                    const GetPre &get_pre, abs_tr_t &abs_tr,
+                    const std::set<const statement_t *> &safe_assertions,
+                    bool only_interesting_blocks) {
+    if (m_num_threads > 1 && blocks.size() > 1) {
+      crab::ScopedCrabStats __st__("Checker.parallel");
+      if (check_blocks_in_parallel(
+              blocks, get_pre, abs_tr, safe_assertions,
+              only_interesting_blocks,
+              std::integral_constant<
+                  bool, crab::analyzer::abs_transformer_per_thread_copy<
+                            abs_tr_t>::value>())) {
+        return;
+      }
+    }
+    check_blocks(blocks, 0, blocks.size(), get_pre, abs_tr, m_checkers,
+                 safe_assertions, only_interesting_blocks);
+  }
 
 public:
-  checker(prop_checker_vector checkers) : m_checkers(checkers) {}
+  checker(prop_checker_vector checkers, unsigned num_threads = 1)
+      : m_checkers(checkers), m_num_threads(num_threads) {}
 
   checker(const checker<Analyzer> &other) = delete; 
   checker<Analyzer> &operator=(const checker<Analyzer> &other) = delete;
@@ -57,6 +177,18 @@ public:
   }
 };
 
+namespace checker_impl {
+// Whether the analyzer can return the invariants by block id
+template <typename Analyzer, typename = void>
+struct has_get_pre_by_id : std::false_type {};
+
+template <typename Analyzer>
+struct has_get_pre_by_id<
+    Analyzer,
+    decltype(std::declval<const Analyzer &>().get_pre_by_id(0u), void())>
+    : std::true_type {};
+} // namespace checker_impl
+
 template <typename Analyzer> class intra_checker : public checker<Analyzer> {
 public:
   using base_checker_t = checker<Analyzer>;
@@ -65,15 +197,43 @@ public:
 
 private:
   using cfg_t = typename Analyzer::cfg_t;
+  using basic_block_t = typename cfg_t::basic_block_t;
   using statement_t = typename cfg_t::statement_t;
   using abs_dom_t = typename Analyzer::abs_dom_t;
   using abs_tr_t = typename Analyzer::abs_tr_t;
 
   Analyzer &m_analyzer;
 
+  void check(const std::vector<basic_block_t *> &blocks, cfg_t &cfg,
+             abs_tr_t &abs_tr,
+             const std::set<const statement_t *> &safe_assertions,
+             std::true_type) {
+    if (!cfg.is_indexed()) {
+      check(blocks, cfg, abs_tr, safe_assertions, std::false_type());
+      return;
+    }
+    auto get_pre = [this, &blocks](unsigned i) {
+      return m_analyzer.get_pre_by_id(blocks[i]->block_id());
+    };
+    this->check_blocks(blocks, get_pre, abs_tr, safe_assertions,
+                       true /*only interesting blocks*/);
+  }
+
+  void check(const std::vector<basic_block_t *> &blocks, cfg_t &cfg,
+             abs_tr_t &abs_tr,
+             const std::set<const statement_t *> &safe_assertions,
+             std::false_type) {
+    auto get_pre = [this, &blocks](unsigned i) {
+      return m_analyzer[blocks[i]->label()];
+    };
+    this->check_blocks(blocks, get_pre, abs_tr, safe_assertions,
+                       true /*only interesting blocks*/);
+  }
+
 public:
-  intra_checker(Analyzer &analyzer, prop_checker_vector checkers)
-      : base_checker_t(checkers), m_analyzer(analyzer) {}
+  intra_checker(Analyzer &analyzer, prop_checker_vector checkers,
+                unsigned num_threads = 1)
+      : base_checker_t(checkers, num_threads), m_analyzer(analyzer) {}
 
   virtual void run() override {
     CRAB_VERBOSE_IF(1, get_msg_stream() << "Started property checker.\n";);
@@ -88,22 +248,12 @@ public:
     m_analyzer.get_safe_assertions(safe_assertions);
     abs_tr_t &abs_tr = m_analyzer.get_abs_transformer();
 
+    std::vector<basic_block_t *> blocks;
     for (auto &bb : cfg) {
-      for (auto checker : this->m_checkers) {
-        if (checker->is_interesting(bb)) {
-          crab::ScopedCrabStats __st__("Checker." +
-                                       checker->get_property_name());
-          abs_dom_t inv = m_analyzer[bb.label()];
-          abs_tr.set_abs_value(std::move(inv));
-          // propagate forward the invariants from the block entry
-          // while checking the property
-          checker->set(&abs_tr, safe_assertions);
-          for (auto &stmt : bb) {
-            stmt.accept(&*checker);
-          }
-        }
-      }
+      blocks.push_back(&bb);
     }
+    check(blocks, cfg, abs_tr, safe_assertions,
+          checker_impl::has_get_pre_by_id<Analyzer>());
     CRAB_VERBOSE_IF(1, get_msg_stream() << "Finished property checker.\n";);
   }
 };
@@ -117,6 +267,7 @@ public:
 private:
   using cg_t = typename Analyzer::cg_t;
   using cfg_t = typename Analyzer::cfg_t;
+  using basic_block_t = typename cfg_t::basic_block_t;
   using statement_t = typename cfg_t::statement_t;
   using abs_dom_t = typename Analyzer::abs_dom_t;
   using abs_tr_t = typename Analyzer::abs_tr_t;
@@ -124,8 +275,9 @@ private:
   Analyzer &m_analyzer;
 
 public:
-  inter_checker(Analyzer &analyzer, prop_checker_vector checkers)
-      : base_checker_t(checkers), m_analyzer(analyzer) {}
+  inter_checker(Analyzer &analyzer, prop_checker_vector checkers,
+                unsigned num_threads = 1)
+      : base_checker_t(checkers, num_threads), m_analyzer(analyzer) {}
 
   virtual void run() override {
     CRAB_VERBOSE_IF(1, get_msg_stream() << "Started property checker.\n";);
@@ -133,27 +285,25 @@ public:
     cg_t &cg = m_analyzer.get_call_graph();
 
     abs_tr_t &abs_tr = m_analyzer.get_abs_transformer();
+    // the blocks of all functions with the function of each block
+    std::vector<cfg_t> cfgs;
+    std::vector<unsigned> block_cfg;
+    std::vector<basic_block_t *> blocks;
     for (auto &v : boost::make_iterator_range(vertices(cg))) {
-      cfg_t cfg = v.get_cfg();
-
-      for (auto &bb : cfg) {
-        // the forward+backward analyzer only works for
-        // intra-procedural analysis.
-        std::set<const statement_t *> safe_assertions;
-        for (auto checker : this->m_checkers) {
-          crab::ScopedCrabStats __st__("Checker." +
-                                       checker->get_property_name());
-          abs_dom_t inv = m_analyzer.get_pre(cfg, bb.label());
-          abs_tr.set_abs_value(std::move(inv));
-          // propagate forward the invariants from the block entry
-          // while checking the property
-          checker->set(&abs_tr, safe_assertions);
-          for (auto &stmt : bb) {
-            stmt.accept(&*checker);
-          }
-        }
+      cfgs.push_back(v.get_cfg());
+      for (auto &bb : cfgs.back()) {
+        blocks.push_back(&bb);
+        block_cfg.push_back(cfgs.size() - 1);
       }
     }
+    // the forward+backward analyzer only works for
+    // intra-procedural analysis.
+    std::set<const statement_t *> safe_assertions;
+    auto get_pre = [this, &cfgs, &block_cfg, &blocks](unsigned i) {
+      return m_analyzer.get_pre(cfgs[block_cfg[i]], blocks[i]->label());
+    };
+    this->check_blocks(blocks, get_pre, abs_tr, safe_assertions,
+                       false /*all blocks*/);
     CRAB_VERBOSE_IF(1, get_msg_stream() << "Finished property checker.";);
   }
 };
@@ -34,6 +34,10 @@ public:
     return "integer division by zero checker";
   }
 
+  virtual std::shared_ptr<base_checker_t> clone() const override {
+    return std::make_shared<div_zero_property_checker>(this->m_verbose);
+  }
+
   void check(bin_op_t &s) override {
     if (!this->m_abs_tr)
       return;
@@ -198,6 +198,12 @@ class zones_domain_params {
   bool m_widen_restabilize;
   bool m_special_assign;
   bool m_close_bounds_inline;
+  // Graphs with at most this number of vertices and at least half of
+  // the possible edges are closed with a dense kernel. Zero (default)
+  // disables it.
+  unsigned m_dense_closure_max_size;
+  // Copies share their state until one of them is modified
+  bool m_copy_on_write;
 
   friend class crab_domain_params;  
 public:
@@ -205,16 +211,22 @@ public:
     : m_chrome_dijkstra(true),
       m_widen_restabilize(true),
       m_special_assign(true),
-      m_close_bounds_inline(false) {
+      m_close_bounds_inline(false),
+      m_dense_closure_max_size(0),
+      m_copy_on_write(false) {
   }
   zones_domain_params(bool chrome_dijkstra,
 		      bool widen_restabilize,
 		      bool special_assign,
-		      bool close_bounds_inline)
+		      bool close_bounds_inline,
+		      unsigned dense_closure_max_size,
+		      bool copy_on_write)
     : m_chrome_dijkstra(chrome_dijkstra),
       m_widen_restabilize(widen_restabilize),
       m_special_assign(special_assign),
-      m_close_bounds_inline(close_bounds_inline) {
+      m_close_bounds_inline(close_bounds_inline),
+      m_dense_closure_max_size(dense_closure_max_size),
+      m_copy_on_write(copy_on_write) {
   }
   
   bool zones_chrome_dijkstra() const {
@@ -229,6 +241,12 @@ public:
   bool zones_close_bounds_inline() const {
     return m_close_bounds_inline;
   }
+  unsigned zones_dense_closure_max_size() const {
+    return m_dense_closure_max_size;
+  }
+  bool zones_copy_on_write() const {
+    return m_copy_on_write;
+  }
   void update_params(const zones_domain_params& p);
   void write(crab::crab_os &o) const;
 };
@@ -340,6 +358,8 @@ public:
      - zones.widen_restabilize: bool
      - zones.special_assign: bool
      - zones.close_bounds_inline: bool
+     - zones.dense_closure_max_size: unsigned
+     - zones.copy_on_write: bool
      - oct.chrome_dijkstra: bool
      - oct.widen_restabilize: bool
      - oct.special_assign: bool
@@ -85,7 +85,7 @@ class offset_t : public indexable {
 public:
   explicit offset_t(ikos::index_t v);
 
-  virtual ikos::index_t index() const override;
+  ikos::index_t index() const;
 
   size_t hash() const;
 
@@ -103,7 +103,7 @@ public:
 
   bool is_zero() const;
 
-  virtual void write(crab::crab_os &o) const override;
+  void write(crab::crab_os &o) const;
 
   friend crab::crab_os &operator<<(crab::crab_os &o, const offset_t &v) {
     v.write(o);
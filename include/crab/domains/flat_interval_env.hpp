@@ -0,0 +1,542 @@
+#pragma once
+
+#include <crab/domains/i64_interval.hpp>
+#include <crab/support/debug.hpp>
+#include <crab/support/os.hpp>
+#include <crab/types/indexable.hpp>
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace crab {
+namespace domains {
+
+/**
+ * Environment from Key to i64_interval with the same interface than
+ * ikos::separate_domain<Key, i64_interval>.
+ *
+ * Keys are numbered by their index. The intervals are stored in two
+ * arrays of lower and upper bounds indexed by (Key::index() - base)
+ * where base is the smallest index in the environment. A key that is
+ * not in the environment is mapped to [-oo, +oo] so that join, meet,
+ * widening, narrowing and inclusion are branch-free loops over the
+ * common range of indexes that the compiler can vectorize.
+ *
+ * Unlike separate_domain, copying the environment is linear in the
+ * number of keys. This pays off if the variables of the analyzed
+ * program have close indexes, which is the case if they are created
+ * by the same variable factory, one function at a time.
+ **/
+template <typename Key> class flat_interval_env {
+public:
+  using flat_interval_env_t = flat_interval_env<Key>;
+  using key_type = Key;
+  using mapped_type = i64_interval;
+  using value_type = std::pair<Key, i64_interval>;
+
+private:
+  using index_t = ikos::index_t;
+
+  bool m_is_bottom;
+  // index of the first key
+  index_t m_base;
+  std::vector<int64_t> m_lb;
+  std::vector<int64_t> m_ub;
+  // m_keys[i] is meaningful only if [m_lb[i], m_ub[i]] is not top.
+  std::vector<Key> m_keys;
+
+  static constexpr int64_t minus_inf() { return i64_interval::minus_inf(); }
+  static constexpr int64_t plus_inf() { return i64_interval::plus_inf(); }
+
+  flat_interval_env(bool is_bottom) : m_is_bottom(is_bottom), m_base(0) {}
+
+  std::size_t num_slots() const { return m_lb.size(); }
+
+  index_t end_index() const { return m_base + num_slots(); }
+
+  bool is_top(std::size_t i) const {
+    return m_lb[i] == minus_inf() && m_ub[i] == plus_inf();
+  }
+
+  bool find_slot(const Key &k, std::size_t &i) const {
+    index_t idx = k.index();
+    if (idx < m_base || idx >= end_index()) {
+      return false;
+    }
+    i = idx - m_base;
+    return true;
+  }
+
+  // Return the slot of k, creating it if needed. k is used to fill
+  // the new slots.
+  std::size_t get_slot(const Key &k) {
+    index_t idx = k.index();
+    if (num_slots() == 0) {
+      m_base = idx;
+      m_lb.push_back(minus_inf());
+      m_ub.push_back(plus_inf());
+      m_keys.push_back(k);
+    } else if (idx < m_base) {
+      std::size_t n = m_base - idx;
+      m_lb.insert(m_lb.begin(), n, minus_inf());
+      m_ub.insert(m_ub.begin(), n, plus_inf());
+      m_keys.insert(m_keys.begin(), n, k);
+      m_base = idx;
+    } else if (idx >= end_index()) {
+      std::size_t n = idx - end_index() + 1;
+      m_lb.insert(m_lb.end(), n, minus_inf());
+      m_ub.insert(m_ub.end(), n, plus_inf());
+      m_keys.insert(m_keys.end(), n, k);
+    }
+    return idx - m_base;
+  }
+
+  // Remove the slots at both ends that are top.
+  void shrink() {
+    std::size_t first = 0, last = num_slots();
+    while (first < last && is_top(first)) {
+      ++first;
+    }
+    while (last > first && is_top(last - 1)) {
+      --last;
+    }
+    if (first == 0 && last == num_slots()) {
+      return;
+    }
+    m_lb.erase(m_lb.begin() + last, m_lb.end());
+    m_ub.erase(m_ub.begin() + last, m_ub.end());
+    m_keys.erase(m_keys.begin() + last, m_keys.end());
+    m_lb.erase(m_lb.begin(), m_lb.begin() + first);
+    m_ub.erase(m_ub.begin(), m_ub.begin() + first);
+    m_keys.erase(m_keys.begin(), m_keys.begin() + first);
+    m_base = (m_lb.empty() ? 0 : m_base + first);
+  }
+
+  // Return true if some interval is empty
+  bool has_empty_interval() const {
+    const int64_t *lb = m_lb.data();
+    const int64_t *ub = m_ub.data();
+    bool res = false;
+    for (std::size_t i = 0, n = num_slots(); i < n; ++i) {
+      res |= (lb[i] > ub[i]);
+    }
+    return res;
+  }
+
+  // Set this to the slots of x and y in [x.m_base, x.end_index())
+  // intersected with [y.m_base, y.end_index()). The keys are taken
+  // from x.
+  template <typename BinOp>
+  void apply_on_common_slots(const flat_interval_env_t &x,
+                             const flat_interval_env_t &y, BinOp op) {
+    index_t lo = std::max(x.m_base, y.m_base);
+    index_t hi = std::min(x.end_index(), y.end_index());
+    if (lo >= hi) {
+      return;
+    }
+    std::size_t n = hi - lo;
+    m_base = lo;
+    m_lb.resize(n);
+    m_ub.resize(n);
+    std::size_t dx = lo - x.m_base, dy = lo - y.m_base;
+    m_keys.assign(x.m_keys.begin() + dx, x.m_keys.begin() + dx + n);
+    op(x.m_lb.data() + dx, x.m_ub.data() + dx, y.m_lb.data() + dy,
+       y.m_ub.data() + dy, m_lb.data(), m_ub.data(), n);
+    shrink();
+  }
+
+  // Set this to the slots of x and y in the union of [x.m_base,
+  // x.end_index()) and [y.m_base, y.end_index()). A slot that is not
+  // in x or y is top.
+  template <typename BinOp>
+  void apply_on_all_slots(const flat_interval_env_t &x,
+                          const flat_interval_env_t &y, BinOp op) {
+    if (x.num_slots() == 0) {
+      *this = y;
+      return;
+    } else if (y.num_slots() == 0) {
+      *this = x;
+      return;
+    }
+    // extend x so that it covers y and then apply op on y's range
+    *this = x;
+    get_slot(y.m_keys.front());
+    get_slot(y.m_keys.back());
+    std::size_t d = y.m_base - m_base;
+    std::size_t n = y.num_slots();
+    const int64_t *ylb = y.m_lb.data();
+    const int64_t *yub = y.m_ub.data();
+    int64_t *lb = m_lb.data() + d;
+    int64_t *ub = m_ub.data() + d;
+    // keys must be updated before op modifies the bounds
+    for (std::size_t i = 0; i < n; ++i) {
+      if (is_top(d + i)) {
+        m_keys[d + i] = y.m_keys[i];
+      }
+    }
+    op(lb, ub, ylb, yub, lb, ub, n);
+    if (has_empty_interval()) {
+      set_to_bottom();
+    } else {
+      shrink();
+    }
+  }
+
+public:
+  class iterator {
+    const flat_interval_env_t *m_env;
+    std::size_t m_i;
+
+    void skip_top() {
+      while (m_i < m_env->num_slots() && m_env->is_top(m_i)) {
+        ++m_i;
+      }
+    }
+
+  public:
+    struct arrow_proxy {
+      value_type m_kv;
+      const value_type *operator->() const { return &m_kv; }
+    };
+
+    iterator(const flat_interval_env_t *env, std::size_t i)
+        : m_env(env), m_i(i) {
+      skip_top();
+    }
+
+    value_type operator*() const {
+      return value_type(m_env->m_keys[m_i],
+                        i64_interval(m_env->m_lb[m_i], m_env->m_ub[m_i]));
+    }
+
+    arrow_proxy operator->() const { return arrow_proxy{operator*()}; }
+
+    iterator &operator++() {
+      ++m_i;
+      skip_top();
+      return *this;
+    }
+
+    bool operator==(const iterator &o) const { return m_i == o.m_i; }
+
+    bool operator!=(const iterator &o) const { return m_i != o.m_i; }
+  };
+
+  flat_interval_env() : m_is_bottom(false), m_base(0) {}
+  flat_interval_env(const flat_interval_env_t &o) = default;
+  flat_interval_env(flat_interval_env_t &&o) = default;
+  flat_interval_env_t &operator=(const flat_interval_env_t &o) = default;
+  flat_interval_env_t &operator=(flat_interval_env_t &&o) = default;
+
+  static flat_interval_env_t top() { return flat_interval_env_t(false); }
+  static flat_interval_env_t bottom() { return flat_interval_env_t(true); }
+
+  iterator begin() const {
+    if (is_bottom()) {
+      CRAB_ERROR("Flat interval environment: trying to invoke iterator on "
+                 "bottom");
+    }
+    return iterator(this, 0);
+  }
+
+  iterator end() const {
+    if (is_bottom()) {
+      CRAB_ERROR("Flat interval environment: trying to invoke iterator on "
+                 "bottom");
+    }
+    return iterator(this, num_slots());
+  }
+
+  bool is_bottom() const { return m_is_bottom; }
+
+  bool is_top() const {
+    if (is_bottom()) {
+      return false;
+    }
+    for (std::size_t i = 0, n = num_slots(); i < n; ++i) {
+      if (!is_top(i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator<=(const flat_interval_env_t &o) const {
+    if (is_bottom()) {
+      return true;
+    } else if (o.is_bottom()) {
+      return false;
+    }
+    // The slots of o that are not in this must be top
+    index_t lo = std::max(m_base, o.m_base);
+    index_t hi = std::min(end_index(), o.end_index());
+    for (std::size_t i = 0, n = o.num_slots(); i < n; ++i) {
+      index_t idx = o.m_base + i;
+      if ((idx < lo || idx >= hi) && !o.is_top(i)) {
+        return false;
+      }
+    }
+    if (lo >= hi) {
+      return true;
+    }
+    std::size_t n = hi - lo;
+    const int64_t *lb = m_lb.data() + (lo - m_base);
+    const int64_t *ub = m_ub.data() + (lo - m_base);
+    const int64_t *olb = o.m_lb.data() + (lo - o.m_base);
+    const int64_t *oub = o.m_ub.data() + (lo - o.m_base);
+    bool res = true;
+    for (std::size_t i = 0; i < n; ++i) {
+      res &= (olb[i] <= lb[i]) & (ub[i] <= oub[i]);
+    }
+    return res;
+  }
+
+  // Join
+  flat_interval_env_t operator|(const flat_interval_env_t &o) const {
+    if (is_bottom()) {
+      return o;
+    } else if (o.is_bottom()) {
+      return *this;
+    } else {
+      flat_interval_env_t res;
+      res.apply_on_common_slots(
+          *this, o,
+          [](const int64_t *xlb, const int64_t *xub, const int64_t *ylb,
+             const int64_t *yub, int64_t *lb, int64_t *ub, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+              lb[i] = std::min(xlb[i], ylb[i]);
+              ub[i] = std::max(xub[i], yub[i]);
+            }
+          });
+      return res;
+    }
+  }
+
+  // Meet
+  flat_interval_env_t operator&(const flat_interval_env_t &o) const {
+    if (is_bottom() || o.is_bottom()) {
+      return bottom();
+    } else {
+      flat_interval_env_t res;
+      res.apply_on_all_slots(
+          *this, o,
+          [](const int64_t *xlb, const int64_t *xub, const int64_t *ylb,
+             const int64_t *yub, int64_t *lb, int64_t *ub, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+              lb[i] = std::max(xlb[i], ylb[i]);
+              ub[i] = std::min(xub[i], yub[i]);
+            }
+          });
+      return res;
+    }
+  }
+
+  // Widening
+  flat_interval_env_t operator||(const flat_interval_env_t &o) const {
+    if (is_bottom()) {
+      return o;
+    } else if (o.is_bottom()) {
+      return *this;
+    } else {
+      flat_interval_env_t res;
+      res.apply_on_common_slots(
+          *this, o,
+          [](const int64_t *xlb, const int64_t *xub, const int64_t *ylb,
+             const int64_t *yub, int64_t *lb, int64_t *ub, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+              lb[i] = (ylb[i] < xlb[i] ? minus_inf() : xlb[i]);
+              ub[i] = (xub[i] < yub[i] ? plus_inf() : xub[i]);
+            }
+          });
+      return res;
+    }
+  }
+
+  // Widening with thresholds
+  template <typename Thresholds>
+  flat_interval_env_t widening_thresholds(const flat_interval_env_t &o,
+                                          const Thresholds &ts) const {
+    if (is_bottom()) {
+      return o;
+    } else if (o.is_bottom()) {
+      return *this;
+    } else {
+      flat_interval_env_t res;
+      res.apply_on_common_slots(
+          *this, o,
+          [&ts](const int64_t *xlb, const int64_t *xub, const int64_t *ylb,
+                const int64_t *yub, int64_t *lb, int64_t *ub, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+              i64_interval x(xlb[i], xub[i]), y(ylb[i], yub[i]);
+              i64_interval z = x.widening_thresholds(y, ts);
+              lb[i] = z.lb();
+              ub[i] = z.ub();
+            }
+          });
+      return res;
+    }
+  }
+
+  // Narrowing
+  flat_interval_env_t operator&&(const flat_interval_env_t &o) const {
+    if (is_bottom() || o.is_bottom()) {
+      return bottom();
+    } else {
+      flat_interval_env_t res;
+      res.apply_on_all_slots(
+          *this, o,
+          [](const int64_t *xlb, const int64_t *xub, const int64_t *ylb,
+             const int64_t *yub, int64_t *lb, int64_t *ub, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+              lb[i] = (xlb[i] == minus_inf() ? ylb[i] : xlb[i]);
+              ub[i] = (xub[i] == plus_inf() ? yub[i] : xub[i]);
+            }
+          });
+      return res;
+    }
+  }
+
+  void set(const Key &k, const i64_interval &v) {
+    if (!is_bottom()) {
+      if (v.is_bottom()) {
+        set_to_bottom();
+      } else if (v.is_top()) {
+        operator-=(k);
+      } else {
+        std::size_t i = get_slot(k);
+        m_lb[i] = v.lb();
+        m_ub[i] = v.ub();
+        m_keys[i] = k;
+      }
+    }
+  }
+
+  void join(const Key &k, const i64_interval &v) {
+    if (!is_bottom()) {
+      if (v.is_bottom()) {
+        set_to_bottom();
+      } else {
+        set(k, at(k) | v);
+      }
+    }
+  }
+
+  void set_to_bottom() {
+    m_is_bottom = true;
+    m_base = 0;
+    m_lb.clear();
+    m_ub.clear();
+    m_keys.clear();
+  }
+
+  flat_interval_env_t &operator-=(const Key &k) {
+    std::size_t i;
+    if (!is_bottom() && find_slot(k, i)) {
+      m_lb[i] = minus_inf();
+      m_ub[i] = plus_inf();
+      if (i == 0 || i == num_slots() - 1) {
+        shrink();
+      }
+    }
+    return *this;
+  }
+
+  i64_interval at(const Key &k) const {
+    if (is_bottom()) {
+      return i64_interval::bottom();
+    }
+    std::size_t i;
+    if (find_slot(k, i)) {
+      return i64_interval(m_lb[i], m_ub[i]);
+    } else {
+      return i64_interval::top();
+    }
+  }
+
+  std::size_t size() const {
+    if (is_bottom()) {
+      return 0;
+    } else if (is_top()) {
+      CRAB_ERROR("flat_interval_env::size() is undefined if top");
+    } else {
+      std::size_t n = 0;
+      for (std::size_t i = 0, e = num_slots(); i < e; ++i) {
+        n += !is_top(i);
+      }
+      return n;
+    }
+  }
+
+  void write(crab::crab_os &o) const {
+    if (is_bottom()) {
+      o << "_|_";
+    } else {
+      o << "{";
+      bool first = true;
+      for (auto it = begin(), et = end(); it != et; ++it) {
+        if (!first) {
+          o << "; ";
+        }
+        first = false;
+        it->first.write(o);
+        o << " -> ";
+        it->second.write(o);
+      }
+      o << "}";
+    }
+  }
+
+  void project(const std::vector<Key> &keys) {
+    if (is_bottom() || is_top()) {
+      return;
+    }
+    flat_interval_env_t env;
+    for (auto const &k : keys) {
+      env.set(k, at(k));
+    }
+    std::swap(*this, env);
+  }
+
+  // Assume that from does not have duplicates.
+  void rename(const std::vector<Key> &from, const std::vector<Key> &to) {
+    if (is_top() || is_bottom()) {
+      // nothing to rename
+      return;
+    }
+    if (from.size() != to.size()) {
+      CRAB_ERROR(
+          "flat_interval_env::rename with input vectors of different sizes");
+    }
+    for (unsigned i = 0, sz = from.size(); i < sz; ++i) {
+      const Key &k = from[i];
+      const Key &new_k = to[i];
+      if (k == new_k) { // nothing to rename
+        continue;
+      }
+      if (::crab::CrabSanityCheckFlag) {
+        if (!at(new_k).is_top()) {
+          CRAB_ERROR("flat_interval_env::rename assumes that  ", new_k,
+                     " does not exist in ", *this);
+        }
+      }
+      i64_interval v = at(k);
+      if (!v.is_top()) {
+        operator-=(k);
+        set(new_k, v);
+      }
+    }
+  }
+
+  friend crab::crab_os &operator<<(crab::crab_os &o,
+                                   const flat_interval_env_t &d) {
+    d.write(o);
+    return o;
+  }
+}; // class flat_interval_env
+
+} // namespace domains
+} // namespace crab
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <crab/domains/graphs/graph_iterators.hpp>
+#include <crab/domains/graphs/util/reference_wrapper.hpp>
+#include <crab/support/os.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+/*
+ * A dense implementation of a weighted graph.
+ *
+ * The weights are stored in a row-major matrix next to a matrix of
+ * flags that tells which edges exist. Rows are padded to a multiple
+ * of a cache line and the matrices are cache-aligned. Lookups and
+ * updates take constant time and the closure kernel runs over
+ * contiguous rows without branches so that the compiler can
+ * vectorize it. This representation is meant for small graphs
+ * that are nearly complete.
+ */
+namespace crab {
+
+namespace dense_graph_impl {
+
+enum { cache_line_size = 64 };
+
+// std::allocator that aligns the storage to a cache line
+template <class T> class cache_aligned_allocator {
+public:
+  using value_type = T;
+
+  cache_aligned_allocator() {}
+  template <class U>
+  cache_aligned_allocator(const cache_aligned_allocator<U> &) {}
+
+  T *allocate(std::size_t n) {
+    void *p = nullptr;
+    if (posix_memalign(&p, cache_line_size, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(p);
+  }
+
+  void deallocate(T *p, std::size_t) { free(p); }
+
+  template <class U> struct rebind {
+    using other = cache_aligned_allocator<U>;
+  };
+};
+
+template <class T, class U>
+bool operator==(const cache_aligned_allocator<T> &,
+                const cache_aligned_allocator<U> &) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const cache_aligned_allocator<T> &,
+                const cache_aligned_allocator<U> &) {
+  return false;
+}
+
+// Min-plus kernel: row_i[j] = min(row_i[j], w_ik + row_k[j]) for
+// all j. Absent weights are zero so the sum is always defined.
+template <class Wt>
+inline void relax_row(Wt *row_i, uint8_t *flags_i, const Wt *row_k,
+                      const uint8_t *flags_k, const Wt &w_ik, unsigned n) {
+  for (unsigned j = 0; j < n; ++j) {
+    Wt w = w_ik + row_k[j];
+    bool improve = (flags_k[j] != 0) & ((flags_i[j] == 0) | (w < row_i[j]));
+    row_i[j] = improve ? w : row_i[j];
+    flags_i[j] |= flags_k[j];
+  }
+}
+
+} // namespace dense_graph_impl
+
+template <class Weight> class DenseWtGraph {
+public:
+  using Wt = Weight;
+  using graph_t = DenseWtGraph<Wt>;
+  using vert_id = graph_iterators::vert_id;
+  using wt_ref_t = crab::reference_wrapper<const Wt>;
+
+private:
+  using flag_t = uint8_t;
+  using wt_vector =
+      std::vector<Wt, dense_graph_impl::cache_aligned_allocator<Wt>>;
+  using flag_vector =
+      std::vector<flag_t, dense_graph_impl::cache_aligned_allocator<flag_t>>;
+
+  // Iterate over the vertices whose flag is set in a row (step is 1)
+  // or in a column (step is the row length) of the matrix.
+  class adj_iterator {
+  public:
+    adj_iterator(void) : flags(nullptr), step(0), v(0), last(0) {}
+    adj_iterator(const flag_t *_flags, std::size_t _step, vert_id _v,
+                 vert_id _last)
+        : flags(_flags), step(_step), v(_v), last(_last) {
+      skip();
+    }
+    // XXX: to make sure that we always return the same address
+    // for the "empty" iterator, otherwise we can trigger
+    // undefined behavior.
+    static adj_iterator empty_iterator() {
+      static std::unique_ptr<adj_iterator> it = nullptr;
+      if (!it)
+        it = std::unique_ptr<adj_iterator>(new adj_iterator());
+      return *it;
+    }
+    vert_id operator*(void) const { return v; }
+    adj_iterator &operator++(void) {
+      ++v;
+      skip();
+      return *this;
+    }
+    bool operator!=(const adj_iterator &o) const { return v != o.v; }
+
+  private:
+    void skip() {
+      while (v < last && !flags[v * step]) {
+        ++v;
+      }
+    }
+
+    const flag_t *flags;
+    std::size_t step;
+    vert_id v;
+    vert_id last;
+  };
+
+  class adj_range {
+  public:
+    using iterator = adj_iterator;
+
+    adj_range(const flag_t *_flags, std::size_t _step, vert_id _last,
+              unsigned _sz)
+        : flags(_flags), step(_step), last(_last), sz(_sz) {}
+    iterator begin(void) const { return iterator(flags, step, 0, last); }
+    iterator end(void) const { return iterator(flags, step, last, last); }
+    std::size_t size(void) const { return sz; }
+    bool mem(unsigned int v) const { return v < last && flags[v * step]; }
+
+  private:
+    const flag_t *flags;
+    std::size_t step;
+    vert_id last;
+    unsigned sz;
+  };
+
+  using edge_ref_t = graph_iterators::edge_ref_t<Wt>;
+  using const_edge_ref_t = graph_iterators::const_edge_ref_t<Wt>;
+
+public:
+  using vert_iterator = graph_iterators::vert_iterator;
+  using vert_range = graph_iterators::vert_range;
+  using pred_range = adj_range;
+  using const_pred_range = adj_range;
+  using succ_range = adj_range;
+  using const_succ_range = adj_range;
+  using e_succ_range =
+      graph_iterators::fwd_edge_range<graph_t, adj_iterator, edge_ref_t>;
+  using e_pred_range =
+      graph_iterators::rev_edge_range<graph_t, adj_iterator, edge_ref_t>;
+  using const_e_succ_range =
+      graph_iterators::const_fwd_edge_range<graph_t, adj_iterator,
+                                            const_edge_ref_t>;
+  using const_e_pred_range =
+      graph_iterators::const_rev_edge_range<graph_t, adj_iterator,
+                                            const_edge_ref_t>;
+
+private:
+  // Number of vertices, including the free ones
+  vert_id _sz;
+  // Length of a row of the matrices
+  vert_id _stride;
+  // Absent edges have weight zero
+  wt_vector _ws;
+  flag_vector _flags;
+  std::vector<unsigned> _out_deg;
+  std::vector<unsigned> _in_deg;
+  std::size_t edge_count;
+  std::vector<bool> is_free;
+  std::vector<vert_id> free_id;
+
+  // Round n up to a whole number of cache lines
+  static vert_id round_up(vert_id n) {
+    const vert_id line =
+        sizeof(Wt) >= dense_graph_impl::cache_line_size
+            ? 1
+            : dense_graph_impl::cache_line_size / sizeof(Wt);
+    return ((n + line - 1) / line) * line;
+  }
+
+  std::size_t idx(vert_id s, vert_id d) const {
+    return static_cast<std::size_t>(s) * _stride + d;
+  }
+
+  void reserve(vert_id n) {
+    if (n <= _stride) {
+      return;
+    }
+    vert_id stride = round_up(std::max(n, 2 * _stride));
+    wt_vector ws(static_cast<std::size_t>(stride) * stride, Wt(0));
+    flag_vector flags(static_cast<std::size_t>(stride) * stride, 0);
+    for (vert_id s = 0; s < _sz; ++s) {
+      std::copy(&_ws[idx(s, 0)], &_ws[idx(s, 0)] + _sz,
+                &ws[static_cast<std::size_t>(s) * stride]);
+      std::copy(&_flags[idx(s, 0)], &_flags[idx(s, 0)] + _sz,
+                &flags[static_cast<std::size_t>(s) * stride]);
+    }
+    _ws.swap(ws);
+    _flags.swap(flags);
+    _stride = stride;
+  }
+
+  // Recompute the degrees and the number of edges after a kernel
+  void recount(void) {
+    edge_count = 0;
+    std::fill(_out_deg.begin(), _out_deg.end(), 0);
+    std::fill(_in_deg.begin(), _in_deg.end(), 0);
+    for (vert_id s = 0; s < _sz; ++s) {
+      const flag_t *flags = &_flags[idx(s, 0)];
+      unsigned deg = 0;
+      for (vert_id d = 0; d < _sz; ++d) {
+        deg += flags[d];
+        _in_deg[d] += flags[d];
+      }
+      _out_deg[s] = deg;
+      edge_count += deg;
+    }
+  }
+
+public:
+  DenseWtGraph(void) : _sz(0), _stride(0), edge_count(0) {}
+  DenseWtGraph(const DenseWtGraph<Wt> &o) = default;
+  DenseWtGraph(DenseWtGraph<Wt> &&o) = default;
+  DenseWtGraph<Wt> &operator=(const DenseWtGraph<Wt> &o) = default;
+  DenseWtGraph<Wt> &operator=(DenseWtGraph<Wt> &&o) = default;
+
+  template <class G> static graph_t copy(const G &g) {
+    graph_t ret;
+    ret.growTo(g.size());
+    for (vert_id s : g.verts()) {
+      for (vert_id d : g.succs(s)) {
+        ret.add_edge(s, g.edge_val(s, d), d);
+      }
+    }
+    return ret;
+  }
+
+  bool is_empty(void) const { return edge_count == 0; }
+
+  // Number of allocated vertices
+  std::size_t size(void) const { return _sz; }
+
+  // Number of edges
+  std::size_t num_edges(void) const { return edge_count; }
+
+  vert_id new_vertex(void) {
+    vert_id v;
+    if (free_id.size() > 0) {
+      v = free_id.back();
+      assert(v < _sz);
+      free_id.pop_back();
+      is_free[v] = false;
+    } else {
+      reserve(_sz + 1);
+      v = _sz++;
+      is_free.push_back(false);
+      _out_deg.push_back(0);
+      _in_deg.push_back(0);
+    }
+    return v;
+  }
+
+  void growTo(vert_id v) {
+    reserve(v);
+    while (size() < v)
+      new_vertex();
+  }
+
+  void forget(vert_id v) {
+    if (is_free[v])
+      return;
+
+    for (vert_id d = 0; d < _sz; ++d) {
+      if (_flags[idx(v, d)]) {
+        _flags[idx(v, d)] = 0;
+        _ws[idx(v, d)] = Wt(0);
+        _in_deg[d]--;
+        edge_count--;
+      }
+      if (_flags[idx(d, v)]) {
+        _flags[idx(d, v)] = 0;
+        _ws[idx(d, v)] = Wt(0);
+        _out_deg[d]--;
+        edge_count--;
+      }
+    }
+    _out_deg[v] = 0;
+    _in_deg[v] = 0;
+
+    is_free[v] = true;
+    free_id.push_back(v);
+  }
+
+  void clear_edges(void) {
+    std::fill(_ws.begin(), _ws.end(), Wt(0));
+    std::fill(_flags.begin(), _flags.end(), 0);
+    std::fill(_out_deg.begin(), _out_deg.end(), 0);
+    std::fill(_in_deg.begin(), _in_deg.end(), 0);
+    edge_count = 0;
+  }
+
+  void clear(void) {
+    _ws.clear();
+    _flags.clear();
+    _out_deg.clear();
+    _in_deg.clear();
+    is_free.clear();
+    free_id.clear();
+    _sz = 0;
+    _stride = 0;
+    edge_count = 0;
+  }
+
+  bool elem(vert_id s, vert_id d) const { return _flags[idx(s, d)]; }
+
+  Wt &edge_val(vert_id s, vert_id d) { return _ws[idx(s, d)]; }
+
+  const Wt &edge_val(vert_id s, vert_id d) const { return _ws[idx(s, d)]; }
+
+  // Precondition: elem(s, d) is true.
+  Wt operator()(vert_id s, vert_id d) const { return _ws[idx(s, d)]; }
+
+  bool lookup(vert_id s, vert_id d, wt_ref_t &w) const {
+    if (!elem(s, d))
+      return false;
+    w = wt_ref_t(_ws[idx(s, d)]);
+    return true;
+  }
+
+  void add_edge(vert_id s, Wt w, vert_id d) {
+    assert(!elem(s, d));
+    _ws[idx(s, d)] = w;
+    _flags[idx(s, d)] = 1;
+    _out_deg[s]++;
+    _in_deg[d]++;
+    edge_count++;
+  }
+
+  template <class Op> void update_edge(vert_id s, Wt w, vert_id d, Op &op) {
+    if (elem(s, d)) {
+      _ws[idx(s, d)] = op.apply(_ws[idx(s, d)], w);
+    } else if (!op.default_is_absorbing()) {
+      add_edge(s, w, d);
+    }
+  }
+
+  void set_edge(vert_id s, Wt w, vert_id d) {
+    if (elem(s, d)) {
+      _ws[idx(s, d)] = w;
+    } else {
+      add_edge(s, w, d);
+    }
+  }
+
+  void set_edge_if_less_than(vert_id s, Wt w, vert_id d) {
+    if (elem(s, d)) {
+      if (w < _ws[idx(s, d)]) {
+        _ws[idx(s, d)] = w;
+      }
+    } else {
+      add_edge(s, w, d);
+    }
+  }
+
+  vert_range verts(void) const { return vert_range(_sz, is_free); }
+
+  succ_range succs(vert_id v) const {
+    return succ_range(&_flags[idx(v, 0)], 1, _sz, _out_deg[v]);
+  }
+
+  pred_range preds(vert_id v) const {
+    return pred_range(&_flags[idx(0, v)], _stride, _sz, _in_deg[v]);
+  }
+
+  e_succ_range e_succs(vert_id v) { return e_succ_range(*this, v); }
+  e_pred_range e_preds(vert_id v) { return e_pred_range(*this, v); }
+  const_e_succ_range e_succs(vert_id v) const {
+    return const_e_succ_range(*this, v);
+  }
+  const_e_pred_range e_preds(vert_id v) const {
+    return const_e_pred_range(*this, v);
+  }
+
+  // Replace each edge with the shortest path between its endpoints
+  // (Floyd-Warshall). The graph must not have negative cycles.
+  void close(void) {
+    for (vert_id k = 0; k < _sz; ++k) {
+      const Wt *row_k = &_ws[idx(k, 0)];
+      const flag_t *flags_k = &_flags[idx(k, 0)];
+      for (vert_id i = 0; i < _sz; ++i) {
+        if (i == k || !_flags[idx(i, k)]) {
+          continue;
+        }
+        Wt w_ik = _ws[idx(i, k)];
+        dense_graph_impl::relax_row(&_ws[idx(i, 0)], &_flags[idx(i, 0)],
+                                    row_k, flags_k, w_ik, _sz);
+      }
+    }
+    // Paths from a vertex to itself are not edges
+    for (vert_id v = 0; v < _sz; ++v) {
+      _ws[idx(v, v)] = Wt(0);
+      _flags[idx(v, v)] = 0;
+    }
+    recount();
+  }
+
+  void write(crab_os &o) const {
+    o << "[|";
+    bool first = true;
+    for (vert_id v = 0; v < _sz; v++) {
+      auto it = succs(v).begin();
+      auto end = succs(v).end();
+
+      if (it != end) {
+        if (first)
+          first = false;
+        else
+          o << ", ";
+
+        o << "[v" << v << " -> ";
+        o << "(" << edge_val(v, *it) << ":" << *it << ")";
+        for (++it; it != end; ++it) {
+          o << ", (" << edge_val(v, *it) << ":" << *it << ")";
+        }
+        o << "]";
+      }
+    }
+    o << "|]";
+  }
+
+  friend crab::crab_os &operator<<(crab::crab_os &o,
+                                   const DenseWtGraph<Weight> &g) {
+    g.write(o);
+    return o;
+  }
+};
+
+} // namespace crab
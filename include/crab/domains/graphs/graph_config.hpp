@@ -3,6 +3,7 @@
 #include <type_traits>
 
 #include <crab/domains/graphs/adapt_sgraph.hpp>
+#include <crab/domains/graphs/dense_graph.hpp>
 #include <crab/domains/graphs/ht_graph.hpp>
 #include <crab/domains/graphs/pt_graph.hpp>
 #include <crab/domains/graphs/sparse_graph.hpp>
@@ -13,9 +14,10 @@ namespace crab {
 namespace domains {
 namespace DBM_impl {
 
-// All of these representations are implementations of a
-// sparse weighted graph. They differ on the datastructures
-// used to store successors and predecessors
+// All of these representations but the last one are implementations
+// of a sparse weighted graph. They differ on the datastructures used
+// to store successors and predecessors. The last one is a matrix,
+// only suitable for small and nearly complete graphs.
 enum GraphRep {
   // sparse-map and sparse-sets
   ss = 1,
@@ -24,7 +26,9 @@ enum GraphRep {
   // patricia tree-maps and patricia tree-sets
   pt = 3,
   // hash table and hash sets
-  ht = 4
+  ht = 4,
+  // cache-aligned adjacency matrix
+  dense = 5
 };
 
 /** DBM weights (Wt) can be represented using one of the following
@@ -55,8 +59,11 @@ public:
       (Graph == ss), SparseWtGraph<Wt>,
       typename std::conditional<
           (Graph == adapt_ss), AdaptGraph<Wt>,
-          typename std::conditional<(Graph == pt), PtGraph<Wt>,
-                                    HtGraph<Wt>>::type>::type>::type;
+          typename std::conditional<
+              (Graph == pt), PtGraph<Wt>,
+              typename std::conditional<(Graph == ht), HtGraph<Wt>,
+                                        DenseWtGraph<Wt>>::type>::type>::
+          type>::type;
 };
 
 // We don't use GraphRep::adapt_ss because having problems
@@ -70,8 +77,11 @@ public:
       (Graph == ss), SparseWtGraph<Wt>,
       typename std::conditional<
           (Graph == adapt_ss), AdaptGraph<Wt>,
-          typename std::conditional<(Graph == pt), PtGraph<Wt>,
-                                    HtGraph<Wt>>::type>::type>::type;
+          typename std::conditional<
+              (Graph == pt), PtGraph<Wt>,
+              typename std::conditional<(Graph == ht), HtGraph<Wt>,
+                                        DenseWtGraph<Wt>>::type>::type>::
+          type>::type;
 };
 
 template <typename Number, GraphRep Graph = GraphRep::adapt_ss>
@@ -83,8 +93,11 @@ public:
       (Graph == ss), SparseWtGraph<Wt>,
       typename std::conditional<
           (Graph == adapt_ss), AdaptGraph<Wt>,
-          typename std::conditional<(Graph == pt), PtGraph<Wt>,
-                                    HtGraph<Wt>>::type>::type>::type;
+          typename std::conditional<
+              (Graph == pt), PtGraph<Wt>,
+              typename std::conditional<(Graph == ht), HtGraph<Wt>,
+                                        DenseWtGraph<Wt>>::type>::type>::
+          type>::type;
 };
 
 /**
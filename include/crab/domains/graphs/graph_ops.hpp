@@ -1,5 +1,6 @@
 #pragma once
 
+#include <crab/domains/graphs/dense_graph.hpp>
 #include <crab/domains/graphs/graph_views.hpp>
 #include <crab/domains/graphs/util/Heap.h>
 
@@ -48,48 +49,56 @@ public:
   enum QMarkT { BF_NONE = 0, BF_SCC = 1, BF_QUEUED = 2 };
   // ===========================================
   // Scratch space needed by the graph algorithms.
-  // Should really switch to some kind of arena allocator, rather
-  // than having all these static structures.
+  // There is one scratch space per thread so that several
+  // analyses can run concurrently. It grows on demand.
   // ===========================================
-  static char *edge_marks;
-
-  // Used for Bellman-Ford queueing
-  static vert_id *dual_queue;
-  static int *vert_marks;
-  static unsigned int scratch_sz;
-
-  // For locality, should combine dists & dist_ts.
-  // Wt must have an empty constructor, but does _not_
-  // need a top or infty element.
-  // dist_ts tells us which distances are current,
-  // and ts_idx prevents wraparound problems, in the unlikely
-  // circumstance that we have more than 2^sizeof(uint) iterations.
-  static std::vector<Wt> dists;
-  static std::vector<Wt> dists_alt;
-  static std::vector<unsigned int> dist_ts;
-  static unsigned int ts;
-  static unsigned int ts_idx;
+  struct scratch_t {
+    std::vector<char> edge_marks;
+
+    // Used for Bellman-Ford queueing
+    std::vector<vert_id> dual_queue;
+    std::vector<int> vert_marks;
+    unsigned int scratch_sz;
+
+    // For locality, should combine dists & dist_ts.
+    // Wt must have an empty constructor, but does _not_
+    // need a top or infty element.
+    // dist_ts tells us which distances are current,
+    // and ts_idx prevents wraparound problems, in the unlikely
+    // circumstance that we have more than 2^sizeof(uint) iterations.
+    std::vector<Wt> dists;
+    std::vector<Wt> dists_alt;
+    std::vector<unsigned int> dist_ts;
+    unsigned int ts;
+    unsigned int ts_idx;
+
+    scratch_t() : scratch_sz(0), ts(0), ts_idx(0) {}
+  };
+
+  static scratch_t &scratch() {
+    static thread_local scratch_t s;
+    return s;
+  }
 
   static void grow_scratch(unsigned int sz) {
-    if (sz <= scratch_sz)
+    scratch_t &scr = scratch();
+    if (sz <= scr.scratch_sz)
       return;
 
-    if (scratch_sz == 0)
-      scratch_sz = 10; // Introduce enums for init_sz and growth_factor
-    while (scratch_sz < sz)
-      scratch_sz *= 1.5;
+    if (scr.scratch_sz == 0)
+      scr.scratch_sz = 10; // Introduce enums for init_sz and growth_factor
+    while (scr.scratch_sz < sz)
+      scr.scratch_sz *= 1.5;
 
-    edge_marks =
-        (char *)realloc(edge_marks, sizeof(char) * scratch_sz * scratch_sz);
-    dual_queue =
-        (vert_id *)realloc(dual_queue, sizeof(vert_id) * 2 * scratch_sz);
-    vert_marks = (int *)realloc(vert_marks, sizeof(int) * scratch_sz);
+    scr.edge_marks.resize(scr.scratch_sz * scr.scratch_sz);
+    scr.dual_queue.resize(2 * scr.scratch_sz);
+    scr.vert_marks.resize(scr.scratch_sz);
 
     // Initialize new elements as necessary.
-    while (dists.size() < scratch_sz) {
-      dists.push_back(Wt());
-      dists_alt.push_back(Wt());
-      dist_ts.push_back(ts - 1);
+    while (scr.dists.size() < scr.scratch_sz) {
+      scr.dists.push_back(Wt());
+      scr.dists_alt.push_back(Wt());
+      scr.dist_ts.push_back(scr.ts - 1);
     }
   }
 
@@ -162,33 +171,35 @@ public:
   static void strong_connect(const G &x, std::vector<vert_id> &stack,
                              int &index, vert_id v,
                              std::vector<std::vector<vert_id>> &sccs) {
-    vert_marks[v] = (index << 1) | 1;
+    scratch_t &scr = scratch();
+    scr.vert_marks[v] = (index << 1) | 1;
     // assert(vert_marks[v]&1);
-    dual_queue[v] = index;
+    scr.dual_queue[v] = index;
     index++;
 
     stack.push_back(v);
 
     // Consider successors of v
     for (vert_id w : x.succs(v)) {
-      if (!vert_marks[w]) {
+      if (!scr.vert_marks[w]) {
         strong_connect(x, stack, index, w, sccs);
-        dual_queue[v] = std::min(dual_queue[v], dual_queue[w]);
-      } else if (vert_marks[w] & 1) {
+        scr.dual_queue[v] = std::min(scr.dual_queue[v], scr.dual_queue[w]);
+      } else if (scr.vert_marks[w] & 1) {
         // W is on the stack
-        dual_queue[v] = std::min(dual_queue[v], (vert_id)(vert_marks[w] >> 1));
+        scr.dual_queue[v] =
+            std::min(scr.dual_queue[v], (vert_id)(scr.vert_marks[w] >> 1));
       }
     }
 
     // If v is a root node, pop the stack and generate an SCC
-    if (dual_queue[v] == (vert_marks[v] >> 1)) {
+    if (scr.dual_queue[v] == (scr.vert_marks[v] >> 1)) {
       sccs.push_back(std::vector<vert_id>());
       std::vector<vert_id> &scc(sccs.back());
       int w;
       do {
         w = stack.back();
         stack.pop_back();
-        vert_marks[w] &= (~1);
+        scr.vert_marks[w] &= (~1);
         scc.push_back(w);
       } while (v != w);
     }
@@ -197,20 +208,21 @@ public:
   template <class G>
   static void compute_sccs(const G &x,
                            std::vector<std::vector<vert_id>> &out_scc) {
+    scratch_t &scr = scratch();
     int sz = x.size();
     grow_scratch(sz);
 
     for (vert_id v : x.verts())
-      vert_marks[v] = 0;
+      scr.vert_marks[v] = 0;
     int index = 1;
     std::vector<vert_id> stack;
     for (vert_id v : x.verts()) {
-      if (!vert_marks[v])
+      if (!scr.vert_marks[v])
         strong_connect(x, stack, index, v, out_scc);
     }
 
     for (vert_id v : x.verts()) {
-      vert_marks[v] = 0;
+      scr.vert_marks[v] = 0;
     }
   }
 
@@ -218,6 +230,7 @@ public:
   // constraints. Returns false if there is some negative cycle.
   template <class G, class P>
   static bool select_potentials(const G &g, P &potentials) {
+    scratch_t &scr = scratch();
     int sz = g.size();
     assert(potentials.size() >= sz);
     grow_scratch(sz);
@@ -245,15 +258,15 @@ public:
     for (auto it = sccs.rbegin(); it != sccs.rend(); ++it) {
       std::vector<vert_id> &scc(*it);
 
-      vert_id *qhead = dual_queue;
+      vert_id *qhead = scr.dual_queue.data();
       vert_id *qtail = qhead;
 
-      vert_id *next_head = dual_queue + sz;
+      vert_id *next_head = scr.dual_queue.data() + sz;
       vert_id *next_tail = next_head;
 
       for (vert_id v : scc) {
         *qtail = v;
-        vert_marks[v] = BF_SCC | BF_QUEUED;
+        scr.vert_marks[v] = BF_SCC | BF_QUEUED;
         qtail++;
       }
 
@@ -261,7 +274,7 @@ public:
         for (; qtail != qhead;) {
           vert_id s = *(--qtail);
           // If it _was_ on the queue, it must be in the SCC
-          vert_marks[s] = BF_SCC;
+          scr.vert_marks[s] = BF_SCC;
 
           Wt s_pot = potentials[s];
 
@@ -270,9 +283,9 @@ public:
             Wt sd_pot = s_pot + e.val;
             if (sd_pot < potentials[d]) {
               potentials[d] = sd_pot;
-              if (vert_marks[d] == BF_SCC) {
+              if (scr.vert_marks[d] == BF_SCC) {
                 *next_tail = d;
-                vert_marks[d] = (BF_SCC | BF_QUEUED);
+                scr.vert_marks[d] = (BF_SCC | BF_QUEUED);
                 next_tail++;
               }
             }
@@ -294,7 +307,7 @@ public:
           if (s_pot + e.val < potentials[d]) {
             // Cleanup vertex marks
             for (vert_id v : g.verts())
-              vert_marks[v] = BF_NONE;
+              scr.vert_marks[v] = BF_NONE;
             return false;
           }
         }
@@ -306,6 +319,17 @@ public:
   template <class G, class G1, class G2, class P>
   static void close_after_meet(const G &g, const P &pots, const G1 &l,
                                const G2 &r, edge_vector &delta) {
+    close_after_meet(g, pots, l, r, g.verts(), delta);
+  }
+
+  // Same as above but only the shortest paths from the vertices in
+  // srcs are recomputed. Every path of g that uses an edge only in r
+  // must start at some vertex in srcs.
+  template <class G, class G1, class G2, class P, class V>
+  static void close_after_meet(const G &g, const P &pots, const G1 &l,
+                               const G2 &r, const V &srcs,
+                               edge_vector &delta) {
+    scratch_t &scr = scratch();
     // We assume the syntactic meet has already been computed,
     // and potentials have been initialized.
     // We just want to restore closure.
@@ -341,7 +365,7 @@ public:
         default:
           break;
         }
-        edge_marks[sz * s + d] = mark;
+        scr.edge_marks[sz * s + d] = mark;
       }
     }
 
@@ -349,7 +373,7 @@ public:
     // on each source.
     std::vector<std::pair<vert_id, Wt>> adjs;
     //      for(vert_id v = 0; v < sz; v++)
-    for (vert_id v : g.verts()) {
+    for (vert_id v : srcs) {
       adjs.clear();
       chrome_dijkstra(g, pots, colour_succs, v, adjs);
 
@@ -358,6 +382,57 @@ public:
     }
   }
 
+  // Restore closure with a dense all-pairs shortest path kernel if
+  // g has at most max_size vertices and at least half of the
+  // possible edges. The edges that must be added or tightened are
+  // appended to delta. Return false, leaving delta unchanged, if g is
+  // too large or too sparse. g must not have negative cycles.
+  template <class G>
+  static bool close_dense(const G &g, unsigned max_size, edge_vector &delta) {
+    std::vector<vert_id> verts;
+    for (vert_id v : g.verts()) {
+      verts.push_back(v);
+      if (verts.size() > max_size) {
+        return false;
+      }
+    }
+    const unsigned n = verts.size();
+    if (n < 3) {
+      return false;
+    }
+    std::vector<int> index(g.size(), -1);
+    for (unsigned i = 0; i < n; ++i) {
+      index[verts[i]] = i;
+    }
+
+    DenseWtGraph<Wt> dense;
+    dense.growTo(n);
+    for (unsigned i = 0; i < n; ++i) {
+      for (auto e : g.e_succs(verts[i])) {
+        int j = index[e.vert];
+        if (j >= 0 && j != (int)i) {
+          dense.add_edge(i, e.val, j);
+        }
+      }
+    }
+    if (2 * dense.num_edges() < n * (n - 1)) {
+      return false;
+    }
+
+    DenseWtGraph<Wt> closed(dense);
+    closed.close();
+    typename DenseWtGraph<Wt>::wt_ref_t w;
+    for (unsigned i = 0; i < n; ++i) {
+      for (vert_id j : closed.succs(i)) {
+        const Wt &c = closed.edge_val(i, j);
+        if (!dense.lookup(i, j, w) || c < w.get()) {
+          delta.push_back(std::make_pair(std::make_pair(verts[i], verts[j]), c));
+        }
+      }
+    }
+    return true;
+  }
+
   static void apply_delta(graph_t &g, edge_vector &delta) {
     for (std::pair<std::pair<vert_id, vert_id>, Wt> &e : delta) {
       assert(e.first.first != e.first.second);
@@ -371,35 +446,36 @@ public:
   template <class G, class P>
   static void dijkstra(const G &g, const P &p, vert_id src,
                        std::vector<std::pair<vert_id, Wt>> &out) {
+    scratch_t &scr = scratch();
     unsigned int sz = g.size();
     if (sz == 0)
       return;
     grow_scratch(sz);
 
     // Reset all vertices to infty.
-    dist_ts[ts_idx] = ts++;
-    ts_idx = (ts_idx + 1) % dists.size();
+    scr.dist_ts[scr.ts_idx] = scr.ts++;
+    scr.ts_idx = (scr.ts_idx + 1) % scr.dists.size();
 
-    dists[src] = Wt(0);
-    dist_ts[src] = ts;
+    scr.dists[src] = Wt(0);
+    scr.dist_ts[src] = scr.ts;
 
-    WtComp comp(dists);
+    WtComp comp(scr.dists);
     WtHeap heap(comp);
 
     for (auto e : g.e_succs(src)) {
       vert_id dest = e.vert;
-      dists[dest] = p[src] + e.val - p[dest];
-      dist_ts[dest] = ts;
+      scr.dists[dest] = p[src] + e.val - p[dest];
+      scr.dist_ts[dest] = scr.ts;
 
-      vert_marks[dest] = edge_marks[sz * src + dest];
+      scr.vert_marks[dest] = scr.edge_marks[sz * src + dest];
       heap.insert(dest);
     }
 
     wt_ref_t w;
     while (!heap.empty()) {
       int es = heap.removeMin();
-      Wt es_cost =
-          dists[es] + p[es]; // If it's on the queue, distance is not infinite.
+      // If it's on the queue, distance is not infinite.
+      Wt es_cost = scr.dists[es] + p[es];
       Wt es_val = es_cost - p[src];
       if (!g.lookup(src, es, w) || w.get() > es_val)
         out.push_back(std::make_pair(es, es_val));
@@ -407,9 +483,9 @@ public:
       for (auto e_ed : g.e_succs(es)) {
         vert_id ed(e_ed.vert);
         Wt v = es_cost + e_ed.val - p[ed];
-        if (dist_ts[ed] != ts || v < dists[ed]) {
-          dists[ed] = v;
-          dist_ts[ed] = ts;
+        if (scr.dist_ts[ed] != scr.ts || v < scr.dists[ed]) {
+          scr.dists[ed] = v;
+          scr.dist_ts[ed] = scr.ts;
 
           if (heap.inHeap(ed)) {
             heap.decrease(ed);
@@ -423,8 +499,15 @@ public:
 
   template <class G, class P>
   static void close_johnson(const G &g, const P &p, edge_vector &out) {
+    close_johnson(g, p, g.verts(), out);
+  }
+
+  // Compute only the shortest paths from the vertices in srcs
+  template <class G, class P, class V>
+  static void close_johnson(const G &g, const P &p, const V &srcs,
+                            edge_vector &out) {
     std::vector<std::pair<vert_id, Wt>> adjs;
-    for (vert_id v : g.verts()) {
+    for (vert_id v : srcs) {
       adjs.clear();
       dijkstra(g, p, v, adjs);
       for (auto p : adjs)
@@ -439,60 +522,61 @@ public:
                               std::vector<std::vector<vert_id>> &colour_succs,
                               vert_id src,
                               std::vector<std::pair<vert_id, Wt>> &out) {
+    scratch_t &scr = scratch();
     unsigned int sz = g.size();
     if (sz == 0)
       return;
     grow_scratch(sz);
 
     // Reset all vertices to infty.
-    dist_ts[ts_idx] = ts++;
-    ts_idx = (ts_idx + 1) % dists.size();
+    scr.dist_ts[scr.ts_idx] = scr.ts++;
+    scr.ts_idx = (scr.ts_idx + 1) % scr.dists.size();
 
-    dists[src] = Wt(0);
-    dist_ts[src] = ts;
+    scr.dists[src] = Wt(0);
+    scr.dist_ts[src] = scr.ts;
 
-    WtComp comp(dists);
+    WtComp comp(scr.dists);
     WtHeap heap(comp);
 
     for (auto e : g.e_succs(src)) {
       vert_id dest = e.vert;
-      dists[dest] = p[src] + e.val - p[dest];
-      dist_ts[dest] = ts;
+      scr.dists[dest] = p[src] + e.val - p[dest];
+      scr.dist_ts[dest] = scr.ts;
 
-      vert_marks[dest] = edge_marks[sz * src + dest];
+      scr.vert_marks[dest] = scr.edge_marks[sz * src + dest];
       heap.insert(dest);
     }
 
     wt_ref_t w;
     while (!heap.empty()) {
       int es = heap.removeMin();
-      Wt es_cost =
-          dists[es] + p[es]; // If it's on the queue, distance is not infinite.
+      // If it's on the queue, distance is not infinite.
+      Wt es_cost = scr.dists[es] + p[es];
       Wt es_val = es_cost - p[src];
       if (!g.lookup(src, es, w) || w.get() > es_val)
         out.push_back(std::make_pair(es, es_val));
 
-      if (vert_marks[es] == (E_LEFT | E_RIGHT))
+      if (scr.vert_marks[es] == (E_LEFT | E_RIGHT))
         continue;
 
       // Pick the appropriate set of successors
-      std::vector<vert_id> &es_succs = (vert_marks[es] == E_LEFT)
+      std::vector<vert_id> &es_succs = (scr.vert_marks[es] == E_LEFT)
                                            ? colour_succs[2 * es + 1]
                                            : colour_succs[2 * es];
       for (vert_id ed : es_succs) {
         Wt v = es_cost + g.edge_val(es, ed) - p[ed];
-        if (dist_ts[ed] != ts || v < dists[ed]) {
-          dists[ed] = v;
-          dist_ts[ed] = ts;
-          vert_marks[ed] = edge_marks[sz * es + ed];
+        if (scr.dist_ts[ed] != scr.ts || v < scr.dists[ed]) {
+          scr.dists[ed] = v;
+          scr.dist_ts[ed] = scr.ts;
+          scr.vert_marks[ed] = scr.edge_marks[sz * es + ed];
 
           if (heap.inHeap(ed)) {
             heap.decrease(ed);
           } else {
             heap.insert(ed);
           }
-        } else if (v == dists[ed]) {
-          vert_marks[ed] |= edge_marks[sz * es + ed];
+        } else if (v == scr.dists[ed]) {
+          scr.vert_marks[ed] |= scr.edge_marks[sz * es + ed];
         }
       }
     }
@@ -505,6 +589,7 @@ public:
   static void dijkstra_recover(const G &g, const P &p, const S &is_stable,
                                vert_id src,
                                std::vector<std::pair<vert_id, Wt>> &out) {
+    scratch_t &scr = scratch();
     unsigned int sz = g.size();
     if (sz == 0)
       return;
@@ -514,34 +599,34 @@ public:
     grow_scratch(sz);
 
     // Reset all vertices to infty.
-    dist_ts[ts_idx] = ts++;
-    ts_idx = (ts_idx + 1) % dists.size();
+    scr.dist_ts[scr.ts_idx] = scr.ts++;
+    scr.ts_idx = (scr.ts_idx + 1) % scr.dists.size();
 
-    dists[src] = Wt(0);
-    dist_ts[src] = ts;
+    scr.dists[src] = Wt(0);
+    scr.dist_ts[src] = scr.ts;
 
-    WtComp comp(dists);
+    WtComp comp(scr.dists);
     WtHeap heap(comp);
 
     for (auto e : g.e_succs(src)) {
       vert_id dest = e.vert;
-      dists[dest] = p[src] + e.val - p[dest];
-      dist_ts[dest] = ts;
+      scr.dists[dest] = p[src] + e.val - p[dest];
+      scr.dist_ts[dest] = scr.ts;
 
-      vert_marks[dest] = V_UNSTABLE;
+      scr.vert_marks[dest] = V_UNSTABLE;
       heap.insert(dest);
     }
 
     wt_ref_t w;
     while (!heap.empty()) {
       int es = heap.removeMin();
-      Wt es_cost =
-          dists[es] + p[es]; // If it's on the queue, distance is not infinite.
+      // If it's on the queue, distance is not infinite.
+      Wt es_cost = scr.dists[es] + p[es];
       Wt es_val = es_cost - p[src];
       if (!g.lookup(src, es, w) || w.get() > es_val)
         out.push_back(std::make_pair(es, es_val));
 
-      if (vert_marks[es] == V_STABLE)
+      if (scr.vert_marks[es] == V_STABLE)
         continue;
 
       char es_mark = is_stable[es] ? V_STABLE : V_UNSTABLE;
@@ -550,18 +635,18 @@ public:
       for (auto e : g.e_succs(es)) {
         vert_id ed = e.vert;
         Wt v = es_cost + e.val - p[ed];
-        if (dist_ts[ed] != ts || v < dists[ed]) {
-          dists[ed] = v;
-          dist_ts[ed] = ts;
-          vert_marks[ed] = es_mark;
+        if (scr.dist_ts[ed] != scr.ts || v < scr.dists[ed]) {
+          scr.dists[ed] = v;
+          scr.dist_ts[ed] = scr.ts;
+          scr.vert_marks[ed] = es_mark;
 
           if (heap.inHeap(ed)) {
             heap.decrease(ed);
           } else {
             heap.insert(ed);
           }
-        } else if (v == dists[ed]) {
-          vert_marks[ed] |= es_mark;
+        } else if (v == scr.dists[ed]) {
+          scr.vert_marks[ed] |= es_mark;
         }
       }
     }
@@ -569,21 +654,22 @@ public:
 
   template <class G, class P>
   static bool repair_potential(const G &g, P &p, vert_id ii, vert_id jj) {
+    scratch_t &scr = scratch();
     // Ensure there's enough scratch space.
     unsigned int sz = g.size();
     // assert(src < (int) sz && dest < (int) sz);
     grow_scratch(sz);
 
     for (vert_id vi : g.verts()) {
-      dists[vi] = Wt(0);
-      dists_alt[vi] = p[vi];
+      scr.dists[vi] = Wt(0);
+      scr.dists_alt[vi] = p[vi];
     }
-    dists[jj] = p[ii] + g.edge_val(ii, jj) - p[jj];
+    scr.dists[jj] = p[ii] + g.edge_val(ii, jj) - p[jj];
 
-    if (dists[jj] >= Wt(0))
+    if (scr.dists[jj] >= Wt(0))
       return true;
 
-    WtComp comp(dists);
+    WtComp comp(scr.dists);
     WtHeap heap(comp);
 
     heap.insert(jj);
@@ -591,14 +677,14 @@ public:
     while (!heap.empty()) {
       int es = heap.removeMin();
 
-      dists_alt[es] = p[es] + dists[es];
+      scr.dists_alt[es] = p[es] + scr.dists[es];
 
       for (auto e : g.e_succs(es)) {
         vert_id ed = e.vert;
-        if (dists_alt[ed] == p[ed]) {
-          Wt gnext_ed = dists_alt[es] + e.val - dists_alt[ed];
-          if (gnext_ed < dists[ed]) {
-            dists[ed] = gnext_ed;
+        if (scr.dists_alt[ed] == p[ed]) {
+          Wt gnext_ed = scr.dists_alt[es] + e.val - scr.dists_alt[ed];
+          if (gnext_ed < scr.dists[ed]) {
+            scr.dists[ed] = gnext_ed;
             if (heap.inHeap(ed)) {
               heap.decrease(ed);
             } else {
@@ -608,11 +694,11 @@ public:
         }
       }
     }
-    if (dists[ii] < Wt(0))
+    if (scr.dists[ii] < Wt(0))
       return false;
 
     for (vert_id v : g.verts())
-      p[v] = dists_alt[v];
+      p[v] = scr.dists_alt[v];
 
     return true;
   }
@@ -620,6 +706,7 @@ public:
   template <class G, class P, class V>
   static void close_after_widen(const G &g, P &p, const V &is_stable,
                                 edge_vector &delta) {
+    scratch_t &scr = scratch();
     unsigned int sz = g.size();
     grow_scratch(sz);
     //      assert(orig.size() == sz);
@@ -628,14 +715,14 @@ public:
       // We're abusing edge_marks to store _vertex_ flags.
       // Should really just switch this to allocating regions of a fixed-size
       // buffer.
-      edge_marks[v] = is_stable[v] ? V_STABLE : V_UNSTABLE;
+      scr.edge_marks[v] = is_stable[v] ? V_STABLE : V_UNSTABLE;
     }
 
     std::vector<std::pair<vert_id, Wt>> aux;
     for (vert_id v : g.verts()) {
-      if (!edge_marks[v]) {
+      if (!scr.edge_marks[v]) {
         aux.clear();
-        dijkstra_recover(g, p, edge_marks, v, aux);
+        dijkstra_recover(g, p, scr.edge_marks, v, aux);
         for (auto p : aux)
           delta.push_back(std::make_pair(std::make_pair(v, p.first), p.second));
       }
@@ -647,7 +734,7 @@ public:
   // dists is initialized.
   template <class P> class AdjCmp {
   public:
-    AdjCmp(const P &_p) : p(_p) {}
+    AdjCmp(const P &_p) : p(_p), dists(scratch().dists) {}
 
     bool operator()(vert_id d1, vert_id d2) const {
       return (dists[d1] - p[d1]) < (dists[d2] - p[d2]);
@@ -655,6 +742,7 @@ public:
 
   protected:
     const P &p;
+    const std::vector<Wt> &dists;
   };
 
   template <class P> static AdjCmp<P> make_adjcmp(const P &p) {
@@ -675,18 +763,19 @@ public:
   template <class G, class P>
   static void close_after_assign_fwd(const G &g, const P &p, vert_id v,
                                      std::vector<std::pair<vert_id, Wt>> &aux) {
+    scratch_t &scr = scratch();
     // Initialize the queue and distances.
     for (vert_id u : g.verts())
-      vert_marks[u] = 0;
+      scr.vert_marks[u] = 0;
 
-    vert_marks[v] = BF_QUEUED;
-    dists[v] = Wt(0);
-    vert_id *adj_head = dual_queue;
+    scr.vert_marks[v] = BF_QUEUED;
+    scr.dists[v] = Wt(0);
+    vert_id *adj_head = scr.dual_queue.data();
     vert_id *adj_tail = adj_head;
     for (auto e : g.e_succs(v)) {
       vert_id d = e.vert;
-      vert_marks[d] = BF_QUEUED;
-      dists[d] = e.val;
+      scr.vert_marks[d] = BF_QUEUED;
+      scr.dists[d] = e.val;
       //        assert(p[v] + dists[d] - p[d] >= Wt(0));
       *adj_tail = d;
       adj_tail++;
@@ -699,26 +788,26 @@ public:
     for (; adj_head < adj_tail; adj_head++) {
       vert_id d = *adj_head;
 
-      Wt d_wt = dists[d];
+      Wt d_wt = scr.dists[d];
       for (auto edge : g.e_succs(d)) {
         vert_id e = edge.vert;
         Wt e_wt = d_wt + edge.val;
-        if (!vert_marks[e]) {
-          dists[e] = e_wt;
-          vert_marks[e] = BF_QUEUED;
+        if (!scr.vert_marks[e]) {
+          scr.dists[e] = e_wt;
+          scr.vert_marks[e] = BF_QUEUED;
           *reach_tail = e;
           reach_tail++;
         } else {
-          dists[e] = std::min(e_wt, dists[e]);
+          scr.dists[e] = std::min(e_wt, scr.dists[e]);
         }
       }
     }
 
     // Now collect the adjacencies, and clear vertex flags
     // FIXME: This collects _all_ edges from x, not just new ones.
-    for (adj_head = dual_queue; adj_head < reach_tail; adj_head++) {
-      aux.push_back(std::make_pair(*adj_head, dists[*adj_head]));
-      vert_marks[*adj_head] = 0;
+    for (adj_head = scr.dual_queue.data(); adj_head < reach_tail; adj_head++) {
+      aux.push_back(std::make_pair(*adj_head, scr.dists[*adj_head]));
+      scr.vert_marks[*adj_head] = 0;
     }
   }
 
@@ -742,22 +831,5 @@ public:
   }
 };
 
-// Static data allocation
-template <class Wt> char *GraphOps<Wt>::edge_marks = NULL;
-
-// Used for Bellman-Ford queueing
-template <class Wt>
-typename GraphOps<Wt>::vert_id *GraphOps<Wt>::dual_queue = NULL;
-
-template <class Wt> int *GraphOps<Wt>::vert_marks = NULL;
-
-template <class Wt> unsigned int GraphOps<Wt>::scratch_sz = 0;
-
-template <class G> std::vector<typename G::Wt> GraphOps<G>::dists;
-template <class G> std::vector<typename G::Wt> GraphOps<G>::dists_alt;
-template <class G> std::vector<unsigned int> GraphOps<G>::dist_ts;
-template <class G> unsigned int GraphOps<G>::ts = 0;
-template <class G> unsigned int GraphOps<G>::ts_idx = 0;
-
 } // namespace crab
 #pragma GCC diagnostic pop
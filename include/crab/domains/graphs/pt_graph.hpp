@@ -49,10 +49,10 @@ private:
   class vert_idx : public indexable {
   public:
     vert_idx(vert_id _v) : v(_v) {}
-    virtual ikos::index_t index(void) const override {
+    ikos::index_t index(void) const {
       return (ikos::index_t)v;
     }
-    virtual void write(crab_os &o) const override { o << v; }
+    void write(crab_os &o) const { o << v; }
 
     vert_id v;
   };
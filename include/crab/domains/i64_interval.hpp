@@ -0,0 +1,385 @@
+#pragma once
+
+/*******************************************************************************
+ * Intervals over mathematical integers whose bounds are stored in
+ * int64_t rather than in z_number.
+ *
+ * INT64_MIN and INT64_MAX are reserved to represent -oo and +oo so
+ * finite bounds are in [INT64_MIN+1, INT64_MAX-1]. All operations are
+ * saturating: if a bound does not fit then it is rounded outwards
+ * (lower bounds towards -oo and upper bounds towards +oo). Therefore,
+ * the result is always a sound over-approximation of the one computed
+ * by ikos::interval<z_number>, and exactly the same one if no
+ * overflow happens.
+ ******************************************************************************/
+
+#include <crab/domains/interval.hpp>
+#include <crab/domains/linear_interval_solver.hpp>
+#include <crab/fixpoint/thresholds.hpp>
+#include <crab/numbers/bignums.hpp>
+#include <crab/numbers/safeint.hpp>
+#include <crab/support/os.hpp>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <limits>
+
+namespace crab {
+namespace domains {
+
+class i64_interval {
+public:
+  using z_interval_t = ikos::interval<ikos::z_number>;
+  using z_bound_t = ikos::bound<ikos::z_number>;
+
+private:
+  int64_t m_lb;
+  int64_t m_ub;
+
+  static constexpr int64_t min_finite() { return minus_inf() + 1; }
+  static constexpr int64_t max_finite() { return plus_inf() - 1; }
+
+  static bool is_inf(int64_t b) { return b == minus_inf() || b == plus_inf(); }
+
+  // Round a value to a lower (upper) bound. n can be minus_inf() or
+  // plus_inf() if the value overflowed.
+  static int64_t round_lb(int64_t n) {
+    return n == plus_inf() ? max_finite() : n;
+  }
+  static int64_t round_ub(int64_t n) {
+    return n == minus_inf() ? min_finite() : n;
+  }
+
+  // Operations over bounds. Infinite operands and results that do not
+  // fit in int64_t are represented by minus_inf() and plus_inf(). The
+  // result must be passed to round_lb or round_ub.
+  static int64_t neg(int64_t a) {
+    if (a == minus_inf()) {
+      return plus_inf();
+    } else if (a == plus_inf()) {
+      return minus_inf();
+    } else {
+      return -a;
+    }
+  }
+
+  // -oo + +oo cannot happen since lower bounds are only added to
+  // lower bounds and upper bounds to upper bounds.
+  static int64_t add(int64_t a, int64_t b) {
+    if (is_inf(a)) {
+      return a;
+    } else if (is_inf(b)) {
+      return b;
+    } else {
+      int64_t r;
+      if (safe_i64::checked_add(a, b, &r)) {
+        return b > 0 ? plus_inf() : minus_inf();
+      }
+      return r;
+    }
+  }
+
+  static int64_t mul(int64_t a, int64_t b) {
+    if (a == 0 || b == 0) {
+      return 0;
+    }
+    bool is_neg = (a < 0) != (b < 0);
+    if (is_inf(a) || is_inf(b)) {
+      return is_neg ? minus_inf() : plus_inf();
+    }
+    int64_t r;
+    if (safe_i64::checked_mul(a, b, &r)) {
+      return is_neg ? minus_inf() : plus_inf();
+    }
+    return r;
+  }
+
+  // b must be different from zero. Finite divisions truncate like
+  // z_number. Unlike ikos::bound, a finite number divided by an
+  // infinite one is zero.
+  static int64_t div(int64_t a, int64_t b) {
+    if (is_inf(a)) {
+      return (b < 0) ? neg(a) : a;
+    } else if (is_inf(b)) {
+      return 0;
+    } else {
+      // no overflow: a cannot be INT64_MIN
+      return a / b;
+    }
+  }
+
+  static int64_t min(int64_t a, int64_t b) { return a < b ? a : b; }
+  static int64_t max(int64_t a, int64_t b) { return a < b ? b : a; }
+
+  static int64_t min(int64_t a, int64_t b, int64_t c, int64_t d) {
+    return min(min(a, b), min(c, d));
+  }
+  static int64_t max(int64_t a, int64_t b, int64_t c, int64_t d) {
+    return max(max(a, b), max(c, d));
+  }
+
+  static int64_t from_z_lb(const z_bound_t &b);
+  static int64_t from_z_ub(const z_bound_t &b);
+  static z_bound_t to_z_bound(int64_t b);
+
+  i64_interval mul_non_singleton(const i64_interval &x) const;
+  i64_interval div_non_singleton(const i64_interval &x) const;
+
+public:
+  // Representation of -oo and +oo
+  static constexpr int64_t minus_inf() {
+    return std::numeric_limits<int64_t>::min();
+  }
+  static constexpr int64_t plus_inf() {
+    return std::numeric_limits<int64_t>::max();
+  }
+
+  static i64_interval top() { return i64_interval(minus_inf(), plus_inf()); }
+
+  static i64_interval bottom() { return i64_interval(1, 0); }
+
+  // top
+  i64_interval() : m_lb(minus_inf()), m_ub(plus_inf()) {}
+
+  // lb and ub can be minus_inf() and plus_inf(), respectively.
+  i64_interval(int64_t lb, int64_t ub) : m_lb(lb), m_ub(ub) {
+    if (m_lb == plus_inf() || m_ub == minus_inf() || m_lb > m_ub) {
+      m_lb = 1;
+      m_ub = 0;
+    }
+  }
+
+  // n can be any int64_t: INT64_MIN and INT64_MAX are not
+  // representable as finite bounds so they are rounded outwards.
+  explicit i64_interval(int64_t n) : m_lb(round_lb(n)), m_ub(round_ub(n)) {}
+
+  // Return the smallest interval that contains n
+  explicit i64_interval(const ikos::z_number &n);
+
+  // Return the smallest interval that contains i
+  explicit i64_interval(const z_interval_t &i);
+
+  z_interval_t to_interval() const;
+
+  // Return minus_inf() if -oo
+  int64_t lb() const { return m_lb; }
+
+  // Return plus_inf() if +oo
+  int64_t ub() const { return m_ub; }
+
+  bool is_bottom() const { return m_lb > m_ub; }
+
+  bool is_top() const { return m_lb == minus_inf() && m_ub == plus_inf(); }
+
+  bool lb_is_finite() const { return m_lb != minus_inf(); }
+
+  bool ub_is_finite() const { return m_ub != plus_inf(); }
+
+  boost::optional<int64_t> singleton() const {
+    if (!is_bottom() && m_lb == m_ub) {
+      return m_lb;
+    } else {
+      return boost::optional<int64_t>();
+    }
+  }
+
+  bool operator[](int64_t n) const { return m_lb <= n && n <= m_ub; }
+
+  i64_interval lower_half_line() const {
+    if (is_bottom()) {
+      return bottom();
+    }
+    return i64_interval(minus_inf(), m_ub);
+  }
+
+  i64_interval upper_half_line() const {
+    if (is_bottom()) {
+      return bottom();
+    }
+    return i64_interval(m_lb, plus_inf());
+  }
+
+  bool operator==(const i64_interval &x) const {
+    if (is_bottom()) {
+      return x.is_bottom();
+    } else {
+      return m_lb == x.m_lb && m_ub == x.m_ub;
+    }
+  }
+
+  bool operator!=(const i64_interval &x) const { return !operator==(x); }
+
+  bool operator<=(const i64_interval &x) const {
+    if (is_bottom()) {
+      return true;
+    } else if (x.is_bottom()) {
+      return false;
+    } else {
+      return x.m_lb <= m_lb && m_ub <= x.m_ub;
+    }
+  }
+
+  i64_interval operator|(const i64_interval &x) const {
+    if (is_bottom()) {
+      return x;
+    } else if (x.is_bottom()) {
+      return *this;
+    } else {
+      return i64_interval(min(m_lb, x.m_lb), max(m_ub, x.m_ub));
+    }
+  }
+
+  i64_interval operator&(const i64_interval &x) const {
+    if (is_bottom() || x.is_bottom()) {
+      return bottom();
+    } else {
+      return i64_interval(max(m_lb, x.m_lb), min(m_ub, x.m_ub));
+    }
+  }
+
+  i64_interval operator||(const i64_interval &x) const {
+    if (is_bottom()) {
+      return x;
+    } else if (x.is_bottom()) {
+      return *this;
+    } else {
+      return i64_interval(x.m_lb < m_lb ? minus_inf() : m_lb,
+                          m_ub < x.m_ub ? plus_inf() : m_ub);
+    }
+  }
+
+  i64_interval
+  widening_thresholds(const i64_interval &x,
+                      const crab::thresholds<ikos::z_number> &ts) const;
+
+  i64_interval operator&&(const i64_interval &x) const {
+    if (is_bottom() || x.is_bottom()) {
+      return bottom();
+    } else {
+      return i64_interval(
+          !lb_is_finite() && x.lb_is_finite() ? x.m_lb : m_lb,
+          !ub_is_finite() && x.ub_is_finite() ? x.m_ub : m_ub);
+    }
+  }
+
+  i64_interval operator+(const i64_interval &x) const {
+    if (is_bottom() || x.is_bottom()) {
+      return bottom();
+    } else {
+      return i64_interval(round_lb(add(m_lb, x.m_lb)),
+                          round_ub(add(m_ub, x.m_ub)));
+    }
+  }
+
+  i64_interval &operator+=(const i64_interval &x) {
+    return operator=(operator+(x));
+  }
+
+  i64_interval operator-() const {
+    if (is_bottom()) {
+      return bottom();
+    } else {
+      return i64_interval(neg(m_ub), neg(m_lb));
+    }
+  }
+
+  i64_interval operator-(const i64_interval &x) const {
+    if (is_bottom() || x.is_bottom()) {
+      return bottom();
+    } else {
+      return i64_interval(round_lb(add(m_lb, neg(x.m_ub))),
+                          round_ub(add(m_ub, neg(x.m_lb))));
+    }
+  }
+
+  i64_interval &operator-=(const i64_interval &x) {
+    return operator=(operator-(x));
+  }
+
+  i64_interval operator*(const i64_interval &x) const {
+    if (is_bottom() || x.is_bottom()) {
+      return bottom();
+    } else if (x.m_lb == x.m_ub) {
+      // the linear interval solver and the transfer functions
+      // multiply mostly by constants.
+      int64_t l = mul(m_lb, x.m_lb);
+      int64_t u = mul(m_ub, x.m_lb);
+      return (x.m_lb >= 0 ? i64_interval(round_lb(l), round_ub(u))
+                          : i64_interval(round_lb(u), round_ub(l)));
+    } else {
+      return mul_non_singleton(x);
+    }
+  }
+
+  i64_interval &operator*=(const i64_interval &x) {
+    return operator=(operator*(x));
+  }
+
+  i64_interval operator/(const i64_interval &x) const {
+    if (is_bottom() || x.is_bottom()) {
+      return bottom();
+    } else if (x.m_lb == x.m_ub) {
+      // Divisor is a singleton (common case in the linear interval
+      // solver)
+      int64_t c = x.m_lb;
+      if (c == 1) {
+        return *this;
+      } else if (c > 0) {
+        return i64_interval(div(m_lb, c), div(m_ub, c));
+      } else if (c < 0) {
+        return i64_interval(div(m_ub, c), div(m_lb, c));
+      }
+    }
+    return div_non_singleton(x);
+  }
+
+  i64_interval &operator/=(const i64_interval &x) {
+    return operator=(operator/(x));
+  }
+
+  // division and remainder operations
+  i64_interval UDiv(const i64_interval &x) const;
+  i64_interval SRem(const i64_interval &x) const;
+  i64_interval URem(const i64_interval &x) const;
+
+  // bitwise operations
+  i64_interval And(const i64_interval &x) const;
+  i64_interval Or(const i64_interval &x) const;
+  i64_interval Xor(const i64_interval &x) const;
+  i64_interval Shl(const i64_interval &x) const;
+  i64_interval LShr(const i64_interval &x) const;
+  i64_interval AShr(const i64_interval &x) const;
+
+  void write(crab::crab_os &o) const;
+
+  friend crab::crab_os &operator<<(crab::crab_os &o, const i64_interval &i) {
+    i.write(o);
+    return o;
+  }
+};
+
+} // end namespace domains
+} // end namespace crab
+
+namespace ikos {
+namespace linear_interval_solver_impl {
+template <>
+inline crab::domains::i64_interval
+mk_interval(ikos::z_number c, typename crab::wrapint::bitwidth_t /*w*/) {
+  return crab::domains::i64_interval(c);
+}
+
+template <>
+crab::domains::i64_interval
+trim_interval(const crab::domains::i64_interval &i,
+              const crab::domains::i64_interval &j);
+
+template <>
+crab::domains::i64_interval
+lower_half_line(const crab::domains::i64_interval &i, bool is_signed);
+
+template <>
+crab::domains::i64_interval
+upper_half_line(const crab::domains::i64_interval &i, bool is_signed);
+} // namespace linear_interval_solver_impl
+} // end namespace ikos
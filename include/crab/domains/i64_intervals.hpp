@@ -0,0 +1,543 @@
+#pragma once
+
+/**
+ * Domain of intervals whose bounds are machine integers (see
+ * i64_interval.hpp).
+ *
+ * It is a drop-in replacement of ikos::interval_domain<z_number,...>:
+ * the interface (linear constraints, interval_t, etc.) is still over
+ * z_number but the intervals are stored and manipulated as pairs of
+ * int64_t. Constants are converted only when a statement or
+ * constraint is processed. If all the bounds fit in int64_t, both
+ * domains infer exactly the same invariants. Otherwise, bounds that
+ * overflow are soundly rounded to -oo or +oo.
+ **/
+
+#include <crab/domains/abstract_domain.hpp>
+#include <crab/domains/abstract_domain_specialized_traits.hpp>
+#include <crab/domains/backward_assign_operations.hpp>
+#include <crab/domains/flat_interval_env.hpp>
+#include <crab/domains/i64_interval.hpp>
+#include <crab/domains/linear_interval_solver.hpp>
+#include <crab/domains/separate_domains.hpp>
+#include <crab/support/stats.hpp>
+
+#include <type_traits>
+
+namespace crab {
+namespace domains {
+
+// Env is the environment from variables to i64_interval. It can be
+// ikos::separate_domain or crab::domains::flat_interval_env.
+template <typename Number, typename VariableName,
+          std::size_t max_reduction_cycles = 10,
+          typename Env = ikos::separate_domain<variable<Number, VariableName>,
+                                               i64_interval>>
+class i64_interval_domain final
+    : public abstract_domain_api<i64_interval_domain<
+          Number, VariableName, max_reduction_cycles, Env>> {
+public:
+  using i64_interval_domain_t =
+      i64_interval_domain<Number, VariableName, max_reduction_cycles, Env>;
+  using abstract_domain_t = abstract_domain_api<i64_interval_domain_t>;
+  using typename abstract_domain_t::disjunctive_linear_constraint_system_t;
+  using typename abstract_domain_t::interval_t;
+  using typename abstract_domain_t::linear_constraint_system_t;
+  using typename abstract_domain_t::linear_constraint_t;
+  using typename abstract_domain_t::linear_expression_t;
+  using typename abstract_domain_t::reference_constraint_t;
+  using typename abstract_domain_t::variable_or_constant_t;
+  using typename abstract_domain_t::variable_t;
+  using typename abstract_domain_t::variable_vector_t;
+  using typename abstract_domain_t::variable_or_constant_vector_t;
+  using number_t = Number;
+  using varname_t = VariableName;
+
+  static_assert(std::is_same<Number, ikos::z_number>::value,
+                "i64_interval_domain only supports z_number");
+
+  static_assert(std::is_same<typename Env::key_type, variable_t>::value,
+                "Env must map variables to i64_interval");
+
+private:
+  using separate_domain_t = Env;
+  using solver_t =
+      ikos::linear_interval_solver<number_t, varname_t, separate_domain_t>;
+
+public:
+  using iterator = typename separate_domain_t::iterator;
+
+private:
+  separate_domain_t _env;
+
+  i64_interval_domain(separate_domain_t env) : _env(env) {}
+
+  i64_interval eval(const linear_expression_t &expr) const {
+    i64_interval r(expr.constant());
+    for (auto const &kv : expr) {
+      r += i64_interval(kv.first) * this->_env.at(kv.second);
+    }
+    return r;
+  }
+
+  void add(const linear_constraint_system_t &csts,
+           std::size_t threshold = max_reduction_cycles) {
+    if (!this->is_bottom()) {
+      linear_constraint_system_t pp_csts;
+      for (auto const &c : csts) {
+        if (c.is_disequation()) {
+          // We try to convert a disequation into a strict inequality
+          constraint_simp_domain_traits<i64_interval_domain_t>::
+              lower_disequality(*this, c, pp_csts);
+        }
+        pp_csts += c;
+      }
+      solver_t solver(pp_csts, threshold);
+      solver.run(this->_env);
+    }
+  }
+
+  static i64_interval eval(arith_operation_t op, const i64_interval &yi,
+                           const i64_interval &zi) {
+    switch (op) {
+    case OP_ADDITION:
+      return yi + zi;
+    case OP_SUBTRACTION:
+      return yi - zi;
+    case OP_MULTIPLICATION:
+      return yi * zi;
+    case OP_SDIV:
+      return yi / zi;
+    case OP_UDIV:
+      return yi.UDiv(zi);
+    case OP_SREM:
+      return yi.SRem(zi);
+    default:
+      // case OP_UREM:
+      return yi.URem(zi);
+    }
+  }
+
+  static i64_interval eval(bitwise_operation_t op, const i64_interval &yi,
+                           const i64_interval &zi) {
+    switch (op) {
+    case OP_AND:
+      return yi.And(zi);
+    case OP_OR:
+      return yi.Or(zi);
+    case OP_XOR:
+      return yi.Xor(zi);
+    case OP_SHL:
+      return yi.Shl(zi);
+    case OP_LSHR:
+      return yi.LShr(zi);
+    default:
+      // case OP_ASHR:
+      return yi.AShr(zi);
+    }
+  }
+
+public:
+  i64_interval_domain_t make_top() const override {
+    return i64_interval_domain_t(separate_domain_t::top());
+  }
+
+  i64_interval_domain_t make_bottom() const override {
+    return i64_interval_domain_t(separate_domain_t::bottom());
+  }
+
+  void set_to_top() override {
+    i64_interval_domain abs(separate_domain_t::top());
+    std::swap(*this, abs);
+  }
+
+  void set_to_bottom() override {
+    i64_interval_domain abs(separate_domain_t::bottom());
+    std::swap(*this, abs);
+  }
+
+  i64_interval_domain() : _env(separate_domain_t::top()) {}
+
+  i64_interval_domain(const i64_interval_domain_t &e) : _env(e._env) {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
+  }
+
+  i64_interval_domain_t &operator=(const i64_interval_domain_t &o) {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
+    if (this != &o)
+      this->_env = o._env;
+    return *this;
+  }
+
+  iterator begin() { return this->_env.begin(); }
+
+  iterator end() { return this->_env.end(); }
+
+  bool is_bottom() const override { return this->_env.is_bottom(); }
+
+  bool is_top() const override { return this->_env.is_top(); }
+
+  bool operator<=(const i64_interval_domain_t &e) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.leq"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".leq"));
+    return (this->_env <= e._env);
+  }
+
+  void operator|=(const i64_interval_domain_t &e) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.join"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".join"));
+    this->_env = this->_env | e._env;
+  }
+
+  i64_interval_domain_t
+  operator|(const i64_interval_domain_t &e) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.join"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".join"));
+    return (this->_env | e._env);
+  }
+
+  void operator&=(const i64_interval_domain_t &e) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.meet"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".meet"));
+    this->_env = this->_env & e._env;
+  }
+
+  i64_interval_domain_t
+  operator&(const i64_interval_domain_t &e) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.meet"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".meet"));
+    return (this->_env & e._env);
+  }
+
+  i64_interval_domain_t
+  operator||(const i64_interval_domain_t &e) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.widening"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".widening"));
+    return (this->_env || e._env);
+  }
+
+  i64_interval_domain_t
+  widening_thresholds(const i64_interval_domain_t &e,
+                      const crab::thresholds<number_t> &ts) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.widening"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".widening"));
+    return this->_env.widening_thresholds(e._env, ts);
+  }
+
+  i64_interval_domain_t
+  operator&&(const i64_interval_domain_t &e) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.narrowing"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".narrowing"));
+    return (this->_env && e._env);
+  }
+
+  void set(const variable_t &v, interval_t i) {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
+    this->_env.set(v, i64_interval(i));
+  }
+
+  void set(const variable_t &v, number_t n) {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
+    this->_env.set(v, i64_interval(n));
+  }
+
+  void operator-=(const variable_t &v) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.forget"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".forget"));
+    this->_env -= v;
+  }
+
+  interval_t operator[](const variable_t &v) override { return at(v); }
+
+  interval_t at(const variable_t &v) const override {
+    return this->_env.at(v).to_interval();
+  }
+
+  void operator+=(const linear_constraint_system_t &csts) override {
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.add_constraints"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".add_constraints"));
+    this->add(csts);
+  }
+
+  virtual bool entails(const linear_constraint_t &cst) const override {
+    if (is_bottom()) {
+      return true;
+    }
+    if (cst.is_tautology()) {
+      return true;
+    }
+    if (cst.is_contradiction()) {
+      return false;
+    }
+
+    // val is modified after the check
+    auto entailmentFn = [](i64_interval_domain_t &val,
+                           const linear_constraint_t &c) -> bool {
+      linear_constraint_t neg_c = c.negate();
+      val += neg_c;
+      return val.is_bottom();
+    };
+
+    // Get only relevant state wrt cst variables
+    i64_interval_domain_t val;
+    for (auto const &v : cst.variables()) {
+      val._env.set(v, this->_env.at(v));
+    }
+
+    if (cst.is_equality()) {
+      linear_constraint_t pob1(cst.expression(),
+                               linear_constraint_t::INEQUALITY);
+      i64_interval_domain_t tmp(val);
+      if (!entailmentFn(tmp, pob1)) {
+        return false;
+      }
+      linear_constraint_t pob2(cst.expression() * number_t(-1),
+                               linear_constraint_t::INEQUALITY);
+      return entailmentFn(val, pob2);
+    } else {
+      return entailmentFn(val, cst);
+    }
+  }
+
+  void assign(const variable_t &x, const linear_expression_t &e) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
+
+    if (boost::optional<variable_t> v = e.get_variable()) {
+      this->_env.set(x, this->_env.at(*v));
+    } else {
+      this->_env.set(x, eval(e));
+    }
+  }
+
+  void weak_assign(const variable_t &x, const linear_expression_t &e) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.weak_assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".weak_assign"));
+
+    if (boost::optional<variable_t> v = e.get_variable()) {
+      this->_env.join(x, this->_env.at(*v));
+    } else {
+      this->_env.join(x, eval(e));
+    }
+  }
+
+  void apply(arith_operation_t op, const variable_t &x, const variable_t &y,
+             const variable_t &z) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
+    this->_env.set(x, eval(op, this->_env.at(y), this->_env.at(z)));
+  }
+
+  void apply(arith_operation_t op, const variable_t &x, const variable_t &y,
+             number_t k) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
+    this->_env.set(x, eval(op, this->_env.at(y), i64_interval(k)));
+  }
+
+  // intrinsics operations
+  void intrinsic(std::string name, const variable_or_constant_vector_t &inputs,
+                 const variable_vector_t &outputs) override {
+    CRAB_WARN("Intrinsics ", name, " not implemented by ", domain_name());
+  }
+
+  void backward_intrinsic(std::string name,
+                          const variable_or_constant_vector_t &inputs,
+                          const variable_vector_t &outputs,
+                          const i64_interval_domain_t &invariant) override {
+    CRAB_WARN("Intrinsics ", name, " not implemented by ", domain_name());
+  }
+
+  // backward arithmetic operations
+  void backward_assign(const variable_t &x, const linear_expression_t &e,
+                       const i64_interval_domain_t &inv) override {
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_assign"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_assign"));
+
+    BackwardAssignOps<i64_interval_domain_t>::assign(*this, x, e, inv);
+  }
+
+  void backward_apply(arith_operation_t op, const variable_t &x,
+                      const variable_t &y, number_t z,
+                      const i64_interval_domain_t &inv) override {
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_apply"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_apply"));
+
+    BackwardAssignOps<i64_interval_domain_t>::apply(*this, op, x, y, z, inv);
+  }
+
+  void backward_apply(arith_operation_t op, const variable_t &x,
+                      const variable_t &y, const variable_t &z,
+                      const i64_interval_domain_t &inv) override {
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_apply"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_apply"));
+
+    BackwardAssignOps<i64_interval_domain_t>::apply(*this, op, x, y, z, inv);
+  }
+
+  // cast operations
+  void apply(int_conv_operation_t op, const variable_t &dst,
+             const variable_t &src) override {
+    int_cast_domain_traits<i64_interval_domain_t>::apply(*this, op, dst, src);
+  }
+
+  // bitwise operations
+  void apply(bitwise_operation_t op, const variable_t &x, const variable_t &y,
+             const variable_t &z) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
+    this->_env.set(x, eval(op, this->_env.at(y), this->_env.at(z)));
+  }
+
+  void apply(bitwise_operation_t op, const variable_t &x, const variable_t &y,
+             number_t k) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
+    this->_env.set(x, eval(op, this->_env.at(y), i64_interval(k)));
+  }
+
+  virtual void select(const variable_t &lhs, const linear_constraint_t &cond,
+                      const linear_expression_t &e1,
+                      const linear_expression_t &e2) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.select"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".select"));
+
+    if (!is_bottom()) {
+      i64_interval_domain_t inv1(*this);
+      inv1 += cond;
+      if (inv1.is_bottom()) {
+        assign(lhs, e2);
+        return;
+      }
+
+      i64_interval_domain_t inv2(*this);
+      inv2 += cond.negate();
+      if (inv2.is_bottom()) {
+        assign(lhs, e1);
+        return;
+      }
+
+      this->_env.set(lhs, eval(e1) | eval(e2));
+    }
+  }
+
+  /// i64_interval_domain implements only standard abstract operations
+  /// of a numerical domain so it is intended to be used as a leaf
+  /// domain in the hierarchy of domains.
+  BOOL_OPERATIONS_NOT_IMPLEMENTED(i64_interval_domain_t)
+  ARRAY_OPERATIONS_NOT_IMPLEMENTED(i64_interval_domain_t)
+  REGION_AND_REFERENCE_OPERATIONS_NOT_IMPLEMENTED(i64_interval_domain_t)
+
+  void forget(const variable_vector_t &variables) override {
+    if (is_bottom() || is_top()) {
+      return;
+    }
+    for (auto const &var : variables) {
+      this->operator-=(var);
+    }
+  }
+
+  void project(const variable_vector_t &variables) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.project"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".project"));
+
+    _env.project(variables);
+  }
+
+  void rename(const variable_vector_t &from,
+              const variable_vector_t &to) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.rename"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".rename"));
+
+    _env.rename(from, to);
+  }
+
+  void expand(const variable_t &x, const variable_t &new_x) override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.expand"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".expand"));
+
+    if (is_bottom() || is_top()) {
+      return;
+    }
+
+    this->_env.set(new_x, this->_env.at(x));
+  }
+
+  void normalize() override {}
+
+  void minimize() override {}
+
+  void write(crab::crab_os &o) const override {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.write"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".write"));
+
+    this->_env.write(o);
+  }
+
+  linear_constraint_system_t to_linear_constraint_system() const override {
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.to_linear_constraint_system"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".to_linear_constraint_system"));
+
+    linear_constraint_system_t csts;
+
+    if (this->is_bottom()) {
+      csts += linear_constraint_t::get_false();
+      return csts;
+    }
+
+    for (iterator it = this->_env.begin(); it != this->_env.end(); ++it) {
+      // copies: the iterator of flat_interval_env returns temporaries
+      variable_t v = it->first;
+      i64_interval i = it->second;
+      if (i.lb_is_finite())
+        csts += linear_constraint_t(v >= number_t(i.lb()));
+      if (i.ub_is_finite())
+        csts += linear_constraint_t(v <= number_t(i.ub()));
+    }
+    return csts;
+  }
+
+  disjunctive_linear_constraint_system_t
+  to_disjunctive_linear_constraint_system() const override {
+    auto lin_csts = to_linear_constraint_system();
+    if (lin_csts.is_false()) {
+      return disjunctive_linear_constraint_system_t(true /*is_false*/);
+    } else if (lin_csts.is_true()) {
+      return disjunctive_linear_constraint_system_t(false /*is_false*/);
+    } else {
+      return disjunctive_linear_constraint_system_t(lin_csts);
+    }
+  }
+
+  std::string domain_name() const override {
+    return std::is_same<Env, flat_interval_env<variable_t>>::value
+               ? "FlatInt64Intervals"
+               : "Int64Intervals";
+  }
+
+}; // class i64_interval_domain
+
+template <typename Number, typename VariableName,
+          std::size_t max_reduction_cycles, typename Env>
+struct abstract_domain_traits<
+    i64_interval_domain<Number, VariableName, max_reduction_cycles, Env>> {
+  using number_t = Number;
+  using varname_t = VariableName;
+};
+
+} // namespace domains
+} // namespace crab
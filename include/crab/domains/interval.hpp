@@ -275,6 +275,26 @@ inline interval<Number> operator-(const interval<Number> &x, Number c) {
   return x - interval<Number>(c);
 }
 
+/** for boost::hash_combine (e.g., hash-consed environments) **/
+template <typename Number>
+inline std::size_t hash_value(const bound<Number> &b) {
+  std::size_t seed = 0;
+  if (boost::optional<Number> n = b.number()) {
+    boost::hash_combine(seed, *n);
+  } else {
+    boost::hash_combine(seed, b.is_plus_infinity() ? 1 : -1);
+  }
+  return seed;
+}
+
+template <typename Number>
+inline std::size_t hash_value(const interval<Number> &i) {
+  std::size_t seed = 0;
+  boost::hash_combine(seed, i.lb());
+  boost::hash_combine(seed, i.ub());
+  return seed;
+}
+
 namespace bounds_impl {
 void convert_bounds(bound<z_number> b1, bound<z_number> &b2);
 void convert_bounds(bound<q_number> b1, bound<q_number> &b2);
@@ -53,14 +53,19 @@
 
 namespace ikos {
 
+// Env is the environment from variables to intervals. It can be
+// replaced with a hash-consed separate_domain (see
+// hc_interval_domain below).
 template <typename Number, typename VariableName,
-          std::size_t max_reduction_cycles = 10>
+          std::size_t max_reduction_cycles = 10,
+          typename Env = separate_domain<crab::variable<Number, VariableName>,
+                                         interval<Number>>>
 class interval_domain final
     : public crab::domains::abstract_domain_api<
-          interval_domain<Number, VariableName, max_reduction_cycles>> {
+          interval_domain<Number, VariableName, max_reduction_cycles, Env>> {
 public:
   using interval_domain_t =
-      interval_domain<Number, VariableName, max_reduction_cycles>;
+      interval_domain<Number, VariableName, max_reduction_cycles, Env>;
   using abstract_domain_t =
       crab::domains::abstract_domain_api<interval_domain_t>;
   using typename abstract_domain_t::disjunctive_linear_constraint_system_t;
@@ -77,7 +82,7 @@ public:
   using varname_t = VariableName;
 
 private:
-  using separate_domain_t = separate_domain<variable_t, interval_t>;
+  using separate_domain_t = Env;
   using solver_t =
       linear_interval_solver<number_t, varname_t, separate_domain_t>;
 
@@ -143,13 +148,13 @@ public:
   interval_domain() : _env(separate_domain_t::top()) {}
 
   interval_domain(const interval_domain_t &e) : _env(e._env) {
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
   }
 
   interval_domain_t &operator=(const interval_domain_t &o) {
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
     if (this != &o)
       this->_env = o._env;
     return *this;
@@ -164,70 +169,70 @@ public:
   bool is_top() const override { return this->_env.is_top(); }
 
   bool operator<=(const interval_domain_t &e) const override {
-    crab::CrabStats::count(domain_name() + ".count.leq");
-    crab::ScopedCrabStats __st__(domain_name() + ".leq");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.leq"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".leq"));
     return (this->_env <= e._env);
   }
 
   void operator|=(const interval_domain_t &e) override {
-    crab::CrabStats::count(domain_name() + ".count.join");
-    crab::ScopedCrabStats __st__(domain_name() + ".join");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.join"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".join"));
     this->_env = this->_env | e._env;
   }
 
   interval_domain_t operator|(const interval_domain_t &e) const override {
-    crab::CrabStats::count(domain_name() + ".count.join");
-    crab::ScopedCrabStats __st__(domain_name() + ".join");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.join"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".join"));
     return (this->_env | e._env);
   }
 
   void operator&=(const interval_domain_t &e) override {
-    crab::CrabStats::count(domain_name() + ".count.meet");
-    crab::ScopedCrabStats __st__(domain_name() + ".meet");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.meet"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".meet"));
     this->_env = this->_env & e._env;
   }
   
   interval_domain_t operator&(const interval_domain_t &e) const override {
-    crab::CrabStats::count(domain_name() + ".count.meet");
-    crab::ScopedCrabStats __st__(domain_name() + ".meet");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.meet"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".meet"));
     return (this->_env & e._env);
   }
 
   interval_domain_t operator||(const interval_domain_t &e) const override {
-    crab::CrabStats::count(domain_name() + ".count.widening");
-    crab::ScopedCrabStats __st__(domain_name() + ".widening");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.widening"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".widening"));
     return (this->_env || e._env);
   }
 
   interval_domain_t widening_thresholds(
       const interval_domain_t &e,
       const crab::thresholds<number_t> &ts) const override {
-    crab::CrabStats::count(domain_name() + ".count.widening");
-    crab::ScopedCrabStats __st__(domain_name() + ".widening");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.widening"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".widening"));
     return this->_env.widening_thresholds(e._env, ts);
   }
 
   interval_domain_t operator&&(const interval_domain_t &e) const override {
-    crab::CrabStats::count(domain_name() + ".count.narrowing");
-    crab::ScopedCrabStats __st__(domain_name() + ".narrowing");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.narrowing"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".narrowing"));
     return (this->_env && e._env);
   }
 
   void set(const variable_t &v, interval_t i) {
-    crab::CrabStats::count(domain_name() + ".count.assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".assign");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
     this->_env.set(v, i);
   }
 
   void set(const variable_t &v, number_t n) {
-    crab::CrabStats::count(domain_name() + ".count.assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".assign");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
     this->_env.set(v, interval_t(n));
   }
 
   void operator-=(const variable_t &v) override {
-    crab::CrabStats::count(domain_name() + ".count.forget");
-    crab::ScopedCrabStats __st__(domain_name() + ".forget");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.forget"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".forget"));
     this->_env -= v;
   }
 
@@ -238,8 +243,10 @@ public:
   }
 
   void operator+=(const linear_constraint_system_t &csts) override {
-    crab::CrabStats::count(domain_name() + ".count.add_constraints");
-    crab::ScopedCrabStats __st__(domain_name() + ".add_constraints");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.add_constraints"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".add_constraints"));
     this->add(csts);
   }
 
@@ -279,8 +286,8 @@ public:
   }
   
   void assign(const variable_t &x, const linear_expression_t &e) override {
-    crab::CrabStats::count(domain_name() + ".count.assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".assign");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
 
     if (boost::optional<variable_t> v = e.get_variable()) {
       this->_env.set(x, this->_env.at(*v));
@@ -294,8 +301,8 @@ public:
   }
 
   void weak_assign(const variable_t &x, const linear_expression_t &e) override {
-    crab::CrabStats::count(domain_name() + ".count.weak_assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".weak_assign");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.weak_assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".weak_assign"));
 
     if (boost::optional<variable_t> v = e.get_variable()) {
       this->_env.join(x, this->_env.at(*v));
@@ -311,8 +318,8 @@ public:
   
   void apply(crab::domains::arith_operation_t op, const variable_t &x,
              const variable_t &y, const variable_t &z) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     interval_t yi = this->_env.at(y);
     interval_t zi = this->_env.at(z);
@@ -347,8 +354,8 @@ public:
 
   void apply(crab::domains::arith_operation_t op, const variable_t &x,
              const variable_t &y, number_t k) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     interval_t yi = this->_env.at(y);
     interval_t zi(k);
@@ -398,8 +405,10 @@ public:
   // backward arithmetic operations
   void backward_assign(const variable_t &x, const linear_expression_t &e,
                        const interval_domain_t &inv) override {
-    crab::CrabStats::count(domain_name() + ".count.backward_assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".backward_assign");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_assign"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_assign"));
 
     crab::domains::BackwardAssignOps<interval_domain_t>::assign(*this, x, e,
                                                                 inv);
@@ -408,8 +417,10 @@ public:
   void backward_apply(crab::domains::arith_operation_t op, const variable_t &x,
                       const variable_t &y, number_t z,
                       const interval_domain_t &inv) override {
-    crab::CrabStats::count(domain_name() + ".count.backward_apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".backward_apply");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_apply"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_apply"));
 
     crab::domains::BackwardAssignOps<interval_domain_t>::apply(*this, op, x, y,
                                                                z, inv);
@@ -418,8 +429,10 @@ public:
   void backward_apply(crab::domains::arith_operation_t op, const variable_t &x,
                       const variable_t &y, const variable_t &z,
                       const interval_domain_t &inv) override {
-    crab::CrabStats::count(domain_name() + ".count.backward_apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".backward_apply");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_apply"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_apply"));
 
     crab::domains::BackwardAssignOps<interval_domain_t>::apply(*this, op, x, y,
                                                                z, inv);
@@ -434,8 +447,8 @@ public:
   // bitwise operations
   void apply(crab::domains::bitwise_operation_t op, const variable_t &x,
              const variable_t &y, const variable_t &z) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     interval_t yi = this->_env.at(y);
     interval_t zi = this->_env.at(z);
@@ -472,8 +485,8 @@ public:
 
   void apply(crab::domains::bitwise_operation_t op, const variable_t &x,
              const variable_t &y, number_t k) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     interval_t yi = this->_env.at(y);
     interval_t zi(k);
@@ -509,8 +522,8 @@ public:
 
   virtual void select(const variable_t &lhs, const linear_constraint_t &cond,
 		      const linear_expression_t &e1,  const linear_expression_t &e2) override {
-    crab::CrabStats::count(domain_name() + ".count.select");
-    crab::ScopedCrabStats __st__(domain_name() + ".select");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.select"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".select"));
     
     if (!is_bottom()) {
       interval_domain_t inv1(*this);
@@ -549,23 +562,23 @@ public:
   }
 
   void project(const variable_vector_t &variables) override {
-    crab::CrabStats::count(domain_name() + ".count.project");
-    crab::ScopedCrabStats __st__(domain_name() + ".project");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.project"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".project"));
 
     _env.project(variables);
   }
 
   void rename(const variable_vector_t &from,
               const variable_vector_t &to) override {
-    crab::CrabStats::count(domain_name() + ".count.rename");
-    crab::ScopedCrabStats __st__(domain_name() + ".rename");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.rename"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".rename"));
 
     _env.rename(from, to);
   }
 
   void expand(const variable_t &x, const variable_t &new_x) override {
-    crab::CrabStats::count(domain_name() + ".count.expand");
-    crab::ScopedCrabStats __st__(domain_name() + ".expand");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.expand"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".expand"));
 
     if (is_bottom() || is_top()) {
       return;
@@ -579,17 +592,17 @@ public:
   void minimize() override {}
 
   void write(crab::crab_os &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.write");
-    crab::ScopedCrabStats __st__(domain_name() + ".write");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.write"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".write"));
 
     this->_env.write(o);
   }
 
   linear_constraint_system_t to_linear_constraint_system() const override {
-    crab::CrabStats::count(domain_name() +
-                           ".count.to_linear_constraint_system");
-    crab::ScopedCrabStats __st__(domain_name() +
-                                 ".to_linear_constraint_system");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.to_linear_constraint_system"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".to_linear_constraint_system"));
 
     linear_constraint_system_t csts;
 
@@ -626,13 +639,26 @@ public:
   std::string domain_name() const override { return "Intervals"; }
 
 }; // class interval_domain
+
+// Interval domain whose environment is hash-consed: equal environments
+// share the same tree so that equality, inclusion, join and meet on
+// them are resolved by pointer comparison.
+template <typename Number, typename VariableName,
+          std::size_t max_reduction_cycles = 10>
+using hc_interval_domain = interval_domain<
+    Number, VariableName, max_reduction_cycles,
+    separate_domain<crab::variable<Number, VariableName>, interval<Number>,
+                    std::equal_to<interval<Number>>,
+                    boost::hash<interval<Number>>>>;
 } // namespace ikos
 
 namespace crab {
 namespace domains {
 
-template <typename Number, typename VariableName>
-struct abstract_domain_traits<ikos::interval_domain<Number, VariableName>> {
+template <typename Number, typename VariableName,
+          std::size_t max_reduction_cycles, typename Env>
+struct abstract_domain_traits<
+    ikos::interval_domain<Number, VariableName, max_reduction_cycles, Env>> {
   using number_t = Number;
   using varname_t = VariableName;
 };
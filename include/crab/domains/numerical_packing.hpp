@@ -4,11 +4,93 @@
 #include <crab/domains/union_find_domain.hpp>
 #include <crab/support/debug.hpp>
 #include <crab/support/os.hpp>
+
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace crab {
 namespace domains {
 
+/*
+ * A fixed partition of variables into packs. Variables that do not
+ * appear in any pack are in their own singleton pack.
+ */
+template <class Variable> class variable_packs {
+  std::vector<std::vector<Variable>> m_packs;
+  std::unordered_map<Variable, unsigned> m_pack_of;
+
+public:
+  variable_packs() {}
+
+  // packs must be pairwise disjoint
+  explicit variable_packs(std::vector<std::vector<Variable>> packs)
+      : m_packs(std::move(packs)) {
+    for (unsigned i = 0, sz = m_packs.size(); i < sz; ++i) {
+      for (auto const &v : m_packs[i]) {
+        if (!m_pack_of.insert({v, i}).second) {
+          CRAB_ERROR("variable_packs: ", v, " is in more than one pack");
+        }
+      }
+    }
+  }
+
+  const std::vector<std::vector<Variable>> &packs() const { return m_packs; }
+
+  boost::optional<unsigned> pack_of(const Variable &v) const {
+    auto it = m_pack_of.find(v);
+    if (it != m_pack_of.end()) {
+      return it->second;
+    } else {
+      return boost::none;
+    }
+  }
+
+  // Return true if all the variables are in the same pack
+  bool in_same_pack(const std::vector<Variable> &vars) const {
+    if (vars.empty()) {
+      return true;
+    }
+    boost::optional<unsigned> p = pack_of(vars[0]);
+    for (unsigned i = 1, sz = vars.size(); i < sz; ++i) {
+      if (p) {
+        if (pack_of(vars[i]) != p) {
+          return false;
+        }
+      } else if (!(vars[i] == vars[0])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void write(crab_os &o) const {
+    o << "{";
+    for (unsigned i = 0, sz = m_packs.size(); i < sz; ++i) {
+      if (i > 0) {
+        o << ",";
+      }
+      o << "{";
+      for (unsigned j = 0, n = m_packs[i].size(); j < n; ++j) {
+        if (j > 0) {
+          o << ",";
+        }
+        o << m_packs[i][j];
+      }
+      o << "}";
+    }
+    o << "}";
+  }
+
+  friend crab_os &operator<<(crab_os &o, const variable_packs<Variable> &p) {
+    p.write(o);
+    return o;
+  }
+};
+
 /*
  * Variable packing domain for numerical domains.
  *
@@ -22,6 +104,13 @@ namespace domains {
  * operations. Note that we use intersection semantics in the
  * union-find because the concretization of the variable packing
  * domain is the intersection of the concretization of each pack.
+ *
+ * Optionally, the packs can be fixed in advance (e.g., by
+ * crab::analyzer::var_packing_analysis). Then, two variables are
+ * merged only if they belong to the same fixed pack so the size of
+ * the packs is bounded. An operation over variables from different
+ * fixed packs is executed on the meet of their packs and only the
+ * intervals of the modified variables are kept.
  */
 template <class NumDom>
 class numerical_packing_domain
@@ -64,7 +153,14 @@ private:
   using pack_vars_t = typename union_find_domain_t::equivalence_class_elems_t;
   /* end type definitions */
 
+public:
+  using variable_packs_t = variable_packs<variable_t>;
+
+private:
   union_find_domain_t m_packs;
+  // If not null then variables can only be merged if they are in the
+  // same pack.
+  std::shared_ptr<const variable_packs_t> m_fixed_packs;
 
   // return null if the merge causes bottom.
   std::shared_ptr<base_domain_t> merge(const variable_vector_t &vars) {
@@ -143,14 +239,102 @@ private:
     return absval;
   }
   
-  numerical_packing_domain(union_find_domain_t &&packs)
-      : m_packs(std::move(packs)) {}
+  // Return true if the variables can be modelled by the same pack
+  bool in_fixed_pack(const variable_vector_t &vars) const {
+    return !m_fixed_packs || m_fixed_packs->in_same_pack(vars);
+  }
+
+  // Meet the pack of x with the interval i
+  void refine(const variable_t &x, const interval_t &i) {
+    if (i.is_bottom()) {
+      set_to_bottom();
+      return;
+    }
+    linear_constraint_system_t csts;
+    if (boost::optional<number_t> lb = i.lb().number()) {
+      csts += linear_constraint_t(x >= *lb);
+    }
+    if (boost::optional<number_t> ub = i.ub().number()) {
+      csts += linear_constraint_t(x <= *ub);
+    }
+    if (csts.size() > 0) {
+      variable_vector_t vars{x};
+      std::shared_ptr<base_domain_t> absval = merge(vars);
+      *absval += csts;
+      if (absval->is_bottom()) {
+        set_to_bottom();
+      }
+    }
+  }
+
+  // Apply op on the meet of the packs of vars and copy back the
+  // intervals of the modified variables. If is_assign then the
+  // modified variables are first forgotten from their packs.
+  template <typename Op>
+  void apply_across_packs(const variable_vector_t &vars,
+                          const variable_vector_t &modified, bool is_assign,
+                          Op op) {
+    const this_type &self = *this;
+    base_domain_t absval = self.merge(vars);
+    op(absval);
+    if (absval.is_bottom()) {
+      set_to_bottom();
+      return;
+    }
+    std::vector<interval_t> intervals;
+    intervals.reserve(modified.size());
+    for (auto const &v : modified) {
+      intervals.push_back(absval.at(v));
+    }
+    for (unsigned i = 0, sz = modified.size(); i < sz && !is_bottom(); ++i) {
+      if (is_assign) {
+        operator-=(modified[i]);
+      }
+      refine(modified[i], intervals[i]);
+    }
+  }
+
+  // x := f(vars). Return false if x and vars are in the same fixed
+  // pack, otherwise op is applied across packs.
+  template <typename Op>
+  bool assign_across_packs(const variable_t &x, variable_vector_t vars,
+                           Op op) {
+    vars.push_back(x);
+    if (in_fixed_pack(vars)) {
+      return false;
+    }
+    apply_across_packs(vars, {x}, true, op);
+    return true;
+  }
+
+  // Return x with the fixed packs of y if x does not have them.
+  static this_type with_fixed_packs(this_type x, const this_type &y) {
+    if (!x.m_fixed_packs) {
+      x.m_fixed_packs = y.m_fixed_packs;
+    }
+    return x;
+  }
+
+  numerical_packing_domain(
+      union_find_domain_t &&packs,
+      std::shared_ptr<const variable_packs_t> fixed_packs = nullptr)
+      : m_packs(std::move(packs)), m_fixed_packs(fixed_packs) {}
+
+  std::shared_ptr<const variable_packs_t>
+  fixed_packs(const this_type &other) const {
+    return m_fixed_packs ? m_fixed_packs : other.m_fixed_packs;
+  }
 
 public:
   numerical_packing_domain(bool is_bottom = false)
       : m_packs(is_bottom ? union_find_domain_t::bottom()
                           : union_find_domain_t()) {}
 
+  // Top value whose packs are restricted to fixed_packs
+  explicit numerical_packing_domain(
+      std::shared_ptr<const variable_packs_t> fixed_packs)
+      : m_packs(union_find_domain_t()), m_fixed_packs(fixed_packs) {}
+
   numerical_packing_domain(const this_type &o) = default;
   numerical_packing_domain(this_type &&o) = default;
   this_type &operator=(const this_type &o) = default;
@@ -164,11 +348,13 @@ public:
 
   this_type make_bottom() const override {
     this_type res(true);
+    res.m_fixed_packs = m_fixed_packs;
     return res;
   }
 
   this_type make_top() const override {
     this_type res(false);
+    res.m_fixed_packs = m_fixed_packs;
     return res;
   }
 
@@ -198,21 +384,22 @@ public:
 
   void operator|=(const this_type &other) override {
     if (is_bottom() || other.is_top()) {
-      *this = other;
+      *this = with_fixed_packs(other, *this);
     } else if (other.is_bottom() || is_top()) {
       // do nothing
     } else {
       m_packs = m_packs | other.m_packs;
+      m_fixed_packs = fixed_packs(other);
     }
   }
 
   this_type operator|(const this_type &other) const override {
     if (is_bottom() || other.is_top()) {
-      return other;
+      return with_fixed_packs(other, *this);
     } else if (other.is_bottom() || is_top()) {
-      return *this;
+      return with_fixed_packs(*this, other);
     } else {
-      return this_type(m_packs | other.m_packs);
+      return this_type(m_packs | other.m_packs, fixed_packs(other));
     }
   }
 
@@ -220,29 +407,30 @@ public:
     if (is_bottom() || other.is_top()) {
       // do nothing
     } else if (other.is_bottom() || is_top()) {
-      *this = other;
+      *this = with_fixed_packs(other, *this);
     } else {
       m_packs = m_packs & other.m_packs;
+      m_fixed_packs = fixed_packs(other);
     }
   }
 
   this_type operator&(const this_type &other) const override {
     if (is_bottom() || other.is_top()) {
-      return *this;
+      return with_fixed_packs(*this, other);
     } else if (other.is_bottom() || is_top()) {
-      return other;
+      return with_fixed_packs(other, *this);
     } else {
-      return this_type(m_packs & other.m_packs);
+      return this_type(m_packs & other.m_packs, fixed_packs(other));
     }
   }
 
   this_type operator||(const this_type &other) const override {
     if (is_bottom() || other.is_top()) {
-      return other;
+      return with_fixed_packs(other, *this);
     } else if (other.is_bottom() || is_top()) {
-      return *this;
+      return with_fixed_packs(*this, other);
     } else {
-      return this_type(m_packs || other.m_packs);
+      return this_type(m_packs || other.m_packs, fixed_packs(other));
     }
   }
 
@@ -250,22 +438,22 @@ public:
   widening_thresholds(const this_type &other,
                       const thresholds<number_t> & /*ts*/) const override {
     if (is_bottom() || other.is_top()) {
-      return other;
+      return with_fixed_packs(other, *this);
     } else if (other.is_bottom() || is_top()) {
-      return *this;
+      return with_fixed_packs(*this, other);
     } else {
       // TODO: widening w/ thresholds
-      return this_type(m_packs || other.m_packs);
+      return this_type(m_packs || other.m_packs, fixed_packs(other));
     }
   }
 
   this_type operator&&(const this_type &other) const override {
     if (is_bottom() || other.is_top()) {
-      return *this;
+      return with_fixed_packs(*this, other);
     } else if (other.is_bottom() || is_top()) {
-      return other;
+      return with_fixed_packs(other, *this);
     } else {
-      return this_type(m_packs && other.m_packs);
+      return this_type(m_packs && other.m_packs, fixed_packs(other));
     }
   }
 
@@ -317,7 +505,13 @@ public:
           continue;
         }
         variable_vector_t vars(cst.variables().begin(), cst.variables().end());
-        if (!vars.empty()) {
+        if (!in_fixed_pack(vars)) {
+          apply_across_packs(vars, vars, false,
+                             [&cst](base_domain_t &dom) { dom += cst; });
+          if (is_bottom()) {
+            return;
+          }
+        } else if (!vars.empty()) {
           if (std::shared_ptr<base_domain_t> absval = merge(vars)) {
             *absval += cst;
             if (absval->is_bottom()) {
@@ -350,6 +544,11 @@ public:
     if (!is_bottom()) {
       std::shared_ptr<base_domain_t> absval = nullptr;
       variable_vector_t vars(e.variables().begin(), e.variables().end());      
+      if (assign_across_packs(x, vars, [&x, &e](base_domain_t &dom) {
+            dom.assign(x, e);
+          })) {
+        return;
+      }
       if (std::find(vars.begin(), vars.end(), x) == vars.end()) {
 	m_packs.forget(x);
 	vars.push_back(x);
@@ -368,6 +567,11 @@ public:
     if (!is_bottom()) {
       std::shared_ptr<base_domain_t> absval = nullptr;
       variable_vector_t vars(e.variables().begin(), e.variables().end());      
+      if (assign_across_packs(x, vars, [&x, &e](base_domain_t &dom) {
+            dom.weak_assign(x, e);
+          })) {
+        return;
+      }
       if (std::find(vars.begin(), vars.end(), x) == vars.end()) {
 	m_packs.forget(x);
 	vars.push_back(x);
@@ -385,6 +589,11 @@ public:
   void apply(arith_operation_t op, const variable_t &x, const variable_t &y,
              number_t z) override {
     if (!is_bottom()) {
+      if (assign_across_packs(x, {y}, [&](base_domain_t &dom) {
+            dom.apply(op, x, y, z);
+          })) {
+        return;
+      }
       if (std::shared_ptr<base_domain_t> absval = apply_packs(x, y)) {
 	absval->apply(op, x, y, z);
       } else {
@@ -396,6 +605,11 @@ public:
   void apply(arith_operation_t op, const variable_t &x, const variable_t &y,
              const variable_t &z) override {
     if (!is_bottom()) {
+      if (assign_across_packs(x, {y, z}, [&](base_domain_t &dom) {
+            dom.apply(op, x, y, z);
+          })) {
+        return;
+      }
       if (std::shared_ptr<base_domain_t> absval = apply_packs(x, y, z)) {
 	absval->apply(op, x, y, z);
       } else {
@@ -407,6 +621,11 @@ public:
   void apply(int_conv_operation_t op, const variable_t &dst,
              const variable_t &src) override {
     if (!is_bottom() && (src != dst)) {
+      if (assign_across_packs(dst, {src}, [&](base_domain_t &dom) {
+            dom.apply(op, dst, src);
+          })) {
+        return;
+      }
       m_packs.forget(dst);
       variable_vector_t vars{src, dst};
       if (std::shared_ptr<base_domain_t> absval = merge(vars)) {
@@ -420,6 +639,11 @@ public:
   void apply(bitwise_operation_t op, const variable_t &x, const variable_t &y,
              number_t k) override {
     if (!is_bottom()) {
+      if (assign_across_packs(x, {y}, [&](base_domain_t &dom) {
+            dom.apply(op, x, y, k);
+          })) {
+        return;
+      }
       if (std::shared_ptr<base_domain_t> absval = apply_packs(x, y)) {
         absval->apply(op, x, y, k);
       } else {
@@ -431,6 +655,11 @@ public:
   void apply(bitwise_operation_t op, const variable_t &x, const variable_t &y,
              const variable_t &z) override {
     if (!is_bottom()) {
+      if (assign_across_packs(x, {y, z}, [&](base_domain_t &dom) {
+            dom.apply(op, x, y, z);
+          })) {
+        return;
+      }
       if (std::shared_ptr<base_domain_t> absval = apply_packs(x, y, z)) {
         absval->apply(op, x, y, z);
       } else {
@@ -443,8 +672,6 @@ public:
               const linear_expression_t &e1,
               const linear_expression_t &e2) override {
     if (!is_bottom()) {
-      m_packs.forget(lhs);
-
       variable_vector_t vars;
       size_t num_vars =
           std::distance(cond.variables().begin(), cond.variables().end()) +
@@ -457,6 +684,14 @@ public:
       vars.insert(vars.end(), e1.variables_begin(), e1.variables_end());
       vars.insert(vars.end(), e2.variables_begin(), e2.variables_end());
 
+      if (!in_fixed_pack(vars)) {
+        apply_across_packs(vars, {lhs}, true, [&](base_domain_t &dom) {
+          dom.select(lhs, cond, e1, e2);
+        });
+        return;
+      }
+
+      m_packs.forget(lhs);
       if (std::shared_ptr<base_domain_t> absval = merge(vars)) {
         absval->select(lhs, cond, e1, e2);
       }
@@ -532,6 +767,11 @@ public:
 
   void expand(const variable_t &var, const variable_t &new_var) override {
     if (!is_bottom()) {
+      if (assign_across_packs(new_var, {var}, [&](base_domain_t &dom) {
+            dom.expand(var, new_var);
+          })) {
+        return;
+      }
       m_packs.forget(new_var);
       variable_vector_t vars{var, new_var};
       if (std::shared_ptr<base_domain_t> absval = merge(vars)) {
@@ -580,7 +820,9 @@ public:
         variable_t v = v_or_c.get_variable();
         vars.push_back(v);
       }
-      if (!vars.empty()) {
+      // with fixed packs, variables from different packs are never
+      // merged
+      if (!vars.empty() && in_fixed_pack(vars)) {
         merge(vars);
       }
     } else {
@@ -46,10 +46,15 @@
 #include <crab/types/indexable.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <boost/functional/hash.hpp>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/optional.hpp>
 #include <memory>
+#include <mutex>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace ikos {
@@ -93,14 +98,24 @@ public:
   virtual bool default_is_absorbing() = 0;    
 };
   
+// Default hash policy for patricia_tree: trees are not hash-consed.
+struct no_hash_consing {};
+
 namespace patricia_trees_impl {
-template <typename Key, typename Value, typename ValueEqual> class tree;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class tree;
 } // end namespace patricia_trees_impl
 
+// If ValueHash is different from no_hash_consing then ValueHash is a
+// hash function for Value and the tree is hash-consed: structurally
+// equal subtrees are shared so that merge and compare can
+// short-circuit on them by pointer equality. The nodes of hash-consed
+// trees are allocated from an arena shared by all threads.
 template <typename Key, typename Value,
-          typename ValueEqual = std::equal_to<Value>>
+          typename ValueEqual = std::equal_to<Value>,
+          typename ValueHash = no_hash_consing>
 class patricia_tree {
-  using tree_t = patricia_trees_impl::tree<Key, Value, ValueEqual>;
+  using tree_t = patricia_trees_impl::tree<Key, Value, ValueEqual, ValueHash>;
   using tree_ptr = typename tree_t::ptr;
 
 public:
@@ -108,7 +123,7 @@ public:
       std::is_base_of<crab::indexable, Key>::value,
       "Key must inherit from indexable to be used as a key in a patricia tree");
 
-  using patricia_tree_t = patricia_tree<Key, Value, ValueEqual>;
+  using patricia_tree_t = patricia_tree<Key, Value, ValueEqual, ValueHash>;
   using unary_op_t = typename tree_t::unary_op_t;
   using binary_op_t = typename tree_t::binary_op_t;
   using partial_order_t = typename tree_t::partial_order_t;
@@ -122,7 +137,7 @@ public:
       : public boost::iterator_facade<iterator, binding_t,
                                       boost::forward_traversal_tag, binding_t> {
     friend class boost::iterator_core_access;
-    friend class patricia_tree<Key, Value, ValueEqual>;
+    friend class patricia_tree<Key, Value, ValueEqual, ValueHash>;
 
     typename tree_t::iterator _it;
     
@@ -222,6 +237,12 @@ public:
     return tree_t::compare(this->_tree, t._tree, po, true);
   }
 
+  // True if both trees share the same root. If the trees are
+  // hash-consed then this is structural equality.
+  bool is_identical(const patricia_tree_t &t) const {
+    return this->_tree == t._tree;
+  }
+
 }; // class patricia_tree
 
 // An efficient implement of a set based on patricia trees.
@@ -448,11 +469,24 @@ inline bool match_prefix(index_t k, index_t p, index_t m) {
   return mask(k, m) == p;
 }
 
-template <typename Key, typename Value, typename ValueEqual> class tree {
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class node;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class leaf;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class unique_table;
+
+// A tree is either a node or a leaf. The kind of tree is stored in a
+// tag so that no virtual dispatch is needed. Trees are reference
+// counted and immutable.
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class tree {
 public:
-  using tree_t = tree<Key, Value, ValueEqual>;
-  using tree_ptr = std::shared_ptr<tree_t>;
+  using tree_t = tree<Key, Value, ValueEqual, ValueHash>;
+  using tree_ptr = boost::intrusive_ptr<tree_t>;
   using ptr = tree_ptr;
+  using node_t = node<Key, Value, ValueEqual, ValueHash>;
+  using leaf_t = leaf<Key, Value, ValueEqual, ValueHash>;
   using unary_op_t = unary_op<Value>;
   using binary_op_t = binary_op<Key, Value>;
   using partial_order_t = partial_order<Value>;
@@ -463,6 +497,54 @@ public:
         : first(first_), second(second_) {}
   };
 
+  // If true then structurally equal trees are pointer-equal.
+  static constexpr bool is_hash_consed =
+      !std::is_same<ValueHash, no_hash_consing>::value;
+
+private:
+  friend class unique_table<Key, Value, ValueEqual, ValueHash>;
+
+  mutable std::atomic<std::size_t> _ref_count;
+  bool _is_leaf;
+  std::size_t _size;
+  index_t _prefix;
+  index_t _branching_bit;
+
+  tree(const tree_t &) = delete;
+  tree_t &operator=(const tree_t &) = delete;
+
+  using hash_consed_t = std::integral_constant<bool, is_hash_consed>;
+
+  static void destroy(tree_t *t, std::true_type);
+  static void destroy(tree_t *t, std::false_type);
+  static tree_ptr new_node(index_t, index_t, const tree_ptr &,
+                           const tree_ptr &, std::true_type);
+  static tree_ptr new_node(index_t, index_t, const tree_ptr &,
+                           const tree_ptr &, std::false_type);
+  static tree_ptr new_leaf(const Key &, const Value &, std::true_type);
+  static tree_ptr new_leaf(const Key &, const Value &, std::false_type);
+
+  friend void intrusive_ptr_add_ref(const tree_t *t) {
+    t->_ref_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  friend void intrusive_ptr_release(const tree_t *t) {
+    if (t->_ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      destroy(const_cast<tree_t *>(t), hash_consed_t());
+    }
+  }
+
+protected:
+  tree(bool is_leaf, std::size_t size, index_t prefix, index_t branching_bit)
+      : _ref_count(0), _is_leaf(is_leaf), _size(size), _prefix(prefix),
+        _branching_bit(branching_bit) {}
+
+  ~tree() {}
+
+  const node_t &as_node() const { return *static_cast<const node_t *>(this); }
+  const leaf_t &as_leaf() const { return *static_cast<const leaf_t *>(this); }
+
+public:
   static tree_ptr make_node(index_t, index_t, tree_ptr, tree_ptr);
   static tree_ptr make_leaf(const Key &, const Value &);  
   static tree_ptr join(tree_ptr t0, tree_ptr t1);
@@ -472,20 +554,26 @@ public:
   static tree_ptr transform(tree_ptr, unary_op_t &);
   static tree_ptr remove(tree_ptr, const Key &);
   static bool compare(tree_ptr, tree_ptr, partial_order_t &, bool);
-  virtual boost::optional<Value> lookup(const Key &) const = 0;
-  virtual const Value *find(const Key &) const = 0;
-  
-  virtual std::size_t size() const = 0;
-  virtual bool is_leaf() const = 0;
-  virtual binding_t binding() const = 0;
-  virtual tree_ptr left_branch() const = 0;
-  virtual tree_ptr right_branch() const = 0;
-  virtual index_t prefix() const = 0;
-  virtual index_t branching_bit() const = 0;
-  
-  bool is_node() const { return !is_leaf(); }
 
-  virtual ~tree() {}
+  boost::optional<Value> lookup(const Key &key) const {
+    const Value *v = find(key);
+    if (v) {
+      return boost::optional<Value>(*v);
+    } else {
+      return boost::optional<Value>();
+    }
+  }
+
+  const Value *find(const Key &key) const;
+
+  std::size_t size() const { return _size; }
+  bool is_leaf() const { return _is_leaf; }
+  bool is_node() const { return !_is_leaf; }
+  index_t prefix() const { return _prefix; }
+  index_t branching_bit() const { return _branching_bit; }
+  binding_t binding() const;
+  const tree_ptr &left_branch() const;
+  const tree_ptr &right_branch() const;
 
   class iterator
     : public boost::iterator_facade<iterator, binding_t,
@@ -576,154 +664,315 @@ public:
   }; // class iterator
 }; // class tree
 
-template <typename Key, typename Value, typename ValueEqual>
-class node : public tree<Key, Value, ValueEqual> {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
-  using binding_t = typename tree<Key, Value, ValueEqual>::binding_t;
-  using node_t = node<Key, Value, ValueEqual>;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class node : public tree<Key, Value, ValueEqual, ValueHash> {
+  using tree_t = tree<Key, Value, ValueEqual, ValueHash>;
+  using tree_ptr = typename tree_t::ptr;
+  friend tree_t;
+  friend class unique_table<Key, Value, ValueEqual, ValueHash>;
 
-  std::size_t _size;
-  index_t _prefix;
-  index_t _branching_bit;
   tree_ptr _left_branch;
   tree_ptr _right_branch;
 
-  node();
-  node(const node_t &);
-  node_t &operator=(const node_t &);
-
 public:
+  // pre: left_branch_ and right_branch_ are not empty
   node(index_t prefix_, index_t branching_bit_, tree_ptr left_branch_,
        tree_ptr right_branch_)
-      : _prefix(prefix_), _branching_bit(branching_bit_),
-        _left_branch(left_branch_), _right_branch(right_branch_) {
-    this->_size = 0;
-    if (left_branch_) {
-      this->_size += left_branch_->size();
+      : tree_t(false, left_branch_->size() + right_branch_->size(), prefix_,
+               branching_bit_),
+        _left_branch(std::move(left_branch_)),
+        _right_branch(std::move(right_branch_)) {}
+}; // class node
+
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class leaf : public tree<Key, Value, ValueEqual, ValueHash> {
+  using tree_t = tree<Key, Value, ValueEqual, ValueHash>;
+  friend tree_t;
+  friend class unique_table<Key, Value, ValueEqual, ValueHash>;
+
+  Key _key;
+  Value _value;
+
+public:
+  leaf(const Key &key_, const Value &value_)
+      : tree_t(true, 1, key_.index(), 0), _key(key_), _value(value_) {}
+}; // class leaf
+
+// Unique table used to hash-cons the trees of one type. There is a
+// single table per type of tree, shared by all threads and protected
+// by a mutex, so hash-consed trees can be passed between threads. The
+// nodes are allocated from the table's arena.
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+class unique_table {
+  using tree_t = tree<Key, Value, ValueEqual, ValueHash>;
+  using tree_ptr = typename tree_t::ptr;
+  using node_t = typename tree_t::node_t;
+  using leaf_t = typename tree_t::leaf_t;
+
+  // Arena of fixed-size blocks. Blocks are never returned to the
+  // system.
+  class arena {
+    static constexpr std::size_t blocks_per_chunk = 512;
+    union block {
+      block *next;
+      typename std::aligned_storage<
+          (sizeof(node_t) > sizeof(leaf_t) ? sizeof(node_t) : sizeof(leaf_t)),
+          (alignof(node_t) > alignof(leaf_t) ? alignof(node_t)
+                                             : alignof(leaf_t))>::type storage;
+    };
+    std::vector<std::unique_ptr<block[]>> _chunks;
+    block *_free;
+
+  public:
+    arena() : _free(nullptr) {}
+
+    void *allocate() {
+      if (!_free) {
+        _chunks.emplace_back(new block[blocks_per_chunk]);
+        block *chunk = _chunks.back().get();
+        for (std::size_t i = 0; i < blocks_per_chunk; ++i) {
+          chunk[i].next = _free;
+          _free = &chunk[i];
+        }
+      }
+      block *b = _free;
+      _free = b->next;
+      return b;
     }
-    if (right_branch_) {
-      this->_size += right_branch_->size();
+
+    void deallocate(void *p) {
+      block *b = static_cast<block *>(p);
+      b->next = _free;
+      _free = b;
     }
-  }
+  };
+
+  std::unordered_multimap<std::size_t, tree_t *> _table;
+  arena _arena;
+  std::mutex _mutex;
 
-  virtual std::size_t size() const override { return this->_size; }
+  unique_table() {}
 
-  virtual index_t prefix() const override { return this->_prefix; }
+  static std::size_t hash_node(index_t prefix, index_t branching_bit,
+                               const tree_t *left, const tree_t *right) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, prefix);
+    boost::hash_combine(seed, branching_bit);
+    boost::hash_combine(seed, left);
+    boost::hash_combine(seed, right);
+    return seed;
+  }
 
-  virtual index_t branching_bit() const override {
-    return this->_branching_bit;
+  static std::size_t hash_leaf(const Key &key, const Value &value) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, key.index());
+    boost::hash_combine(seed, ValueHash()(value));
+    return seed;
   }
 
-  virtual bool is_leaf() const override { return false; }
+  static std::size_t hash(const tree_t *t) {
+    if (t->is_leaf()) {
+      return hash_leaf(t->as_leaf()._key, t->as_leaf()._value);
+    } else {
+      return hash_node(t->_prefix, t->_branching_bit,
+                       t->as_node()._left_branch.get(),
+                       t->as_node()._right_branch.get());
+    }
+  }
 
-  virtual binding_t binding() const override {
-    CRAB_ERROR("Patricia tree: trying to call binding() on a node");
+  // Increment the reference count of t unless it is zero. A tree
+  // whose count dropped to zero is about to be destroyed by some
+  // thread so it cannot be returned anymore.
+  static bool try_add_ref(tree_t *t) {
+    std::size_t n = t->_ref_count.load(std::memory_order_relaxed);
+    while (n != 0) {
+      if (t->_ref_count.compare_exchange_weak(n, n + 1,
+                                              std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
   }
 
-  virtual tree_ptr left_branch() const override { return this->_left_branch; }
+  // pre: the caller holds _mutex
+  tree_ptr insert(std::size_t h, tree_t *t) {
+    _table.insert({h, t});
+    return tree_ptr(t);
+  }
 
-  virtual tree_ptr right_branch() const override { return this->_right_branch; }
+public:
+  // The table is never deleted so that trees owned by static objects
+  // can still be released at program exit.
+  static unique_table &get() {
+    static unique_table *table = new unique_table();
+    return *table;
+  }
 
-  virtual boost::optional<Value> lookup(const Key &key) const override {
-    if (key.index() <= this->_prefix) {
-      if (this->_left_branch) {
-        return this->_left_branch->lookup(key);
-      } else {
-        return boost::optional<Value>();
+  tree_ptr make_node(index_t prefix, index_t branching_bit,
+                     const tree_ptr &left, const tree_ptr &right) {
+    std::size_t h = hash_node(prefix, branching_bit, left.get(), right.get());
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto range = _table.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+      tree_t *t = it->second;
+      if (t->is_node() && t->_prefix == prefix &&
+          t->_branching_bit == branching_bit &&
+          t->as_node()._left_branch == left &&
+          t->as_node()._right_branch == right && try_add_ref(t)) {
+        return tree_ptr(t, false);
       }
-    } else {
-      if (this->_right_branch) {
-        return this->_right_branch->lookup(key);
-      } else {
-        return boost::optional<Value>();
+    }
+    return insert(h, new (_arena.allocate())
+                         node_t(prefix, branching_bit, left, right));
+  }
+
+  tree_ptr make_leaf(const Key &key, const Value &value) {
+    std::size_t h = hash_leaf(key, value);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto range = _table.equal_range(h);
+    ValueEqual eq;
+    for (auto it = range.first; it != range.second; ++it) {
+      tree_t *t = it->second;
+      if (t->is_leaf() && t->_prefix == key.index() &&
+          eq(t->as_leaf()._value, value) && try_add_ref(t)) {
+        return tree_ptr(t, false);
       }
     }
+    return insert(h, new (_arena.allocate()) leaf_t(key, value));
   }
 
-  virtual const Value *find(const Key &key) const override {
-    if (key.index() <= this->_prefix) {
-      if (this->_left_branch) {
-        return this->_left_branch->find(key);
-      } else {
-        return nullptr;
+  // pre: t is not referenced anymore
+  void destroy(tree_t *t) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto range = _table.equal_range(hash(t));
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == t) {
+          _table.erase(it);
+          break;
+        }
       }
+    }
+    // The destructor releases the branches of a node, which might
+    // destroy them too, so the mutex is not held here.
+    if (t->is_leaf()) {
+      static_cast<leaf_t *>(t)->~leaf_t();
     } else {
-      if (this->_right_branch) {
-        return this->_right_branch->find(key);
-      } else {
-        return nullptr;
-      }
+      static_cast<node_t *>(t)->~node_t();
     }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _arena.deallocate(t);
   }
+}; // class unique_table
 
-}; // class node
-
-template <typename Key, typename Value, typename ValueEqual>
-class leaf : public tree<Key, Value, ValueEqual> {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
-  using binding_t = typename tree<Key, Value, ValueEqual>::binding_t;
-  using leaf_t = leaf<Key, Value, ValueEqual>;
-
-  Key _key;
-  Value _value;
-
-  leaf();
-  leaf(const leaf_t &);
-  leaf_t &operator=(const leaf_t &);
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+void tree<Key, Value, ValueEqual, ValueHash>::destroy(tree_t *t,
+                                                     std::true_type) {
+  unique_table<Key, Value, ValueEqual, ValueHash>::get().destroy(t);
+}
 
-public:
-  leaf(const Key &key_, const Value &value_) : _key(key_), _value(value_) {}
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+void tree<Key, Value, ValueEqual, ValueHash>::destroy(tree_t *t,
+                                                     std::false_type) {
+  if (t->is_leaf()) {
+    delete static_cast<leaf_t *>(t);
+  } else {
+    delete static_cast<node_t *>(t);
+  }
+}
 
-  virtual std::size_t size() const override { return 1; }
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::new_node(index_t prefix,
+                                                  index_t branching_bit,
+                                                  const tree_ptr &left_branch,
+                                                  const tree_ptr &right_branch,
+                                                  std::true_type) {
+  return unique_table<Key, Value, ValueEqual, ValueHash>::get().make_node(
+      prefix, branching_bit, left_branch, right_branch);
+}
 
-  virtual index_t prefix() const override { return this->_key.index(); }
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::new_node(index_t prefix,
+                                                  index_t branching_bit,
+                                                  const tree_ptr &left_branch,
+                                                  const tree_ptr &right_branch,
+                                                  std::false_type) {
+  return tree_ptr(new node_t(prefix, branching_bit, left_branch, right_branch));
+}
 
-  virtual index_t branching_bit() const override { return 0; }
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::new_leaf(const Key &key,
+                                                  const Value &value,
+                                                  std::true_type) {
+  return unique_table<Key, Value, ValueEqual, ValueHash>::get().make_leaf(
+      key, value);
+}
 
-  virtual bool is_leaf() const override { return true; }
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::new_leaf(const Key &key,
+                                                  const Value &value,
+                                                  std::false_type) {
+  return tree_ptr(new leaf_t(key, value));
+}
 
-  virtual binding_t binding() const override {
-    return binding_t(this->_key, this->_value);
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+const Value *
+tree<Key, Value, ValueEqual, ValueHash>::find(const Key &key) const {
+  const tree_t *t = this;
+  while (t->is_node()) {
+    const node_t &n = t->as_node();
+    t = (key.index() <= t->_prefix ? n._left_branch : n._right_branch).get();
   }
-
-  virtual tree_ptr left_branch() const override {
-    CRAB_ERROR("Patricia tree: trying to call left_branch() on a leaf");
+  if (t->_prefix == key.index()) {
+    return &(t->as_leaf()._value);
+  } else {
+    return nullptr;
   }
+}
 
-  virtual tree_ptr right_branch() const override {
-    CRAB_ERROR("Patricia tree: trying to call right_branch() on a leaf");
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::binding_t
+tree<Key, Value, ValueEqual, ValueHash>::binding() const {
+  if (is_node()) {
+    CRAB_ERROR("Patricia tree: trying to call binding() on a node");
   }
+  return binding_t(as_leaf()._key, as_leaf()._value);
+}
 
-  virtual boost::optional<Value> lookup(const Key &key_) const override {
-    if (this->_key.index() == key_.index()) {
-      return boost::optional<Value>(this->_value);
-    } else {
-      return boost::optional<Value>();
-    }
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+const typename tree<Key, Value, ValueEqual, ValueHash>::ptr &
+tree<Key, Value, ValueEqual, ValueHash>::left_branch() const {
+  if (is_leaf()) {
+    CRAB_ERROR("Patricia tree: trying to call left_branch() on a leaf");
   }
+  return as_node()._left_branch;
+}
 
-  virtual const Value *find(const Key &key) const override {
-    if (this->_key.index() == key.index()) {
-      return &(this->_value);
-    } else {
-      return nullptr;
-    }
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+const typename tree<Key, Value, ValueEqual, ValueHash>::ptr &
+tree<Key, Value, ValueEqual, ValueHash>::right_branch() const {
+  if (is_leaf()) {
+    CRAB_ERROR("Patricia tree: trying to call right_branch() on a leaf");
   }
+  return as_node()._right_branch;
+}
 
-}; // class leaf
-
-template <typename Key, typename Value, typename ValueEqual>
-typename tree<Key, Value, ValueEqual>::ptr
-tree<Key, Value, ValueEqual>::make_node(
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::make_node(
     index_t prefix, index_t branching_bit,
-    typename tree<Key, Value, ValueEqual>::ptr left_branch,
-    typename tree<Key, Value, ValueEqual>::ptr right_branch) {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr left_branch,
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr right_branch) {
+  using tree_ptr = typename tree<Key, Value, ValueEqual, ValueHash>::ptr;
   tree_ptr n;
   if (left_branch) {
     if (right_branch) {
-      n = std::make_shared<node<Key, Value, ValueEqual>>(
-          prefix, branching_bit, left_branch, right_branch);
+      n = new_node(prefix, branching_bit, left_branch, right_branch,
+                   hash_consed_t());
     } else {
       n = left_branch;
     }
@@ -737,17 +986,18 @@ tree<Key, Value, ValueEqual>::make_node(
   return n;
 }
 
-template <typename Key, typename Value, typename ValueEqual>
-typename tree<Key, Value, ValueEqual>::ptr
-tree<Key, Value, ValueEqual>::make_leaf(const Key &key, const Value &value) {
-  return std::make_shared<leaf<Key, Value, ValueEqual>>(key, value);
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::make_leaf(const Key &key,
+                                                   const Value &value) {
+  return new_leaf(key, value, hash_consed_t());
 }
 
-template <typename Key, typename Value, typename ValueEqual>
-typename tree<Key, Value, ValueEqual>::ptr tree<Key, Value, ValueEqual>::join(
-    typename tree<Key, Value, ValueEqual>::ptr t0,
-    typename tree<Key, Value, ValueEqual>::ptr t1) {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr tree<Key, Value, ValueEqual, ValueHash>::join(
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t0,
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t1) {
+  using tree_ptr = typename tree<Key, Value, ValueEqual, ValueHash>::ptr;
   index_t p0 = t0->prefix();
   index_t p1 = t1->prefix();
   index_t m =
@@ -762,12 +1012,12 @@ typename tree<Key, Value, ValueEqual>::ptr tree<Key, Value, ValueEqual>::join(
   return t;
 }
 
-template <typename Key, typename Value, typename ValueEqual>
-std::pair<bool, typename tree<Key, Value, ValueEqual>::ptr>
-tree<Key, Value, ValueEqual>::insert(
-    typename tree<Key, Value, ValueEqual>::ptr t, const Key &key_,
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+std::pair<bool, typename tree<Key, Value, ValueEqual, ValueHash>::ptr>
+tree<Key, Value, ValueEqual, ValueHash>::insert(
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t, const Key &key_,
     const Value &value_, binary_op_t &op, bool combine_left_to_right) {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
+  using tree_ptr = typename tree<Key, Value, ValueEqual, ValueHash>::ptr;
   tree_ptr nil;
   std::pair<bool, tree_ptr> res, res_lb, res_rb;
   std::pair<bool, boost::optional<Value>> new_value;
@@ -864,11 +1114,11 @@ tree<Key, Value, ValueEqual>::insert(
   }
 }
 
-template <typename Key, typename Value, typename ValueEqual>
-typename tree<Key, Value, ValueEqual>::ptr
-tree<Key, Value, ValueEqual>::transform(
-    typename tree<Key, Value, ValueEqual>::ptr t, unary_op_t &op) {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr
+tree<Key, Value, ValueEqual, ValueHash>::transform(
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t, unary_op_t &op) {
+  using tree_ptr = typename tree<Key, Value, ValueEqual, ValueHash>::ptr;
   tree_ptr nil;
   if (t) {
     if (t->is_node()) {
@@ -912,10 +1162,10 @@ tree<Key, Value, ValueEqual>::transform(
   }
 }
   
-template <typename Key, typename Value, typename ValueEqual>
-typename tree<Key, Value, ValueEqual>::ptr tree<Key, Value, ValueEqual>::remove(
-    typename tree<Key, Value, ValueEqual>::ptr t, const Key &key_) {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+typename tree<Key, Value, ValueEqual, ValueHash>::ptr tree<Key, Value, ValueEqual, ValueHash>::remove(
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t, const Key &key_) {
+  using tree_ptr = typename tree<Key, Value, ValueEqual, ValueHash>::ptr;
   tree_ptr nil;
   index_t id = key_.index();
   if (t) {
@@ -963,13 +1213,13 @@ typename tree<Key, Value, ValueEqual>::ptr tree<Key, Value, ValueEqual>::remove(
   }
 }
 
-template <typename Key, typename Value, typename ValueEqual>
-std::pair<bool, typename tree<Key, Value, ValueEqual>::ptr>
-tree<Key, Value, ValueEqual>::merge(
-    typename tree<Key, Value, ValueEqual>::ptr s,
-    typename tree<Key, Value, ValueEqual>::ptr t, binary_op_t &op,
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+std::pair<bool, typename tree<Key, Value, ValueEqual, ValueHash>::ptr>
+tree<Key, Value, ValueEqual, ValueHash>::merge(
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr s,
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t, binary_op_t &op,
     bool combine_left_to_right) {
-  using tree_ptr = typename tree<Key, Value, ValueEqual>::ptr;
+  using tree_ptr = typename tree<Key, Value, ValueEqual, ValueHash>::ptr;
   tree_ptr nil;
   std::pair<bool, tree_ptr> res, res_lb, res_rb;
   std::pair<bool, boost::optional<Value>> new_value;
@@ -1145,10 +1395,10 @@ tree<Key, Value, ValueEqual>::merge(
   }
 }
 
-template <typename Key, typename Value, typename ValueEqual>
-bool tree<Key, Value, ValueEqual>::compare(
-    typename tree<Key, Value, ValueEqual>::ptr s,
-    typename tree<Key, Value, ValueEqual>::ptr t, partial_order_t &po,
+template <typename Key, typename Value, typename ValueEqual, typename ValueHash>
+bool tree<Key, Value, ValueEqual, ValueHash>::compare(
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr s,
+    typename tree<Key, Value, ValueEqual, ValueHash>::ptr t, partial_order_t &po,
     bool compare_left_to_right) {
   if (s) {
     if (t) {
@@ -24,8 +24,8 @@ public:
   }
   bool operator<(const tag &as) const { return m_id < as.m_id; }
   bool operator==(const tag &as) const { return m_id == as.m_id; }
-  virtual ikos::index_t index() const override { return m_id; }
-  void write(crab_os &o) const override { o << "TAG_" << m_id; }
+  ikos::index_t index() const { return m_id; }
+  void write(crab_os &o) const { o << "TAG_" << m_id; }
   friend crab_os &operator<<(crab_os &o, const tag &as) {
     as.write(o);
     return o;
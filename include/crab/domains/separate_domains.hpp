@@ -52,19 +52,23 @@
 
 namespace ikos {
 
-/* Environment from Key to Value with all lattice operations */ 
+/* Environment from Key to Value with all lattice operations.
+ * If ValueHash is not no_hash_consing then the underlying patricia
+ * tree is hash-consed (see patricia_tree). */
 template <typename Key, typename Value,
-	  typename ValueEqual = std::equal_to<Value>>
+	  typename ValueEqual = std::equal_to<Value>,
+	  typename ValueHash = no_hash_consing>
 class separate_domain {
 
 private:
-  using patricia_tree_t = patricia_tree<Key, Value, ValueEqual>;
+  using patricia_tree_t = patricia_tree<Key, Value, ValueEqual, ValueHash>;
   using binary_op_t = typename patricia_tree_t::binary_op_t;
   using partial_order_t = typename patricia_tree_t::partial_order_t;
 
 public:
   using unary_op_t = typename patricia_tree_t::unary_op_t;  
-  using separate_domain_t = separate_domain<Key, Value, ValueEqual>;
+  using separate_domain_t =
+      separate_domain<Key, Value, ValueEqual, ValueHash>;
   using iterator = typename patricia_tree_t::iterator;
   using key_type = Key;
   using value_type = typename patricia_tree_t::binding_t;
@@ -228,7 +232,20 @@ public:
     }
   }
 
+  // Cheap test: true only if both environments are represented by the
+  // same tree. With hash-consing this is equivalent to operator==.
+  bool is_identical(const separate_domain_t &e) const {
+    if (is_bottom() || e.is_bottom()) {
+      return is_bottom() && e.is_bottom();
+    } else {
+      return _tree.is_identical(e._tree);
+    }
+  }
+
   bool operator==(const separate_domain_t &e) const {
+    if (is_identical(e)) {
+      return true;
+    }
     return (this->operator<=(e) && e.operator<=(*this));
   }
 
@@ -479,7 +496,7 @@ public:
   }
 
   friend crab::crab_os &operator<<(crab::crab_os &o,
-                                   const separate_domain<Key, Value, ValueEqual> &d) {
+                                   const separate_domain_t &d) {
     d.write(o);
     return o;
   }
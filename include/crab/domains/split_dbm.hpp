@@ -29,6 +29,9 @@
 #include <crab/support/stats.hpp>
 
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <unordered_set>
 
 #define JOIN_CLOSE_AFTER_MEET
@@ -99,13 +102,84 @@ protected:
   // Domain data
   //================
   // GKG: ranges are now maintained in the graph
-  vert_map_t vert_map; // Mapping from variables to vertices
-  rev_map_t rev_map;
-  graph_t g;                 // The underlying relation graph
-  std::vector<Wt> potential; // Stored potential for the vertex
-  vert_set_t unstable;
+  struct dbm_state {
+    vert_map_t vert_map; // Mapping from variables to vertices
+    rev_map_t rev_map;
+    graph_t g;                 // The underlying relation graph
+    std::vector<Wt> potential; // Stored potential for the vertex
+    vert_set_t unstable;
+  };
+  // If zones.copy_on_write is enabled then copies share the state
+  // until one of them modifies it. The state is only accessed through
+  // the methods below: the non-const ones give first exclusive
+  // ownership of the state to this DBM.
+  std::shared_ptr<dbm_state> m_state;
   bool _is_bottom;
 
+  static std::shared_ptr<dbm_state>
+  copy_state(const std::shared_ptr<dbm_state> &state) {
+    if (crab_domain_params_man::get().zones_copy_on_write()) {
+      return state;
+    } else {
+      return std::make_shared<dbm_state>(*state);
+    }
+  }
+
+  void detach() {
+    if (m_state.use_count() == 1) {
+      // The other owners might have released the state from other
+      // threads: see their last writes before modifying it.
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } else {
+      crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.detach"));
+      m_state = std::make_shared<dbm_state>(*m_state);
+    }
+  }
+
+  vert_map_t &vert_map() {
+    detach();
+    return m_state->vert_map;
+  }
+  const vert_map_t &vert_map() const { return m_state->vert_map; }
+
+  rev_map_t &rev_map() {
+    detach();
+    return m_state->rev_map;
+  }
+  const rev_map_t &rev_map() const { return m_state->rev_map; }
+
+  graph_t &g() {
+    detach();
+    return m_state->g;
+  }
+  const graph_t &g() const { return m_state->g; }
+
+  std::vector<Wt> &potential() {
+    detach();
+    return m_state->potential;
+  }
+  const std::vector<Wt> &potential() const { return m_state->potential; }
+
+  vert_set_t &unstable() {
+    detach();
+    return m_state->unstable;
+  }
+  const vert_set_t &unstable() const { return m_state->unstable; }
+
+  // Replace the whole state, e.g., by the result of a join or a
+  // meet. Unlike the non-const accessors, it never copies the current
+  // state.
+  void reset_state(vert_map_t &&vert_map, rev_map_t &&rev_map, graph_t &&g,
+                   std::vector<Wt> &&potential, vert_set_t &&unstable) {
+    m_state = std::make_shared<dbm_state>();
+    m_state->vert_map = std::move(vert_map);
+    m_state->rev_map = std::move(rev_map);
+    m_state->g = std::move(g);
+    m_state->potential = std::move(potential);
+    m_state->unstable = std::move(unstable);
+    _is_bottom = false;
+  }
+
   class Wt_max {
   public:
     Wt_max() {}
@@ -121,22 +195,22 @@ protected:
   };
   
   vert_id get_vert(variable_t v) {
-    auto it = vert_map.find(v);
-    if (it != vert_map.end())
+    auto it = vert_map().find(v);
+    if (it != vert_map().end())
       return (*it).second;
 
-    vert_id vert(g.new_vertex());
-    vert_map.insert(vmap_elt_t(v, vert));
+    vert_id vert(g().new_vertex());
+    vert_map().insert(vmap_elt_t(v, vert));
     // Initialize
-    assert(vert <= rev_map.size());
-    if (vert < rev_map.size()) {
-      potential[vert] = Wt(0);
-      rev_map[vert] = v;
+    assert(vert <= rev_map().size());
+    if (vert < rev_map().size()) {
+      potential()[vert] = Wt(0);
+      rev_map()[vert] = v;
     } else {
-      potential.push_back(Wt(0));
-      rev_map.push_back(v);
+      potential().push_back(Wt(0));
+      rev_map().push_back(v);
     }
-    vert_map.insert(vmap_elt_t(v, vert));
+    vert_map().insert(vmap_elt_t(v, vert));
 
     assert(vert != 0);
 
@@ -144,8 +218,8 @@ protected:
   }
 
   boost::optional<vert_id> get_vert(const variable_t &v) const {
-    auto it = vert_map.find(v);
-    if (it != vert_map.end()) {
+    auto it = vert_map().find(v);
+    if (it != vert_map().end()) {
       return (*it).second;
     } else {
       return boost::none;
@@ -199,9 +273,9 @@ protected:
 
   // Evaluate the potential value of a variable.
   Wt pot_value(const variable_t &v) {
-    auto it = vert_map.find(v);
-    if (it != vert_map.end())
-      return potential[(*it).second];
+    auto it = vert_map().find(v);
+    if (it != vert_map().end())
+      return potential()[(*it).second];
     return ((Wt)0);
   }
 
@@ -218,7 +292,7 @@ protected:
       if (overflow) {
         return Wt(0);
       }
-      v += (pot_value(p.second) - potential[0]) * coef;
+      v += (pot_value(p.second) - potential()[0]) * coef;
     }
     return v;
   }
@@ -457,7 +531,7 @@ protected:
     std::vector<diffcst_t> csts;
     diffcsts_of_lin_leq(exp, csts, lbs, ubs);
 
-    check_potential(g, potential, __LINE__);
+    check_potential(g(), potential(), __LINE__);
 
     Wt_min min_op;
     wt_ref_t w;
@@ -466,27 +540,27 @@ protected:
                                   << p.first << ">=" << p.second << "\n");
       variable_t x(p.first);
       vert_id v = get_vert(p.first);
-      if (g.lookup(v, 0, w) && w.get() <= -p.second)
+      if (g().lookup(v, 0, w) && w.get() <= -p.second)
         continue;
-      g.set_edge(v, -p.second, 0);
+      g().set_edge(v, -p.second, 0);
 
       if (!repair_potential(v, 0)) {
         set_to_bottom();
         return false;
       }
-      check_potential(g, potential, __LINE__);
+      check_potential(g(), potential(), __LINE__);
       // Compute other updated bounds
       if (crab_domain_params_man::get().zones_close_bounds_inline()) {
-        for (auto e : g.e_preds(v)) {
+        for (auto e : g().e_preds(v)) {
           if (e.vert == 0)
             continue;
-          g.update_edge(e.vert, e.val - p.second, 0, min_op);
+          g().update_edge(e.vert, e.val - p.second, 0, min_op);
 
           if (!repair_potential(e.vert, 0)) {
             set_to_bottom();
             return false;
           }
-          check_potential(g, potential, __LINE__);
+          check_potential(g(), potential(), __LINE__);
         }
       }
     }
@@ -495,25 +569,25 @@ protected:
                                   << p.first << "<=" << p.second << "\n");
       variable_t x(p.first);
       vert_id v = get_vert(p.first);
-      if (g.lookup(0, v, w) && w.get() <= p.second)
+      if (g().lookup(0, v, w) && w.get() <= p.second)
         continue;
-      g.set_edge(0, p.second, v);
+      g().set_edge(0, p.second, v);
       if (!repair_potential(0, v)) {
         set_to_bottom();
         return false;
       }
-      check_potential(g, potential, __LINE__);
+      check_potential(g(), potential(), __LINE__);
 
       if (crab_domain_params_man::get().zones_close_bounds_inline()) {
-        for (auto e : g.e_succs(v)) {
+        for (auto e : g().e_succs(v)) {
           if (e.vert == 0)
             continue;
-          g.update_edge(0, e.val + p.second, e.vert, min_op);
+          g().update_edge(0, e.val + p.second, e.vert, min_op);
           if (!repair_potential(0, e.vert)) {
             set_to_bottom();
             return false;
           }
-          check_potential(g, potential, __LINE__);
+          check_potential(g(), potential(), __LINE__);
         }
       }
     }
@@ -528,34 +602,171 @@ protected:
 
       // Check if the edge (src,dest) via bounds already exists
       wt_ref_t w1, w2;
-      if (g.lookup(src, 0, w1) && g.lookup(0, dest, w2) &&
+      if (g().lookup(src, 0, w1) && g().lookup(0, dest, w2) &&
           (w1.get() + w2.get()) <= diff.second) {
         continue;
       }
 
-      g.update_edge(src, diff.second, dest, min_op);
+      g().update_edge(src, diff.second, dest, min_op);
       if (!repair_potential(src, dest)) {
         set_to_bottom();
         return false;
       }
-      check_potential(g, potential, __LINE__);
+      check_potential(g(), potential(), __LINE__);
       close_over_edge(src, dest);
-      check_potential(g, potential, __LINE__);
+      check_potential(g(), potential(), __LINE__);
     }
     // Collect bounds
     // GKG: Now done in close_over_edge
 
     if (!crab_domain_params_man::get().zones_close_bounds_inline()) {
       edge_vector delta;
-      GrOps::close_after_assign(g, potential, 0, delta);
-      GrOps::apply_delta(g, delta);
+      GrOps::close_after_assign(g(), potential(), 0, delta);
+      GrOps::apply_delta(g(), delta);
     }
 
-    check_potential(g, potential, __LINE__);
+    check_potential(g(), potential(), __LINE__);
     // CRAB_WARN("split_dbm_domain::add_linear_leq not yet implemented.");
     return true;
   }
 
+  // If exp <= 0 is x - y <= k, x <= k or -x <= k then append its
+  // edge to edges and return true. Otherwise, return false.
+  bool diffcst_edge_of_lin_leq(const linear_expression_t &exp,
+                               edge_vector &edges) {
+    if (exp.size() == 0 || exp.size() > 2) {
+      return false;
+    }
+    bool overflow, underflow;
+    Wt k = -(ntow::convert(exp.constant(), overflow));
+    // same restriction as diffcsts_of_lin_leq
+    ntow::convert(exp.constant() - 1, underflow);
+    if (overflow || underflow) {
+      return false;
+    }
+    boost::optional<variable_t> pos, neg;
+    for (auto p : exp) {
+      if (p.first == number_t(1) && !pos) {
+        pos = p.second;
+      } else if (p.first == number_t(-1) && !neg) {
+        neg = p.second;
+      } else {
+        return false;
+      }
+    }
+    vert_id src = neg ? get_vert(*neg) : 0;
+    vert_id dest = pos ? get_vert(*pos) : 0;
+    edges.push_back({{src, dest}, k});
+    return true;
+  }
+
+  // Add the edges of a batch of difference constraints. Unlike
+  // add_linear_leq, potentials are repaired once and closure is
+  // restored once, only from the vertices whose shortest paths can
+  // change. Return false if the result is bottom.
+  bool add_diffcsts(const edge_vector &edges) {
+    check_potential(g(), potential(), __LINE__);
+
+    Wt_min min_op;
+    wt_ref_t w, w1, w2;
+    // new relations
+    graph_t r;
+    r.growTo(g().size());
+    std::vector<vert_id> tails;
+    bool new_bounds = false;
+    for (auto const &e : edges) {
+      vert_id src = e.first.first;
+      vert_id dest = e.first.second;
+      if (g().lookup(src, dest, w) && w.get() <= e.second) {
+        continue;
+      }
+      if (src == 0 || dest == 0) {
+        g().set_edge(src, e.second, dest);
+        new_bounds = true;
+      } else {
+        // the edge is already implied by the bounds
+        if (g().lookup(src, 0, w1) && g().lookup(0, dest, w2) &&
+            (w1.get() + w2.get()) <= e.second) {
+          continue;
+        }
+        if (r.lookup(src, dest, w) && w.get() <= e.second) {
+          continue;
+        }
+        r.set_edge(src, e.second, dest);
+        tails.push_back(src);
+      }
+    }
+    if (!new_bounds && tails.empty()) {
+      return true;
+    }
+    std::sort(tails.begin(), tails.end());
+    tails.erase(std::unique(tails.begin(), tails.end()), tails.end());
+
+    // The chromatic Dijkstra needs the relations before the batch
+    bool chrome = !tails.empty() &&
+                  crab_domain_params_man::get().zones_chrome_dijkstra();
+    graph_t l;
+    if (chrome) {
+      l = g();
+    }
+    for (vert_id s : tails) {
+      for (auto e : r.e_succs(s)) {
+        g().update_edge(s, e.val, e.vert, min_op);
+      }
+    }
+
+    if (!GrOps::select_potentials(g(), potential())) {
+      return false;
+    }
+
+    if (!tails.empty()) {
+      edge_vector delta;
+      SubGraph<graph_t> g_excl(g(), 0);
+      if (close_dense(g_excl, delta)) {
+        // closed with the dense kernel
+      } else if (chrome) {
+        // close_after_meet assumes that both operands are closed
+        GrOps::close_johnson(r, potential(), tails, delta);
+        for (auto const &e : delta) {
+          r.set_edge(e.first.first, e.second, e.first.second);
+          g().update_edge(e.first.first, e.second, e.first.second, min_op);
+        }
+        delta.clear();
+        // l is closed so a path that starts with l-edges can start
+        // with a single one.
+        SubGraph<graph_t> l_excl(l, 0);
+        std::vector<vert_id> srcs(tails);
+        for (vert_id v : tails) {
+          for (auto e : l_excl.e_preds(v)) {
+            srcs.push_back(e.vert);
+          }
+        }
+        std::sort(srcs.begin(), srcs.end());
+        srcs.erase(std::unique(srcs.begin(), srcs.end()), srcs.end());
+        GrOps::close_after_meet(g_excl, potential(), l_excl, r, srcs, delta);
+      } else {
+        std::vector<vert_id> srcs(tails);
+        for (vert_id v : tails) {
+          for (auto e : g_excl.e_preds(v)) {
+            srcs.push_back(e.vert);
+          }
+        }
+        std::sort(srcs.begin(), srcs.end());
+        srcs.erase(std::unique(srcs.begin(), srcs.end()), srcs.end());
+        GrOps::close_johnson(g_excl, potential(), srcs, delta);
+      }
+      GrOps::apply_delta(g(), delta);
+    }
+
+    // Recover updated LBs and UBs.
+    edge_vector delta;
+    GrOps::close_after_assign(g(), potential(), 0, delta);
+    GrOps::apply_delta(g(), delta);
+
+    check_potential(g(), potential(), __LINE__);
+    return true;
+  }
+
   // x != n
   bool add_univar_disequation(const variable_t &x, number_t n) {
     bool overflow;
@@ -578,23 +789,23 @@ protected:
           return true;
         }
 
-        if (g.lookup(v, 0, w) && lb_val < w.get()) {
-          g.set_edge(v, lb_val, 0);
+        if (g().lookup(v, 0, w) && lb_val < w.get()) {
+          g().set_edge(v, lb_val, 0);
           if (!repair_potential(v, 0)) {
             set_to_bottom();
             return false;
           }
-          check_potential(g, potential, __LINE__);
+          check_potential(g(), potential(), __LINE__);
           // Update other bounds
-          for (auto e : g.e_preds(v)) {
+          for (auto e : g().e_preds(v)) {
             if (e.vert == 0)
               continue;
-            g.update_edge(e.vert, e.val + lb_val, 0, min_op);
+            g().update_edge(e.vert, e.val + lb_val, 0, min_op);
             if (!repair_potential(e.vert, 0)) {
               set_to_bottom();
               return false;
             }
-            check_potential(g, potential, __LINE__);
+            check_potential(g(), potential(), __LINE__);
           }
         }
       }
@@ -605,23 +816,23 @@ protected:
           return true;
         }
 
-        if (g.lookup(0, v, w) && (ub_val < w.get())) {
-          g.set_edge(0, ub_val, v);
+        if (g().lookup(0, v, w) && (ub_val < w.get())) {
+          g().set_edge(0, ub_val, v);
           if (!repair_potential(0, v)) {
             set_to_bottom();
             return false;
           }
-          check_potential(g, potential, __LINE__);
+          check_potential(g(), potential(), __LINE__);
           // Update other bounds
-          for (auto e : g.e_succs(v)) {
+          for (auto e : g().e_succs(v)) {
             if (e.vert == 0)
               continue;
-            g.update_edge(0, e.val + ub_val, e.vert, min_op);
+            g().update_edge(0, e.val + ub_val, e.vert, min_op);
             if (!repair_potential(0, e.vert)) {
               set_to_bottom();
               return false;
             }
-            check_potential(g, potential, __LINE__);
+            check_potential(g(), potential(), __LINE__);
           }
         }
       }
@@ -683,7 +894,7 @@ protected:
   }
 
   interval_t get_interval(const variable_t &x) const {
-    return get_interval(vert_map, g, x);
+    return get_interval(vert_map(), g(), x);
   }
 
   interval_t get_interval(const vert_map_t &m, const graph_t &g,
@@ -699,9 +910,18 @@ protected:
     return x_out;
   }
 
+  // Restore closure with a dense kernel if g is small and dense
+  // enough. Return false otherwise.
+  template <class G>
+  static bool close_dense(const G &g, edge_vector &delta) {
+    unsigned max_size =
+        crab_domain_params_man::get().zones_dense_closure_max_size();
+    return max_size > 0 && GrOps::close_dense(g, max_size, delta);
+  }
+
   // Resore potential after an edge addition
   bool repair_potential(vert_id src, vert_id dest) {
-    return GrOps::repair_potential(g, potential, src, dest);
+    return GrOps::repair_potential(g(), potential(), src, dest);
   }
 
   // Restore closure after a single edge addition
@@ -710,15 +930,15 @@ protected:
 
     Wt_min min_op;
     wt_ref_t w;
-    SubGraph<graph_t> g_excl(g, 0);
+    SubGraph<graph_t> g_excl(g(), 0);
     Wt c = g_excl.edge_val(ii, jj);
 
 
     if (crab_domain_params_man::get().zones_close_bounds_inline()) {
-      if (g.lookup(0, ii, w))
-        g.update_edge(0, w.get() + c, jj, min_op);
-      if (g.lookup(jj, 0, w))
-        g.update_edge(ii, w.get() + c, 0, min_op);
+      if (g().lookup(0, ii, w))
+        g().update_edge(0, w.get() + c, jj, min_op);
+      if (g().lookup(jj, 0, w))
+        g().update_edge(ii, w.get() + c, 0, min_op);
     }
 
     // There may be a cheaper way to do this.
@@ -736,20 +956,20 @@ protected:
             continue;
 	  }
 	  // REVISIT(PERFORMANCE): extra call to lookup
-	  g.set_edge(se, wt_sij, jj);
+	  g().set_edge(se, wt_sij, jj);
         } else {
           delta.push_back({{se, jj}, wt_sij});
         }
         src_dec.push_back(std::make_pair(se, edge.val));
         if (crab_domain_params_man::get().zones_close_bounds_inline()) {
-          if (g.lookup(0, se, w))
-            g.update_edge(0, w.get() + wt_sij, jj, min_op);
-          if (g.lookup(jj, 0, w))
-            g.update_edge(se, w.get() + wt_sij, 0, min_op);
+          if (g().lookup(0, se, w))
+            g().update_edge(0, w.get() + wt_sij, jj, min_op);
+          if (g().lookup(jj, 0, w))
+            g().update_edge(se, w.get() + wt_sij, 0, min_op);
         }
       }
     }
-    GrOps::apply_delta(g, delta);
+    GrOps::apply_delta(g(), delta);
     delta.clear();
     std::vector<std::pair<vert_id, Wt>> dest_dec;
     for (auto edge : g_excl.e_succs(jj)) {
@@ -761,20 +981,20 @@ protected:
             continue;
 	  }
 	  // REVISIT(PERFORMANCE): extra call to lookup
-	  g.set_edge(ii, wt_ijd, de);
+	  g().set_edge(ii, wt_ijd, de);
         } else {
           delta.push_back({{ii, de}, {wt_ijd}});
         }
         dest_dec.push_back(std::make_pair(de, edge.val));
         if (crab_domain_params_man::get().zones_close_bounds_inline()) {
-          if (g.lookup(0, ii, w))
-            g.update_edge(0, w.get() + wt_ijd, de, min_op);
-          if (g.lookup(de, 0, w))
-            g.update_edge(ii, w.get() + wt_ijd, 0, min_op);
+          if (g().lookup(0, ii, w))
+            g().update_edge(0, w.get() + wt_ijd, de, min_op);
+          if (g().lookup(de, 0, w))
+            g().update_edge(ii, w.get() + wt_ijd, 0, min_op);
         }
       }
     }
-    GrOps::apply_delta(g, delta);
+    GrOps::apply_delta(g(), delta);
 
     for (auto s_p : src_dec) {
       vert_id se = s_p.first;
@@ -782,20 +1002,20 @@ protected:
       for (auto d_p : dest_dec) {
         vert_id de = d_p.first;
         Wt wt_sijd = wt_sij + d_p.second;
-        if (g.lookup(se, de, w)) {
+        if (g().lookup(se, de, w)) {
           if (w.get() <= wt_sijd) {
             continue;
 	  }
 	  // REVISIT(PERFORMANCE): extra call to lookup
-	  g.set_edge(se, wt_sijd, de);
+	  g().set_edge(se, wt_sijd, de);
         } else {
-          g.add_edge(se, wt_sijd, de);
+          g().add_edge(se, wt_sijd, de);
         }
         if (crab_domain_params_man::get().zones_close_bounds_inline()) {
-          if (g.lookup(0, se, w))
-            g.update_edge(0, w.get() + wt_sijd, de, min_op);
-          if (g.lookup(de, 0, w))
-            g.update_edge(se, w.get() + wt_sijd, 0, min_op);
+          if (g().lookup(0, se, w))
+            g().update_edge(0, w.get() + wt_sijd, de, min_op);
+          if (g().lookup(de, 0, w))
+            g().update_edge(se, w.get() + wt_sijd, 0, min_op);
         }
       }
     }
@@ -812,9 +1032,9 @@ protected:
     // Run Dijkstra's forward to collect successors of v,
     // and backward to collect predecessors
     edge_vector delta;
-    if(!GrOps::close_after_assign(g, potential, v, delta))
+    if(!GrOps::close_after_assign(g(), potential(), v, delta))
       return false;
-    GrOps::apply_delta(g, delta);
+    GrOps::apply_delta(g(), delta);
     return true;
   }
 
@@ -828,21 +1048,21 @@ protected:
   // return true if edge from x to y with weight k is unsatisfiable
   bool is_unsat_edge(vert_id x, vert_id y, Wt k) const {
     wt_ref_t w;
-    if (g.lookup(y, x, w)) {
+    if (g().lookup(y, x, w)) {
       return ((w.get() + k) < Wt(0));
     } else {
       interval_t intv_x = interval_t::top();
       interval_t intv_y = interval_t::top();
-      if (g.elem(0, x) || g.elem(x, 0)) {
-        intv_x = interval_t(g.elem(x, 0) ? -number_t(g.edge_val(x, 0))
+      if (g().elem(0, x) || g().elem(x, 0)) {
+        intv_x = interval_t(g().elem(x, 0) ? -number_t(g().edge_val(x, 0))
                                          : bound_t::minus_infinity(),
-                            g.elem(0, x) ? number_t(g.edge_val(0, x))
+                            g().elem(0, x) ? number_t(g().edge_val(0, x))
                                          : bound_t::plus_infinity());
       }
-      if (g.elem(0, y) || g.elem(y, 0)) {
-        intv_y = interval_t(g.elem(y, 0) ? -number_t(g.edge_val(y, 0))
+      if (g().elem(0, y) || g().elem(y, 0)) {
+        intv_y = interval_t(g().elem(y, 0) ? -number_t(g().edge_val(y, 0))
                                          : bound_t::minus_infinity(),
-                            g.elem(0, y) ? number_t(g.edge_val(0, y))
+                            g().elem(0, y) ? number_t(g().edge_val(0, y))
                                          : bound_t::plus_infinity());
       }
       if (intv_x.is_top() || intv_y.is_top()) {
@@ -944,7 +1164,9 @@ protected:
     if (!is_closed) {
       edge_vector delta;
       SubGraph<graph_t> g_rx_excl(g_rx, 0);
-      GrOps::close_after_meet(g_rx_excl, pot_rx, gx, g_ix_ry, delta);
+      if (!close_dense(g_rx_excl, delta)) {
+        GrOps::close_after_meet(g_rx_excl, pot_rx, gx, g_ix_ry, delta);
+      }
       GrOps::apply_delta(g_rx, delta);
     }
 #endif
@@ -970,7 +1192,9 @@ protected:
     if (!is_closed) {
       edge_vector delta;
       SubGraph<graph_t> g_ry_excl(g_ry, 0);
-      GrOps::close_after_meet(g_ry_excl, pot_ry, gy, g_rx_iy, delta);
+      if (!close_dense(g_ry_excl, delta)) {
+        GrOps::close_after_meet(g_ry_excl, pot_ry, gy, g_rx_iy, delta);
+      }
       GrOps::apply_delta(g_ry, delta);
     }
 #endif
@@ -1068,8 +1292,8 @@ protected:
             ((edge_pred.val + edge_succ.val) <= wx.get())) {
           bool res = update_edge_widen_g(s, d, wx.get());
           if (res) {
-            CRAB_LOG("zones-split-widening", auto vs = rev_map[s];
-                     auto vd = rev_map[d];
+            CRAB_LOG("zones-split-widening", auto vs = rev_map()[s];
+                     auto vd = rev_map()[d];
                      crab::outs() << "Widening 1: added " << *vd << "-" << *vs
 		                  << "<=" << wx.get() << "\n";);
           }
@@ -1088,8 +1312,8 @@ protected:
           bool res = update_edge_widen_g(s, d, wx.get());
           if (res) {
             CRAB_LOG(
-                "zones-split-widening", auto vs = rev_map[s];
-                auto vd = rev_map[d]; if (s == 0 && d != 0) {
+                "zones-split-widening", auto vs = rev_map()[s];
+                auto vd = rev_map()[d]; if (s == 0 && d != 0) {
                   crab::outs() << "Widening 2: added " << *vd
                                << "<=" << wx.get() << "\n";
                 } else if (s != 0 && d == 0) {
@@ -1112,7 +1336,7 @@ protected:
                      crab::outs() << "Widening 5: added v0"
                                   << " in the normalization queue\n";
                    } else {
-                     auto vs = rev_map[s];
+                     auto vs = rev_map()[s];
                      crab::outs() << "Widening 5: added " << *vs
                                   << " in the normalization queue\n";
                    });
@@ -1136,7 +1360,7 @@ protected:
 #ifdef SDBM_NO_NORMALIZE
     return false;
 #endif
-    return unstable.size() > 0;
+    return unstable().size() > 0;
   }
 
   // dbm is already normalized
@@ -1150,30 +1374,30 @@ protected:
     }
 
     // Extract all the edges
-    SubGraph<graph_t> g_excl(const_cast<graph_t &>(dbm.g), 0);
+    SubGraph<graph_t> g_excl(const_cast<graph_t &>(dbm.g()), 0);
     for (vert_id v : g_excl.verts()) {
-      if (!dbm.rev_map[v])
+      if (!dbm.rev_map()[v])
         continue;
-      if (dbm.g.elem(v, 0)) {
-        variable_t vv = *dbm.rev_map[v];
-        Wt c = dbm.g.edge_val(v, 0);
+      if (dbm.g().elem(v, 0)) {
+        variable_t vv = *dbm.rev_map()[v];
+        Wt c = dbm.g().edge_val(v, 0);
         csts += linear_constraint_t(linear_expression_t(vv) >= -number_t(c));
       }
-      if (dbm.g.elem(0, v)) {
-        variable_t vv = *dbm.rev_map[v];
-        Wt c = dbm.g.edge_val(0, v);
+      if (dbm.g().elem(0, v)) {
+        variable_t vv = *dbm.rev_map()[v];
+        Wt c = dbm.g().edge_val(0, v);
         csts += linear_constraint_t(linear_expression_t(vv) <= number_t(c));
       }
     }
 
     for (vert_id s : g_excl.verts()) {
-      if (!dbm.rev_map[s])
+      if (!dbm.rev_map()[s])
         continue;
-      variable_t vs = *dbm.rev_map[s];
+      variable_t vs = *dbm.rev_map()[s];
       for (vert_id d : g_excl.succs(s)) {
-        if (!dbm.rev_map[d])
+        if (!dbm.rev_map()[d])
           continue;
-        variable_t vd = *dbm.rev_map[d];
+        variable_t vd = *dbm.rev_map()[d];
         csts += linear_constraint_t(vd - vs <= number_t(g_excl.edge_val(s, d)));
       }
     }
@@ -1184,23 +1408,23 @@ protected:
   void write(crab_os &o, const DBM_t &dbm) const {
 #if 0
     o << "edges={";
-    for(vert_id v : dbm.g.verts()) {
-      for(vert_id d : dbm.g.succs(v)) {
-	if(!dbm.rev_map[v] || !dbm.rev_map[d]) {
+    for(vert_id v : dbm.g().verts()) {
+      for(vert_id d : dbm.g().succs(v)) {
+	if(!dbm.rev_map()[v] || !dbm.rev_map()[d]) {
 	  CRAB_WARN("Edge incident to un-mapped vertex.");
 	  continue;
 	}
-	variable_t vv = *dbm.rev_map[v];
-	variable_t vd = *dbm.rev_map[d];
+	variable_t vv = *dbm.rev_map()[v];
+	variable_t vd = *dbm.rev_map()[d];
 	o << "(" << vv << "," << vd << ":"
-	  << dbm.g.edge_val(v,d) << ")";
+	  << dbm.g().edge_val(v,d) << ")";
       }
     }
     o << "}";
     crab::outs() << "rev_map={";
-    for(unsigned i=0, e = dbm.rev_map.size(); i!=e; i++) {
-      if (dbm.rev_map[i]) {
-	variable_t vi = *dbm.rev_map[i];
+    for(unsigned i=0, e = dbm.rev_map().size(); i!=e; i++) {
+      if (dbm.rev_map()[i]) {
+	variable_t vi = *dbm.rev_map()[i];
 	crab::outs() << vi << "(" << i << ");";
       }
     }
@@ -1217,33 +1441,33 @@ protected:
       bool first = true;
       o << "{";
       // Extract all the edges
-      SubGraph<graph_t> g_excl(const_cast<graph_t &>(dbm.g), 0);
+      SubGraph<graph_t> g_excl(const_cast<graph_t &>(dbm.g()), 0);
       for (vert_id v : g_excl.verts()) {
-        if (!dbm.rev_map[v])
+        if (!dbm.rev_map()[v])
           continue;
-        if (!dbm.g.elem(0, v) && !dbm.g.elem(v, 0))
+        if (!dbm.g().elem(0, v) && !dbm.g().elem(v, 0))
           continue;
         interval_t v_out =
-            interval_t(dbm.g.elem(v, 0) ? -number_t(dbm.g.edge_val(v, 0))
+            interval_t(dbm.g().elem(v, 0) ? -number_t(dbm.g().edge_val(v, 0))
                                         : bound_t::minus_infinity(),
-                       dbm.g.elem(0, v) ? number_t(dbm.g.edge_val(0, v))
+                       dbm.g().elem(0, v) ? number_t(dbm.g().edge_val(0, v))
                                         : bound_t::plus_infinity());
         if (first)
           first = false;
         else
           o << ", ";
-        variable_t vv = *dbm.rev_map[v];
+        variable_t vv = *dbm.rev_map()[v];
         o << vv << " -> " << v_out;
       }
 
       for (vert_id s : g_excl.verts()) {
-        if (!dbm.rev_map[s])
+        if (!dbm.rev_map()[s])
           continue;
-        variable_t vs = *dbm.rev_map[s];
+        variable_t vs = *dbm.rev_map()[s];
         for (vert_id d : g_excl.succs(s)) {
-          if (!dbm.rev_map[d])
+          if (!dbm.rev_map()[d])
             continue;
-          variable_t vd = *dbm.rev_map[d];
+          variable_t vd = *dbm.rev_map()[d];
 
           if (first)
             first = false;
@@ -1258,12 +1482,12 @@ protected:
 
   split_dbm_domain(vert_map_t &&_vert_map, rev_map_t &&_rev_map, graph_t &&_g,
                    std::vector<Wt> &&_potential, vert_set_t &&_unstable)
-      : vert_map(std::move(_vert_map)), rev_map(std::move(_rev_map)),
-        g(std::move(_g)), potential(std::move(_potential)),
-        unstable(std::move(_unstable)), _is_bottom(false) {
+      : _is_bottom(false) {
+    reset_state(std::move(_vert_map), std::move(_rev_map), std::move(_g),
+                std::move(_potential), std::move(_unstable));
 
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
 
     if (is_top()) {
       // Garbage collection from unconstrained variables in vert_map
@@ -1287,54 +1511,41 @@ protected:
   }
 
 public:
-  split_dbm_domain(bool is_bottom = false) : _is_bottom(is_bottom) {
-    g.growTo(1); // Allocate the zero vector
-    potential.push_back(Wt(0));
-    rev_map.push_back(boost::none);
+  split_dbm_domain(bool is_bottom = false)
+      : m_state(std::make_shared<dbm_state>()), _is_bottom(is_bottom) {
+    g().growTo(1); // Allocate the zero vector
+    potential().push_back(Wt(0));
+    rev_map().push_back(boost::none);
   }
 
-  // FIXME: Rewrite to avoid copying if o is _|_
   split_dbm_domain(const DBM_t &o)
-      : vert_map(o.vert_map), rev_map(o.rev_map), g(o.g),
-        potential(o.potential), unstable(o.unstable), _is_bottom(false) {
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+      : m_state(copy_state(o.m_state)), _is_bottom(o._is_bottom) {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
 
     CRAB_LOG("zones-split-size",
 	     auto p = size();
 	     print_dbm_size(p.first, p.second));
-    
-    if (o._is_bottom)
-      set_to_bottom();
 
     if (!_is_bottom)
-      assert(g.size() > 0);
+      assert(m_state->g.size() > 0);
   }
 
   split_dbm_domain(DBM_t &&o)
-      : vert_map(std::move(o.vert_map)), rev_map(std::move(o.rev_map)),
-        g(std::move(o.g)), potential(std::move(o.potential)),
-        unstable(std::move(o.unstable)), _is_bottom(o._is_bottom) {
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+      : m_state(std::move(o.m_state)), _is_bottom(o._is_bottom) {
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
   }
 
   split_dbm_domain &operator=(const split_dbm_domain &o) {
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
 
     if (this != &o) {
-      if (o._is_bottom) {
-        set_to_bottom();
-      } else {
-        _is_bottom = false;
-        vert_map = o.vert_map;
-        rev_map = o.rev_map;
-        g = o.g;
-        potential = o.potential;
-        unstable = o.unstable;
-        assert(g.size() > 0);
-      }
+      m_state = copy_state(o.m_state);
+      _is_bottom = o._is_bottom;
+      if (!_is_bottom)
+        assert(m_state->g.size() > 0);
     }
 
     CRAB_LOG("zones-split-size",
@@ -1345,18 +1556,12 @@ public:
   }
 
   split_dbm_domain &operator=(split_dbm_domain &&o) {
-    crab::CrabStats::count(domain_name() + ".count.copy");
-    crab::ScopedCrabStats __st__(domain_name() + ".copy");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".copy"));
 
-    if (o._is_bottom) {
-      set_to_bottom();
-    } else {
-      _is_bottom = false;
-      vert_map = std::move(o.vert_map);
-      rev_map = std::move(o.rev_map);
-      g = std::move(o.g);
-      potential = std::move(o.potential);
-      unstable = std::move(o.unstable);
+    if (this != &o) {
+      m_state = std::move(o.m_state);
+      _is_bottom = o._is_bottom;
     }
     return *this;
   }
@@ -1371,11 +1576,8 @@ public:
   }
 
   void set_to_bottom() override {
-    vert_map.clear();
-    rev_map.clear();
-    g.clear();
-    potential.clear();
-    unstable.clear();
+    // do not clear the state in place: it might be shared
+    m_state = std::make_shared<dbm_state>();
     _is_bottom = true;
   }
 
@@ -1384,12 +1586,12 @@ public:
   bool is_top() const override {
     if (_is_bottom)
       return false;
-    return g.is_empty();
+    return g().is_empty();
   }
 
   bool operator<=(const DBM_t &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.leq");
-    crab::ScopedCrabStats __st__(domain_name() + ".leq");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.leq"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".leq"));
 
     // cover all trivial cases to avoid allocating a dbm matrix
     if (is_bottom())
@@ -1406,44 +1608,44 @@ public:
 
 	wt_ref_t wx, wy;
 	
-	if (left.vert_map.size() < right.vert_map.size()) {
+	if (left.vert_map().size() < right.vert_map().size()) {
 	  return false;
 	}
 	
 	// Set up a mapping from o to this.
-	std::vector<unsigned int> vert_renaming(right.g.size(), -1);
+	std::vector<unsigned int> vert_renaming(right.g().size(), -1);
 	vert_renaming[0] = 0;
-	for (auto p : right.vert_map) {
-	  if (right.g.succs(p.second).size() == 0 &&
-	      right.g.preds(p.second).size() == 0)
+	for (auto p : right.vert_map()) {
+	  if (right.g().succs(p.second).size() == 0 &&
+	      right.g().preds(p.second).size() == 0)
 	    continue;
 	  
-	  auto it = left.vert_map.find(p.first);
+	  auto it = left.vert_map().find(p.first);
 	  // We can't have this <= o if we're missing some
 	  // vertex.
-	  if (it == left.vert_map.end())
+	  if (it == left.vert_map().end())
 	    return false;
 	  vert_renaming[p.second] = (*it).second;
 	  // vert_renaming[(*it).second] = p.second;
 	}
 	
-	assert(left.g.size() > 0);
+	assert(left.g().size() > 0);
 	// GrPerm g_perm(vert_renaming, g);
 	
-	for (vert_id ox : right.g.verts()) {
-	  if (right.g.succs(ox).size() == 0)
+	for (vert_id ox : right.g().verts()) {
+	  if (right.g().succs(ox).size() == 0)
 	    continue;
 	  
 	  assert(vert_renaming[ox] != -1);
 	  vert_id x = vert_renaming[ox];
-	  for (auto edge : right.g.e_succs(ox)) {
+	  for (auto edge : right.g().e_succs(ox)) {
 	    vert_id oy = edge.vert;
 	    assert(vert_renaming[oy] != -1);
 	    vert_id y = vert_renaming[oy];
 	    Wt ow = edge.val;
-	    if (left.g.lookup(x, y, wx) && (wx.get() <= ow))
+	    if (left.g().lookup(x, y, wx) && (wx.get() <= ow))
             continue;
-	    if (!left.g.lookup(x, 0, wx) || !left.g.lookup(0, y, wy))
+	    if (!left.g().lookup(x, 0, wx) || !left.g().lookup(0, y, wy))
 	      return false;
 	    if (!(wx.get() + wy.get() <= ow))
 	      return false;
@@ -1463,8 +1665,8 @@ public:
   }
 
   void operator|=(const DBM_t &o) override {
-    crab::CrabStats::count(domain_name() + ".count.join");
-    crab::ScopedCrabStats __st__(domain_name() + ".join");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.join"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".join"));
 
     CRAB_LOG("zones-split", crab::outs() << "Before join:\n"
                                          << "DBM 1\n"
@@ -1480,11 +1682,13 @@ public:
       // do nothing
     } else {
 
-      auto join_op = [this](DBM_t &left, const DBM_t& right)  {
+      // left is this DBM: its state is only read and then replaced
+      // by the result without being copied.
+      auto join_op = [this](const DBM_t &left, const DBM_t& right)  {
 	// Both left and right are normalized
 	
-	check_potential(left.g, left.potential, __LINE__);
-	check_potential(right.g, right.potential, __LINE__);
+	check_potential(left.g(), left.potential(), __LINE__);
+	check_potential(right.g(), right.potential(), __LINE__);
 	
 	// Figure out the common renaming, initializing the
 	// resulting potentials as we go.
@@ -1495,23 +1699,23 @@ public:
 	vert_map_t out_vmap;
 	rev_map_t out_revmap;
 	// Add the zero vertex
-	assert(left.potential.size() > 0);
+	assert(left.potential().size() > 0);
 	pot_rx.push_back(0);
 	pot_ry.push_back(0);
 	perm_x.push_back(0);
 	perm_y.push_back(0);
 	out_revmap.push_back(boost::none);
 	
-	for (auto p : left.vert_map) {
-	  auto it = right.vert_map.find(p.first);
+	for (auto p : left.vert_map()) {
+	  auto it = right.vert_map().find(p.first);
 	  // Variable exists in both
-	  if (it != right.vert_map.end()) {
+	  if (it != right.vert_map().end()) {
 	    out_vmap.insert(vmap_elt_t(p.first, perm_x.size()));
 	    out_revmap.push_back(p.first);
-	    pot_rx.push_back(left.potential[p.second] - left.potential[0]);
+	    pot_rx.push_back(left.potential()[p.second] - left.potential()[0]);
 	    // XXX JNL: check this out
 	    // pot_ry.push_back(right.potential[p.second] - right.potential[0]);
-	    pot_ry.push_back(right.potential[(*it).second] - right.potential[0]);
+	    pot_ry.push_back(right.potential()[(*it).second] - right.potential()[0]);
 	    perm_inv.push_back(p.first);
 	    perm_x.push_back(p.second);
 	    perm_y.push_back((*it).second);
@@ -1520,10 +1724,10 @@ public:
 	unsigned int sz = perm_x.size();
 	
 	// Build the permuted view of x and y.
-	assert(left.g.size() > 0);
-	GrPerm gx(perm_x, left.g);
-	assert(right.g.size() > 0);
-	GrPerm gy(perm_y, right.g);
+	assert(left.g().size() > 0);
+	GrPerm gx(perm_x, left.g());
+	assert(right.g().size() > 0);
+	GrPerm gy(perm_y, right.g());
 	
 	graph_t join_g = join(gx, gy, sz, pot_rx, pot_ry);
 	// Conjecture: join_g remains closed.
@@ -1541,13 +1745,9 @@ public:
 	  }
 	}
 	
-	left.vert_map = std::move(out_vmap);
-	left.rev_map = std::move(out_revmap);
-	left.g = std::move(join_g);
-	left.potential = std::move(pot_rx);
-	left.unstable.clear();
-	left._is_bottom = false;
-	CRAB_LOG("zones-split", crab::outs() << "Result join:\n" << left << "\n");
+	reset_state(std::move(out_vmap), std::move(out_revmap),
+		    std::move(join_g), std::move(pot_rx), vert_set_t());
+	CRAB_LOG("zones-split", crab::outs() << "Result join:\n" << *this << "\n");
     };
 
       DBM_t &left = *this;
@@ -1563,8 +1763,8 @@ public:
   }
 
   DBM_t operator|(const DBM_t &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.join");
-    crab::ScopedCrabStats __st__(domain_name() + ".join");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.join"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".join"));
 
     if (is_bottom()) {
       return o;
@@ -1583,8 +1783,8 @@ public:
       auto join_op = [this](const DBM_t &left, const DBM_t& right) -> DBM_t {
 	// Both left and right are normalized
 	
-	check_potential(left.g, left.potential, __LINE__);
-	check_potential(right.g, right.potential, __LINE__);
+	check_potential(left.g(), left.potential(), __LINE__);
+	check_potential(right.g(), right.potential(), __LINE__);
 	
 	// Figure out the common renaming, initializing the
 	// resulting potentials as we go.
@@ -1595,24 +1795,24 @@ public:
 	vert_map_t out_vmap;
 	rev_map_t out_revmap;
 	// Add the zero vertex
-	assert(left.potential.size() > 0);
+	assert(left.potential().size() > 0);
 	pot_rx.push_back(0);
 	pot_ry.push_back(0);
 	perm_x.push_back(0);
 	perm_y.push_back(0);
 	out_revmap.push_back(boost::none);
 	
-	for (auto p : left.vert_map) {
-	  auto it = right.vert_map.find(p.first);
+	for (auto p : left.vert_map()) {
+	  auto it = right.vert_map().find(p.first);
 	  // Variable exists in both
-	  if (it != right.vert_map.end()) {
+	  if (it != right.vert_map().end()) {
 	    out_vmap.insert(vmap_elt_t(p.first, perm_x.size()));
 	    out_revmap.push_back(p.first);
 	    
-	    pot_rx.push_back(left.potential[p.second] - left.potential[0]);
+	    pot_rx.push_back(left.potential()[p.second] - left.potential()[0]);
 	    // XXX JNL: check this out
 	    // pot_ry.push_back(right.potential[p.second] - right.potential[0]);
-	    pot_ry.push_back(right.potential[(*it).second] - right.potential[0]);
+	    pot_ry.push_back(right.potential()[(*it).second] - right.potential()[0]);
 	    perm_inv.push_back(p.first);
 	    perm_x.push_back(p.second);
 	    perm_y.push_back((*it).second);
@@ -1621,10 +1821,10 @@ public:
 	unsigned int sz = perm_x.size();
 	
 	// Build the permuted view of x and y.
-	assert(left.g.size() > 0);
-	GrPerm gx(perm_x, left.g);
-	assert(right.g.size() > 0);
-	GrPerm gy(perm_y, right.g);
+	assert(left.g().size() > 0);
+	GrPerm gx(perm_x, left.g());
+	assert(right.g().size() > 0);
+	GrPerm gy(perm_y, right.g());
 	
 	graph_t join_g = join(gx, gy, sz, pot_rx, pot_ry);
 	// Conjecture: join_g remains closed.
@@ -1673,8 +1873,8 @@ public:
   }
 
   DBM_t operator||(const DBM_t &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.widening");
-    crab::ScopedCrabStats __st__(domain_name() + ".widening");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.widening"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".widening"));
 
     if (is_bottom())
       return o;
@@ -1697,31 +1897,31 @@ public:
 	vert_map_t out_vmap;
 	rev_map_t out_revmap;
 	std::vector<Wt> widen_pot;
-	vert_set_t widen_unstable(left.unstable);
+	vert_set_t widen_unstable(left.unstable());
 	
-	assert(left.potential.size() > 0);
+	assert(left.potential().size() > 0);
 	widen_pot.push_back(Wt(0));
 	perm_x.push_back(0);
 	perm_y.push_back(0);
 	out_revmap.push_back(boost::none);
-	for (auto p : left.vert_map) {
-	  auto it = right.vert_map.find(p.first);
+	for (auto p : left.vert_map()) {
+	  auto it = right.vert_map().find(p.first);
 	  // Variable exists in both
-	  if (it != right.vert_map.end()) {
+	  if (it != right.vert_map().end()) {
 	    out_vmap.insert(vmap_elt_t(p.first, perm_x.size()));
 	    out_revmap.push_back(p.first);
 	    
-	    widen_pot.push_back(left.potential[p.second] - left.potential[0]);
+	    widen_pot.push_back(left.potential()[p.second] - left.potential()[0]);
 	    perm_x.push_back(p.second);
 	    perm_y.push_back((*it).second);
 	  }
 	}
 	
 	// Build the permuted view of x and y.
-	assert(left.g.size() > 0);
-	GrPerm gx(perm_x, left.g);
-	assert(right.g.size() > 0);
-	GrPerm gy(perm_y, right.g);
+	assert(left.g().size() > 0);
+	GrPerm gx(perm_x, left.g());
+	assert(right.g().size() > 0);
+	GrPerm gy(perm_y, right.g());
 	
 	// Now perform the widening
 	std::vector<vert_id> destabilized;
@@ -1755,8 +1955,8 @@ public:
   }
 
   void operator&=(const DBM_t &o) override {
-    crab::CrabStats::count(domain_name() + ".count.meet");
-    crab::ScopedCrabStats __st__(domain_name() + ".meet");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.meet"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".meet"));
 
     if (is_bottom() || o.is_top()) {
       // do nothing
@@ -1769,11 +1969,13 @@ public:
                                            << "DBM 2\n"
                                            << o << "\n");
 
-      auto meet_op = [this](DBM_t &left, const DBM_t & right) {
+      // left is this DBM: its state is only read and then replaced
+      // by the result without being copied.
+      auto meet_op = [this](const DBM_t &left, const DBM_t & right) {
 	// Both left and right are normalized
 	
-	check_potential(left.g, left.potential, __LINE__);
-	check_potential(right.g, right.potential, __LINE__);
+	check_potential(left.g(), left.potential(), __LINE__);
+	check_potential(right.g(), right.potential(), __LINE__);
 
 	// We map vertices in the left operand onto a contiguous range.
 	// This will often be the identity map, but there might be gaps.
@@ -1786,18 +1988,18 @@ public:
 	perm_y.push_back(0);
 	meet_pi.push_back(Wt(0));
 	meet_rev.push_back(boost::none);
-	for (auto p : left.vert_map) {
+	for (auto p : left.vert_map()) {
 	  vert_id vv = perm_x.size();
 	  meet_verts.insert(vmap_elt_t(p.first, vv));
 	  meet_rev.push_back(p.first);
 	  
 	  perm_x.push_back(p.second);
 	  perm_y.push_back(-1);
-	  meet_pi.push_back(left.potential[p.second] - left.potential[0]);
+	  meet_pi.push_back(left.potential()[p.second] - left.potential()[0]);
 	}
 	
 	// Add missing mappings from the right operand.
-	for (auto p : right.vert_map) {
+	for (auto p : right.vert_map()) {
 	  auto it = meet_verts.find(p.first);
 	  
 	  if (it == meet_verts.end()) {
@@ -1806,7 +2008,7 @@ public:
 	    
 	    perm_y.push_back(p.second);
 	    perm_x.push_back(-1);
-	    meet_pi.push_back(right.potential[p.second] - right.potential[0]);
+	    meet_pi.push_back(right.potential()[p.second] - right.potential()[0]);
 	    meet_verts.insert(vmap_elt_t(p.first, vv));
 	  } else {
 	    perm_y[(*it).second] = p.second;
@@ -1814,10 +2016,10 @@ public:
 	}
 	
 	// Build the permuted view of x and y.
-	assert(left.g.size() > 0);
-	GrPerm gx(perm_x, left.g);
-	assert(right.g.size() > 0);
-	GrPerm gy(perm_y, right.g);
+	assert(left.g().size() > 0);
+	GrPerm gx(perm_x, left.g());
+	assert(right.g().size() > 0);
+	GrPerm gy(perm_y, right.g());
 	
 	// Compute the syntactic meet of the permuted graphs.
 	bool is_closed;
@@ -1837,10 +2039,13 @@ public:
 	  SubGraph<graph_t> meet_g_excl(meet_g, 0);
 	  // GrOps::close_after_meet(meet_g_excl, meet_pi, gx, gy, delta);
 	  
-	  if (crab_domain_params_man::get().zones_chrome_dijkstra())
+	  if (close_dense(meet_g_excl, delta)) {
+	    // closed with the dense kernel
+	  } else if (crab_domain_params_man::get().zones_chrome_dijkstra()) {
 	    GrOps::close_after_meet(meet_g_excl, meet_pi, gx, gy, delta);
-	  else
+	  } else {
 	    GrOps::close_johnson(meet_g_excl, meet_pi, delta);
+	  }
 	  
 	  GrOps::apply_delta(meet_g, delta);
 	  
@@ -1867,14 +2072,10 @@ public:
 	check_potential(meet_g, meet_pi, __LINE__);
 
       
-	left.vert_map = std::move(meet_verts);
-	left.rev_map = std::move(meet_rev);
-	left.g = std::move(meet_g);
-	left.potential = std::move(meet_pi);
-	left.unstable.clear();
-	left._is_bottom = false;
-
-	CRAB_LOG("zones-split", crab::outs() << "Result meet:\n" << left << "\n");
+	reset_state(std::move(meet_verts), std::move(meet_rev),
+		    std::move(meet_g), std::move(meet_pi), vert_set_t());
+
+	CRAB_LOG("zones-split", crab::outs() << "Result meet:\n" << *this << "\n");
       };
 
       DBM_t &left = *this;
@@ -1892,8 +2093,8 @@ public:
 
   
   DBM_t operator&(const DBM_t &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.meet");
-    crab::ScopedCrabStats __st__(domain_name() + ".meet");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.meet"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".meet"));
 
     if (is_bottom() || o.is_top())
       return *this;
@@ -1908,8 +2109,8 @@ public:
 
       auto meet_op = [this](const DBM_t &left, const DBM_t &right) -> DBM_t {
 	// Both left and right are normalized 
-	check_potential(left.g, left.potential, __LINE__);
-	check_potential(right.g, right.potential, __LINE__);
+	check_potential(left.g(), left.potential(), __LINE__);
+	check_potential(right.g(), right.potential(), __LINE__);
 	
 	// We map vertices in the left operand onto a contiguous range.
 	// This will often be the identity map, but there might be gaps.
@@ -1922,18 +2123,18 @@ public:
 	perm_y.push_back(0);
 	meet_pi.push_back(Wt(0));
 	meet_rev.push_back(boost::none);
-	for (auto p : left.vert_map) {
+	for (auto p : left.vert_map()) {
 	  vert_id vv = perm_x.size();
 	  meet_verts.insert(vmap_elt_t(p.first, vv));
 	  meet_rev.push_back(p.first);
 	  
 	  perm_x.push_back(p.second);
 	  perm_y.push_back(-1);
-	  meet_pi.push_back(left.potential[p.second] - left.potential[0]);
+	  meet_pi.push_back(left.potential()[p.second] - left.potential()[0]);
 	}
 	
 	// Add missing mappings from the right operand.
-	for (auto p : right.vert_map) {
+	for (auto p : right.vert_map()) {
 	  auto it = meet_verts.find(p.first);
 	  
 	  if (it == meet_verts.end()) {
@@ -1942,7 +2143,7 @@ public:
 	    
 	    perm_y.push_back(p.second);
 	    perm_x.push_back(-1);
-	    meet_pi.push_back(right.potential[p.second] - right.potential[0]);
+	    meet_pi.push_back(right.potential()[p.second] - right.potential()[0]);
 	    meet_verts.insert(vmap_elt_t(p.first, vv));
 	  } else {
 	    perm_y[(*it).second] = p.second;
@@ -1950,10 +2151,10 @@ public:
 	}
 	
 	// Build the permuted view of x and y.
-	assert(left.g.size() > 0);
-	GrPerm gx(perm_x, left.g);
-	assert(right.g.size() > 0);
-	GrPerm gy(perm_y, right.g);
+	assert(left.g().size() > 0);
+	GrPerm gx(perm_x, left.g());
+	assert(right.g().size() > 0);
+	GrPerm gy(perm_y, right.g());
 	
 	// Compute the syntactic meet of the permuted graphs.
 	bool is_closed;
@@ -1974,10 +2175,13 @@ public:
 	  SubGraph<graph_t> meet_g_excl(meet_g, 0);
 	  // GrOps::close_after_meet(meet_g_excl, meet_pi, gx, gy, delta);
 	  
-	  if (crab_domain_params_man::get().zones_chrome_dijkstra())
+	  if (close_dense(meet_g_excl, delta)) {
+	    // closed with the dense kernel
+	  } else if (crab_domain_params_man::get().zones_chrome_dijkstra()) {
 	    GrOps::close_after_meet(meet_g_excl, meet_pi, gx, gy, delta);
-	  else
+	  } else {
 	    GrOps::close_johnson(meet_g_excl, meet_pi, delta);
+	  }
 	  
 	  GrOps::apply_delta(meet_g, delta);
 	  
@@ -2030,8 +2234,8 @@ public:
   }
 
   DBM_t operator&&(const DBM_t &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.narrowing");
-    crab::ScopedCrabStats __st__(domain_name() + ".narrowing");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.narrowing"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".narrowing"));
 
     if (is_bottom() || o.is_top())
       return *this;
@@ -2062,8 +2266,8 @@ public:
   }
 
   void normalize() override {
-    crab::CrabStats::count(domain_name() + ".count.normalize");
-    crab::ScopedCrabStats __st__(domain_name() + ".normalize");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.normalize"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".normalize"));
 
     // Always maintained in normal form, except for widening
     if (!need_normalization()) {
@@ -2073,44 +2277,47 @@ public:
     edge_vector delta;
     // GrOps::close_after_widen(g, potential, vert_set_wrap_t(unstable), delta);
     // GKG: Check
-    SubGraph<graph_t> g_excl(g, 0);
-    if (crab_domain_params_man::get().zones_widen_restabilize())
-      GrOps::close_after_widen(g_excl, potential, vert_set_wrap_t(unstable),
+    SubGraph<graph_t> g_excl(g(), 0);
+    if (close_dense(g_excl, delta)) {
+      // closed with the dense kernel
+    } else if (crab_domain_params_man::get().zones_widen_restabilize()) {
+      GrOps::close_after_widen(g_excl, potential(), vert_set_wrap_t(unstable()),
                                delta);
-    else
-      GrOps::close_johnson(g_excl, potential, delta);
+    } else {
+      GrOps::close_johnson(g_excl, potential(), delta);
+    }
     // Retrive variable bounds
-    GrOps::close_after_assign(g, potential, 0, delta);
+    GrOps::close_after_assign(g(), potential(), 0, delta);
 
-    GrOps::apply_delta(g, delta);
+    GrOps::apply_delta(g(), delta);
 
-    unstable.clear();
+    unstable().clear();
   }
 
   void minimize() override {}
 
   void operator-=(const variable_t &v) override {
-    crab::CrabStats::count(domain_name() + ".count.forget");
-    crab::ScopedCrabStats __st__(domain_name() + ".forget");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.forget"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".forget"));
 
     if (is_bottom())
       return;
     normalize();
 
-    auto it = vert_map.find(v);
-    if (it != vert_map.end()) {
+    auto it = vert_map().find(v);
+    if (it != vert_map().end()) {
       CRAB_LOG("zones-split", crab::outs() << "Before forget " << it->second
-                                           << ": " << g << "\n");
-      g.forget(it->second);
-      CRAB_LOG("zones-split", crab::outs() << "After: " << g << "\n");
-      rev_map[it->second] = boost::none;
-      vert_map.erase(v);
+                                           << ": " << g() << "\n");
+      g().forget(it->second);
+      CRAB_LOG("zones-split", crab::outs() << "After: " << g() << "\n");
+      rev_map()[it->second] = boost::none;
+      vert_map().erase(v);
     }
   }
 
   void assign(const variable_t &x, const linear_expression_t &e) override {
-    crab::CrabStats::count(domain_name() + ".count.assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".assign");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
 
     if (is_bottom()) {
       return;
@@ -2120,7 +2327,7 @@ public:
     CRAB_LOG("zones-split", crab::outs() << x << ":=" << e << "\n");
     normalize();
 
-    check_potential(g, potential, __LINE__);
+    check_potential(g(), potential(), __LINE__);
 
     interval_t x_int = eval_interval(e);
 
@@ -2176,14 +2383,14 @@ public:
             return;
           }
           // Allocate a new vertex for x
-          vert_id v = g.new_vertex();
-          assert(v <= rev_map.size());
-          if (v == rev_map.size()) {
-            rev_map.push_back(x);
-            potential.push_back(potential[0] + e_val);
+          vert_id v = g().new_vertex();
+          assert(v <= rev_map().size());
+          if (v == rev_map().size()) {
+            rev_map().push_back(x);
+            potential().push_back(potential()[0] + e_val);
           } else {
-            potential[v] = potential[0] + e_val;
-            rev_map[v] = x;
+            potential()[v] = potential()[0] + e_val;
+            rev_map()[v] = x;
           }
 
           edge_vector delta;
@@ -2196,32 +2403,32 @@ public:
           }
 
           // apply_delta should be safe here, as x has no edges in G.
-          GrOps::apply_delta(g, delta);
+          GrOps::apply_delta(g(), delta);
           delta.clear();
-          SubGraph<graph_t> g_excl(g, 0);
-          GrOps::close_after_assign(g_excl, potential, v, delta);
-          GrOps::apply_delta(g, delta);
+          SubGraph<graph_t> g_excl(g(), 0);
+          GrOps::close_after_assign(g_excl, potential(), v, delta);
+          GrOps::apply_delta(g(), delta);
 
           Wt_min min_op;
           if (lb_w) {
-            g.update_edge(v, *lb_w, 0, min_op);
+            g().update_edge(v, *lb_w, 0, min_op);
           }
           if (ub_w) {
-            g.update_edge(0, *ub_w, v, min_op);
+            g().update_edge(0, *ub_w, v, min_op);
           }
           // Clear the old x vertex
           operator-=(x);
-          vert_map.insert(vmap_elt_t(x, v));
+          vert_map().insert(vmap_elt_t(x, v));
         } else {
           // Assignment as a sequence of edge additions.
-          vert_id v = g.new_vertex();
-          assert(v <= rev_map.size());
-          if (v == rev_map.size()) {
-            rev_map.push_back(x);
-            potential.push_back(Wt(0));
+          vert_id v = g().new_vertex();
+          assert(v <= rev_map().size());
+          if (v == rev_map().size()) {
+            rev_map().push_back(x);
+            potential().push_back(Wt(0));
           } else {
-            potential[v] = Wt(0);
-            rev_map[v] = x;
+            potential()[v] = Wt(0);
+            rev_map()[v] = x;
           }
           Wt_min min_op;
           edge_vector cst_edges;
@@ -2237,26 +2444,26 @@ public:
           for (auto diff : cst_edges) {
             vert_id src = diff.first.first;
             vert_id dest = diff.first.second;
-            g.update_edge(src, diff.second, dest, min_op);
+            g().update_edge(src, diff.second, dest, min_op);
             if (!repair_potential(src, dest)) {
               assert(0 && "Unreachable");
               set_to_bottom();
             }
-            check_potential(g, potential, __LINE__);
+            check_potential(g(), potential(), __LINE__);
             close_over_edge(src, dest);
-            check_potential(g, potential, __LINE__);
+            check_potential(g(), potential(), __LINE__);
           }
 
           if (lb_w) {
-            g.update_edge(v, *lb_w, 0, min_op);
+            g().update_edge(v, *lb_w, 0, min_op);
           }
           if (ub_w) {
-            g.update_edge(0, *ub_w, v, min_op);
+            g().update_edge(0, *ub_w, v, min_op);
           }
 
           // Clear the old x vertex
           operator-=(x);
-          vert_map.insert(vmap_elt_t(x, v));
+          vert_map().insert(vmap_elt_t(x, v));
         }
       } else {
         set(x, x_int);
@@ -2267,15 +2474,15 @@ public:
     // this->operator-=(x);
     // g.check_adjs();
 
-    check_potential(g, potential, __LINE__);
+    check_potential(g(), potential(), __LINE__);
     CRAB_LOG("zones-split", crab::outs() << "---" << x << ":=" << e << "\n"
                                          << *this << "\n");
   }
 
   void apply(arith_operation_t op, const variable_t &x, const variable_t &y,
              const variable_t &z) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     if (is_bottom()) {
       return;
@@ -2316,8 +2523,8 @@ public:
 
   void apply(arith_operation_t op, const variable_t &x, const variable_t &y,
              number_t k) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     if (is_bottom()) {
       return;
@@ -2358,8 +2565,10 @@ public:
 
   void backward_assign(const variable_t &x, const linear_expression_t &e,
                        const DBM_t &inv) override {
-    crab::CrabStats::count(domain_name() + ".count.backward_assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".backward_assign");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_assign"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_assign"));
 
     crab::domains::BackwardAssignOps<DBM_t>::assign(*this, x, e, inv);
   }
@@ -2367,8 +2576,10 @@ public:
   void backward_apply(arith_operation_t op, const variable_t &x,
                       const variable_t &y, number_t z,
                       const DBM_t &inv) override {
-    crab::CrabStats::count(domain_name() + ".count.backward_apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".backward_apply");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_apply"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_apply"));
 
     crab::domains::BackwardAssignOps<DBM_t>::apply(*this, op, x, y, z, inv);
   }
@@ -2376,15 +2587,19 @@ public:
   void backward_apply(arith_operation_t op, const variable_t &x,
                       const variable_t &y, const variable_t &z,
                       const DBM_t &inv) override {
-    crab::CrabStats::count(domain_name() + ".count.backward_apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".backward_apply");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.backward_apply"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".backward_apply"));
 
     crab::domains::BackwardAssignOps<DBM_t>::apply(*this, op, x, y, z, inv);
   }
 
   void operator+=(const linear_constraint_t &cst) {
-    crab::CrabStats::count(domain_name() + ".count.add_constraints");
-    crab::ScopedCrabStats __st__(domain_name() + ".add_constraints");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.add_constraints"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".add_constraints"));
 
     if (cst.is_tautology()) {
       return;
@@ -2450,9 +2665,54 @@ public:
     if (is_bottom())
       return;
 
-    for (auto cst : csts) {
+    // Consecutive difference constraints are added as a batch. Other
+    // constraints flush the batch and are added one by one since
+    // they depend on the current bounds.
+    edge_vector batch;
+    auto flush_batch = [this, &batch]() {
+      if (!batch.empty()) {
+        crab::CrabStats::count(
+            CRAB_STATS_ID(domain_name() + ".count.add_constraints"));
+        crab::ScopedCrabStats __st__(
+            CRAB_STATS_ID(domain_name() + ".add_constraints"));
+        if (!add_diffcsts(batch)) {
+          set_to_bottom();
+        }
+        batch.clear();
+      }
+    };
+
+    normalize();
+    for (auto const &cst : csts) {
+      if (cst.is_tautology()) {
+        continue;
+      }
+      if (cst.is_inequality() || cst.is_equality()) {
+        unsigned num_edges = batch.size();
+        if (diffcst_edge_of_lin_leq(cst.expression(), batch) &&
+            (cst.is_inequality() ||
+             diffcst_edge_of_lin_leq(-cst.expression(), batch))) {
+          continue;
+        }
+        batch.erase(batch.begin() + num_edges, batch.end());
+      } else if (cst.is_strict_inequality()) {
+        auto nc =
+            ikos::linear_constraint_impl::strict_to_non_strict_inequality(cst);
+        if (nc.is_inequality() &&
+            diffcst_edge_of_lin_leq(nc.expression(), batch)) {
+          continue;
+        }
+      }
+      flush_batch();
+      if (is_bottom()) {
+        return;
+      }
       operator+=(cst);
+      if (is_bottom()) {
+        return;
+      }
     }
+    flush_batch();
   }
 
   virtual bool entails(const linear_constraint_t &cst) const override {	
@@ -2494,23 +2754,29 @@ public:
   }
   
   interval_t operator[](const variable_t &x) override {
-    crab::CrabStats::count(domain_name() + ".count.to_intervals");
-    crab::ScopedCrabStats __st__(domain_name() + ".to_intervals");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.to_intervals"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".to_intervals"));
     normalize();
+    // read-only: do not copy a shared state
+    const DBM_t &self = *this;
     return (is_bottom() ? interval_t::bottom() :
-	    get_interval(vert_map, g, x));    
+	    get_interval(self.vert_map(), self.g(), x));
   }
 
   interval_t at(const variable_t &x) const override {
-    crab::CrabStats::count(domain_name() + ".count.to_intervals");
-    crab::ScopedCrabStats __st__(domain_name() + ".to_intervals");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.to_intervals"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".to_intervals"));
     return (is_bottom() ? interval_t::bottom() :
-	    get_interval(vert_map, g, x));
+	    get_interval(vert_map(), g(), x));
   }
 
   void set(const variable_t &x, interval_t intv) {
-    crab::CrabStats::count(domain_name() + ".count.assign");
-    crab::ScopedCrabStats __st__(domain_name() + ".assign");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.assign"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".assign"));
 
     if (is_bottom())
       return;
@@ -2533,16 +2799,16 @@ public:
       if (overflow) {
         return;
       }
-      potential[v] = potential[0] + ub;
-      g.set_edge(0, ub, v);
+      potential()[v] = potential()[0] + ub;
+      g().set_edge(0, ub, v);
     }
     if (intv.lb().is_finite()) {
       Wt lb = ntow::convert(*(intv.lb().number()), overflow);
       if (overflow) {
         return;
       }
-      potential[v] = potential[0] + lb;
-      g.set_edge(v, -lb, 0);
+      potential()[v] = potential()[0] + lb;
+      g().set_edge(v, -lb, 0);
     }
   }
 
@@ -2555,8 +2821,8 @@ public:
   // bitwise_operators_api
   void apply(bitwise_operation_t op, const variable_t &x, const variable_t &y,
              const variable_t &z) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     if (is_bottom())
       return;
@@ -2597,8 +2863,8 @@ public:
 
   void apply(bitwise_operation_t op, const variable_t &x, const variable_t &y,
              number_t k) override {
-    crab::CrabStats::count(domain_name() + ".count.apply");
-    crab::ScopedCrabStats __st__(domain_name() + ".apply");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.apply"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".apply"));
 
     if (is_bottom())
       return;
@@ -2648,8 +2914,8 @@ public:
   DEFAULT_WEAK_ASSIGN(DBM_t)
     
   void project(const variable_vector_t &variables) override {
-    crab::CrabStats::count(domain_name() + ".count.project");
-    crab::ScopedCrabStats __st__(domain_name() + ".project");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.project"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".project"));
 
     if (is_bottom() || is_top()) {
       return;
@@ -2662,24 +2928,24 @@ public:
 
     normalize();
 
-    std::vector<bool> save(rev_map.size(), false);
+    std::vector<bool> save(rev_map().size(), false);
     for (auto x : variables) {
-      auto it = vert_map.find(x);
-      if (it != vert_map.end())
+      auto it = vert_map().find(x);
+      if (it != vert_map().end())
         save[(*it).second] = true;
     }
 
-    for (vert_id v = 0; v < rev_map.size(); v++) {
-      if (!save[v] && rev_map[v]) {
-        variable_t vv = *rev_map[v];
+    for (vert_id v = 0; v < rev_map().size(); v++) {
+      if (!save[v] && rev_map()[v]) {
+        variable_t vv = *rev_map()[v];
         operator-=(vv);
       }
     }
   }
 
   void forget(const variable_vector_t &variables) override {
-    crab::CrabStats::count(domain_name() + ".count.forget");
-    crab::ScopedCrabStats __st__(domain_name() + ".forget");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.forget"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".forget"));
 
     if (is_bottom() || is_top()) {
       return;
@@ -2691,8 +2957,8 @@ public:
   }
 
   void expand(const variable_t &x, const variable_t &y) override {
-    crab::CrabStats::count(domain_name() + ".count.expand");
-    crab::ScopedCrabStats __st__(domain_name() + ".expand");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.expand"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".expand"));
 
     if (is_bottom() || is_top()) {
       return;
@@ -2702,24 +2968,24 @@ public:
                                          << y << ":\n"
                                          << *this << "\n");
 
-    auto it = vert_map.find(y);
-    if (it != vert_map.end()) {
+    auto it = vert_map().find(y);
+    if (it != vert_map().end()) {
       CRAB_ERROR("split_dbm expand operation failed because y already exists");
     }
 
     vert_id ii = get_vert(x);
     vert_id jj = get_vert(y);
     edge_vector delta;
-    for (auto edge : g.e_preds(ii)) {
+    for (auto edge : g().e_preds(ii)) {
       delta.push_back({{edge.vert, jj}, edge.val});
     }
 
-    for (auto edge : g.e_succs(ii)) {
+    for (auto edge : g().e_succs(ii)) {
       delta.push_back({{jj, edge.vert}, edge.val});
     }
-    GrOps::apply_delta(g, delta);
+    GrOps::apply_delta(g(), delta);
 
-    potential[jj] = potential[ii];
+    potential()[jj] = potential()[ii];
 
     CRAB_LOG("zones-split", crab::outs() << "After expand " << x << " into "
                                          << y << ":\n"
@@ -2728,8 +2994,8 @@ public:
 
   void rename(const variable_vector_t &from,
               const variable_vector_t &to) override {
-    crab::CrabStats::count(domain_name() + ".count.rename");
-    crab::ScopedCrabStats __st__(domain_name() + ".rename");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.rename"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".rename"));
 
     if (is_top() || is_bottom())
       return;
@@ -2753,22 +3019,22 @@ public:
       { // We do garbage collection of unconstrained variables only
         // after joins so it's possible to find new_v but we are ok as
         // long as it's unconstrained.
-        auto it = vert_map.find(new_v);
-        if (it != vert_map.end()) {
+        auto it = vert_map().find(new_v);
+        if (it != vert_map().end()) {
           vert_id dim = it->second;
-          if (g.succs(dim).size() != 0 || g.preds(dim).size() != 0) {
+          if (g().succs(dim).size() != 0 || g().preds(dim).size() != 0) {
             CRAB_ERROR(domain_name() + "::rename assumes that ", new_v,
                        " does not exist");
           }
         }
       }
 
-      auto it = vert_map.find(v);
-      if (it != vert_map.end()) {
+      auto it = vert_map().find(v);
+      if (it != vert_map().end()) {
         vert_id dim = it->second;
-        vert_map.erase(it);
-        vert_map.insert(vmap_elt_t(new_v, dim));
-        rev_map[dim] = new_v;
+        vert_map().erase(it);
+        vert_map().insert(vmap_elt_t(new_v, dim));
+        rev_map()[dim] = new_v;
       }
     }
 
@@ -2777,23 +3043,25 @@ public:
 
   void extract(const variable_t &x, linear_constraint_system_t &csts,
                bool only_equalities) {
-    crab::CrabStats::count(domain_name() + ".count.extract");
-    crab::ScopedCrabStats __st__(domain_name() + ".extract");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.extract"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".extract"));
 
     normalize();
     if (is_bottom()) {
       return;
     }
 
-    auto it = vert_map.find(x);
-    if (it != vert_map.end()) {
+    // read-only: do not copy a shared state
+    const DBM_t &self = *this;
+    auto it = self.vert_map().find(x);
+    if (it != self.vert_map().end()) {
       vert_id s = (*it).second;
-      if (rev_map[s]) {
-        variable_t vs = *rev_map[s];
-        SubGraph<graph_t> g_excl(g, 0);
+      if (self.rev_map()[s]) {
+        variable_t vs = *self.rev_map()[s];
+        SubGraph<graph_t> g_excl(self.g(), 0);
         for (vert_id d : g_excl.verts()) {
-          if (rev_map[d]) {
-            variable_t vd = *rev_map[d];
+          if (self.rev_map()[d]) {
+            variable_t vd = *self.rev_map()[d];
             // We give priority to equalities since some domains
             // might not understand inequalities
             if (g_excl.elem(s, d) && g_excl.elem(d, s) &&
@@ -2835,8 +3103,8 @@ public:
 
   // Output function
   void write(crab_os &o) const override {
-    crab::CrabStats::count(domain_name() + ".count.write");
-    crab::ScopedCrabStats __st__(domain_name() + ".write");
+    crab::CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.write"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID(domain_name() + ".write"));
 
     // linear_constraint_system_t inv = to_linear_constraint_system();
     // o << inv;
@@ -2851,8 +3119,10 @@ public:
   }
 
   linear_constraint_system_t to_linear_constraint_system() const override {
-    crab::CrabStats::count(domain_name() + ".count.to_linear_constraints");
-    crab::ScopedCrabStats __st__(domain_name() + ".to_linear_constraints");
+    crab::CrabStats::count(
+        CRAB_STATS_ID(domain_name() + ".count.to_linear_constraints"));
+    crab::ScopedCrabStats __st__(
+        CRAB_STATS_ID(domain_name() + ".to_linear_constraints"));
 
     if (need_normalization()) {
       DBM_t tmp(*this);
@@ -2877,7 +3147,7 @@ public:
 
   // return number of vertices and edges
   std::pair<std::size_t, std::size_t> size() const {
-    return {g.size(), g.num_edges()};
+    return {g().size(), g().num_edges()};
   }
 
   std::string domain_name() const override { return "SplitDBM"; }
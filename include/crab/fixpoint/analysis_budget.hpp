@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace crab {
+
+/**
+ * A wall-time budget shared by several fixpoint computations (e.g.,
+ * all the functions of an inter-procedural analysis).
+ *
+ * It also records the functions whose analysis has been degraded
+ * because some budget was exhausted. The budget can be queried and
+ * updated concurrently.
+ **/
+class analysis_budget {
+  using clock_t = std::chrono::steady_clock;
+
+  // in milliseconds. 0 means no limit.
+  unsigned m_max_time;
+  clock_t::time_point m_start;
+  // protect m_degraded
+  mutable std::mutex m_mutex;
+  std::set<std::string> m_degraded;
+
+public:
+  explicit analysis_budget(unsigned max_time = 0)
+      : m_max_time(max_time), m_start(clock_t::now()) {}
+
+  analysis_budget(const analysis_budget &o) = delete;
+
+  analysis_budget &operator=(const analysis_budget &o) = delete;
+
+  unsigned get_max_time() const { return m_max_time; }
+
+  void set_max_time(unsigned max_time) { m_max_time = max_time; }
+
+  // Start counting time from now and forget the degraded functions
+  void start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_start = clock_t::now();
+    m_degraded.clear();
+  }
+
+  bool is_exhausted() const {
+    if (m_max_time == 0) {
+      return false;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        clock_t::now() - m_start);
+    return elapsed.count() >= m_max_time;
+  }
+
+  void add_degraded(const std::string &func_name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_degraded.insert(func_name);
+  }
+
+  bool is_degraded(const std::string &func_name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_degraded.count(func_name) > 0;
+  }
+
+  // Return the names of the degraded functions in alphabetical order
+  std::vector<std::string> get_degraded() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::vector<std::string>(m_degraded.begin(), m_degraded.end());
+  }
+};
+
+} // end namespace crab
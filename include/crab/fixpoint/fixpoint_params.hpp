@@ -2,6 +2,8 @@
 
 namespace crab {
 
+class analysis_budget;
+
 /** Class to group together all the fixpoint parameters **/
 class fixpoint_parameters {
   // number of iterations until widening operator is called.
@@ -16,6 +18,38 @@ class fixpoint_parameters {
   // that collects at most max_thresholds per wto cycle. This
   // means that each wto cycle has its own set of thresholds.
   unsigned max_thresholds;
+  // Number of threads used to stabilize the top-level components of
+  // the WTO. If greater than one then components that do not depend
+  // on each other are analyzed concurrently. This only takes effect
+  // if the abstract transformer supports it, and it requires the
+  // abstract domain to be thread-safe.
+  unsigned num_threads;
+  // If true then only the invariants at the heads of the WTO cycles,
+  // the entry and exit blocks and the blocks requested by the client
+  // are kept once the fixpoint has been reached. The invariants of
+  // any other block are recomputed on demand from the closest stored
+  // ones. This only makes sense if the transfer function of a block
+  // has no side effects.
+  bool keep_only_cycle_heads;
+  // Maximum number of recomputed invariants that are kept in a cache
+  // if keep_only_cycle_heads is enabled.
+  unsigned invariant_cache_size;
+  // Budgets checked each time a WTO cycle is iterated. 0 means no
+  // limit. Once a budget is exceeded the cycle is widened at the next
+  // iteration regardless of widening_delay and max_thresholds, and if
+  // it is still not stable the head of the cycle is set to top. No
+  // descending iterations are done afterwards.
+  //
+  // maximum time in milliseconds to analyze a CFG
+  unsigned max_time;
+  // maximum number of increasing iterations over a WTO cycle
+  unsigned max_cycle_iterations;
+  // maximum number of linear constraints of the invariant at the head
+  // of a WTO cycle
+  unsigned max_state_size;
+  // time budget shared with other CFGs. It also records the CFGs
+  // whose analysis has been degraded. Not owned and can be null.
+  analysis_budget *global_budget;
 
 public:
   
@@ -23,7 +57,15 @@ public:
     widening_delay(2),
     descending_iterations(1),
     // Set to 0 to disable widening with thresholds
-    max_thresholds(0) {}
+    max_thresholds(0),
+    // Set to 1 to analyze sequentially
+    num_threads(1),
+    keep_only_cycle_heads(false),
+    // Set to 0 to disable the cache
+    invariant_cache_size(0),
+    // Set to 0 for no limit
+    max_time(0), max_cycle_iterations(0), max_state_size(0),
+    global_budget(nullptr) {}
 
   unsigned get_widening_delay() const { return widening_delay; }
   unsigned& get_widening_delay() { return widening_delay; }  
@@ -33,6 +75,27 @@ public:
 
   unsigned get_max_thresholds() const { return max_thresholds; }
   unsigned& get_max_thresholds() { return max_thresholds; }  
+
+  unsigned get_num_threads() const { return num_threads; }
+  unsigned& get_num_threads() { return num_threads; }
+
+  bool get_keep_only_cycle_heads() const { return keep_only_cycle_heads; }
+  bool& get_keep_only_cycle_heads() { return keep_only_cycle_heads; }
+
+  unsigned get_invariant_cache_size() const { return invariant_cache_size; }
+  unsigned& get_invariant_cache_size() { return invariant_cache_size; }
+
+  unsigned get_max_time() const { return max_time; }
+  unsigned& get_max_time() { return max_time; }
+
+  unsigned get_max_cycle_iterations() const { return max_cycle_iterations; }
+  unsigned& get_max_cycle_iterations() { return max_cycle_iterations; }
+
+  unsigned get_max_state_size() const { return max_state_size; }
+  unsigned& get_max_state_size() { return max_state_size; }
+
+  analysis_budget *get_global_budget() const { return global_budget; }
+  analysis_budget *&get_global_budget() { return global_budget; }
 };
   
 } // end namespace crab 
@@ -44,14 +44,28 @@
 #pragma once
 
 #include <crab/cfg/cfg_bgl.hpp> // needed by wto
+#include <crab/fixpoint/analysis_budget.hpp>
 #include <crab/fixpoint/fixpoint_iterators_api.hpp>
 #include <crab/fixpoint/fixpoint_params.hpp>
+#include <crab/fixpoint/invariant_table.hpp>
 #include <crab/fixpoint/thresholds.hpp>
 #include <crab/fixpoint/wto.hpp>
 #include <crab/support/debug.hpp>
+#include <crab/support/lru_cache.hpp>
 #include <crab/support/stats.hpp>
+#include <crab/support/thread_pool.hpp>
 
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace ikos {
 
@@ -61,6 +75,9 @@ template <typename CFG, typename AbstractValue> class wto_iterator;
 
 template <typename CFG, typename AbstractValue> class wto_processor;
 
+using wto_impl::has_block_index;
+using wto_impl::no_vertex_id;
+
 } // namespace interleaved_fwd_fixpoint_iterator_impl
 
 // for debugging only
@@ -83,10 +100,10 @@ public:
   using basic_block_t = typename CFG::basic_block_t;
   using basic_block_label_t = typename CFG::basic_block_label_t;
   using wto_t = wto<CFG>;
+  using wto_component_t = wto_component<CFG>;
   using assumption_map_t =
       std::unordered_map<basic_block_label_t, AbstractValue>;
-  using invariant_table_t =
-      std::unordered_map<basic_block_label_t, AbstractValue>;
+  using invariant_table_t = invariant_table<basic_block_label_t, AbstractValue>;
 
 private:
   using wto_iterator_t =
@@ -96,7 +113,59 @@ private:
   using thresholds_t = crab::thresholds<typename CFG::number_t>;
   using wto_thresholds_t = crab::wto_thresholds<CFG>;
   using thresholds_map_t = typename wto_thresholds_t::thresholds_map_t;
-  
+
+  // Map each node of a WTO component to the index of the component
+  class component_index_builder : public wto_component_visitor<CFG> {
+    std::unordered_map<basic_block_label_t, unsigned> &m_index;
+    unsigned m_component;
+
+  public:
+    using wto_vertex_t = wto_vertex<CFG>;
+    using wto_cycle_t = wto_cycle<CFG>;
+
+    component_index_builder(
+        std::unordered_map<basic_block_label_t, unsigned> &index,
+        unsigned component)
+        : m_index(index), m_component(component) {}
+
+    virtual void visit(wto_vertex_t &vertex) override {
+      m_index[vertex.node()] = m_component;
+    }
+
+    virtual void visit(wto_cycle_t &cycle) override {
+      m_index[cycle.head()] = m_component;
+      for (auto &c : cycle) {
+        c.accept(this);
+      }
+    }
+  };
+
+  // Collect the nodes of a WTO component and the heads of its cycles
+  class component_member_collector : public wto_component_visitor<CFG> {
+    std::vector<basic_block_label_t> &m_members;
+    std::unordered_set<basic_block_label_t> &m_heads;
+
+  public:
+    using wto_vertex_t = wto_vertex<CFG>;
+    using wto_cycle_t = wto_cycle<CFG>;
+
+    component_member_collector(std::vector<basic_block_label_t> &members,
+                               std::unordered_set<basic_block_label_t> &heads)
+        : m_members(members), m_heads(heads) {}
+
+    virtual void visit(wto_vertex_t &vertex) override {
+      m_members.push_back(vertex.node());
+    }
+
+    virtual void visit(wto_cycle_t &cycle) override {
+      m_members.push_back(cycle.head());
+      m_heads.insert(cycle.head());
+      for (auto &c : cycle) {
+        c.accept(this);
+      }
+    }
+  };
+
 protected:
   using iterator = typename invariant_table_t::iterator;
   using const_iterator = typename invariant_table_t::const_iterator;
@@ -114,50 +183,362 @@ protected:
   bool m_enable_processor;
   
 private:
+  using block_ids_t = typename invariant_table_t::slot_map_t;
+
   // We don't want derived classes to access directly to m_pre and
   // m_post in case we make internal changes
   invariant_table_t m_pre, m_post;
+  // If the block index of the CFG is built when the fixpoint starts:
+  // the dense id of each block. The invariant tables are then indexed
+  // by block id and the WTO components carry the ids of their blocks
+  // so that the fixpoint does not hash labels.
+  std::shared_ptr<const block_ids_t> m_block_ids;
+  // not null only while the WTO components are analyzed in parallel
+  crab::thread_pool *m_pool;
+  // If only the invariants at the heads of the WTO cycles are kept:
+  // blocks whose invariants must be kept as well
+  std::unordered_set<basic_block_label_t> m_requested;
+  // blocks whose post invariant has not been removed yet because it
+  // is read by a later WTO component
+  std::vector<basic_block_label_t> m_pending;
+  // recently recomputed invariants
+  mutable crab::lru_cache<basic_block_label_t, AbstractValue> m_pre_cache;
+  mutable crab::lru_cache<basic_block_label_t, AbstractValue> m_post_cache;
+  mutable std::mutex m_cache_mutex;
+  // time at which the last run started
+  std::chrono::steady_clock::time_point m_start;
+  // whether some budget was exceeded during the last run
+  std::atomic<bool> m_degraded;
+
+  // Whether id is the dense id of a block in the invariant tables
+  bool is_block_id(unsigned id) const {
+    return m_block_ids &&
+           id != interleaved_fwd_fixpoint_iterator_impl::no_vertex_id;
+  }
+
+  // id is the dense id of node or no_vertex_id if it is unknown
+  inline void set_pre(basic_block_label_t node, unsigned id,
+                      const AbstractValue &v) {
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.invariant_table.update"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.invariant_table.update"));
+    if (is_block_id(id)) {
+      m_pre.insert_or_assign_by_id(id, node, v);
+    } else {
+      m_pre.insert_or_assign(node, v);
+    }
+  }
 
   inline void set_pre(basic_block_label_t node, const AbstractValue &v) {
-    crab::CrabStats::count("Fixpo.invariant_table.update");
-    crab::ScopedCrabStats __st__("Fixpo.invariant_table.update");
-    // To avoid calling the default constructor
-    // m_pre[node] = v;
+    set_pre(node, interleaved_fwd_fixpoint_iterator_impl::no_vertex_id, v);
+  }
 
-    auto res = m_pre.insert({node, v});
-    if (!res.second) {
-      // if the insertion failed then we just update value
-      res.first->second = v;
+  inline void set_post(basic_block_label_t node, unsigned id,
+                       AbstractValue &&v) {
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.invariant_table.update"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.invariant_table.update"));
+    if (is_block_id(id)) {
+      m_post.insert_or_assign_by_id(id, node, std::move(v));
+    } else {
+      m_post.insert_or_assign(node, std::move(v));
     }
   }
 
   inline void set_post(basic_block_label_t node, AbstractValue &&v) {
-    crab::CrabStats::count("Fixpo.invariant_table.update");
-    crab::ScopedCrabStats __st__("Fixpo.invariant_table.update");
-    // To avoid calling the default constructor
-    // m_post[node] = std::move(v);
-
-    auto it = m_post.find(node);
-    if (it == m_post.end()) {
-      m_post.insert({node, std::move(v)});
-    } else {
-      it->second = std::move(v);
-    }
+    set_post(node, interleaved_fwd_fixpoint_iterator_impl::no_vertex_id,
+             std::move(v));
   }
 
   inline AbstractValue get(const invariant_table_t &table,
                            basic_block_label_t node) const {
-    crab::CrabStats::count("Fixpo.invariant_table.lookup");
-    crab::ScopedCrabStats __st__("Fixpo.invariant_table.lookup");
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.invariant_table.lookup"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.invariant_table.lookup"));
     return table.at(node);
   }
 
+  void build_block_ids(std::false_type) { m_block_ids.reset(); }
+
+  void build_block_ids(std::true_type) {
+    m_block_ids.reset();
+    if (!m_cfg.is_indexed()) {
+      return;
+    }
+    std::shared_ptr<block_ids_t> ids = std::make_shared<block_ids_t>();
+    for (auto it = m_cfg.label_begin(), et = m_cfg.label_end(); it != et; ++it) {
+      ids->insert({*it, m_cfg.block_id(*it)});
+    }
+    m_block_ids = std::move(ids);
+  }
+
+  AbstractValue join_predecessors(basic_block_label_t node, unsigned id,
+                                  std::false_type) {
+    AbstractValue pre = m_absval_fac.make_bottom();
+    for (basic_block_label_t prev : m_cfg.prev_nodes(node)) {
+      pre |= get(m_post, prev);
+    }
+    return pre;
+  }
+
+  AbstractValue join_predecessors(basic_block_label_t node, unsigned id,
+                                  std::true_type) {
+    if (!is_block_id(id)) {
+      return join_predecessors(node, id, std::false_type());
+    }
+    AbstractValue pre = m_absval_fac.make_bottom();
+    for (unsigned prev : m_cfg.prev_ids(id)) {
+      if (const AbstractValue *post = m_post.find_by_id(prev)) {
+        pre |= *post;
+      } else {
+        // the invariant is no longer stored
+        pre |= get_post(m_cfg.block_label(prev));
+      }
+    }
+    return pre;
+  }
+
+  // Return the join of the post invariants of all the predecessors
+  // of node. id is the dense id of node or no_vertex_id.
+  AbstractValue join_predecessors(basic_block_label_t node, unsigned id) {
+    return join_predecessors(
+        node, id,
+        interleaved_fwd_fixpoint_iterator_impl::has_block_index<CFG>());
+  }
+
+  void forget_post(basic_block_label_t node) { m_post.erase(node); }
+
+  bool is_kept(basic_block_label_t node,
+               const std::unordered_set<basic_block_label_t> &heads) const {
+    return heads.count(node) > 0 || m_requested.count(node) > 0 ||
+           node == m_cfg.entry() || (m_cfg.has_exit() && node == m_cfg.exit());
+  }
+
+  // Remove the invariants of the nodes of a stabilized top-level WTO
+  // component that are not kept. The post invariant of a node with a
+  // successor outside the component is still read by the next
+  // components so it is only removed by forget_pending_invariants.
+  void forget_invariants(wto_component_t &c) {
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.forget_invariants"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.forget_invariants"));
+    std::vector<basic_block_label_t> members;
+    std::unordered_set<basic_block_label_t> heads;
+    component_member_collector collector(members, heads);
+    c.accept(&collector);
+    std::unordered_set<basic_block_label_t> member_set(members.begin(),
+                                                       members.end());
+    for (basic_block_label_t node : members) {
+      if (is_kept(node, heads)) {
+        continue;
+      }
+      m_pre.erase(node);
+      bool is_read_later = false;
+      for (basic_block_label_t succ : m_cfg.next_nodes(node)) {
+        if (member_set.count(succ) == 0) {
+          is_read_later = true;
+          break;
+        }
+      }
+      if (is_read_later) {
+        m_pending.push_back(node);
+      } else {
+        forget_post(node);
+      }
+    }
+  }
+
+  void forget_pending_invariants() {
+    for (basic_block_label_t node : m_pending) {
+      forget_post(node);
+    }
+    m_pending.clear();
+  }
+
+  // Recompute the invariant that holds at the entry of node, or at
+  // its exit if post is true, after it has been removed by
+  // forget_invariants.
+  //
+  // Every cycle of the CFG goes through the head of a WTO cycle whose
+  // invariants are kept. Thus, the post invariants of the
+  // predecessors of node are computed, in postorder, by replaying
+  // the transfer function from the closest blocks with a stored pre
+  // or post invariant. Since the post invariant of a head is the one
+  // computed during the last iteration over its cycle, the replay
+  // yields the same invariants as if all of them had been kept.
+  AbstractValue recompute(basic_block_label_t node, bool post) const {
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.recompute"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.recompute"));
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    if (const AbstractValue *inv =
+            post ? m_post_cache.find(node) : m_pre_cache.find(node)) {
+      return *inv;
+    }
+
+    invariant_table_t new_pre, new_post;
+    auto find_post =
+        [this, &new_post](basic_block_label_t n) -> const AbstractValue * {
+      auto it = m_post.find(n);
+      if (it != m_post.end()) {
+        return &it->second;
+      }
+      it = new_post.find(n);
+      if (it != new_post.end()) {
+        return &it->second;
+      }
+      return m_post_cache.find(n);
+    };
+    auto has_pre = [this](basic_block_label_t n) {
+      return m_pre.count(n) > 0 || m_pre_cache.find(n) != nullptr;
+    };
+    auto join_posts = [this, &find_post](basic_block_label_t n) {
+      AbstractValue pre = m_absval_fac.make_bottom();
+      for (basic_block_label_t prev : m_cfg.prev_nodes(n)) {
+        const AbstractValue *prev_post = find_post(prev);
+        if (!prev_post) {
+          CRAB_ERROR("fixpoint: cannot recompute the invariants of ",
+                     crab::basic_block_traits<basic_block_t>::to_string(n));
+        }
+        pre |= *prev_post;
+      }
+      return pre;
+    };
+
+    // Blocks whose post invariant must be recomputed, in postorder
+    std::vector<basic_block_label_t> order;
+    std::unordered_set<basic_block_label_t> visited;
+    std::vector<std::pair<basic_block_label_t, bool>> stack;
+    auto push_missing_preds = [&](basic_block_label_t n) {
+      for (basic_block_label_t prev : m_cfg.prev_nodes(n)) {
+        if (!find_post(prev) && visited.insert(prev).second) {
+          stack.emplace_back(prev, false);
+        }
+      }
+    };
+    if (post) {
+      visited.insert(node);
+      stack.emplace_back(node, false);
+    } else {
+      push_missing_preds(node);
+    }
+    while (!stack.empty()) {
+      if (stack.back().second) {
+        order.push_back(stack.back().first);
+        stack.pop_back();
+      } else {
+        stack.back().second = true;
+        basic_block_label_t n = stack.back().first;
+        if (!has_pre(n)) {
+          push_missing_preds(n);
+        }
+      }
+    }
+
+    // The caches are only updated at the end so that no entry read
+    // here is evicted.
+    auto *self = const_cast<interleaved_fwd_fixpoint_iterator *>(this);
+    for (basic_block_label_t n : order) {
+      AbstractValue pre = std::move(m_absval_fac.make_top());
+      auto it = m_pre.find(n);
+      if (it != m_pre.end()) {
+        pre = it->second;
+      } else if (const AbstractValue *inv = m_pre_cache.find(n)) {
+        pre = *inv;
+      } else {
+        pre = join_posts(n);
+        new_pre.insert({n, pre});
+      }
+      new_post.insert({n, self->analyze(n, std::move(pre))});
+    }
+
+    AbstractValue res = post ? new_post.at(node) : join_posts(node);
+    for (auto &kv : new_pre) {
+      m_pre_cache.insert(kv.first, std::move(kv.second));
+    }
+    for (auto &kv : new_post) {
+      m_post_cache.insert(kv.first, std::move(kv.second));
+    }
+    if (post) {
+      m_post_cache.insert(node, res);
+    } else {
+      m_pre_cache.insert(node, res);
+    }
+    return res;
+  }
+
+  // Stabilize the top-level components of the WTO one after the
+  // other and remove the invariants that are not kept as soon as
+  // each component is stabilized.
+  void run_and_forget() {
+    bool first = true;
+    for (auto &c : m_wto) {
+      // Only the first component contains the entry of the CFG
+      wto_iterator_t iterator(this, m_absval_fac, first);
+      c.accept(&iterator);
+      if (m_enable_processor) {
+        wto_processor_t processor(this);
+        c.accept(&processor);
+      }
+      forget_invariants(c);
+      first = false;
+    }
+    forget_pending_invariants();
+  }
+
+  void start_budget() {
+    m_start = std::chrono::steady_clock::now();
+    m_degraded = false;
+  }
+
+  bool is_time_exhausted() const {
+    if (m_params.get_max_time() > 0) {
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - m_start);
+      if (elapsed.count() >= m_params.get_max_time()) {
+        return true;
+      }
+    }
+    const crab::analysis_budget *global = m_params.get_global_budget();
+    return global && global->is_exhausted();
+  }
+
+  // Return true if some budget is exceeded after iteration increasing
+  // iterations over a WTO cycle. inv is the new invariant at the
+  // head of the cycle.
+  bool is_budget_exhausted(unsigned int iteration,
+                           const AbstractValue &inv) const {
+    if (m_params.get_max_cycle_iterations() > 0 &&
+        iteration >= m_params.get_max_cycle_iterations()) {
+      return true;
+    }
+    if (m_params.get_max_state_size() > 0 &&
+        inv.to_linear_constraint_system().size() >
+            m_params.get_max_state_size()) {
+      return true;
+    }
+    return is_time_exhausted();
+  }
+
+  // Record that the analysis of the cycle with head node has been
+  // degraded.
+  void degrade(basic_block_label_t node) {
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.degraded_cycles"));
+    CRAB_VERBOSE_IF(
+        1, crab::get_msg_stream()
+               << "Budget exceeded at " << func_name(m_cfg) << "::"
+               << crab::basic_block_traits<basic_block_t>::to_string(node)
+               << "\n";);
+    if (!m_degraded.exchange(true)) {
+      crab::CrabStats::count(CRAB_STATS_ID("Fixpo.degraded_cfgs"));
+      if (crab::analysis_budget *global = m_params.get_global_budget()) {
+        global->add_degraded(func_name(m_cfg));
+      }
+    }
+  }
+
   inline AbstractValue extrapolate(basic_block_label_t node,
                                    unsigned int iteration,
                                    AbstractValue &before,
                                    AbstractValue &after) {
-    crab::CrabStats::count("Fixpo.extrapolate");
-    crab::ScopedCrabStats __st__("Fixpo.extrapolate");
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.extrapolate"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.extrapolate"));
 
     CRAB_VERBOSE_IF(
         1, crab::get_msg_stream()
@@ -204,8 +585,8 @@ private:
 
   inline AbstractValue refine(basic_block_label_t node, unsigned int iteration,
                               AbstractValue &before, AbstractValue &after) {
-    crab::CrabStats::count("Fixpo.refine");
-    crab::ScopedCrabStats __st__("Fixpo.refine");
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.refine"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.refine"));
 
     CRAB_VERBOSE_IF(
         1, crab::get_msg_stream()
@@ -231,33 +612,117 @@ private:
 
   void initialize_thresholds(size_t jump_set_size) {
     if (m_params.get_max_thresholds() > 0) {
-      crab::CrabStats::resume("Fixpo");
+      crab::CrabStats::resume(CRAB_STATS_ID("Fixpo"));
       // select statically some widening points to jump to.
       wto_thresholds_t wto_thresholds(m_cfg, jump_set_size);
       m_wto.accept(&wto_thresholds);
       m_thresholds_per_cycle = wto_thresholds.get_thresholds_map();
       CRAB_VERBOSE_IF(2, crab::outs() << "Thresholds\n"
                                       << wto_thresholds << "\n");
-      crab::CrabStats::stop("Fixpo");
+      crab::CrabStats::stop(CRAB_STATS_ID("Fixpo"));
     }
   }
 
   void initialize_invariant_tables() {
     clear();
+    m_pre_cache.set_capacity(m_params.get_invariant_cache_size());
+    m_post_cache.set_capacity(m_params.get_invariant_cache_size());
+    build_block_ids(
+        interleaved_fwd_fixpoint_iterator_impl::has_block_index<CFG>());
+    if (m_block_ids) {
+      m_pre = invariant_table_t(m_block_ids);
+      m_post = invariant_table_t(m_block_ids);
+    } else {
+      m_pre = invariant_table_t();
+      m_post = invariant_table_t();
+    }
     for (auto it = m_cfg.label_begin(), et = m_cfg.label_end(); it != et; ++it) {
       auto const &label = *it;
       m_pre.emplace(label, std::move(m_absval_fac.make_bottom()));
       m_post.emplace(label, std::move(m_absval_fac.make_bottom()));
     }
   }
-  
+
+  // Stabilize the top-level components of the WTO using a pool of
+  // worker threads.
+  //
+  // A component is scheduled once all the components with an edge
+  // into it have been stabilized. Hence, it reads the same
+  // invariants as in the sequential order and the result does not
+  // depend on the schedule. The invariant tables have an entry for
+  // each node before the workers start so that they only update
+  // values.
+  void run_parallel() {
+    std::vector<wto_component_t *> components;
+    std::unordered_map<basic_block_label_t, unsigned> component_of;
+    for (auto &c : m_wto) {
+      component_index_builder builder(component_of, components.size());
+      c.accept(&builder);
+      components.push_back(&c);
+    }
+
+    const unsigned num_components = components.size();
+    std::vector<std::vector<unsigned>> succs(num_components);
+    for (auto &kv : component_of) {
+      for (basic_block_label_t prev : m_cfg.prev_nodes(kv.first)) {
+        auto it = component_of.find(prev);
+        if (it != component_of.end() && it->second != kv.second) {
+          succs[it->second].push_back(kv.second);
+        }
+      }
+    }
+    for (auto &s : succs) {
+      std::sort(s.begin(), s.end());
+      s.erase(std::unique(s.begin(), s.end()), s.end());
+    }
+
+    crab::thread_pool pool(m_params.get_num_threads());
+    m_pool = &pool;
+    crab::run_dag(pool, succs, [this, &components](unsigned i) {
+      // Only the first component contains the entry of the CFG
+      wto_iterator_t iterator(this, m_absval_fac,
+                              i == 0 /*skip until the entry*/);
+      components[i]->accept(&iterator);
+    });
+    m_pool = nullptr;
+  }
+
+protected:
+  // Same as analyze but id is the dense id of node if the invariant
+  // tables are indexed by block id and no_vertex_id otherwise.
+  virtual AbstractValue analyze_block(const basic_block_label_t &node,
+                                      unsigned id, AbstractValue &&inv) {
+    return this->analyze(node, std::move(inv));
+  }
+
+  // Called before the fixpoint starts if the fixpoint parameters
+  // ask for more than one thread. Return true if analyze can be
+  // called concurrently from num_workers threads. The thread that
+  // calls analyze is identified by current_worker().
+  virtual bool prepare_parallel_analysis(unsigned num_workers) {
+    return false;
+  }
+
+  // Return the index in [0, num_workers) of the thread calling
+  // analyze if the fixpoint is running in parallel.
+  boost::optional<unsigned> current_worker() const {
+    if (m_pool) {
+      unsigned id = m_pool->worker_id();
+      if (id < m_pool->size()) {
+        return id;
+      }
+    }
+    return boost::none;
+  }
+
 public:
   interleaved_fwd_fixpoint_iterator(CFG cfg, AbstractValue absval_fac,
 				    const crab::fixpoint_parameters &params,
                                     bool enable_processor = true)
       : m_cfg(cfg), m_wto(cfg), m_absval_fac(absval_fac),
         m_params(params),
-        m_enable_processor(enable_processor) {
+        m_enable_processor(enable_processor), m_pool(nullptr),
+        m_degraded(false) {
     initialize_thresholds(m_params.get_max_thresholds());
   }
 
@@ -268,12 +733,42 @@ public:
   wto_t &get_wto() { return m_wto; }
   const wto_t &get_wto() const { return m_wto; }
 
+  // Return true if some budget of the fixpoint parameters was
+  // exceeded during the last run. The invariants are still sound but
+  // they can be less precise.
+  bool is_degraded() const { return m_degraded; }
+
+  // Keep the invariants of node if the fixpoint parameters ask to
+  // keep only the invariants at the heads of the WTO cycles.
+  void keep_invariants_at(basic_block_label_t node) {
+    m_requested.insert(node);
+  }
+
   /* Begin access methods for getting invariants */
+  // If only the invariants at the heads of the WTO cycles are kept
+  // then get_pre and get_post recompute the missing invariants while
+  // the invariant tables only contain the stored ones.
   AbstractValue get_pre(basic_block_label_t node) const {
-    return get(m_pre, node);
+    if (!m_params.get_keep_only_cycle_heads() || m_pre.count(node) > 0) {
+      return get(m_pre, node);
+    }
+    return recompute(node, false);
+  }
+  // Same as get_pre(block_label(id)) but without hashing the label if
+  // the invariant is stored. The block index of the CFG must be built.
+  AbstractValue get_pre_by_id(unsigned id) const {
+    if (is_block_id(id)) {
+      if (const AbstractValue *inv = m_pre.find_by_id(id)) {
+        return *inv;
+      }
+    }
+    return get_pre(m_cfg.block_label(id));
   }
   AbstractValue get_post(basic_block_label_t node) const {
-    return get(m_post, node);
+    if (!m_params.get_keep_only_cycle_heads() || m_post.count(node) > 0) {
+      return get(m_post, node);
+    }
+    return recompute(node, true);
   }
   const invariant_table_t &get_pre_invariants() const { return m_pre; }
   const invariant_table_t &get_post_invariants() const { return m_post; }
@@ -290,19 +785,37 @@ public:
   /* End access methods for getting invariants */
 
   void run(AbstractValue init) {
-    crab::ScopedCrabStats __st__("Fixpo");
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo"));
 
     initialize_invariant_tables();
+    start_budget();
     
     CRAB_VERBOSE_IF(1, crab::get_msg_stream() << "== Started analysis of "
                                               << func_name(m_cfg) << "\n");
     set_pre(m_cfg.entry(), init);
-    wto_iterator_t iterator(this, m_absval_fac);
-    m_wto.accept(&iterator);
-    if (m_enable_processor) {
+    bool forget = m_params.get_keep_only_cycle_heads();
+    bool parallel = m_params.get_num_threads() > 1 &&
+                    prepare_parallel_analysis(m_params.get_num_threads());
+    if (parallel) {
+      run_parallel();
+    } else if (forget) {
+      run_and_forget();
+    } else {
+      wto_iterator_t iterator(this, m_absval_fac);
+      m_wto.accept(&iterator);
+    }
+    if (m_enable_processor && (parallel || !forget)) {
       wto_processor_t processor(this);
       m_wto.accept(&processor);
     }
+    if (parallel && forget) {
+      // The components read each other's invariants while they are
+      // analyzed so they can only be removed at the end.
+      for (auto &c : m_wto) {
+        forget_invariants(c);
+      }
+      forget_pending_invariants();
+    }
     CRAB_VERBOSE_IF(1, crab::get_msg_stream() << "== Finished analysis of "
                                               << func_name(m_cfg) << "\n");
     CRAB_LOG("fixpo-trace", crab::get_msg_stream()
@@ -310,11 +823,15 @@ public:
                                 << m_wto << "\n";);
   }
 
+  // The analysis is always sequential here since it skips the
+  // components that precede entry in the WTO. All the invariants are
+  // kept.
   void run(basic_block_label_t entry, AbstractValue init,
            const assumption_map_t &assumptions) {
-    crab::ScopedCrabStats __st__("Fixpo");
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo"));
 
     initialize_invariant_tables();
+    start_budget();
     
     CRAB_VERBOSE_IF(
         1, crab::get_msg_stream()
@@ -335,9 +852,102 @@ public:
                                 << m_wto << "\n";);
   }
 
-  void clear_pre() { m_pre.clear(); }
+  // Analyze again the CFG after some of its blocks have been edited
+  // by reusing the invariants of a previous run.
+  //
+  // prev_pre and prev_post are the invariant tables computed by a
+  // previous run on the CFG before the edit and changed contains the
+  // blocks whose statements or predecessors have been modified since
+  // then. Blocks without previous invariants are considered modified
+  // too. A top-level component of the WTO is analyzed again only if
+  // it contains a modified block, the entry with an initial value
+  // different from the previous one, or a block whose predecessor
+  // outside the component has now a different post invariant.
+  // Otherwise, the previous invariants of the component are reused.
+  // The analysis is always sequential here and all the invariants are
+  // kept.
+  void run_incremental(AbstractValue init, invariant_table_t prev_pre,
+                       invariant_table_t prev_post,
+                       const std::unordered_set<basic_block_label_t> &changed) {
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo"));
+
+    initialize_invariant_tables();
+    start_budget();
+
+    CRAB_VERBOSE_IF(1, crab::get_msg_stream()
+                           << "== Started incremental analysis of "
+                           << func_name(m_cfg) << "\n");
+    set_pre(m_cfg.entry(), init);
+
+    auto equal = [](const AbstractValue &x, const AbstractValue &y) {
+      return x <= y && y <= x;
+    };
+
+    // Whether the previous invariants of the members of a component
+    // still hold.
+    auto is_stable =
+        [&](const std::unordered_map<basic_block_label_t, unsigned> &members) {
+          for (auto &kv : members) {
+            basic_block_label_t node = kv.first;
+            if (changed.count(node) > 0 || prev_pre.count(node) == 0 ||
+                prev_post.count(node) == 0) {
+              return false;
+            }
+            if (node == m_cfg.entry() && !equal(init, prev_pre.at(node))) {
+              return false;
+            }
+            for (basic_block_label_t prev : m_cfg.prev_nodes(node)) {
+              if (members.count(prev) > 0) {
+                continue;
+              }
+              auto it = prev_post.find(prev);
+              if (it == prev_post.end() || !equal(m_post.at(prev), it->second)) {
+                return false;
+              }
+            }
+          }
+          return true;
+        };
+
+    bool first = true;
+    for (auto &c : m_wto) {
+      std::unordered_map<basic_block_label_t, unsigned> members;
+      component_index_builder builder(members, 0);
+      c.accept(&builder);
+      if (is_stable(members)) {
+        crab::CrabStats::count(CRAB_STATS_ID("Fixpo.incremental.reused"));
+        for (auto &kv : members) {
+          // prev_post is still read by the next components
+          set_pre(kv.first, prev_pre.at(kv.first));
+          set_post(kv.first, AbstractValue(prev_post.at(kv.first)));
+        }
+      } else {
+        crab::CrabStats::count(CRAB_STATS_ID("Fixpo.incremental.analyzed"));
+        // Only the first component contains the entry of the CFG
+        wto_iterator_t iterator(this, m_absval_fac, first);
+        c.accept(&iterator);
+      }
+      first = false;
+    }
+    if (m_enable_processor) {
+      wto_processor_t processor(this);
+      m_wto.accept(&processor);
+    }
+    CRAB_VERBOSE_IF(1, crab::get_msg_stream()
+                           << "== Finished incremental analysis of "
+                           << func_name(m_cfg) << "\n");
+  }
+
+  void clear_pre() {
+    m_pre.clear();
+    m_pre_cache.clear();
+  }
 
-  void clear_post() { m_post.clear(); }
+  void clear_post() {
+    m_post.clear();
+    m_post_cache.clear();
+    m_pending.clear();
+  }
 
   void clear() {
     clear_pre();
@@ -377,8 +987,8 @@ private:
   inline AbstractValue make_bottom() const { return m_absval_fac.make_bottom(); }
 
   inline AbstractValue strengthen(basic_block_label_t n, AbstractValue inv) {
-    crab::CrabStats::count("Fixpo.strengthen");
-    crab::ScopedCrabStats __st__("Fixpo.strengthen");
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.strengthen"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.strengthen"));
 
     if (m_assumptions) {
       auto it = m_assumptions->find(n);
@@ -394,8 +1004,9 @@ private:
     return inv;
   }
 
-  inline void compute_post(basic_block_label_t node, AbstractValue inv) {
-    crab::CrabStats::resume("Fixpo.analyze_block");
+  inline void compute_post(basic_block_label_t node, unsigned id,
+                           AbstractValue inv) {
+    crab::CrabStats::resume(CRAB_STATS_ID("Fixpo.analyze_block"));
     CRAB_VERBOSE_IF(
         2, crab::get_msg_stream()
                << "Analyzing node " << func_name(m_iterator->m_cfg) << "::"
@@ -404,11 +1015,11 @@ private:
         crab::outs() << " size=" << n.size() << "\n";);
 
     CRAB_VERBOSE_IF(4, crab::outs() << "PRE Invariants:\n" << inv << "\n");
-    inv = m_iterator->analyze(node, std::move(inv));
+    inv = m_iterator->analyze_block(node, id, std::move(inv));
     CRAB_VERBOSE_IF(3, crab::outs() << "POST Invariants:\n" << inv << "\n");
-    crab::CrabStats::stop("Fixpo.analyze_block");
+    crab::CrabStats::stop(CRAB_STATS_ID("Fixpo.analyze_block"));
 
-    m_iterator->set_post(node, std::move(inv));
+    m_iterator->set_post(node, id, std::move(inv));
   }
 
   // Simple visitor to check if node is a member of the wto component.
@@ -444,9 +1055,11 @@ private:
   };
 
 public:
-  wto_iterator(interleaved_iterator_t *iterator, const AbstractValue &absval_fac)
+  wto_iterator(interleaved_iterator_t *iterator, const AbstractValue &absval_fac,
+               bool skip_until_entry = true)
       : m_iterator(iterator), m_entry(m_iterator->get_cfg().entry()),
-        m_absval_fac(absval_fac), m_assumptions(nullptr), m_skip(true) {}
+        m_absval_fac(absval_fac), m_assumptions(nullptr),
+        m_skip(skip_until_entry) {}
 
   wto_iterator(interleaved_iterator_t *iterator, basic_block_label_t entry,
                const AbstractValue &absval_fac, const assumption_map_t *assumptions)
@@ -455,6 +1068,7 @@ public:
 
   virtual void visit(wto_vertex_t &vertex) override {
     basic_block_label_t node = vertex.node();
+    unsigned id = vertex.id();
 
     /** decide whether skip vertex or not **/
     if (m_skip && (node == m_entry)) {
@@ -476,28 +1090,25 @@ public:
       if (m_assumptions && !m_assumptions->empty()) {
         // no necessary but it might avoid copies
         pre = strengthen(node, pre);
-        m_iterator->set_pre(node, pre);
+        m_iterator->set_pre(node, id, pre);
       }
     } else {
-      auto prev_nodes = m_iterator->m_cfg.prev_nodes(node);
-      crab::CrabStats::resume("Fixpo.join_predecessors");
-      pre = std::move(make_bottom());
-      for (basic_block_label_t prev : prev_nodes) {
-        pre |= m_iterator->get_post(prev);
-      }
-      crab::CrabStats::stop("Fixpo.join_predecessors");
+      crab::CrabStats::resume(CRAB_STATS_ID("Fixpo.join_predecessors"));
+      pre = m_iterator->join_predecessors(node, id);
+      crab::CrabStats::stop(CRAB_STATS_ID("Fixpo.join_predecessors"));
       if (m_assumptions && !m_assumptions->empty()) {
         // no necessary but it might avoid copies
         pre = strengthen(node, pre);
       }
-      m_iterator->set_pre(node, pre);
+      m_iterator->set_pre(node, id, pre);
     }
 
-    compute_post(node, pre);
+    compute_post(node, id, pre);
   }
 
   virtual void visit(wto_cycle_t &cycle) override {
     basic_block_label_t head = cycle.head();
+    unsigned head_id = cycle.head_id();
 
     auto get_nesting = [this](basic_block_label_t n) {
       boost::optional<wto_nesting_t> nesting = m_iterator->m_wto.nesting(n);
@@ -547,8 +1158,8 @@ public:
                           << "\n");
       pre = m_iterator->get_pre(m_entry);
     } else {
-      crab::CrabStats::count("Fixpo.join_predecessors");
-      crab::ScopedCrabStats __st__("Fixpo.join_predecessors");
+      crab::CrabStats::count(CRAB_STATS_ID("Fixpo.join_predecessors"));
+      crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.join_predecessors"));
       for (basic_block_label_t prev : prev_nodes) {
         if (!(get_nesting(prev) > cycle_nesting)) {
           pre |= m_iterator->get_post(prev);
@@ -560,60 +1171,70 @@ public:
       pre = strengthen(head, pre);
     }
 
+    // whether some budget has been exceeded while iterating the cycle
+    bool degraded = false;
     for (unsigned int iteration = 1;; ++iteration) {
       // keep track of how many times the cycle is visited by the fixpoint
       cycle.increment_fixpo_visits();
 
       // Increasing iteration sequence with widening
-      m_iterator->set_pre(head, pre);
-      compute_post(head, pre);
+      m_iterator->set_pre(head, head_id, pre);
+      compute_post(head, head_id, pre);
       for (typename wto_cycle_t::iterator it = cycle.begin(); it != cycle.end();
            ++it) {
         it->accept(this);
       }
-      crab::CrabStats::resume("Fixpo.join_predecessors");
-      AbstractValue new_pre = std::move(make_bottom());
-      for (basic_block_label_t prev : prev_nodes) {
-        new_pre |= m_iterator->get_post(prev);
-      }
-      crab::CrabStats::stop("Fixpo.join_predecessors");
-      crab::CrabStats::resume("Fixpo.check_fixpoint");
+      crab::CrabStats::resume(CRAB_STATS_ID("Fixpo.join_predecessors"));
+      AbstractValue new_pre = m_iterator->join_predecessors(head, head_id);
+      crab::CrabStats::stop(CRAB_STATS_ID("Fixpo.join_predecessors"));
+      crab::CrabStats::resume(CRAB_STATS_ID("Fixpo.check_fixpoint"));
       bool fixpoint_reached = new_pre <= pre;
-      crab::CrabStats::stop("Fixpo.check_fixpoint");
+      crab::CrabStats::stop(CRAB_STATS_ID("Fixpo.check_fixpoint"));
       if (fixpoint_reached) {
         // Post-fixpoint reached
         CRAB_VERBOSE_IF(1, crab::get_msg_stream() << "post-fixpoint reached\n");
-        m_iterator->set_pre(head, new_pre);
+        m_iterator->set_pre(head, head_id, new_pre);
         pre = std::move(new_pre);
         break;
+      } else if (m_iterator->is_budget_exhausted(iteration, new_pre)) {
+        m_iterator->degrade(head);
+        if (!degraded) {
+          // widen immediately
+          degraded = true;
+          pre = pre || new_pre;
+        } else {
+          // give up: the next iteration is stable
+          pre = make_top();
+        }
       } else {
         pre = m_iterator->extrapolate(head, iteration, pre, new_pre);
       }
     }
 
-    if (m_iterator->m_params.get_descending_iterations() == 0) {
+    if (m_iterator->m_params.get_descending_iterations() == 0 || degraded) {
       // no narrowing
       return;
     }
+    if (m_iterator->is_time_exhausted()) {
+      m_iterator->degrade(head);
+      return;
+    }
 
     CRAB_VERBOSE_IF(1, crab::get_msg_stream() << "Started narrowing phase\n";);
 
     for (unsigned int iteration = 1;; ++iteration) {
       // Decreasing iteration sequence with narrowing
-      compute_post(head, pre);
+      compute_post(head, head_id, pre);
       for (typename wto_cycle_t::iterator it = cycle.begin(); it != cycle.end();
            ++it) {
         it->accept(this);
       }
-      crab::CrabStats::resume("Fixpo.join_predecessors");
-      AbstractValue new_pre = std::move(make_bottom());
-      for (basic_block_label_t prev : prev_nodes) {
-        new_pre |= m_iterator->get_post(prev);
-      }
-      crab::CrabStats::stop("Fixpo.join_predecessors");
-      crab::CrabStats::resume("Fixpo.check_fixpoint");
+      crab::CrabStats::resume(CRAB_STATS_ID("Fixpo.join_predecessors"));
+      AbstractValue new_pre = m_iterator->join_predecessors(head, head_id);
+      crab::CrabStats::stop(CRAB_STATS_ID("Fixpo.join_predecessors"));
+      crab::CrabStats::resume(CRAB_STATS_ID("Fixpo.check_fixpoint"));
       bool no_more_refinement = pre <= new_pre;
-      crab::CrabStats::stop("Fixpo.check_fixpoint");
+      crab::CrabStats::stop(CRAB_STATS_ID("Fixpo.check_fixpoint"));
       if (no_more_refinement) {
         CRAB_VERBOSE_IF(1, crab::get_msg_stream()
                                << "No more refinement possible.\n");
@@ -622,8 +1243,12 @@ public:
       } else {
         if (iteration > m_iterator->m_params.get_descending_iterations())
           break;
+        if (m_iterator->is_time_exhausted()) {
+          m_iterator->degrade(head);
+          break;
+        }
         pre = m_iterator->refine(head, iteration, pre, new_pre);
-        m_iterator->set_pre(head, pre);
+        m_iterator->set_pre(head, head_id, pre);
       }
     }
     CRAB_VERBOSE_IF(
@@ -653,8 +1278,8 @@ public:
   wto_processor(interleaved_iterator_t *iterator) : m_iterator(iterator) {}
 
   virtual void visit(wto_vertex_t &vertex) override {
-    crab::CrabStats::count("Fixpo.process_invariants");
-    crab::ScopedCrabStats __st__("Fixpo.process_invariants");
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.process_invariants"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.process_invariants"));
 
     basic_block_label_t node = vertex.node();
     m_iterator->process_pre(node, m_iterator->get_pre(node));
@@ -662,8 +1287,8 @@ public:
   }
 
   virtual void visit(wto_cycle_t &cycle) override {
-    crab::CrabStats::count("Fixpo.process_invariants");
-    crab::ScopedCrabStats __st__("Fixpo.process_invariants");
+    crab::CrabStats::count(CRAB_STATS_ID("Fixpo.process_invariants"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("Fixpo.process_invariants"));
 
     basic_block_label_t head = cycle.head();
     m_iterator->process_pre(head, m_iterator->get_pre(head));
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/optional.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ikos {
+
+/*
+ * Map the blocks of a CFG to invariants.
+ *
+ * The invariants are stored in a vector of slots. If the table is
+ * built from the dense ids of the blocks (see
+ * crab::cfg::cfg::build_index) then the slot of a block is its id so
+ * the fixpoint iterator can access the invariants by id without
+ * hashing labels. Otherwise, a slot is allocated for each new label.
+ *
+ * The interface by label is the one of std::unordered_map. Only the
+ * entries are iterated, ordered by slot.
+ */
+template <typename Label, typename Value> class invariant_table {
+public:
+  using key_type = Label;
+  using mapped_type = Value;
+  using value_type = std::pair<const Label, Value>;
+  // map each label to its slot
+  using slot_map_t = std::unordered_map<Label, unsigned>;
+
+private:
+  using slot_t = boost::optional<value_type>;
+  using slot_vector_t = std::vector<slot_t>;
+
+  template <typename V, typename SlotIt>
+  class iterator_impl
+      : public boost::iterator_facade<iterator_impl<V, SlotIt>, V,
+                                      boost::forward_traversal_tag> {
+    friend class boost::iterator_core_access;
+    template <typename, typename> friend class iterator_impl;
+
+    SlotIt m_it;
+    SlotIt m_end;
+
+    void skip() {
+      while (m_it != m_end && !*m_it) {
+        ++m_it;
+      }
+    }
+
+    void increment() {
+      ++m_it;
+      skip();
+    }
+
+    template <typename V2, typename SlotIt2>
+    bool equal(const iterator_impl<V2, SlotIt2> &o) const {
+      return m_it == o.m_it;
+    }
+
+    V &dereference() const { return **m_it; }
+
+  public:
+    iterator_impl() {}
+    iterator_impl(SlotIt it, SlotIt end) : m_it(it), m_end(end) { skip(); }
+    // conversion from iterator to const_iterator
+    template <typename V2, typename SlotIt2,
+              typename = typename std::enable_if<
+                  std::is_convertible<SlotIt2, SlotIt>::value>::type>
+    iterator_impl(const iterator_impl<V2, SlotIt2> &o)
+        : m_it(o.m_it), m_end(o.m_end) {}
+  };
+
+public:
+  using iterator =
+      iterator_impl<value_type, typename slot_vector_t::iterator>;
+  using const_iterator =
+      iterator_impl<const value_type, typename slot_vector_t::const_iterator>;
+
+private:
+  // the block ids if the table is indexed by them, shared by all the
+  // tables of a fixpoint
+  std::shared_ptr<const slot_map_t> m_block_ids;
+  // the slots allocated for labels otherwise
+  slot_map_t m_labels;
+  slot_vector_t m_slots;
+  std::size_t m_size;
+
+  const slot_map_t &slots() const {
+    return m_block_ids ? *m_block_ids : m_labels;
+  }
+
+  bool find_slot(const Label &l, unsigned &slot) const {
+    const slot_map_t &m = slots();
+    auto it = m.find(l);
+    if (it == m.end()) {
+      return false;
+    }
+    slot = it->second;
+    return true;
+  }
+
+  unsigned get_or_add_slot(const Label &l) {
+    unsigned slot;
+    if (!find_slot(l, slot)) {
+      if (m_block_ids) {
+        throw std::out_of_range("invariant_table: unknown block");
+      }
+      slot = m_slots.size();
+      m_labels.insert({l, slot});
+      m_slots.emplace_back();
+    }
+    return slot;
+  }
+
+  template <typename V> void assign(unsigned slot, const Label &l, V &&v) {
+    slot_t &s = m_slots[slot];
+    if (s) {
+      s->second = std::forward<V>(v);
+    } else {
+      s.emplace(l, std::forward<V>(v));
+      ++m_size;
+    }
+  }
+
+public:
+  invariant_table() : m_size(0) {}
+
+  // A table indexed by the dense ids of the blocks
+  explicit invariant_table(std::shared_ptr<const slot_map_t> block_ids)
+      : m_block_ids(std::move(block_ids)), m_slots(m_block_ids->size()),
+        m_size(0) {}
+
+  invariant_table(const invariant_table &o) = default;
+  invariant_table(invariant_table &&o) = default;
+
+  // The entries cannot be assigned because their keys are const
+  invariant_table &operator=(invariant_table o) {
+    std::swap(m_block_ids, o.m_block_ids);
+    std::swap(m_labels, o.m_labels);
+    std::swap(m_slots, o.m_slots);
+    std::swap(m_size, o.m_size);
+    return *this;
+  }
+
+  bool is_indexed() const { return (bool)m_block_ids; }
+
+  /* Access by block id: only if the table is indexed */
+
+  const Value *find_by_id(unsigned id) const {
+    const slot_t &s = m_slots[id];
+    return s ? &s->second : nullptr;
+  }
+
+  Value *find_by_id(unsigned id) {
+    slot_t &s = m_slots[id];
+    return s ? &s->second : nullptr;
+  }
+
+  // l is the label of the block with dense id id
+  void insert_or_assign_by_id(unsigned id, const Label &l, const Value &v) {
+    assign(id, l, v);
+  }
+
+  void insert_or_assign_by_id(unsigned id, const Label &l, Value &&v) {
+    assign(id, l, std::move(v));
+  }
+
+  /* Access by label */
+
+  std::size_t size() const { return m_size; }
+
+  bool empty() const { return m_size == 0; }
+
+  iterator begin() { return iterator(m_slots.begin(), m_slots.end()); }
+  iterator end() { return iterator(m_slots.end(), m_slots.end()); }
+  const_iterator begin() const {
+    return const_iterator(m_slots.begin(), m_slots.end());
+  }
+  const_iterator end() const {
+    return const_iterator(m_slots.end(), m_slots.end());
+  }
+
+  iterator find(const Label &l) {
+    unsigned slot;
+    if (find_slot(l, slot) && m_slots[slot]) {
+      return iterator(m_slots.begin() + slot, m_slots.end());
+    }
+    return end();
+  }
+
+  const_iterator find(const Label &l) const {
+    unsigned slot;
+    if (find_slot(l, slot) && m_slots[slot]) {
+      return const_iterator(m_slots.begin() + slot, m_slots.end());
+    }
+    return end();
+  }
+
+  std::size_t count(const Label &l) const {
+    unsigned slot;
+    return (find_slot(l, slot) && m_slots[slot]) ? 1 : 0;
+  }
+
+  const Value &at(const Label &l) const {
+    unsigned slot;
+    if (!find_slot(l, slot) || !m_slots[slot]) {
+      throw std::out_of_range("invariant_table::at");
+    }
+    return m_slots[slot]->second;
+  }
+
+  Value &at(const Label &l) {
+    unsigned slot;
+    if (!find_slot(l, slot) || !m_slots[slot]) {
+      throw std::out_of_range("invariant_table::at");
+    }
+    return m_slots[slot]->second;
+  }
+
+  // Unlike std::unordered_map, the tables indexed by block id throw
+  // std::out_of_range if the label is not a block of the CFG.
+  std::pair<iterator, bool> insert(const value_type &kv) {
+    return emplace(kv.first, kv.second);
+  }
+
+  template <typename V> std::pair<iterator, bool> emplace(const Label &l, V &&v) {
+    unsigned slot = get_or_add_slot(l);
+    bool inserted = !m_slots[slot];
+    if (inserted) {
+      assign(slot, l, std::forward<V>(v));
+    }
+    return {iterator(m_slots.begin() + slot, m_slots.end()), inserted};
+  }
+
+  template <typename V> void insert_or_assign(const Label &l, V &&v) {
+    assign(get_or_add_slot(l), l, std::forward<V>(v));
+  }
+
+  std::size_t erase(const Label &l) {
+    unsigned slot;
+    if (find_slot(l, slot) && m_slots[slot]) {
+      // the slot is kept for the label
+      m_slots[slot] = boost::none;
+      --m_size;
+      return 1;
+    }
+    return 0;
+  }
+
+  void clear() {
+    if (m_block_ids) {
+      for (slot_t &s : m_slots) {
+        s = boost::none;
+      }
+    } else {
+      m_labels.clear();
+      m_slots.clear();
+    }
+    m_size = 0;
+  }
+};
+
+} // namespace ikos
@@ -8,8 +8,16 @@
 #include <crab/analysis/graphs/sccg.hpp>
 #include <crab/analysis/graphs/topo_order.hpp>
 #include <crab/cfg/cfg_bgl.hpp>
+#include <crab/fixpoint/wto.hpp>
+#include <crab/support/bit_vector.hpp>
 #include <crab/support/debug.hpp>
 #include <crab/support/stats.hpp>
+#include <crab/types/indexable.hpp>
+
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 
 namespace crab {
 // API for a kill-gen analysis operations
@@ -222,4 +230,398 @@ public:
     }
   }
 };
+// Dense numbering of a set of variables
+template <class Variable> class variable_index {
+  std::unordered_map<ikos::index_t, unsigned> m_ids;
+  std::vector<Variable> m_vars;
+
+public:
+  // Return the number of v, adding v if needed.
+  unsigned insert(const Variable &v) {
+    auto res = m_ids.insert({v.index(), m_vars.size()});
+    if (res.second) {
+      m_vars.push_back(v);
+    }
+    return res.first->second;
+  }
+
+  // Return false if v has no number.
+  bool find(const Variable &v, unsigned &id) const {
+    auto it = m_ids.find(v.index());
+    if (it == m_ids.end()) {
+      return false;
+    }
+    id = it->second;
+    return true;
+  }
+
+  std::size_t size() const { return m_vars.size(); }
+
+  const Variable &operator[](unsigned id) const { return m_vars[id]; }
+};
+
+// API for a kill-gen analysis whose facts are variables. The
+// variables are numbered once so that sets of facts are bit vectors.
+template <class CFG> class bitvector_killgen_operations_api {
+
+public:
+  using basic_block_t = typename CFG::basic_block_t;
+  using basic_block_label_t = typename CFG::basic_block_label_t;
+  using variable_t = typename CFG::variable_t;
+  using variable_index_t = variable_index<variable_t>;
+
+protected:
+  CFG m_cfg;
+
+public:
+  bitvector_killgen_operations_api(CFG cfg) : m_cfg(cfg) {}
+
+  virtual ~bitvector_killgen_operations_api() {}
+
+  // whether forward or backward analysis
+  virtual bool is_forward() = 0;
+
+  // number all the variables that can be facts
+  virtual void collect_variables(variable_index_t &vars) = 0;
+
+  // initial state
+  virtual void entry(const variable_index_t &vars, bit_vector &res) = 0;
+
+  // Compute the kill and gen sets of a basic block. Return false if
+  // no fact can flow through the block (e.g., it is unreachable).
+  virtual bool kill_gen(const basic_block_t &b, const variable_index_t &vars,
+                        bit_vector &kill, bit_vector &gen) = 0;
+
+  // analysis name
+  virtual std::string name() = 0;
+};
+
+/**
+ * A fixpoint for a kill-gen analysis whose facts are variables.
+ *
+ * Unlike killgen_fixpoint_iterator, blocks and variables are
+ * numbered densely and the sets of facts are bit vectors. The blocks
+ * are processed from a worklist in reverse post-order (post-order if
+ * the analysis is backward) so that a block is usually visited after
+ * the blocks it depends on. If the CFG provides a block index (see
+ * crab::cfg::cfg::build_index) then the blocks are numbered from their
+ * dense ids instead of hashing their labels.
+ **/
+template <class CFG, class AnalysisOps>
+class bitvector_killgen_fixpoint_iterator {
+
+public:
+  using basic_block_t = typename CFG::basic_block_t;
+  using basic_block_label_t = typename CFG::basic_block_label_t;
+  using variable_t = typename CFG::variable_t;
+  using variable_index_t = variable_index<variable_t>;
+
+protected:
+  CFG m_cfg;
+  variable_index_t m_vars;
+  // blocks in reverse post-order
+  std::vector<basic_block_label_t> m_blocks;
+  // block number of each block indexed by its dense id in the CFG if
+  // the CFG has a block index. Otherwise, m_block_ids is used.
+  std::vector<unsigned> m_number_by_id;
+  std::unordered_map<basic_block_label_t, unsigned> m_block_ids;
+  // indexed by block number. m_in is empty if it has been released.
+  std::vector<bit_vector> m_in;
+  std::vector<bit_vector> m_out;
+
+private:
+  using has_block_index_t = ikos::wto_impl::has_block_index<CFG>;
+
+  // to be constructed by the client so that m_analysis can have
+  // arbitrary internal state.
+  AnalysisOps &m_analysis;
+
+  void number_blocks(std::true_type) {
+    m_cfg.build_index();
+    m_blocks.clear();
+    m_block_ids.clear();
+    const unsigned num_blocks = m_cfg.size();
+    std::vector<unsigned> postorder;
+    std::vector<bool> visited(num_blocks, false);
+    // iterative DFS from the entry (id 0)
+    using id_it_t = decltype(m_cfg.next_ids(0u).begin());
+    std::vector<std::pair<unsigned, id_it_t>> stack;
+    auto push = [&](unsigned id) {
+      visited[id] = true;
+      stack.push_back({id, m_cfg.next_ids(id).begin()});
+    };
+    push(m_cfg.block_id(m_cfg.entry()));
+    while (!stack.empty()) {
+      auto &top = stack.back();
+      if (top.second != m_cfg.next_ids(top.first).end()) {
+        unsigned succ = *top.second;
+        ++top.second;
+        if (!visited[succ]) {
+          push(succ);
+        }
+      } else {
+        postorder.push_back(top.first);
+        stack.pop_back();
+      }
+    }
+    std::vector<unsigned> order(postorder.rbegin(), postorder.rend());
+    for (unsigned id = 0; id < num_blocks; ++id) {
+      if (!visited[id]) {
+        order.push_back(id);
+      }
+    }
+    m_number_by_id.assign(num_blocks, 0);
+    m_blocks.reserve(num_blocks);
+    for (unsigned i = 0; i < num_blocks; ++i) {
+      m_number_by_id[order[i]] = i;
+      m_blocks.push_back(m_cfg.block_label(order[i]));
+    }
+  }
+
+  void number_blocks(std::false_type) {
+    m_blocks.clear();
+    m_block_ids.clear();
+    std::vector<basic_block_label_t> postorder;
+    std::unordered_map<basic_block_label_t, bool> visited;
+    // iterative DFS from the entry
+    using succ_it_t = typename basic_block_t::const_succ_iterator;
+    std::vector<std::pair<basic_block_label_t, succ_it_t>> stack;
+    auto push = [&](const basic_block_label_t &l) {
+      visited[l] = true;
+      auto const &b = m_cfg.get_node(l);
+      stack.push_back({l, b.next_blocks().first});
+    };
+    push(m_cfg.entry());
+    while (!stack.empty()) {
+      auto &top = stack.back();
+      auto const &b = m_cfg.get_node(top.first);
+      if (top.second != b.next_blocks().second) {
+        basic_block_label_t succ = *top.second;
+        ++top.second;
+        if (!visited[succ]) {
+          push(succ);
+        }
+      } else {
+        postorder.push_back(top.first);
+        stack.pop_back();
+      }
+    }
+    m_blocks.assign(postorder.rbegin(), postorder.rend());
+    for (auto &b : boost::make_iterator_range(m_cfg.begin(), m_cfg.end())) {
+      if (!visited[b.label()]) {
+        m_blocks.push_back(b.label());
+      }
+    }
+    for (unsigned i = 0, e = m_blocks.size(); i < e; ++i) {
+      m_block_ids.insert({m_blocks[i], i});
+    }
+  }
+
+  // Set number to the block number of bb. Return false if bb is not
+  // a block of the CFG.
+  bool find_number(const basic_block_label_t &bb, unsigned &number,
+                   std::true_type) const {
+    if (m_number_by_id.empty()) {
+      return false;
+    }
+    number = m_number_by_id[m_cfg.block_id(bb)];
+    return true;
+  }
+
+  bool find_number(const basic_block_label_t &bb, unsigned &number,
+                   std::false_type) const {
+    auto it = m_block_ids.find(bb);
+    if (it == m_block_ids.end()) {
+      return false;
+    }
+    number = it->second;
+    return true;
+  }
+
+  bool find_number(const basic_block_label_t &bb, unsigned &number) const {
+    return find_number(bb, number, has_block_index_t());
+  }
+
+  unsigned get_number(const basic_block_label_t &bb) const {
+    unsigned number;
+    if (!find_number(bb, number)) {
+      CRAB_ERROR("Basic block ", bb, " not found in ", m_analysis.name());
+    }
+    return number;
+  }
+
+  void add_edges(std::vector<std::vector<unsigned>> &succs,
+                 std::vector<std::vector<unsigned>> &preds, std::true_type) {
+    for (unsigned id = 0, e = m_number_by_id.size(); id < e; ++id) {
+      unsigned i = m_number_by_id[id];
+      for (unsigned succ : m_cfg.next_ids(id)) {
+        unsigned j = m_number_by_id[succ];
+        succs[i].push_back(j);
+        preds[j].push_back(i);
+      }
+    }
+  }
+
+  void add_edges(std::vector<std::vector<unsigned>> &succs,
+                 std::vector<std::vector<unsigned>> &preds, std::false_type) {
+    for (unsigned i = 0, e = m_blocks.size(); i < e; ++i) {
+      auto const &b = m_cfg.get_node(m_blocks[i]);
+      for (auto const &l : boost::make_iterator_range(b.next_blocks())) {
+        unsigned j = m_block_ids.at(l);
+        succs[i].push_back(j);
+        preds[j].push_back(i);
+      }
+    }
+  }
+
+public:
+  bitvector_killgen_fixpoint_iterator(CFG cfg, AnalysisOps &analysis)
+      : m_cfg(cfg), m_analysis(analysis) {
+    // don't do anything with m_analysis in the contructor except
+    // storing the reference.
+  }
+
+  void release_memory() {
+    m_in.clear();
+    m_out.clear();
+  }
+
+  void run() {
+    crab::ScopedCrabStats __st__(m_analysis.name());
+
+    number_blocks(has_block_index_t());
+    m_analysis.collect_variables(m_vars);
+    const unsigned num_blocks = m_blocks.size();
+    const unsigned num_vars = m_vars.size();
+    const bool is_forward = m_analysis.is_forward();
+
+    std::vector<std::vector<unsigned>> succs(num_blocks), preds(num_blocks);
+    add_edges(succs, preds, has_block_index_t());
+    // the blocks where the initial state flows in
+    std::vector<bool> is_boundary(num_blocks, false);
+    if (is_forward) {
+      is_boundary[get_number(m_cfg.entry())] = true;
+    } else if (m_cfg.has_exit()) {
+      is_boundary[get_number(m_cfg.exit())] = true;
+    } else {
+      for (unsigned i = 0; i < num_blocks; ++i) {
+        is_boundary[i] = succs[i].empty();
+      }
+    }
+    // For a backward analysis facts flow from the successors.
+    const std::vector<std::vector<unsigned>> &sources =
+        is_forward ? preds : succs;
+    const std::vector<std::vector<unsigned>> &targets =
+        is_forward ? succs : preds;
+
+    bit_vector init(num_vars);
+    m_analysis.entry(m_vars, init);
+    std::vector<bit_vector> kill(num_blocks, bit_vector(num_vars));
+    std::vector<bit_vector> gen(num_blocks, bit_vector(num_vars));
+    std::vector<bool> is_transparent(num_blocks);
+    for (unsigned i = 0; i < num_blocks; ++i) {
+      is_transparent[i] = m_analysis.kill_gen(m_cfg.get_node(m_blocks[i]),
+                                              m_vars, kill[i], gen[i]);
+    }
+
+    // before: facts at the start of the block in the direction of the
+    // analysis; after: at the end.
+    std::vector<bit_vector> before(num_blocks, bit_vector(num_vars));
+    std::vector<bit_vector> after(num_blocks, bit_vector(num_vars));
+
+    // the worklist is ordered by position in the iteration order
+    auto pos = [&](unsigned i) { return is_forward ? i : num_blocks - 1 - i; };
+    std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>>
+        worklist;
+    std::vector<bool> in_worklist(num_blocks, true);
+    for (unsigned i = 0; i < num_blocks; ++i) {
+      worklist.push(pos(i));
+    }
+    unsigned iterations = 0;
+    while (!worklist.empty()) {
+      unsigned i = pos(worklist.top());
+      worklist.pop();
+      in_worklist[i] = false;
+      ++iterations;
+
+      bit_vector &cur_before = before[i];
+      if (is_boundary[i]) {
+        cur_before = init;
+      } else {
+        cur_before.clear();
+      }
+      for (unsigned j : sources[i]) {
+        cur_before |= after[j];
+      }
+      bool change;
+      if (is_transparent[i]) {
+        change = after[i].assign_transfer(cur_before, kill[i], gen[i]);
+      } else {
+        change = !after[i].empty();
+        after[i].clear();
+      }
+      if (change) {
+        for (unsigned j : targets[i]) {
+          if (!in_worklist[j]) {
+            in_worklist[j] = true;
+            worklist.push(pos(j));
+          }
+        }
+      }
+    }
+
+    if (is_forward) {
+      m_in = std::move(before);
+      m_out = std::move(after);
+    } else {
+      m_in = std::move(after);
+      m_out = std::move(before);
+    }
+
+    CRAB_LOG(m_analysis.name(),
+             crab::outs() << m_analysis.name();
+             if (m_cfg.has_func_decl()) {
+               crab::outs() << " for " << m_cfg.get_func_decl();
+             } crab::outs()
+             << ": " << num_blocks << " blocks, " << num_vars
+             << " variables, fixpoint reached after " << iterations
+             << " block visits.\n";);
+  }
+
+  const variable_index_t &get_variables() const { return m_vars; }
+
+  // Whether the blocks are numbered from the block index of the CFG
+  // so that get_in_by_id and get_out_by_id can be used.
+  bool has_block_ids() const { return !m_number_by_id.empty(); }
+
+  // return null if not found
+  const bit_vector *get_in(const basic_block_label_t &bb) const {
+    unsigned number;
+    if (find_number(bb, number) && !m_in.empty()) {
+      return &m_in[number];
+    } else {
+      return nullptr;
+    }
+  }
+
+  // return null if not found
+  const bit_vector *get_out(const basic_block_label_t &bb) const {
+    unsigned number;
+    if (find_number(bb, number) && !m_out.empty()) {
+      return &m_out[number];
+    } else {
+      return nullptr;
+    }
+  }
+
+  // Same as get_in and get_out but for the block with dense id id.
+  // Only if has_block_ids() is true.
+  const bit_vector *get_in_by_id(unsigned id) const {
+    return m_in.empty() ? nullptr : &m_in[m_number_by_id[id]];
+  }
+
+  const bit_vector *get_out_by_id(unsigned id) const {
+    return m_out.empty() ? nullptr : &m_out[m_number_by_id[id]];
+  }
+};
 } // end namespace crab
@@ -45,21 +45,20 @@
 
 #pragma once
 
-#include <crab/domains/interval.hpp>
 #include <crab/support/debug.hpp>
 #include <crab/support/stats.hpp>
 
-#include <boost/container/slist.hpp>
-#include <boost/iterator/indirect_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/optional.hpp>
+#include <limits>
 #include <memory>
 #include <set>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
-// Define RECURSIVE_WTO to use older, recursive version.  It is
-// retained for a while for performance comparison purposes.
-// #define RECURSIVE_WTO
-
 namespace ikos {
 
 template <typename G> class wto;
@@ -70,105 +69,247 @@ template <typename G> class wto_cycle;
 
 template <typename G> class wto_component_visitor;
 
+namespace wto_impl {
+
+template <typename G> struct wto_data;
+
+// Whether G provides dense vertex ids (see crab::cfg::cfg::build_index)
+template <typename G, typename = void>
+struct has_block_index : std::false_type {};
+
+template <typename G>
+struct has_block_index<
+    G, decltype(std::declval<const G &>().prev_ids(0u), void())>
+    : std::true_type {};
+
+// The id of a wto vertex or cycle head whose dense id is unknown
+constexpr unsigned no_vertex_id = std::numeric_limits<unsigned>::max();
+
+template <typename G>
+unsigned vertex_id(const G &g,
+                   typename boost::graph_traits<G>::vertex_descriptor v,
+                   std::true_type) {
+  return g.is_indexed() ? g.block_id(v) : no_vertex_id;
+}
+
+template <typename G>
+unsigned vertex_id(const G &,
+                   typename boost::graph_traits<G>::vertex_descriptor,
+                   std::false_type) {
+  return no_vertex_id;
+}
+
+// Return the dense id of v if the block index of g is built
+template <typename G>
+unsigned vertex_id(const G &g,
+                   typename boost::graph_traits<G>::vertex_descriptor v) {
+  return vertex_id(g, v, has_block_index<G>());
+}
+
+// Map the vertices of G to values of type T. Vertices that have not
+// been set are mapped to a default value.
+template <typename G, typename T, bool = has_block_index<G>::value>
+class vertex_table {
+  using vertex_t = typename boost::graph_traits<G>::vertex_descriptor;
+
+  std::unordered_map<vertex_t, T> m_map;
+  T m_default;
+
+public:
+  vertex_table(const G &, T default_value) : m_default(default_value) {}
+
+  bool is_valid() const { return true; }
+
+  T get(vertex_t v) const {
+    auto it = m_map.find(v);
+    return (it == m_map.end()) ? m_default : it->second;
+  }
+
+  void set(vertex_t v, T value) { m_map[v] = value; }
+};
+
+// If the dense ids of G were built then the table is a vector indexed
+// by them. The table is no longer valid if the ids are dropped later.
+template <typename G, typename T> class vertex_table<G, T, true> {
+  using vertex_t = typename boost::graph_traits<G>::vertex_descriptor;
+
+  // engaged iff the table is indexed by the dense ids of the graph
+  boost::optional<G> m_graph;
+  std::vector<T> m_vector;
+  std::unordered_map<vertex_t, T> m_map;
+  T m_default;
+
+public:
+  vertex_table(const G &g, T default_value) : m_default(default_value) {
+    if (g.is_indexed()) {
+      m_graph = g;
+    }
+  }
+
+  bool is_valid() const { return !m_graph || m_graph->is_indexed(); }
+
+  T get(vertex_t v) const {
+    if (m_graph) {
+      assert(is_valid());
+      unsigned id = m_graph->block_id(v);
+      return (id < m_vector.size()) ? m_vector[id] : m_default;
+    } else {
+      auto it = m_map.find(v);
+      return (it == m_map.end()) ? m_default : it->second;
+    }
+  }
+
+  void set(vertex_t v, T value) {
+    if (m_graph) {
+      assert(is_valid());
+      unsigned id = m_graph->block_id(v);
+      if (id >= m_vector.size()) {
+        m_vector.resize(id + 1, m_default);
+      }
+      m_vector[id] = value;
+    } else {
+      m_map[v] = value;
+    }
+  }
+};
+
+// Iterate over a sequence of sibling components, jumping over the
+// components nested in each cycle.
+template <typename G, typename Component>
+class component_iterator
+    : public boost::iterator_facade<component_iterator<G, Component>,
+                                    Component, boost::forward_traversal_tag> {
+  friend class boost::iterator_core_access;
+
+  wto_data<G> *m_data;
+  unsigned m_pos;
+
+  void increment() { m_pos = m_data->m_next[m_pos]; }
+
+  bool equal(const component_iterator<G, Component> &o) const {
+    return m_pos == o.m_pos;
+  }
+
+  Component &dereference() const { return m_data->component(m_pos); }
+
+public:
+  component_iterator() : m_data(nullptr), m_pos(0) {}
+
+  component_iterator(wto_data<G> *data, unsigned pos)
+      : m_data(data), m_pos(pos) {}
+};
+
+} // namespace wto_impl
+
+// The heads of the cycles that contain a vertex, from the outermost to
+// the innermost one. A nesting shares the tables of the wto that built
+// it.
 template <typename G> class wto_nesting {
 
   friend class wto<G>;
-  friend class wto_vertex<G>;
-  friend class wto_cycle<G>;
 
 public:
   using wto_nesting_t = wto_nesting<G>;
 
 private:
-  using node_list_t =
-      std::vector<typename boost::graph_traits<G>::vertex_descriptor>;
-  using node_list_ptr = std::shared_ptr<node_list_t>;
+  using vertex_t = typename boost::graph_traits<G>::vertex_descriptor;
+  using data_t = wto_impl::wto_data<G>;
+
+  struct get_head {
+    using result_type = vertex_t;
+    const data_t *m_data;
+    get_head() : m_data(nullptr) {}
+    get_head(const data_t *data) : m_data(data) {}
+    vertex_t operator()(unsigned cycle) const {
+      return m_data->m_cycles[cycle].head();
+    }
+  };
 
-  node_list_ptr _nodes;
+  // null for the empty nesting
+  std::shared_ptr<const data_t> _data;
+  // innermost cycle of the nesting
+  unsigned _cycle;
 
-public:
-  using iterator = typename node_list_t::iterator;
-  using const_iterator = typename node_list_t::const_iterator;
+  wto_nesting(std::shared_ptr<const data_t> data, unsigned cycle)
+      : _data(std::move(data)), _cycle(cycle) {}
 
-private:
-  wto_nesting(node_list_ptr l) : _nodes(std::make_shared<node_list_t>(*l)) {}
-
-  int compare(wto_nesting_t &other) const {
-    const_iterator this_it = this->begin(), other_it = other.begin();
-    while (this_it != this->end()) {
-      if (other_it == other.end()) {
-        return 1;
-      } else if (*this_it == *other_it) {
-        ++this_it;
-        ++other_it;
-      } else {
+  unsigned depth() const {
+    return _data ? _data->m_cycles[_cycle].depth() : 0;
+  }
+
+  // Return the cycle at level i of the nesting (0 is the outermost)
+  unsigned at(unsigned i) const {
+    return _data->m_paths[_data->m_cycles[_cycle].path() + i];
+  }
+
+  const unsigned *path_begin() const {
+    return _data ? &_data->m_paths[_data->m_cycles[_cycle].path()] : nullptr;
+  }
+
+  const unsigned *path_end() const {
+    return _data ? path_begin() + depth() : nullptr;
+  }
+
+  int compare(const wto_nesting_t &other) const {
+    assert(!_data || !other._data || _data == other._data);
+    unsigned n = depth(), m = other.depth();
+    if (n >= m) {
+      if (m > 0 && at(m - 1) != other._cycle) {
         return 2; // Nestings are not comparable
       }
-    }
-    if (other_it == other.end()) {
-      return 0;
+      return (n == m) ? 0 : 1;
     } else {
+      if (n > 0 && other.at(n - 1) != _cycle) {
+        return 2; // Nestings are not comparable
+      }
       return -1;
     }
   }
 
 public:
-  wto_nesting() : _nodes(std::make_shared<node_list_t>()) {}
+  using iterator = boost::transform_iterator<get_head, const unsigned *>;
+  using const_iterator = iterator;
 
-  void operator+=(typename boost::graph_traits<G>::vertex_descriptor n) {
-    this->_nodes = std::make_shared<node_list_t>(*(this->_nodes));
-    this->_nodes->push_back(n);
-  }
+  wto_nesting() : _data(nullptr), _cycle(0) {}
 
-  wto_nesting_t
-  operator+(typename boost::graph_traits<G>::vertex_descriptor n) {
-    wto_nesting_t res(this->_nodes);
-    res._nodes->push_back(n);
-    return res;
+  const_iterator begin() const {
+    return boost::make_transform_iterator(path_begin(), get_head(_data.get()));
   }
 
-  iterator begin() { return _nodes->begin(); }
-
-  iterator end() { return _nodes->end(); }
-
-  const_iterator begin() const { return _nodes->begin(); }
-
-  const_iterator end() const { return _nodes->end(); }
+  const_iterator end() const {
+    return boost::make_transform_iterator(path_end(), get_head(_data.get()));
+  }
 
-  wto_nesting_t operator^(wto_nesting_t other) const {
-    wto_nesting_t res;
-    for (const_iterator this_it = this->begin(), other_it = other.begin();
-         this_it != this->end() && other_it != other.end();
-         ++this_it, ++other_it) {
-      if (*this_it == *other_it) {
-        res._nodes->push_back(*this_it);
-      } else {
+  wto_nesting_t operator^(const wto_nesting_t &other) const {
+    unsigned k = 0;
+    for (unsigned n = std::min(depth(), other.depth()); k < n; ++k) {
+      if (at(k) != other.at(k)) {
         break;
       }
     }
-    return res;
+    return (k == 0) ? wto_nesting_t() : wto_nesting_t(_data, at(k - 1));
   }
 
-  bool operator<=(wto_nesting_t other) const {
+  bool operator<=(const wto_nesting_t &other) const {
     return this->compare(other) <= 0;
   }
 
-  bool operator==(wto_nesting_t other) const {
+  bool operator==(const wto_nesting_t &other) const {
     return this->compare(other) == 0;
   }
 
-  bool operator>=(wto_nesting_t other) const {
-    return this->operator<=(other, *this);
+  bool operator>=(const wto_nesting_t &other) const {
+    return other.compare(*this) <= 0;
   }
 
-  bool operator>(wto_nesting_t other) const {
+  bool operator>(const wto_nesting_t &other) const {
     return this->compare(other) == 1;
   }
 
   void write(crab::crab_os &o) const {
     o << "[";
     for (const_iterator it = this->begin(); it != this->end();) {
-      typename boost::graph_traits<G>::vertex_descriptor n = *it;
+      vertex_t n = *it;
       o << n;
       ++it;
       if (it != this->end()) {
@@ -210,15 +351,21 @@ template <typename G> class wto_vertex : public wto_component<G> {
 
 private:
   typename boost::graph_traits<G>::vertex_descriptor _node;
+  unsigned _id;
 
-  wto_vertex(typename boost::graph_traits<G>::vertex_descriptor node)
-      : _node(node) {}
+  wto_vertex(typename boost::graph_traits<G>::vertex_descriptor node,
+             unsigned id)
+      : _node(node), _id(id) {}
 
 public:
-  typename boost::graph_traits<G>::vertex_descriptor node() {
+  typename boost::graph_traits<G>::vertex_descriptor node() const {
     return this->_node;
   }
 
+  // dense id of the node if the block index of the graph was built
+  // when the wto was computed and wto_impl::no_vertex_id otherwise
+  unsigned id() const { return _id; }
+
   virtual void accept(wto_component_visitor<G> *v) override {
     v->visit(*this);
   }
@@ -237,48 +384,53 @@ public:
   using wto_component_t = wto_component<G>;
 
 private:
-  using wto_component_ptr = std::shared_ptr<wto_component_t>;
-  using wto_component_list_t = boost::container::slist<wto_component_ptr>;
-  using wto_component_list_ptr = std::shared_ptr<wto_component_list_t>;
+  using data_t = wto_impl::wto_data<G>;
 
   typename boost::graph_traits<G>::vertex_descriptor _head;
-  wto_component_list_ptr _wto_components;
+  unsigned _head_id;
+  data_t *_data;
+  // the nested components are at positions [_first, _end) of the wto
+  unsigned _first;
+  unsigned _end;
+  // number of cycles that contain this one, included itself
+  unsigned _depth;
+  // offset of the enclosing cycles in the wto paths
+  unsigned _path;
   // number of times the wto cycle is analyzed by the fixpoint iterator
   unsigned _num_fixpo;
 
   wto_cycle(typename boost::graph_traits<G>::vertex_descriptor head,
-            wto_component_list_ptr wto_components)
-      : _head(head), _wto_components(wto_components), _num_fixpo(0) {}
+            unsigned head_id, unsigned first, unsigned depth, unsigned path)
+      : _head(head), _head_id(head_id), _data(nullptr), _first(first), _end(first),
+        _depth(depth), _path(path), _num_fixpo(0) {}
 
 public:
-  using iterator =
-      boost::indirect_iterator<typename wto_component_list_t::iterator>;
+  using iterator = wto_impl::component_iterator<G, wto_component_t>;
   using const_iterator =
-      boost::indirect_iterator<typename wto_component_list_t::const_iterator>;
+      wto_impl::component_iterator<G, const wto_component_t>;
 
-  typename boost::graph_traits<G>::vertex_descriptor head() {
+  typename boost::graph_traits<G>::vertex_descriptor head() const {
     return this->_head;
   }
 
+  // dense id of the head (see wto_vertex::id)
+  unsigned head_id() const { return _head_id; }
+
+  unsigned depth() const { return _depth; }
+
+  unsigned path() const { return _path; }
+
   virtual void accept(wto_component_visitor<G> *v) override {
     v->visit(*this);
   }
 
-  iterator begin() {
-    return boost::make_indirect_iterator(_wto_components->begin());
-  }
+  iterator begin() { return iterator(_data, _first); }
 
-  iterator end() {
-    return boost::make_indirect_iterator(_wto_components->end());
-  }
+  iterator end() { return iterator(_data, _end); }
 
-  const_iterator begin() const {
-    return boost::make_indirect_iterator(_wto_components->begin());
-  }
+  const_iterator begin() const { return const_iterator(_data, _first); }
 
-  const_iterator end() const {
-    return boost::make_indirect_iterator(_wto_components->end());
-  }
+  const_iterator end() const { return const_iterator(_data, _end); }
 
   void increment_fixpo_visits() { _num_fixpo++; }
 
@@ -288,7 +440,7 @@ public:
 
   virtual void write(crab::crab_os &o) const override {
     o << "(" << this->_head;
-    if (!this->_wto_components->empty()) {
+    if (_first != _end) {
       o << " ";
       for (const_iterator it = this->begin(); it != this->end();) {
         const wto_component_t &c = *it;
@@ -318,6 +470,61 @@ public:
 
 }; // class wto_component_visitor
 
+namespace wto_impl {
+
+// The components of a WTO stored contiguously in depth-first order. A
+// cycle at position i is followed by its nested components and
+// m_next[i] is the position right after them.
+template <typename G> struct wto_data {
+  using vertex_t = typename boost::graph_traits<G>::vertex_descriptor;
+
+  std::vector<wto_vertex<G>> m_vertices;
+  std::vector<wto_cycle<G>> m_cycles;
+  // whether each position is a cycle and its index in m_vertices or
+  // m_cycles
+  std::vector<std::pair<bool, unsigned>> m_order;
+  std::vector<unsigned> m_next;
+  // the cycles that contain cycle c from the outermost to c itself are
+  // m_paths[c.path() .. c.path() + c.depth())
+  std::vector<unsigned> m_paths;
+  // innermost cycle that contains each position, not counting the
+  // one it is the head of, or -1 if there is none
+  std::vector<int> m_parent_cycle;
+  // position of each vertex or -1 if it is not part of the wto
+  vertex_table<G, int> m_position;
+
+  wto_data(const G &g) : m_position(g, -1) {}
+
+  vertex_t node(unsigned pos) const {
+    const std::pair<bool, unsigned> &p = m_order[pos];
+    return p.first ? m_cycles[p.second].head() : m_vertices[p.second].node();
+  }
+
+  int position(vertex_t v) const {
+    if (m_position.is_valid()) {
+      return m_position.get(v);
+    }
+    // the graph was modified after the wto was built
+    for (unsigned pos = 0, n = m_order.size(); pos < n; ++pos) {
+      if (node(pos) == v) {
+        return pos;
+      }
+    }
+    return -1;
+  }
+
+  wto_component<G> &component(unsigned pos) {
+    const std::pair<bool, unsigned> &p = m_order[pos];
+    if (p.first) {
+      return m_cycles[p.second];
+    } else {
+      return m_vertices[p.second];
+    }
+  }
+};
+
+} // namespace wto_impl
+
 template <typename G> class wto {
 
 public:
@@ -328,118 +535,56 @@ public:
   using wto_cycle_t = wto_cycle<G>;
   using wto_t = wto<G>;
 
-private:
-  using wto_component_ptr = std::shared_ptr<wto_component_t>;
-  using wto_vertex_ptr = std::shared_ptr<wto_vertex_t>;
-  using wto_cycle_ptr = std::shared_ptr<wto_cycle_t>;
-  using wto_component_list_t = boost::container::slist<wto_component_ptr>;
-  using wto_component_list_ptr = std::shared_ptr<wto_component_list_t>;
-  using dfn_t = bound<z_number>;
-  using dfn_table_t =
-      std::unordered_map<typename boost::graph_traits<G>::vertex_descriptor,
-                         dfn_t>;
-  using dfn_table_ptr = std::shared_ptr<dfn_table_t>;
-  using stack_t =
-      std::vector<typename boost::graph_traits<G>::vertex_descriptor>;
-  using stack_ptr = std::shared_ptr<stack_t>;
-  using nesting_table_t =
-      std::unordered_map<typename boost::graph_traits<G>::vertex_descriptor,
-                         wto_nesting_t>;
-  using nesting_table_ptr = std::shared_ptr<nesting_table_t>;
-
-public:
-  using iterator =
-      boost::indirect_iterator<typename wto_component_list_t::iterator>;
+  using iterator = wto_impl::component_iterator<G, wto_component_t>;
   using const_iterator =
-      boost::indirect_iterator<typename wto_component_list_t::const_iterator>;
+      wto_impl::component_iterator<G, const wto_component_t>;
 
-private:  
-  wto_component_list_ptr _wto_components;
-  dfn_table_ptr _dfn_table;
+private:
+  using vertex_t = typename boost::graph_traits<G>::vertex_descriptor;
+  using data_t = wto_impl::wto_data<G>;
+  // 0 means not visited yet and the maximum value plus infinity
+  using dfn_t = std::size_t;
+  using dfn_table_t = wto_impl::vertex_table<G, dfn_t>;
+  using stack_t = std::vector<vertex_t>;
+
+  // A component found by Bourdoncle's algorithm. The nested
+  // components of a cycle are indexes in the partition pool and they
+  // are stored in reverse order.
+  struct partition_elem {
+    vertex_t node;
+    bool is_cycle;
+    std::vector<unsigned> partition;
+  };
+  using partition_pool_t = std::vector<partition_elem>;
+
+  // shared with the nestings returned by the wto
+  std::shared_ptr<data_t> _data;
+  // only used during the construction
+  boost::optional<dfn_table_t> _dfn_table;
   dfn_t _num;
-  stack_ptr _stack;
-  nesting_table_ptr _nesting_table;
-
-  wto(wto_component_list_ptr &&wto_components,
-      dfn_table_ptr &&dfn_table,
-      dfn_t num,
-      stack_ptr &&stack, 
-      nesting_table_ptr &&nesting_table):
-    _wto_components(std::move(wto_components)),
-    _dfn_table(std::move(dfn_table)),
-    _num(num),
-    _stack(std::move(stack)),
-    _nesting_table(std::move(nesting_table)) {}
-  
-  
-  class nesting_builder : public wto_component_visitor<G> {
-  public:
-    using wto_vertex_t = wto_vertex<G>;
-    using wto_cycle_t = wto_cycle<G>;
-
-  private:
-    wto_nesting_t _nesting;
-    nesting_table_ptr _nesting_table;
-      
-  public:
-    nesting_builder(nesting_table_ptr nesting_table)
-        : _nesting_table(nesting_table) {}
-
-    virtual void visit(wto_cycle_t &cycle) override {
-      typename boost::graph_traits<G>::vertex_descriptor head = cycle.head();
-      wto_nesting_t previous_nesting = this->_nesting;
-      this->_nesting_table->insert(std::make_pair(head, this->_nesting));
-      this->_nesting += head;
-      for (typename wto_cycle_t::iterator it = cycle.begin(); it != cycle.end();
-           ++it) {
-        it->accept(this);
-      }
-      this->_nesting = previous_nesting;
-    }
+  stack_t _stack;
+  partition_pool_t _pool;
 
-    virtual void visit(wto_vertex_t &vertex) override {
-      this->_nesting_table->insert(
-          std::make_pair(vertex.node(), this->_nesting));
-    }
+  static dfn_t plus_infinity() { return std::numeric_limits<dfn_t>::max(); }
 
-  }; // class nesting_builder
+  dfn_t get_dfn(vertex_t n) const { return this->_dfn_table->get(n); }
 
-  dfn_t get_dfn(typename boost::graph_traits<G>::vertex_descriptor n) {
-    typename dfn_table_t::iterator it = this->_dfn_table->find(n);
-    if (it == this->_dfn_table->end()) {
-      return 0;
-    } else {
-      return it->second;
-    }
-  }
+  void set_dfn(vertex_t n, dfn_t dfn) { this->_dfn_table->set(n, dfn); }
 
-  void set_dfn(typename boost::graph_traits<G>::vertex_descriptor n,
-               dfn_t dfn) {
-    std::pair<typename dfn_table_t::iterator, bool> res =
-        this->_dfn_table->insert(std::make_pair(n, dfn));
-    if (!res.second) {
-      (res.first)->second = dfn;
-    }
-  }
-
-  typename boost::graph_traits<G>::vertex_descriptor pop() {
-    if (this->_stack->empty()) {
+  vertex_t pop() {
+    if (this->_stack.empty()) {
       CRAB_ERROR("WTO computation: empty stack");
     } else {
-      typename boost::graph_traits<G>::vertex_descriptor top =
-          this->_stack->back();
-      this->_stack->pop_back();
+      vertex_t top = this->_stack.back();
+      this->_stack.pop_back();
       return top;
     }
   }
 
-  void push(typename boost::graph_traits<G>::vertex_descriptor n) {
-    this->_stack->push_back(n);
-  }
+  void push(vertex_t n) { this->_stack.push_back(n); }
 
-  wto_cycle_ptr
-  component(G g, typename boost::graph_traits<G>::vertex_descriptor vertex) {
-    auto partition = std::make_shared<wto_component_list_t>();
+  unsigned component(G g, vertex_t vertex) {
+    std::vector<unsigned> partition;
     std::pair<typename boost::graph_traits<G>::out_edge_iterator,
               typename boost::graph_traits<G>::out_edge_iterator>
         succ_edges = out_edges(vertex, g);
@@ -447,34 +592,33 @@ private:
              it = succ_edges.first,
              et = succ_edges.second;
          it != et; ++it) {
-      typename boost::graph_traits<G>::vertex_descriptor succ = target(*it, g);
+      vertex_t succ = target(*it, g);
       if (this->get_dfn(succ) == 0) {
         this->visit(g, succ, partition);
       }
     }
-    return wto_cycle_ptr(new wto_cycle_t(vertex, partition));
+    _pool.push_back({vertex, true, std::move(partition)});
+    return _pool.size() - 1;
   }
 
-#ifndef RECURSIVE_WTO
   struct visit_stack_elem {
     using succ_iterator = typename boost::graph_traits<G>::out_edge_iterator;
-    typename boost::graph_traits<G>::vertex_descriptor _node;
+    vertex_t _node;
     succ_iterator _it; // begin iterator for node's successors
     succ_iterator _et; // end iterator for node's successors
     dfn_t _min;        // smallest dfn number of any (direct or
                        // indirect) node's successor through node's
                        // DFS subtree, included node.
 
-    visit_stack_elem(typename boost::graph_traits<G>::vertex_descriptor node,
+    visit_stack_elem(vertex_t node,
                      std::pair<succ_iterator, succ_iterator> succs, dfn_t min)
         : _node(node), _it(succs.first), _et(succs.second), _min(min) {}
   };
 
-  void visit(G g, typename boost::graph_traits<G>::vertex_descriptor vertex,
-             wto_component_list_ptr partition) {
+  void visit(G g, vertex_t vertex, std::vector<unsigned> &partition) {
 
     std::vector<visit_stack_elem> visit_stack;
-    std::set<typename boost::graph_traits<G>::vertex_descriptor> loop_nodes;
+    std::set<vertex_t> loop_nodes;
 
     /* discover vertex */
     push(vertex);
@@ -495,7 +639,7 @@ private:
       while (visit_stack.back()._it != visit_stack.back()._et) {
         typename boost::graph_traits<G>::edge_descriptor e =
             *visit_stack.back()._it++;
-        typename boost::graph_traits<G>::vertex_descriptor child = target(e, g);
+        vertex_t child = target(e, g);
         dfn_t child_dfn = get_dfn(child);
         if (child_dfn == 0) {
           /* discover new vertex */
@@ -517,8 +661,7 @@ private:
       }
 
       // propagate min from child to parent
-      typename boost::graph_traits<G>::vertex_descriptor visiting_node =
-          visit_stack.back()._node;
+      vertex_t visiting_node = visit_stack.back()._node;
       dfn_t min_visiting_node = visit_stack.back()._min;
       bool is_loop = loop_nodes.count(visiting_node) > 0;
       visit_stack.pop_back();
@@ -526,18 +669,17 @@ private:
         visit_stack.back()._min = min_visiting_node;
       }
 
-      auto dfn_visiting_node = get_dfn(visiting_node);
       CRAB_LOG("wto-nonrec", crab::outs()
                                  << "WTO: popped node " << visiting_node
-                                 << " dfs num= " << dfn_visiting_node
+                                 << " dfs num= " << get_dfn(visiting_node)
                                  << ": min=" << min_visiting_node << "\n";);
 
       if (min_visiting_node == get_dfn(visiting_node)) {
         CRAB_LOG("wto-nonrec", crab::outs()
                                    << "WTO: BEGIN building partition for node "
                                    << visiting_node << "\n";);
-        set_dfn(visiting_node, dfn_t::plus_infinity());
-        typename boost::graph_traits<G>::vertex_descriptor element = pop();
+        set_dfn(visiting_node, plus_infinity());
+        vertex_t element = pop();
         if (is_loop) {
           while (!(element == visiting_node)) {
             set_dfn(element, 0);
@@ -548,15 +690,12 @@ private:
           CRAB_LOG("wto-nonrec", crab::outs()
                                      << "\tWTO: adding component starting from "
                                      << visiting_node << "\n";);
-          partition->push_front(
-              std::static_pointer_cast<wto_component_t, wto_cycle_t>(
-                  component(g, visiting_node)));
+          partition.push_back(component(g, visiting_node));
         } else {
           CRAB_LOG("wto-nonrec", crab::outs() << "\tWTO: adding vertex "
                                               << visiting_node << "\n";);
-          partition->push_front(
-              std::static_pointer_cast<wto_component_t, wto_vertex_t>(
-                  wto_vertex_ptr(new wto_vertex_t(visiting_node))));
+          _pool.push_back({visiting_node, false, std::vector<unsigned>()});
+          partition.push_back(_pool.size() - 1);
         }
         CRAB_LOG("wto-nonrec", crab::outs()
                                    << "WTO: END building partition\n";);
@@ -564,132 +703,100 @@ private:
     } // end while (!visit_stack.empty())
   }
 
-#else
-  dfn_t visit(G g, typename boost::graph_traits<G>::vertex_descriptor vertex,
-              wto_component_list_ptr partition) {
-    dfn_t head = 0, min = 0;
-    bool loop;
-    typename boost::graph_traits<G>::vertex_descriptor element;
-
-    this->push(vertex);
-    this->_num += 1;
-    head = this->_num;
-    this->set_dfn(vertex, head);
-    loop = false;
-
-    std::pair<typename boost::graph_traits<G>::out_edge_iterator,
-              typename boost::graph_traits<G>::out_edge_iterator>
-        succ_edges = out_edges(vertex, g);
-    for (typename boost::graph_traits<G>::out_edge_iterator
-             it = succ_edges.first,
-             et = succ_edges.second;
-         it != et; ++it) {
-      typename boost::graph_traits<G>::vertex_descriptor succ = target(*it, g);
-      dfn_t succ_dfn = this->get_dfn(succ);
-      if (succ_dfn == 0) {
-        min = this->visit(g, succ, partition);
-      } else {
-        min = succ_dfn;
-      }
-      if (min <= head) {
-        head = min;
-        loop = true;
-      }
-    }
-    if (head == this->get_dfn(vertex)) {
-      this->set_dfn(vertex, dfn_t::plus_infinity());
-      element = this->pop();
-      if (loop) {
-        while (!(element == vertex)) {
-          this->set_dfn(element, 0);
-          element = this->pop();
-        }
-        partition->push_front(
-            std::static_pointer_cast<wto_component_t, wto_cycle_t>(
-                this->component(g, vertex)));
+  // Store the components of partition contiguously, in the order of
+  // the WTO. path contains the cycles that enclose them.
+  void flatten(const G &g, const std::vector<unsigned> &partition,
+               std::vector<unsigned> &path) {
+    data_t &d = *_data;
+    int parent = path.empty() ? -1 : (int)path.back();
+    for (auto it = partition.rbegin(), et = partition.rend(); it != et; ++it) {
+      const partition_elem &elem = _pool[*it];
+      unsigned pos = d.m_order.size();
+      d.m_parent_cycle.push_back(parent);
+      d.m_position.set(elem.node, pos);
+      if (elem.is_cycle) {
+        unsigned cycle = d.m_cycles.size();
+        d.m_cycles.push_back(wto_cycle_t(elem.node,
+                                         wto_impl::vertex_id(g, elem.node),
+                                         pos + 1, path.size() + 1,
+                                         d.m_paths.size()));
+        d.m_paths.insert(d.m_paths.end(), path.begin(), path.end());
+        d.m_paths.push_back(cycle);
+        d.m_order.push_back({true, cycle});
+        d.m_next.push_back(0);
+        path.push_back(cycle);
+        flatten(g, elem.partition, path);
+        path.pop_back();
+        d.m_cycles[cycle]._end = d.m_order.size();
       } else {
-        partition->push_front(
-            std::static_pointer_cast<wto_component_t, wto_vertex_t>(
-                wto_vertex_ptr(new wto_vertex_t(vertex))));
+        d.m_order.push_back({false, (unsigned)d.m_vertices.size()});
+        d.m_next.push_back(0);
+        d.m_vertices.push_back(
+            wto_vertex_t(elem.node, wto_impl::vertex_id(g, elem.node)));
       }
-    }
-    return head;
-  }
-#endif
-
-  void build_nesting() {
-    nesting_builder builder(this->_nesting_table);
-    for (iterator it = this->begin(); it != this->end(); ++it) {
-      it->accept(&builder);
+      d.m_next[pos] = d.m_order.size();
     }
   }
 
-public:
-  
-  wto(G g)
-      : _wto_components(std::make_shared<wto_component_list_t>()),
-        _dfn_table(std::make_shared<dfn_table_t>()), _num(0),
-        _stack(std::make_shared<stack_t>()),
-        _nesting_table(std::make_shared<nesting_table_t>()) {
+  void build(G g, vertex_t entry) {
     crab::ScopedCrabStats __st__("Fixpo.WTO");
 
-    this->visit(g, entry(g), this->_wto_components);
-    this->_dfn_table.reset();
-    this->_stack.reset();
-    this->build_nesting();
+    _dfn_table = dfn_table_t(g, 0);
+    std::vector<unsigned> partition;
+    this->visit(g, entry, partition);
+    std::vector<unsigned> path;
+    flatten(g, partition, path);
+    for (auto &c : _data->m_cycles) {
+      c._data = _data.get();
+    }
+    _dfn_table = boost::none;
+    _stack.clear();
+    _pool.clear();
   }
 
-  wto(G g, typename boost::graph_traits<G>::vertex_descriptor entry)
-      : _wto_components(std::make_shared<wto_component_list_t>()),
-        _dfn_table(std::make_shared<dfn_table_t>()), _num(0),
-        _stack(std::make_shared<stack_t>()),
-        _nesting_table(std::make_shared<nesting_table_t>()) {
-    crab::ScopedCrabStats __st__("Fixpo.WTO");
+  wto(std::shared_ptr<data_t> data) : _data(std::move(data)), _num(0) {}
+
+public:
+  wto(G g) : _data(new data_t(g)), _num(0) { build(g, entry(g)); }
 
-    this->visit(g, entry, this->_wto_components);
-    this->_dfn_table.reset();
-    this->_stack.reset();
-    this->build_nesting();
+  wto(G g, vertex_t entry) : _data(new data_t(g)), _num(0) {
+    build(g, entry);
   }
 
   wto(const wto_t &other) = delete;
   wto_t &operator=(const wto_t &other) = delete;
-  wto(wto_t &&other) = default;  
+  wto(wto_t &&other) = default;
   wto_t &operator=(wto_t &&other) = default;
 
   // deep copy
-  wto_t clone() const {    
-    auto wto_components = std::make_shared<wto_component_list_t>(*_wto_components);
-    auto dfn_table = _dfn_table ? std::make_shared<dfn_table_t>(*_dfn_table) : nullptr;
-    auto stack = _stack ? std::make_shared<stack_t>(*_stack) : nullptr;
-    auto nesting_table = std::make_shared<nesting_table_t>(*_nesting_table);
-    return wto_t(std::move(wto_components), std::move(dfn_table),
-		 _num, std::move(stack), std::move(nesting_table));
-  }
-  
-  iterator begin() {
-    return boost::make_indirect_iterator(_wto_components->begin());
+  wto_t clone() const {
+    wto_t res(std::make_shared<data_t>(*_data));
+    for (auto &c : res._data->m_cycles) {
+      c._data = res._data.get();
+    }
+    return res;
   }
 
-  iterator end() {
-    return boost::make_indirect_iterator(_wto_components->end());
-  }
+  iterator begin() { return iterator(_data.get(), 0); }
 
-  const_iterator begin() const {
-    return boost::make_indirect_iterator(_wto_components->begin());
-  }
+  iterator end() { return iterator(_data.get(), _data->m_order.size()); }
+
+  const_iterator begin() const { return const_iterator(_data.get(), 0); }
 
   const_iterator end() const {
-    return boost::make_indirect_iterator(_wto_components->end());
+    return const_iterator(_data.get(), _data->m_order.size());
   }
 
-  boost::optional<wto_nesting_t>
-  nesting(typename boost::graph_traits<G>::vertex_descriptor n) {
-    typename nesting_table_t::iterator it = this->_nesting_table->find(n);
-    if (it == this->_nesting_table->end()) {
+  boost::optional<wto_nesting_t> nesting(vertex_t n) const {
+    int pos = _data->position(n);
+    if (pos < 0) {
       return boost::optional<wto_nesting_t>();
+    }
+    int parent = _data->m_parent_cycle[pos];
+    if (parent < 0) {
+      return wto_nesting_t();
     } else {
-      return it->second;
+      return wto_nesting_t(_data, parent);
     }
   }
 
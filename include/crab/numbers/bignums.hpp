@@ -10,15 +10,38 @@
 // some clients.
 namespace ikos {
 
+namespace bignums_impl {
+class mpz_int64_view;
+} // namespace bignums_impl
+
 class z_number {
   friend class q_number;
 
 private:
-  mpz_t _n;
+  // Numbers that fit in int64_t are kept inline in _small and _n is
+  // not initialized. A number is promoted to a GMP integer only if
+  // the result of an operation overflows and it is demoted back as
+  // soon as it fits again in int64_t.
+  bool _is_small;
+  union {
+    int64_t _small;
+    mpz_t _n;
+  };
 
   bool fits_sint() const;
   bool fits_slong() const;
 
+  // Set this to n (normalizing the representation). It does not
+  // release the previous value of this.
+  void init_from_mpz(mpz_srcptr n);
+  // Set this to n (normalizing the representation).
+  void set_from_mpz(mpz_srcptr n);
+  // Make sure that this is represented as a GMP integer.
+  void promote();
+  // Return a read-only GMP integer for this. If this is small then
+  // the GMP integer is stored in tmp.
+  mpz_srcptr get_mpz_srcptr(bignums_impl::mpz_int64_view &tmp) const;
+  
   // used only by q_number
   static z_number from_mpz_t(mpz_t n);
   static z_number from_mpz_srcptr(mpz_srcptr n);
@@ -52,7 +75,10 @@ public:
   std::string get_str(unsigned base = 10) const;
 
   // do not use it: to be removed
-  mpz_ptr get_mpz_t() { return _n; }
+  mpz_ptr get_mpz_t() {
+    promote();
+    return _n;
+  }
   
   std::size_t hash() const;
 
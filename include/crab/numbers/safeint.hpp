@@ -28,15 +28,38 @@ class safe_i64 {
     using wideint_t = boost::multiprecision::int128_t;
 #endif
 
-  static int64_t get_max();
-  static int64_t get_min();
-
-  static int checked_add(int64_t a, int64_t b, int64_t *rp);
-  static int checked_sub(int64_t a, int64_t b, int64_t *rp);
-  static int checked_mul(int64_t a, int64_t b, int64_t *rp);
-  static int checked_div(int64_t a, int64_t b, int64_t *rp);
+  static int64_t get_max() { return std::numeric_limits<int64_t>::max(); }
+  static int64_t get_min() { return std::numeric_limits<int64_t>::min(); }
 
 public:
+  // Overflow checks: return non-zero if the result of the operation
+  // does not fit in int64_t. Otherwise, the result is stored in rp.
+  // They are defined inline since they are also used by the machine
+  // integer intervals (i64_interval).
+  static int checked_add(int64_t a, int64_t b, int64_t *rp) {
+    wideint_t lr = (wideint_t)a + (wideint_t)b;
+    *rp = lr;
+    return lr > get_max() || lr < get_min();
+  }
+
+  static int checked_sub(int64_t a, int64_t b, int64_t *rp) {
+    wideint_t lr = (wideint_t)a - (wideint_t)b;
+    *rp = lr;
+    return lr > get_max() || lr < get_min();
+  }
+
+  static int checked_mul(int64_t a, int64_t b, int64_t *rp) {
+    wideint_t lr = (wideint_t)a * (wideint_t)b;
+    *rp = lr;
+    return lr > get_max() || lr < get_min();
+  }
+
+  static int checked_div(int64_t a, int64_t b, int64_t *rp) {
+    wideint_t lr = (wideint_t)a / (wideint_t)b;
+    *rp = lr;
+    return lr > get_max() || lr < get_min();
+  }
+
   safe_i64();
 
   safe_i64(int64_t num);
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace crab {
+
+/**
+ * Append-only buffer of bytes.
+ *
+ * Unsigned integers are encoded as LEB128 varints and signed ones are
+ * zigzag-encoded first so that small values take a single byte.
+ **/
+class binary_output {
+  std::vector<char> m_buf;
+
+public:
+  binary_output() {}
+
+  void put_u8(uint8_t v) { m_buf.push_back(static_cast<char>(v)); }
+  void put_varint(uint64_t v);
+  void put_svarint(int64_t v);
+  void put_bytes(const char *data, std::size_t size);
+  void put_string(const std::string &s);
+  void append(const binary_output &o);
+
+  const char *data() const { return m_buf.data(); }
+  std::size_t size() const { return m_buf.size(); }
+  void clear() { m_buf.clear(); }
+
+  // Write the buffer into filename. Return false if the file cannot
+  // be written.
+  bool write_to_file(const std::string &filename) const;
+};
+
+/**
+ * Read-only view over a sequence of bytes written by binary_output.
+ *
+ * It does not own the bytes. Reading past the end or decoding a
+ * malformed value is an error.
+ **/
+class binary_input {
+  const char *m_cur;
+  const char *m_end;
+
+  void check(std::size_t n) const;
+
+public:
+  binary_input() : m_cur(nullptr), m_end(nullptr) {}
+  binary_input(const char *data, std::size_t size)
+      : m_cur(data), m_end(data + size) {}
+
+  uint8_t get_u8() {
+    check(1);
+    return static_cast<uint8_t>(*m_cur++);
+  }
+  uint64_t get_varint();
+  int64_t get_svarint();
+  // Return a pointer to the next size bytes and skip them
+  const char *get_bytes(std::size_t size);
+  // Return the bytes of a string written by put_string without copying
+  // them
+  std::pair<const char *, std::size_t> get_string_ref();
+  std::string get_string();
+
+  bool at_end() const { return m_cur == m_end; }
+  const char *position() const { return m_cur; }
+};
+
+/**
+ * A read-only file mapped into memory.
+ *
+ * If the file cannot be mapped (e.g., the platform does not support
+ * mmap) then it is read into a buffer instead.
+ **/
+class mapped_file {
+  const char *m_data;
+  std::size_t m_size;
+  bool m_is_open;
+  bool m_is_mapped;
+  std::vector<char> m_buf;
+
+public:
+  mapped_file()
+      : m_data(nullptr), m_size(0), m_is_open(false), m_is_mapped(false) {}
+  mapped_file(const mapped_file &o) = delete;
+  mapped_file &operator=(const mapped_file &o) = delete;
+  ~mapped_file() { close(); }
+
+  // Return false if the file cannot be opened.
+  bool open(const std::string &filename);
+  void close();
+
+  bool is_open() const { return m_is_open; }
+  const char *data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+};
+
+} // end namespace crab
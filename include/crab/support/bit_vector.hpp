@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace crab {
+
+/**
+ * A fixed-size set of small integers packed into 64-bit words.
+ *
+ * The set operations work a word at a time in plain loops that the
+ * compiler can vectorize. The binary operations require both
+ * operands to have the same size.
+ **/
+class bit_vector {
+  using word_t = uint64_t;
+  static const std::size_t word_bits = 64;
+
+  std::vector<word_t> m_words;
+  std::size_t m_size;
+
+  static std::size_t num_words(std::size_t n) {
+    return (n + word_bits - 1) / word_bits;
+  }
+
+  static unsigned lowest_bit(word_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    unsigned i = 0;
+    while (!(w & 1)) {
+      w >>= 1;
+      ++i;
+    }
+    return i;
+#endif
+  }
+
+  static unsigned popcount(word_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(w);
+#else
+    unsigned n = 0;
+    for (; w; w &= w - 1) {
+      ++n;
+    }
+    return n;
+#endif
+  }
+
+public:
+  bit_vector() : m_size(0) {}
+
+  explicit bit_vector(std::size_t size)
+      : m_words(num_words(size), 0), m_size(size) {}
+
+  std::size_t size() const { return m_size; }
+
+  bool test(std::size_t i) const {
+    return (m_words[i / word_bits] >> (i % word_bits)) & 1;
+  }
+
+  void set(std::size_t i) {
+    m_words[i / word_bits] |= word_t(1) << (i % word_bits);
+  }
+
+  void reset(std::size_t i) {
+    m_words[i / word_bits] &= ~(word_t(1) << (i % word_bits));
+  }
+
+  void clear() {
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      m_words[k] = 0;
+    }
+  }
+
+  bool empty() const {
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      if (m_words[k]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::size_t count() const {
+    std::size_t n = 0;
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      n += popcount(m_words[k]);
+    }
+    return n;
+  }
+
+  // union
+  bit_vector &operator|=(const bit_vector &o) {
+    const word_t *src = o.m_words.data();
+    word_t *dst = m_words.data();
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      dst[k] |= src[k];
+    }
+    return *this;
+  }
+
+  // difference
+  bit_vector &operator-=(const bit_vector &o) {
+    const word_t *src = o.m_words.data();
+    word_t *dst = m_words.data();
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      dst[k] &= ~src[k];
+    }
+    return *this;
+  }
+
+  // this := (a - kill) | gen. Return true if this changed.
+  bool assign_transfer(const bit_vector &a, const bit_vector &kill,
+                       const bit_vector &gen) {
+    word_t changed = 0;
+    word_t *dst = m_words.data();
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      word_t w = (a.m_words[k] & ~kill.m_words[k]) | gen.m_words[k];
+      changed |= w ^ dst[k];
+      dst[k] = w;
+    }
+    return changed != 0;
+  }
+
+  bool operator==(const bit_vector &o) const {
+    return m_size == o.m_size && m_words == o.m_words;
+  }
+
+  bool operator!=(const bit_vector &o) const { return !(*this == o); }
+
+  // Call f(i) for each element i in increasing order
+  template <class F> void for_each(F f) const {
+    for (std::size_t k = 0, e = m_words.size(); k < e; ++k) {
+      word_t w = m_words[k];
+      while (w) {
+        f(k * word_bits + lowest_bit(w));
+        w &= w - 1;
+      }
+    }
+  }
+};
+
+} // end namespace crab
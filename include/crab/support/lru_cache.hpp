@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace crab {
+
+/**
+ * A map with a bounded number of entries.
+ *
+ * When a new entry is inserted into a full cache the least recently
+ * used entry is evicted. Both find() and insert() mark the entry as
+ * the most recently used one. A cache with capacity 0 never stores
+ * anything.
+ **/
+template <typename Key, typename Value> class lru_cache {
+  using entry_t = std::pair<Key, Value>;
+  using list_t = std::list<entry_t>;
+
+  // most recently used entries first
+  list_t m_entries;
+  std::unordered_map<Key, typename list_t::iterator> m_index;
+  std::size_t m_capacity;
+
+public:
+  explicit lru_cache(std::size_t capacity = 0) : m_capacity(capacity) {}
+
+  lru_cache(const lru_cache &o) : m_capacity(o.m_capacity) {
+    for (auto const &kv : o.m_entries) {
+      m_entries.push_back(kv);
+      m_index.insert({kv.first, std::prev(m_entries.end())});
+    }
+  }
+
+  lru_cache &operator=(const lru_cache &o) {
+    if (this != &o) {
+      clear();
+      m_capacity = o.m_capacity;
+      for (auto const &kv : o.m_entries) {
+        m_entries.push_back(kv);
+        m_index.insert({kv.first, std::prev(m_entries.end())});
+      }
+    }
+    return *this;
+  }
+
+  // Return a pointer to the value associated with k or nullptr. The
+  // pointer is valid until the entry is evicted.
+  const Value *find(const Key &k) {
+    auto it = m_index.find(k);
+    if (it == m_index.end()) {
+      return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &(it->second->second);
+  }
+
+  void insert(const Key &k, Value v) {
+    if (m_capacity == 0) {
+      return;
+    }
+    auto it = m_index.find(k);
+    if (it != m_index.end()) {
+      it->second->second = std::move(v);
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return;
+    }
+    if (m_entries.size() == m_capacity) {
+      m_index.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+    m_entries.emplace_front(k, std::move(v));
+    m_index.insert({k, m_entries.begin()});
+  }
+
+  void erase(const Key &k) {
+    auto it = m_index.find(k);
+    if (it != m_index.end()) {
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    }
+  }
+
+  void clear() {
+    m_index.clear();
+    m_entries.clear();
+  }
+
+  std::size_t size() const { return m_entries.size(); }
+
+  std::size_t capacity() const { return m_capacity; }
+
+  void set_capacity(std::size_t capacity) {
+    m_capacity = capacity;
+    while (m_entries.size() > m_capacity) {
+      m_index.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+  }
+};
+
+} // end namespace crab
@@ -32,6 +32,33 @@ inline crab_os &operator<<(crab_os &OS, const Stopwatch &sw) {
   return OS;
 }
 
+/*
+ * The interned name of a counter or a stop watch.
+ *
+ * Interning a name is as expensive as updating a statistic by its
+ * name but then updating it through its identifier does not allocate
+ * nor look up the name. Use CRAB_STATS_ID to intern a name only the
+ * first time a statement is executed.
+ */
+class CrabStatsId {
+  unsigned m_id;
+
+public:
+  explicit CrabStatsId(const std::string &name);
+  unsigned get() const { return m_id; }
+};
+
+/*
+ * Return the identifier of NAME. NAME is only evaluated the first
+ * time so it must not change between executions, e.g.,
+ *   CrabStats::count(CRAB_STATS_ID(domain_name() + ".count.copy"));
+ */
+#define CRAB_STATS_ID(NAME)                                                    \
+  ([&]() -> const ::crab::CrabStatsId & {                                     \
+    static const ::crab::CrabStatsId __crab_stats_id(NAME);                   \
+    return __crab_stats_id;                                                    \
+  }())
+
 class CrabStats {
   static std::map<std::string, unsigned> &getCounters();
   static std::map<std::string, Stopwatch> &getTimers();
@@ -50,6 +77,15 @@ public:
   static void stop(const std::string &name);
   static void resume(const std::string &name);
 
+  /* Counters and stop watches identified by interned names. They are
+     updated without locking in thread-local tables that are
+     aggregated by Print. Print and reset should not be called while
+     other threads are updating statistics. */
+  static void count(const CrabStatsId &id);
+  static void start(const CrabStatsId &id);
+  static void stop(const CrabStatsId &id);
+  static void resume(const CrabStatsId &id);
+
   /** Outputs all statistics to std output */
   static void Print(crab_os &OS);
   static void PrintBrunch(crab_os &OS);
@@ -57,9 +93,12 @@ public:
 
 class ScopedCrabStats {
   std::string m_name;
+  // interned name if m_name is not used
+  const CrabStatsId *m_id;
 
 public:
   ScopedCrabStats(const std::string &name, bool reset = false);
+  ScopedCrabStats(const CrabStatsId &id);
   ~ScopedCrabStats();
 };
 } // namespace crab
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace crab {
+
+/**
+ * A small work-stealing pool of worker threads.
+ *
+ * Each worker owns a queue. Tasks submitted by a worker are pushed
+ * into its own queue and popped in LIFO order while tasks submitted
+ * from outside the pool are distributed round-robin. An idle worker
+ * steals the oldest task from the queues of the other workers.
+ *
+ * wait() blocks until all submitted tasks, including those submitted
+ * by other tasks, have completed and rethrows the first exception
+ * raised by a task, if any.
+ **/
+class thread_pool {
+public:
+  using task_t = std::function<void()>;
+
+private:
+  struct worker_queue {
+    std::mutex m_mutex;
+    std::deque<task_t> m_tasks;
+  };
+
+  std::vector<std::unique_ptr<worker_queue>> m_queues;
+  std::vector<std::thread> m_workers;
+  // protect the fields below
+  std::mutex m_mutex;
+  std::condition_variable m_wakeup;
+  std::condition_variable m_done;
+  // number of submitted tasks that have not completed yet
+  std::size_t m_pending;
+  // number of tasks waiting in the queues
+  std::size_t m_queued;
+  bool m_stop;
+  std::exception_ptr m_error;
+  std::atomic<unsigned> m_next_queue;
+
+  struct worker_info {
+    const thread_pool *pool;
+    unsigned id;
+  };
+
+  static worker_info &current_worker() {
+    static thread_local worker_info info = {nullptr, 0};
+    return info;
+  }
+
+  bool pop(unsigned id, task_t &task) {
+    { // own queue: newest task first
+      worker_queue &q = *m_queues[id];
+      std::lock_guard<std::mutex> lock(q.m_mutex);
+      if (!q.m_tasks.empty()) {
+        task = std::move(q.m_tasks.back());
+        q.m_tasks.pop_back();
+        return true;
+      }
+    }
+    // steal the oldest task from another worker
+    for (unsigned i = 1, n = m_queues.size(); i < n; ++i) {
+      worker_queue &q = *m_queues[(id + i) % n];
+      std::lock_guard<std::mutex> lock(q.m_mutex);
+      if (!q.m_tasks.empty()) {
+        task = std::move(q.m_tasks.front());
+        q.m_tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void worker_loop(unsigned id) {
+    current_worker().pool = this;
+    current_worker().id = id;
+    while (true) {
+      task_t task;
+      if (pop(id, task)) {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          --m_queued;
+        }
+        try {
+          task();
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if (!m_error) {
+            m_error = std::current_exception();
+          }
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) {
+          m_done.notify_all();
+        }
+      } else {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_stop || m_queued > 0; });
+        if (m_stop && m_queued == 0) {
+          return;
+        }
+      }
+    }
+  }
+
+public:
+  thread_pool(unsigned num_threads)
+      : m_pending(0), m_queued(0), m_stop(false), m_next_queue(0) {
+    if (num_threads == 0) {
+      num_threads = 1;
+    }
+    for (unsigned i = 0; i < num_threads; ++i) {
+      m_queues.emplace_back(new worker_queue());
+    }
+    for (unsigned i = 0; i < num_threads; ++i) {
+      m_workers.emplace_back([this, i] { worker_loop(i); });
+    }
+  }
+
+  thread_pool(const thread_pool &other) = delete;
+  thread_pool &operator=(const thread_pool &other) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wakeup.notify_all();
+    for (auto &w : m_workers) {
+      w.join();
+    }
+  }
+
+  unsigned size() const { return m_workers.size(); }
+
+  void submit(task_t task) {
+    const worker_info &info = current_worker();
+    unsigned id = (info.pool == this)
+                      ? info.id
+                      : m_next_queue.fetch_add(1) % m_queues.size();
+    {
+      // account for the task before it can be popped
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_pending;
+      ++m_queued;
+    }
+    {
+      worker_queue &q = *m_queues[id];
+      std::lock_guard<std::mutex> lock(q.m_mutex);
+      q.m_tasks.push_back(std::move(task));
+    }
+    m_wakeup.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    if (m_error) {
+      std::exception_ptr error = m_error;
+      m_error = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Return the index of the calling thread in this pool. The index
+  // is in [0, size()) if the caller is one of the pool workers and
+  // size() otherwise.
+  unsigned worker_id() const {
+    const worker_info &info = current_worker();
+    return (info.pool == this) ? info.id : size();
+  }
+};
+
+/**
+ * Run task(i) for each node i of a directed acyclic graph whose
+ * edges are given by succs on the workers of pool. A node starts
+ * only once all its predecessors have completed. It blocks until all
+ * the tasks have completed.
+ **/
+inline void run_dag(thread_pool &pool,
+                    const std::vector<std::vector<unsigned>> &succs,
+                    const std::function<void(unsigned)> &task) {
+  const unsigned num_nodes = succs.size();
+  std::vector<std::atomic<unsigned>> num_waiting(num_nodes);
+  for (auto &s : succs) {
+    for (unsigned j : s) {
+      ++num_waiting[j];
+    }
+  }
+  // The roots must be collected before any task starts
+  std::vector<unsigned> roots;
+  for (unsigned i = 0; i < num_nodes; ++i) {
+    if (num_waiting[i] == 0) {
+      roots.push_back(i);
+    }
+  }
+
+  std::function<void(unsigned)> run_from = [&](unsigned i) {
+    while (true) {
+      task(i);
+      // Continue with the first successor that becomes ready and
+      // submit the others.
+      bool has_next = false;
+      unsigned next = 0;
+      for (unsigned j : succs[i]) {
+        if (--num_waiting[j] == 0) {
+          if (!has_next) {
+            has_next = true;
+            next = j;
+          } else {
+            pool.submit([&run_from, j] { run_from(j); });
+          }
+        }
+      }
+      if (!has_next) {
+        break;
+      }
+      i = next;
+    }
+  };
+
+  for (unsigned i : roots) {
+    pool.submit([&run_from, i] { run_from(i); });
+  }
+  pool.wait();
+}
+
+} // namespace crab
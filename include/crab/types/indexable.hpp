@@ -9,10 +9,15 @@ using index_t = uint64_t;
 } // end namespace ikos
 
 namespace crab {
-class indexable {
-public:
-  virtual ~indexable() = default;
-  virtual ikos::index_t index() const = 0;
-  virtual void write(crab::crab_os &o) const = 0;
-};
+/*
+ * Base class of the objects that can be used as keys of patricia
+ * trees. A derived class must provide the methods
+ *
+ *   ikos::index_t index() const;
+ *   void write(crab::crab_os &o) const;
+ *
+ * The class is not polymorphic so that small keys such as variables
+ * do not carry a vtable and remain trivially copyable.
+ */
+class indexable {};
 } // end namespace crab
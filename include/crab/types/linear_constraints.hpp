@@ -46,12 +46,13 @@
 #include <crab/types/indexable.hpp>
 #include <crab/types/variable.hpp>
 
-#include <boost/container/flat_map.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/functional/hash_fwd.hpp> // for hash_combine
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <unordered_map>
@@ -69,33 +70,76 @@ public:
   using component_t = std::pair<Number, variable_t>;
 
 private:
-  // use associative map to keep variables ordered.
-  using map_t = boost::container::flat_map<variable_t, Number>;
-  using map_ptr = std::shared_ptr<map_t>;
-  using pair_t = typename map_t::value_type;
+  // Terms sorted by variable. Most expressions have very few terms so
+  // they are kept inline and only spill to the heap when they grow.
+  using pair_t = std::pair<variable_t, Number>;
+  using map_t = boost::container::small_vector<pair_t, 3>;
 
-  map_ptr _map;
+  map_t _map;
   Number _cst;
 
-  linear_expression(map_ptr map, Number cst) : _map(map), _cst(cst) {}
+  linear_expression(const map_t &map, Number cst) : _map(map), _cst(cst) {}
 
-  linear_expression(const map_t &map, Number cst)
-      : _map(std::make_shared<map_t>()), _cst(cst) {
-    *this->_map = map;
+  linear_expression(map_t &&map, Number cst)
+      : _map(std::move(map)), _cst(cst) {}
+
+  static bool var_lt(const pair_t &kv, const variable_t &x) {
+    return kv.first < x;
+  }
+
+  typename map_t::const_iterator find(const variable_t &x) const {
+    auto it = std::lower_bound(_map.begin(), _map.end(), x, var_lt);
+    return (it != _map.end() && it->first == x) ? it : _map.end();
+  }
+
+  // Return the terms of a+b (a-b if negate) by merging the two sorted
+  // sequences.
+  static map_t merge(const map_t &a, const map_t &b, bool negate) {
+    map_t r;
+    r.reserve(a.size() + b.size());
+    auto i = a.begin(), ie = a.end();
+    auto j = b.begin(), je = b.end();
+    while (i != ie && j != je) {
+      if (i->first < j->first) {
+        r.push_back(*i);
+        ++i;
+      } else if (j->first < i->first) {
+        if (j->second != 0) {
+          r.emplace_back(j->first, negate ? -j->second : j->second);
+        }
+        ++j;
+      } else {
+        Number c = negate ? i->second - j->second : i->second + j->second;
+        if (c != 0) {
+          r.emplace_back(i->first, c);
+        }
+        ++i;
+        ++j;
+      }
+    }
+    for (; i != ie; ++i) {
+      r.push_back(*i);
+    }
+    for (; j != je; ++j) {
+      if (j->second != 0) {
+        r.emplace_back(j->first, negate ? -j->second : j->second);
+      }
+    }
+    return r;
   }
 
   void add(variable_t x, Number n) {
-    typename map_t::iterator it = this->_map->find(x);
-    if (it != this->_map->end()) {
+    auto it = std::lower_bound(_map.begin(), _map.end(), x, var_lt);
+    if (it != _map.end() && it->first == x) {
       Number r = it->second + n;
       if (r == 0) {
-        this->_map->erase(it);
+        _map.erase(it);
       } else {
         it->second = r;
       }
     } else {
       if (n != 0) {
-        this->_map->insert(pair_t(x, n));
+        _map.insert(it, pair_t(x, n));
       }
     }
   }
@@ -123,20 +167,18 @@ public:
       boost::transform_iterator<get_var, typename map_t::const_iterator>;
   using const_var_range = boost::iterator_range<const_var_iterator>;
 
-  linear_expression() : _map(std::make_shared<map_t>()), _cst(0) {}
+  linear_expression() : _cst(0) {}
 
-  linear_expression(Number n) : _map(std::make_shared<map_t>()), _cst(n) {}
+  linear_expression(Number n) : _cst(n) {}
 
-  linear_expression(int64_t n)
-      : _map(std::make_shared<map_t>()), _cst(Number(n)) {}
+  linear_expression(int64_t n) : _cst(Number(n)) {}
 
-  linear_expression(variable_t x) : _map(std::make_shared<map_t>()), _cst(0) {
-    this->_map->insert(pair_t(x, Number(1)));
+  linear_expression(variable_t x) : _cst(0) {
+    _map.emplace_back(x, Number(1));
   }
 
-  linear_expression(Number n, variable_t x)
-      : _map(std::make_shared<map_t>()), _cst(0) {
-    this->_map->insert(pair_t(x, n));
+  linear_expression(Number n, variable_t x) : _cst(0) {
+    _map.emplace_back(x, n);
   }
 
   linear_expression(const linear_expression_t &e) = default;
@@ -148,11 +190,11 @@ public:
   linear_expression_t &operator=(linear_expression_t &&e) = default;
 
   const_iterator begin() const {
-    return boost::make_transform_iterator(_map->begin(), tr_value_ty());
+    return boost::make_transform_iterator(_map.begin(), tr_value_ty());
   }
 
   const_iterator end() const {
-    return boost::make_transform_iterator(_map->end(), tr_value_ty());
+    return boost::make_transform_iterator(_map.end(), tr_value_ty());
   }
 
   size_t hash() const {
@@ -210,10 +252,10 @@ public:
     };
     // code from
     // https://en.cppreference.com/w/cpp/algorithm/lexicographical_compare
-    auto first1 = _map->begin();
-    auto last1 = _map->end();
-    auto first2 = o._map->begin();
-    auto last2 = o._map->end();
+    auto first1 = _map.begin();
+    auto last1 = _map.end();
+    auto first2 = o._map.begin();
+    auto last2 = o._map.end();
     for ( ; (first1 != last1) && (first2 != last2); ++first1, (void) ++first2 ) {
       if (comp(*first1, *first2)) return true;
       if (comp(*first2, *first1)) return false;
@@ -221,15 +263,15 @@ public:
     return (first1 == last1) && (first2 != last2);    
   }
   
-  bool is_constant() const { return (this->_map->size() == 0); }
+  bool is_constant() const { return _map.empty(); }
 
   Number constant() const { return this->_cst; }
 
-  std::size_t size() const { return this->_map->size(); }
+  std::size_t size() const { return _map.size(); }
 
   Number operator[](const variable_t &x) const {
-    typename map_t::const_iterator it = this->_map->find(x);
-    if (it != this->_map->end()) {
+    typename map_t::const_iterator it = find(x);
+    if (it != _map.end()) {
       return it->second;
     } else {
       return 0;
@@ -262,18 +304,14 @@ public:
   }
 
   linear_expression_t operator+(variable_t x) const {
-    linear_expression_t r(*this->_map, this->_cst);
+    linear_expression_t r(_map, this->_cst);
     r.add(x, Number(1));
     return r;
   }
 
   linear_expression_t operator+(const linear_expression_t &e) const {
-    linear_expression_t r(*this->_map, this->_cst + e._cst);
-    for (typename map_t::const_iterator it = e._map->begin();
-         it != e._map->end(); ++it) {
-      r.add(it->first, it->second);
-    }
-    return r;
+    return linear_expression_t(merge(_map, e._map, false),
+                               this->_cst + e._cst);
   }
 
   linear_expression_t operator-(Number n) const { return this->operator+(-n); }
@@ -283,7 +321,7 @@ public:
   }
 
   linear_expression_t operator-(variable_t x) const {
-    linear_expression_t r(*this->_map, this->_cst);
+    linear_expression_t r(_map, this->_cst);
     r.add(x, Number(-1));
     return r;
   }
@@ -291,27 +329,24 @@ public:
   linear_expression_t operator-() const { return this->operator*(Number(-1)); }
 
   linear_expression_t operator-(const linear_expression_t &e) const {
-    linear_expression_t r(*this->_map, this->_cst - e._cst);
-    for (typename map_t::const_iterator it = e._map->begin();
-         it != e._map->end(); ++it) {
-      r.add(it->first, -it->second);
-    }
-    return r;
+    return linear_expression_t(merge(_map, e._map, true),
+                               this->_cst - e._cst);
   }
 
   linear_expression_t operator*(Number n) const {
     if (n == 0) {
       return linear_expression_t();
     } else {
-      map_ptr map = std::make_shared<map_t>();
-      for (typename map_t::const_iterator it = this->_map->begin();
-           it != this->_map->end(); ++it) {
+      map_t map;
+      map.reserve(_map.size());
+      for (typename map_t::const_iterator it = _map.begin(); it != _map.end();
+           ++it) {
         Number c = n * it->second;
         if (c != 0) {
-          map->insert(pair_t(it->first, c));
+          map.emplace_back(it->first, c);
         }
       }
-      return linear_expression_t(map, n * this->_cst);
+      return linear_expression_t(std::move(map), n * this->_cst);
     }
   }
 
@@ -320,11 +355,11 @@ public:
   }
 
   const_var_iterator variables_begin() const {
-    return boost::make_transform_iterator(_map->begin(), get_var());
+    return boost::make_transform_iterator(_map.begin(), get_var());
   }
 
   const_var_iterator variables_end() const {
-    return boost::make_transform_iterator(_map->end(), get_var());
+    return boost::make_transform_iterator(_map.end(), get_var());
   }
 
   // Variables are sorted
@@ -362,11 +397,11 @@ public:
   }
 
   void write(crab::crab_os &o) const {
-    for (typename map_t::const_iterator it = this->_map->begin();
-         it != this->_map->end(); ++it) {
+    for (typename map_t::const_iterator it = _map.begin(); it != _map.end();
+         ++it) {
       Number n = it->second;
       variable_t v = it->first;
-      if (n > 0 && it != this->_map->begin()) {
+      if (n > 0 && it != _map.begin()) {
         o << "+";
       }
       if (n == -1) {
@@ -376,10 +411,10 @@ public:
       }
       o << v;
     }
-    if (this->_cst > 0 && this->_map->size() > 0) {
+    if (this->_cst > 0 && !_map.empty()) {
       o << "+";
     }
-    if (this->_cst != 0 || this->_map->size() == 0) {
+    if (this->_cst != 0 || _map.empty()) {
       o << this->_cst;
     }
   }
@@ -24,8 +24,8 @@ public:
   tag &operator=(tag &&as) = default;
   bool operator<(const tag &as) const;
   bool operator==(const tag &as) const;
-  virtual ikos::index_t index() const override;
-  void write(crab_os &o) const override;
+  ikos::index_t index() const;
+  void write(crab_os &o) const;
   friend crab_os &operator<<(crab_os &o, const tag &as) {
     as.write(o);
     return o;
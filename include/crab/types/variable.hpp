@@ -113,6 +113,8 @@ public:
     return res;
   }
 
+  variable_type_kind get_kind() const { return m_kind; }
+
   bool is_typed() const { return m_kind != UNK_TYPE; }
 
   //// scalars
@@ -260,24 +262,27 @@ public:
   using varname_t = VariableName;
 
 private:
-  VariableName _n;
+  // m_ty goes first so that the indexable base of _n does not overlap
+  // with the indexable base of this class: both are empty and then
+  // the variable does not need padding.
   variable_type m_ty;
+  VariableName _n;
 
 public:
   /* ========== Begin internal API  ============= */
   /* Call this constructor only from abstract domains */
-  explicit variable(const VariableName &n) : _n(n), m_ty(crab::UNK_TYPE, 0) {}
+  explicit variable(const VariableName &n) : m_ty(crab::UNK_TYPE, 0), _n(n) {}
 
   /* Call this constructor only from abstract domains */
   variable(const VariableName &n, variable_type_kind ty_kind)
-      : _n(n), m_ty(ty_kind, 0) {}
+      : m_ty(ty_kind, 0), _n(n) {}
 
   /* Call this constructor only from abstract domains */
   variable(const VariableName &n, variable_type_kind ty_kind, bitwidth_t width)
-      : _n(n), m_ty(ty_kind, width) {}
+      : m_ty(ty_kind, width), _n(n) {}
   /* ========== End internal API  =============== */
 public:
-  variable(const VariableName &n, variable_type ty) : _n(n), m_ty(ty) {}
+  variable(const VariableName &n, variable_type ty) : m_ty(ty), _n(n) {}
 
   variable(const variable_t &o) = default;
 
@@ -291,7 +296,7 @@ public:
 
   const VariableName &name() const { return _n; }
 
-  virtual ikos::index_t index() const override { return _n.index(); }
+  ikos::index_t index() const { return _n.index(); }
 
   // Note: for hash(), operator==, and operator< we could delegate on
   // calling _n's methods if _n is an indexed_varname. This is always
@@ -308,7 +313,7 @@ public:
 
   bool operator<(const variable_t &o) const { return index() < o.index(); }
 
-  virtual void write(crab::crab_os &o) const override {
+  void write(crab::crab_os &o) const {
     o << _n;
     CRAB_LOG("crab-print-types", o << ":" << get_type(););
   }
@@ -13,10 +13,14 @@
 #include <boost/optional.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -32,6 +36,100 @@ namespace var_factory_impl {
 
 template <typename T> class variable_factory;
 
+// The live variable factories of type T. An indexed_varname refers to
+// its factory through its position in the registry so that it does
+// not need to store a pointer.
+//
+// The registry is a table of fixed-size chunks of slots. Chunks are
+// never moved or freed and a slot is only written when its factory is
+// created or destroyed, so looking up a factory does not need the
+// lock. The slot of a destroyed factory is reused by the next
+// factories so the number of chunks only depends on the number of
+// factories alive at the same time.
+template <typename T> class variable_factory_registry {
+  using slot_t = std::atomic<variable_factory<T> *>;
+  static constexpr uint32_t chunk_size = 4096;
+  static constexpr uint32_t num_chunks = 1024;
+
+  // protect the creation and destruction of factories
+  std::mutex m_mutex;
+  uint32_t m_next_id;
+  // slots released by destroyed factories
+  std::vector<uint32_t> m_free_ids;
+  std::atomic<slot_t *> m_chunks[num_chunks];
+
+  variable_factory_registry() : m_next_id(0) {
+    for (uint32_t i = 0; i < num_chunks; ++i) {
+      m_chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~variable_factory_registry() {
+    for (uint32_t i = 0; i < num_chunks; ++i) {
+      delete[] m_chunks[i].load(std::memory_order_relaxed);
+    }
+  }
+
+public:
+  static variable_factory_registry<T> &get() {
+    static variable_factory_registry<T> registry;
+    return registry;
+  }
+
+  uint32_t add(variable_factory<T> *vfac) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_free_ids.empty()) {
+      uint32_t id = m_free_ids.back();
+      m_free_ids.pop_back();
+      slot_t *chunk =
+          m_chunks[id / chunk_size].load(std::memory_order_relaxed);
+      chunk[id % chunk_size].store(vfac, std::memory_order_release);
+      return id;
+    }
+    const uint32_t max_factories = chunk_size * num_chunks;
+    if (m_next_id == max_factories) {
+      CRAB_ERROR("Reached limit of ", max_factories,
+                 " live variable factories");
+    }
+    uint32_t id = m_next_id++;
+    slot_t *chunk = m_chunks[id / chunk_size].load(std::memory_order_relaxed);
+    if (!chunk) {
+      chunk = new slot_t[chunk_size];
+      for (uint32_t i = 0; i < chunk_size; ++i) {
+        chunk[i].store(nullptr, std::memory_order_relaxed);
+      }
+      m_chunks[id / chunk_size].store(chunk, std::memory_order_release);
+    }
+    chunk[id % chunk_size].store(vfac, std::memory_order_release);
+    return id;
+  }
+
+  void remove(uint32_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    slot_t *chunk = m_chunks[id / chunk_size].load(std::memory_order_relaxed);
+    assert(chunk);
+    chunk[id % chunk_size].store(nullptr, std::memory_order_release);
+    m_free_ids.push_back(id);
+  }
+
+  variable_factory<T> &at(uint32_t id) const {
+    slot_t *chunk = m_chunks[id / chunk_size].load(std::memory_order_acquire);
+    variable_factory<T> *vfac =
+        chunk ? chunk[id % chunk_size].load(std::memory_order_acquire)
+              : nullptr;
+    if (!vfac) {
+      CRAB_ERROR("variable factory ", id,
+                 " does not exist: a variable outlived its factory");
+    }
+    return *vfac;
+  }
+};
+
+// A variable name is a 32-bit identifier together with the identifier
+// of the factory that created it. Its name and the element of type T
+// it is associated with are kept by the factory. Thus, it is trivially
+// copyable and cheap to store in the datastructures of the abstract
+// domains.
 template <class T> class indexed_varname : public indexable {
   template <typename Any> friend class variable_factory;
 public:  
@@ -40,31 +138,13 @@ public:
 private:
   using this_type = indexed_varname<T>;
   
-  boost::optional<T> m_s;
-  ikos::index_t m_id;
-  // optional string name associated with m_id if m_s is boost::none
-  std::shared_ptr<std::string> m_name;
-  variable_factory_t *m_vfac;
+  uint32_t m_id;
+  // position of the factory in variable_factory_registry<T>
+  uint32_t m_vfac_id;
 
   indexed_varname() = delete;
-  // first constructor
-  indexed_varname(ikos::index_t id, variable_factory_t *vfac,
-                  std::string name = "")
-      : m_s(boost::none), m_id(id),
-        m_name(name == "" ? nullptr : std::make_shared<std::string>(name)),
-        m_vfac(vfac) {}
-  // second constructor
-  indexed_varname(T s, ikos::index_t id, variable_factory_t *vfac)
-      : m_s(s), m_id(id), m_name(nullptr), m_vfac(vfac) {}
-
-  std::string rename(const std::string &s) const {
-    auto it = m_vfac->get_renaming_map().find(s);
-    if (it != m_vfac->get_renaming_map().end()) {
-      return it->second;
-    } else {
-      return s;
-    }
-  }
+  indexed_varname(uint32_t id, uint32_t vfac_id)
+      : m_id(id), m_vfac_id(vfac_id) {}
 
 public:
   indexed_varname(const this_type &is) = default;
@@ -73,28 +153,21 @@ public:
   this_type &operator=(const this_type &is) = default;
   this_type &operator=(this_type &&is) = default;
 
-  virtual ikos::index_t index() const override { return m_id; }
+  ikos::index_t index() const { return m_id; }
 
-  std::string str() const {
-    if (m_s) {
-      return rename(crab::variable_name_traits<T>::to_string(*m_s));
-    } else if (m_name && (*m_name != "")) {
-      return rename(*m_name);
-    } else {
-      // unlikely prefix
-      return rename("@V_" + std::to_string(m_id));
-    }
-  }
+  std::string str() const { return get_var_factory().get_str(*this); }
 
-  boost::optional<T> get() const { return m_s; }
+  boost::optional<T> get() const { return get_var_factory().get_elem(*this); }
 
-  variable_factory_t &get_var_factory() { return *m_vfac; }
+  variable_factory_t &get_var_factory() const {
+    return variable_factory_registry<T>::get().at(m_vfac_id);
+  }
 
   bool operator<(const this_type &s) const { return (m_id < s.m_id); }
 
   bool operator==(const this_type &s) const { return (m_id == s.m_id); }
 
-  virtual void write(crab_os &o) const override { o << str(); }
+  void write(crab_os &o) const { o << str(); }
 
   size_t hash() const {
     std::hash<ikos::index_t> hasher;
@@ -135,14 +208,31 @@ namespace var_factory_impl {
 //
 // The factory uses a counter of type index_t to generate variable
 // id's that always increases.
+//
+// Variables can be created concurrently from several threads.
 template <class T> class variable_factory {
+  template <typename Any> friend class indexed_varname;
   using variable_factory_t = variable_factory<T>;
   using t_map_t = std::unordered_map<T, indexed_varname<T>>;
   using shadow_map_t =
       std::unordered_map<indexed_varname<T>,
                          std::map<std::string, indexed_varname<T>>>;
+  // what the factory knows about a variable
+  struct var_info {
+    // the element associated with the variable, if any
+    boost::optional<T> m_elem;
+    // optional name used if m_elem is boost::none
+    std::string m_name;
+  };
   // global counter to generate indexes
   ikos::index_t m_next_id;
+  // index of the first variable created by the factory
+  ikos::index_t m_first_id;
+  // position of the factory in variable_factory_registry<T>
+  uint32_t m_vfac_id;
+  // information about each variable created by the factory, indexed
+  // by the variable index minus m_first_id.
+  std::deque<var_info> m_vars;
   // (cached) indexed_varname's associated with a T-instance.
   t_map_t m_map;
   // (non-cached) fresh indexed_varname's.
@@ -150,10 +240,12 @@ template <class T> class variable_factory {
   // (cached) indexed_varname's associated with another indexed_varname.
   shadow_map_t m_shadow_map;
   mutable std::unordered_map<std::string, std::string> m_renaming_map;
+  // protect the creation of variables
+  mutable std::mutex m_mutex;
 
   ikos::index_t get_and_increment_id(void) {
-    if (m_next_id == std::numeric_limits<ikos::index_t>::max()) {
-      CRAB_ERROR("Reached limit of ", std::numeric_limits<ikos::index_t>::max(),
+    if (m_next_id == std::numeric_limits<uint32_t>::max()) {
+      CRAB_ERROR("Reached limit of ", std::numeric_limits<uint32_t>::max(),
                  " variables");
     }
     ikos::index_t res = m_next_id;
@@ -161,23 +253,79 @@ template <class T> class variable_factory {
     return res;
   }
 
+  // Pre: m_mutex is held
+  indexed_varname<T> make_varname(boost::optional<T> elem, std::string name) {
+    indexed_varname<T> iv(get_and_increment_id(), m_vfac_id);
+    m_vars.push_back({elem, name});
+    return iv;
+  }
+
+  // Pre: m_mutex is held
+  const var_info &get_info(const indexed_varname<T> &v) const {
+    assert(v.m_vfac_id == m_vfac_id);
+    assert(v.index() >= m_first_id && v.index() < m_next_id);
+    return m_vars[v.index() - m_first_id];
+  }
+
+  // Pre: m_mutex is held
+  std::string rename(const std::string &s) const {
+    auto it = m_renaming_map.find(s);
+    if (it != m_renaming_map.end()) {
+      return it->second;
+    } else {
+      return s;
+    }
+  }
+
+  // Pre: m_mutex is held
+  std::string get_str_unlocked(const indexed_varname<T> &v) const {
+    const var_info &info = get_info(v);
+    if (info.m_elem) {
+      return rename(crab::variable_name_traits<T>::to_string(*info.m_elem));
+    } else if (info.m_name != "") {
+      return rename(info.m_name);
+    } else {
+      // unlikely prefix
+      return rename("@V_" + std::to_string(v.index()));
+    }
+  }
+
+  std::string get_str(const indexed_varname<T> &v) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return get_str_unlocked(v);
+  }
+
+  boost::optional<T> get_elem(const indexed_varname<T> &v) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return get_info(v).m_elem;
+  }
+
 public:
   using varname_t = indexed_varname<T>;
 
-  variable_factory() : m_next_id(1) {}
+  variable_factory() : variable_factory(1) {}
 
-  virtual ~variable_factory() = default;
+  virtual ~variable_factory() {
+    variable_factory_registry<T>::get().remove(m_vfac_id);
+  }
 
-  variable_factory(ikos::index_t start_id) : m_next_id(start_id) {}
+  variable_factory(ikos::index_t start_id)
+      : m_next_id(start_id), m_first_id(start_id),
+        m_vfac_id(variable_factory_registry<T>::get().add(this)) {
+    if (start_id >= std::numeric_limits<uint32_t>::max()) {
+      CRAB_ERROR("Variable indexes must fit in 32 bits");
+    }
+  }
 
   variable_factory(const variable_factory_t &o) = delete;
 
   variable_factory_t &operator=(const variable_factory_t &o) = delete;
 
   virtual varname_t operator[](T s) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_map.find(s);
     if (it == m_map.end()) {
-      varname_t iv(s, get_and_increment_id(), this);
+      varname_t iv = make_varname(s, "");
       m_map.insert({s, iv});
       return iv;
     } else {
@@ -192,7 +340,8 @@ public:
   // necessary because it can produce an unbounded number of
   // indexed_varname objects.
   virtual varname_t get(std::string name = "") {
-    varname_t iv(get_and_increment_id(), this, name);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    varname_t iv = make_varname(boost::none, name);
     m_shadow_vars.push_back(iv);
     return iv;
   }
@@ -203,9 +352,10 @@ public:
   // Given the same var and name it always return the same indexed_varname.
   // The returned indexed_varname's name is var's name concatenated with name.
   virtual varname_t get(const varname_t &var, std::string name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_shadow_map.find(var);
     if (it == m_shadow_map.end()) {
-      varname_t iv(get_and_increment_id(), this, var.str() + name);
+      varname_t iv = make_varname(boost::none, get_str_unlocked(var) + name);
       std::map<std::string, varname_t> named_shadows;
       named_shadows.insert({name, iv});
       m_shadow_map.insert({var, named_shadows});
@@ -216,7 +366,7 @@ public:
       if (nit != named_shadows.end()) {
         return nit->second;
       } else {
-        varname_t iv(get_and_increment_id(), this, var.str() + name);
+        varname_t iv = make_varname(boost::none, get_str_unlocked(var) + name);
         named_shadows.insert({name, iv});
         return iv;
       }
@@ -226,11 +376,15 @@ public:
   // Allow temporary renaming for pretty printing
   void add_renaming_map(
       const std::unordered_map<std::string, std::string> &smap) const {
-    clear_renaming_map();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_renaming_map.clear();
     m_renaming_map.insert(smap.begin(), smap.end());
   }
 
-  void clear_renaming_map() const { m_renaming_map.clear(); }
+  void clear_renaming_map() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_renaming_map.clear();
+  }
 
   const std::unordered_map<std::string, std::string> &get_renaming_map() const {
     return m_renaming_map;
@@ -238,6 +392,7 @@ public:
 
   // return all the non-T variables created by the factory.  
   virtual std::vector<varname_t> get_shadow_vars() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     std::vector<varname_t> out(m_shadow_vars.begin(), m_shadow_vars.end());
     for (auto &kv_ : m_shadow_map) {
       for (auto &kv : kv_.second) {
@@ -83,6 +83,8 @@ void zones_domain_params::update_params(const zones_domain_params &params) {
   m_widen_restabilize = params.zones_widen_restabilize();
   m_special_assign = params.zones_special_assign();
   m_close_bounds_inline = params.zones_close_bounds_inline();
+  m_dense_closure_max_size = params.zones_dense_closure_max_size();
+  m_copy_on_write = params.zones_copy_on_write();
 }
 
 void zones_domain_params::write(crab::crab_os &o) const {
@@ -91,6 +93,8 @@ void zones_domain_params::write(crab::crab_os &o) const {
   o << "\twiden_restabilize=" << m_widen_restabilize << "\n";
   o << "\tspecial_assign=" << m_special_assign << "\n";
   o << "\tclose_bounds_inline=" << m_close_bounds_inline << "\n";  
+  o << "\tdense_closure_max_size=" << m_dense_closure_max_size << "\n";
+  o << "\tcopy_on_write=" << m_copy_on_write << "\n";
 }
 
 void oct_domain_params::update_params(const oct_domain_params &params) {
@@ -156,7 +160,9 @@ void crab_domain_params::update_params(const crab_domain_params &p) {
   zones_domain_params z_p(p.zones_chrome_dijkstra(),
 			  p.zones_widen_restabilize(),
 			  p.zones_special_assign(),
-			  p.zones_close_bounds_inline());
+			  p.zones_close_bounds_inline(),
+			  p.zones_dense_closure_max_size(),
+			  p.zones_copy_on_write());
   oct_domain_params o_p(p.oct_chrome_dijkstra(),
 			p.oct_widen_restabilize(),
 			p.oct_special_assign(),
@@ -255,6 +261,10 @@ void crab_domain_params::set_param(const std::string &param, const std::string &
     zones_domain_params::m_special_assign = to_bool(val);
   } else if (param == "zones.close_bounds_inline") {
     zones_domain_params::m_close_bounds_inline = to_bool(val);
+  } else if (param == "zones.dense_closure_max_size") {
+    zones_domain_params::m_dense_closure_max_size = to_uint(val);
+  } else if (param == "zones.copy_on_write") {
+    zones_domain_params::m_copy_on_write = to_bool(val);
   } else if (param == "oct.chrome_dijkstra") {
     oct_domain_params::m_chrome_dijkstra = to_bool(val);    
   } else if (param == "oct.widen_restabilize") {
@@ -21,112 +21,319 @@ struct scoped_cstring {
     (*freefunc)(m_str, std::strlen(m_str) + 1);
   }
 };
-} // namespace bignums_impl
 
-/* Wrapper for mpz */
+// Number of limbs needed to represent the magnitude of an int64_t
+static constexpr size_t int64_limbs =
+    (sizeof(uint64_t) + sizeof(mp_limb_t) - 1) / sizeof(mp_limb_t);
+
+// Split the magnitude of n into limbs (least significant first) and
+// return the number of non-zero limbs.
+static size_t int64_to_limbs(int64_t n, mp_limb_t *limbs) {
+  uint64_t mag = (n < 0 ? (~static_cast<uint64_t>(n) + 1)
+                        : static_cast<uint64_t>(n));
+  size_t size = 0;
+  while (mag != 0) {
+    limbs[size++] = static_cast<mp_limb_t>(mag);
+    if (sizeof(mp_limb_t) >= sizeof(uint64_t)) {
+      mag = 0;
+    } else {
+      mag >>= (sizeof(mp_limb_t) * 8) % 64;
+    }
+  }
+  return size;
+}
 
-z_number::operator int64_t() const {
-  if (fits_sint()) {
-    return (int64_t)mpz_get_si(_n);
-  } else if (fits_int64()) {
-    int64_t res = 0;
-    mpz_export(&res, 0 /*NULL*/, 1, sizeof(int64_t), 0, 0, _n);
-    return ((mpz_sgn(_n) < 0) ? -res : res);
+// Read-only GMP integer built from an int64_t without allocating
+// memory. Used whenever a small z_number must be passed to GMP.
+class mpz_int64_view {
+  mp_limb_t m_limbs[int64_limbs];
+  mpz_t m_n;
+
+public:
+  mpz_int64_view() {
+    for (size_t i = 0; i < int64_limbs; ++i) {
+      m_limbs[i] = 0;
+    }
+  }
+  mpz_srcptr set(int64_t n) {
+    mp_size_t size = static_cast<mp_size_t>(int64_to_limbs(n, m_limbs));
+    mpz_roinit_n(m_n, m_limbs, n < 0 ? -size : size);
+    return m_n;
+  }
+};
+
+static bool mpz_fits_int64(mpz_srcptr n) {
+  if (std::numeric_limits<signed long int>::digits >=
+      std::numeric_limits<int64_t>::digits) {
+    return mpz_fits_slong_p(n);
   } else {
-    CRAB_ERROR("z_number ", get_str(), " does not fit into int64_t");
+    size_t bits = mpz_sizeinbase(n, 2);
+    if (bits < 64) {
+      return true;
+    } else if (bits > 64) {
+      return false;
+    } else {
+      // the only 64-bit magnitude that fits is -2^63
+      return mpz_sgn(n) < 0 && mpz_scan1(n, 0) == 63;
+    }
   }
 }
 
-z_number::z_number() { mpz_init(_n); }
+// pre: mpz_fits_int64(n)
+static int64_t mpz_get_int64(mpz_srcptr n) {
+  if (std::numeric_limits<signed long int>::digits >=
+      std::numeric_limits<int64_t>::digits) {
+    return static_cast<int64_t>(mpz_get_si(n));
+  } else {
+    uint64_t mag = 0;
+    mpz_export(&mag, 0 /*NULL*/, 1, sizeof(uint64_t), 0, 0, n);
+    return (mpz_sgn(n) < 0) ? static_cast<int64_t>(~mag + 1)
+                            : static_cast<int64_t>(mag);
+  }
+}
 
-z_number::z_number(int64_t n) {
+// pre: n is initialized
+static void mpz_set_int64(mpz_ptr r, int64_t n) {
   if (n >= std::numeric_limits<signed long int>::min() &&
       n <= std::numeric_limits<signed long int>::max()) {
-    mpz_init_set_si(_n, static_cast<signed long int>(n));
+    mpz_set_si(r, static_cast<signed long int>(n));
+  } else {
+    mpz_int64_view v;
+    mpz_set(r, v.set(n));
+  }
+}
+
+// Overflow-checked operations on int64_t. They return true if the
+// operation overflows.
+static bool checked_add(int64_t a, int64_t b, int64_t &r) {
+#ifdef __GNUC__
+  return __builtin_add_overflow(a, b, &r);
+#else
+  if ((b > 0 && a > std::numeric_limits<int64_t>::max() - b) ||
+      (b < 0 && a < std::numeric_limits<int64_t>::min() - b)) {
+    return true;
+  }
+  r = a + b;
+  return false;
+#endif
+}
+
+static bool checked_sub(int64_t a, int64_t b, int64_t &r) {
+#ifdef __GNUC__
+  return __builtin_sub_overflow(a, b, &r);
+#else
+  if ((b < 0 && a > std::numeric_limits<int64_t>::max() + b) ||
+      (b > 0 && a < std::numeric_limits<int64_t>::min() + b)) {
+    return true;
+  }
+  r = a - b;
+  return false;
+#endif
+}
+
+static bool checked_mul(int64_t a, int64_t b, int64_t &r) {
+#ifdef __GNUC__
+  return __builtin_mul_overflow(a, b, &r);
+#else
+  if (a == 0 || b == 0) {
+    r = 0;
+    return false;
+  }
+  int64_t q = a * b;
+  if ((a == -1 && b == std::numeric_limits<int64_t>::min()) ||
+      (b == -1 && a == std::numeric_limits<int64_t>::min()) ||
+      q / b != a) {
+    return true;
+  }
+  r = q;
+  return false;
+#endif
+}
+} // namespace bignums_impl
+
+/* Wrapper for mpz */
+
+void z_number::init_from_mpz(mpz_srcptr n) {
+  if (bignums_impl::mpz_fits_int64(n)) {
+    _is_small = true;
+    _small = bignums_impl::mpz_get_int64(n);
   } else {
+    _is_small = false;
+    mpz_init_set(_n, n);
+  }
+}
+
+void z_number::set_from_mpz(mpz_srcptr n) {
+  if (_is_small) {
+    init_from_mpz(n);
+  } else if (bignums_impl::mpz_fits_int64(n)) {
+    int64_t v = bignums_impl::mpz_get_int64(n);
+    mpz_clear(_n);
+    _is_small = true;
+    _small = v;
+  } else {
+    mpz_set(_n, n);
+  }
+}
+
+void z_number::promote() {
+  if (_is_small) {
+    int64_t v = _small;
     mpz_init(_n);
-    mpz_import(_n, 1, 1, sizeof(int64_t), 0, 0, &n);
-    if (n < 0) {
-      mpz_neg(_n, _n);
-    }
+    bignums_impl::mpz_set_int64(_n, v);
+    _is_small = false;
+  }
+}
+
+mpz_srcptr
+z_number::get_mpz_srcptr(bignums_impl::mpz_int64_view &tmp) const {
+  if (_is_small) {
+    return tmp.set(_small);
+  } else {
+    return _n;
   }
 }
 
+z_number::operator int64_t() const {
+  if (_is_small) {
+    return _small;
+  } else if (bignums_impl::mpz_fits_int64(_n)) {
+    return bignums_impl::mpz_get_int64(_n);
+  } else {
+    CRAB_ERROR("z_number ", get_str(), " does not fit into int64_t");
+  }
+}
+
+z_number::z_number() : _is_small(true), _small(0) {}
+
+z_number::z_number(int64_t n) : _is_small(true), _small(n) {}
+
 z_number z_number::from_uint64(uint64_t n) {
-  z_number r;
+  if (n <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    return z_number(static_cast<int64_t>(n));
+  }
+  mpz_t mp_r;
+  mpz_init(mp_r);
   if (n <= std::numeric_limits<unsigned long>::max()) {
-    mpz_set_ui(r._n, static_cast<unsigned long>(n));
+    mpz_set_ui(mp_r, static_cast<unsigned long>(n));
   } else {
-    mpz_import(r._n, 1, 1, sizeof(uint64_t), 0, 0, &n);
+    mpz_import(mp_r, 1, 1, sizeof(uint64_t), 0, 0, &n);
   }
-  return r;
+  z_number res = from_mpz_t(mp_r);
+  mpz_clear(mp_r);
+  return res;
 }
 
 z_number z_number::from_raw_data(const uint64_t*data, size_t num_words,
 				 bool order) {
-  z_number r;
-  mpz_import(r._n, num_words, (order? 1 : -1), sizeof(uint64_t), 0, 0, data);
-  return r;
+  mpz_t mp_r;
+  mpz_init(mp_r);
+  mpz_import(mp_r, num_words, (order? 1 : -1), sizeof(uint64_t), 0, 0, data);
+  z_number res = from_mpz_t(mp_r);
+  mpz_clear(mp_r);
+  return res;
 }
 
 uint64_t* z_number::to_raw_data(size_t &num_words, bool &sign, bool order) {
   sign = (*this >= 0);
+  bignums_impl::mpz_int64_view tmp;
   return (uint64_t*)mpz_export(nullptr, &num_words, (order? 1: -1),
-			       sizeof(uint64_t), 0, 0, _n);
+			       sizeof(uint64_t), 0, 0, get_mpz_srcptr(tmp));
 }
   
 z_number::z_number(const std::string &s, unsigned base) {
-  int res = mpz_init_set_str(_n, s.c_str(), base);
+  mpz_t mp_r;
+  int res = mpz_init_set_str(mp_r, s.c_str(), base);
   if (res == -1) {
+    mpz_clear(mp_r);
     CRAB_ERROR("z_number: invalid string in constructor", s);
   }
+  init_from_mpz(mp_r);
+  mpz_clear(mp_r);
 }
 
 z_number z_number::from_mpz_t(mpz_t n) {
   z_number z;
-  mpz_set(z._n, n);
+  z.init_from_mpz(n);
   return z;
 }
 
 z_number z_number::from_mpz_srcptr(mpz_srcptr n) {
   z_number z;
-  mpz_set(z._n, n);
+  z.init_from_mpz(n);
   return z;
 }
 
-z_number::z_number(const z_number &o) { mpz_init_set(_n, o._n); }
+z_number::z_number(const z_number &o) : _is_small(o._is_small) {
+  if (_is_small) {
+    _small = o._small;
+  } else {
+    mpz_init_set(_n, o._n);
+  }
+}
 
-z_number::z_number(z_number &&o) {
-  *_n = *o._n;
-  mpz_init(o._n);
+z_number::z_number(z_number &&o) : _is_small(o._is_small) {
+  if (_is_small) {
+    _small = o._small;
+  } else {
+    *_n = *o._n;
+    o._is_small = true;
+    o._small = 0;
+  }
 }
 
 z_number &z_number::operator=(const z_number &o) {
   if (this != &o) {
-    mpz_set(_n, o._n);
+    if (o._is_small) {
+      if (!_is_small) {
+        mpz_clear(_n);
+        _is_small = true;
+      }
+      _small = o._small;
+    } else if (_is_small) {
+      _is_small = false;
+      mpz_init_set(_n, o._n);
+    } else {
+      mpz_set(_n, o._n);
+    }
   }
   return *this;
 }
 
 z_number &z_number::operator=(z_number &&o) {
   if (this != &o) {
-    std::swap(*_n, *o._n);
+    if (!_is_small && !o._is_small) {
+      std::swap(*_n, *o._n);
+    } else {
+      *this = static_cast<const z_number &>(o);
+    }
   }
   return *this;
 }
 
-z_number::~z_number() { mpz_clear(_n); }
+z_number::~z_number() {
+  if (!_is_small) {
+    mpz_clear(_n);
+  }
+}
 
 std::string z_number::get_str(unsigned base) const {
-  bignums_impl::scoped_cstring res(mpz_get_str(0, base, _n));
+  if (_is_small && base == 10) {
+    return std::to_string(_small);
+  }
+  bignums_impl::mpz_int64_view tmp;
+  bignums_impl::scoped_cstring res(mpz_get_str(0, base, get_mpz_srcptr(tmp)));
   return std::string(res.m_str);
 }
   
 std::size_t z_number::hash() const {  
   // Inspired by
   // https://www.boost.org/doc/libs/1_66_0/libs/multiprecision/doc/html/boost_multiprecision/tut/hash.html
+  //
+  // Small numbers are hashed through their GMP limbs so that the hash
+  // does not depend on the representation.
   auto hash_val = [](const mpz_srcptr v) {
-    boost::string_view view(reinterpret_cast<char*>(v->_mp_d),
+    boost::string_view view(reinterpret_cast<const char*>(v->_mp_d),
 			    abs(v->_mp_size) * sizeof(mp_limb_t));
 #if BOOST_VERSION / 100 % 100 >= 74
     // I don't know for sure which boost version started supporting
@@ -142,49 +349,86 @@ std::size_t z_number::hash() const {
     }
     return result;    
   };  
-  return hash_val(static_cast<mpz_srcptr>(_n));
+  bignums_impl::mpz_int64_view tmp;
+  return hash_val(get_mpz_srcptr(tmp));
 }
 
-bool z_number::fits_sint() const { return mpz_fits_sint_p(_n); }
+bool z_number::fits_sint() const {
+  if (_is_small) {
+    return _small >= std::numeric_limits<int>::min() &&
+           _small <= std::numeric_limits<int>::max();
+  }
+  return mpz_fits_sint_p(_n);
+}
 
-bool z_number::fits_slong() const { return mpz_fits_slong_p(_n); }
+bool z_number::fits_slong() const {
+  if (_is_small) {
+    return _small >= std::numeric_limits<signed long int>::min() &&
+           _small <= std::numeric_limits<signed long int>::max();
+  }
+  return mpz_fits_slong_p(_n);
+}
 
 bool z_number::fits_int64() const {
-  return (*this >= std::numeric_limits<int64_t>::min() &&
-          *this <= std::numeric_limits<int64_t>::max());
+  return _is_small || bignums_impl::mpz_fits_int64(_n);
 }
 
 z_number z_number::operator+(z_number x) const {
+  if (_is_small && x._is_small) {
+    int64_t r;
+    if (!bignums_impl::checked_add(_small, x._small, r)) {
+      return z_number(r);
+    }
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_add(mp_r, _n, x._n);
+  mpz_add(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
 }
 
 z_number z_number::operator*(z_number x) const {
+  if (_is_small && x._is_small) {
+    int64_t r;
+    if (!bignums_impl::checked_mul(_small, x._small, r)) {
+      return z_number(r);
+    }
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_mul(mp_r, _n, x._n);
+  mpz_mul(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
 }
 
 z_number z_number::operator-(z_number x) const {
+  if (_is_small && x._is_small) {
+    int64_t r;
+    if (!bignums_impl::checked_sub(_small, x._small, r)) {
+      return z_number(r);
+    }
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_sub(mp_r, _n, x._n);
+  mpz_sub(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
 }
 
 z_number z_number::operator-() const {
+  if (_is_small && _small != std::numeric_limits<int64_t>::min()) {
+    return z_number(-_small);
+  }
+  bignums_impl::mpz_int64_view t1;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_neg(mp_r, _n);
+  mpz_neg(mp_r, get_mpz_srcptr(t1));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
@@ -194,9 +438,15 @@ z_number z_number::operator/(z_number x) const {
   if (x == 0) {
     CRAB_ERROR("z_number: division by zero [1]");
   } else {
+    if (_is_small && x._is_small &&
+        !(_small == std::numeric_limits<int64_t>::min() && x._small == -1)) {
+      // C++ integer division truncates like mpz_tdiv_q
+      return z_number(_small / x._small);
+    }
+    bignums_impl::mpz_int64_view t1, t2;
     mpz_t mp_r;
     mpz_init(mp_r);
-    mpz_tdiv_q(mp_r, _n, x._n);
+    mpz_tdiv_q(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
     z_number res = from_mpz_t(mp_r);
     mpz_clear(mp_r);
     return res;
@@ -207,9 +457,18 @@ z_number z_number::operator%(z_number x) const {
   if (x == 0) {
     CRAB_ERROR("z_number: division by zero [2]");
   } else {
+    if (_is_small && x._is_small) {
+      if (x._small == -1) {
+        return z_number(0);
+      }
+      // C++ integer remainder has the sign of the dividend like
+      // mpz_tdiv_r
+      return z_number(_small % x._small);
+    }
+    bignums_impl::mpz_int64_view t1, t2;
     mpz_t mp_r;
     mpz_init(mp_r);
-    mpz_tdiv_r(mp_r, _n, x._n);
+    mpz_tdiv_r(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
     z_number res = from_mpz_t(mp_r);
     mpz_clear(mp_r);
     return res;
@@ -217,17 +476,17 @@ z_number z_number::operator%(z_number x) const {
 }
 
 z_number &z_number::operator+=(z_number x) {
-  mpz_add(_n, _n, x._n);
+  *this = *this + x;
   return *this;
 }
 
 z_number &z_number::operator*=(z_number x) {
-  mpz_mul(_n, _n, x._n);
+  *this = *this * x;
   return *this;
 }
 
 z_number &z_number::operator-=(z_number x) {
-  mpz_sub(_n, _n, x._n);
+  *this = *this - x;
   return *this;
 }
 
@@ -235,7 +494,7 @@ z_number &z_number::operator/=(z_number x) {
   if (x == 0) {
     CRAB_ERROR("z_number: division by zero [3]");
   } else {
-    mpz_tdiv_q(_n, _n, x._n);
+    *this = *this / x;
     return *this;
   }
 }
@@ -244,18 +503,26 @@ z_number &z_number::operator%=(z_number x) {
   if (x == 0) {
     CRAB_ERROR("z_number: division by zero [4]");
   } else {
-    mpz_tdiv_r(_n, _n, x._n);
+    *this = *this % x;
     return *this;
   }
 }
 
 z_number &z_number::operator--() {
-  mpz_sub_ui(_n, _n, 1);
+  if (_is_small && _small != std::numeric_limits<int64_t>::min()) {
+    --_small;
+  } else {
+    *this = *this - z_number(1);
+  }
   return *this;
 }
 
 z_number &z_number::operator++() {
-  mpz_add_ui(_n, _n, 1);
+  if (_is_small && _small != std::numeric_limits<int64_t>::max()) {
+    ++_small;
+  } else {
+    *this = *this + z_number(1);
+  }
   return *this;
 }
 
@@ -271,40 +538,64 @@ z_number z_number::operator--(int) {
   return r;
 }
 
-bool z_number::operator==(z_number x) const { return mpz_cmp(_n, x._n) == 0; }
+#define Z_NUMBER_CMP(OP)                                                       \
+  if (_is_small && x._is_small) {                                              \
+    return _small OP x._small;                                                 \
+  }                                                                            \
+  bignums_impl::mpz_int64_view t1, t2;                                         \
+  return mpz_cmp(get_mpz_srcptr(t1), x.get_mpz_srcptr(t2)) OP 0;
+
+bool z_number::operator==(z_number x) const { Z_NUMBER_CMP(==) }
 
 bool z_number::operator!=(z_number x) const { return !(*this == x); }
 
-bool z_number::operator<(z_number x) const { return (mpz_cmp(_n, x._n) < 0); }
+bool z_number::operator<(z_number x) const { Z_NUMBER_CMP(<) }
 
-bool z_number::operator<=(z_number x) const { return (mpz_cmp(_n, x._n) <= 0); }
+bool z_number::operator<=(z_number x) const { Z_NUMBER_CMP(<=) }
 
-bool z_number::operator>(z_number x) const { return (mpz_cmp(_n, x._n) > 0); }
+bool z_number::operator>(z_number x) const { Z_NUMBER_CMP(>) }
 
-bool z_number::operator>=(z_number x) const { return (mpz_cmp(_n, x._n) >= 0); }
+bool z_number::operator>=(z_number x) const { Z_NUMBER_CMP(>=) }
 
+#undef Z_NUMBER_CMP
+
+// Bitwise operators on int64_t have the same semantics as GMP
+// (two's complement with infinite sign extension) so the small case
+// never overflows.
 z_number z_number::operator&(z_number x) const {
+  if (_is_small && x._is_small) {
+    return z_number(_small & x._small);
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_and(mp_r, _n, x._n);
+  mpz_and(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
 }
 
 z_number z_number::operator|(z_number x) const {
+  if (_is_small && x._is_small) {
+    return z_number(_small | x._small);
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_ior(mp_r, _n, x._n);
+  mpz_ior(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
 }
 
 z_number z_number::operator^(z_number x) const {
+  if (_is_small && x._is_small) {
+    return z_number(_small ^ x._small);
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
-  mpz_xor(mp_r, _n, x._n);
+  mpz_xor(mp_r, get_mpz_srcptr(t1), x.get_mpz_srcptr(t2));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
@@ -312,10 +603,18 @@ z_number z_number::operator^(z_number x) const {
 
 // left shift  
 z_number z_number::operator<<(z_number x) const {
+  if (_is_small && x._is_small && x._small >= 0 && x._small < 63) {
+    int64_t r;
+    if (!bignums_impl::checked_mul(_small, static_cast<int64_t>(1) << x._small,
+                                   r)) {
+      return z_number(r);
+    }
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);  
   // TODO: check for potential overflow
-  mpz_mul_2exp(mp_r, _n, mpz_get_ui(x._n));
+  mpz_mul_2exp(mp_r, get_mpz_srcptr(t1), mpz_get_ui(x.get_mpz_srcptr(t2)));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
@@ -323,11 +622,19 @@ z_number z_number::operator<<(z_number x) const {
 
 // arithmetic right shift  
 z_number z_number::operator>>(z_number x) const {
-  
+  if (_is_small && x._is_small && x._small >= 0) {
+    if (x._small >= 63) {
+      return z_number(_small < 0 ? -1 : 0);
+    }
+    // rounds towards -oo like mpz_fdiv_q_2exp
+    return z_number(_small >= 0 ? _small >> x._small
+                                : ~((~_small) >> x._small));
+  }
+  bignums_impl::mpz_int64_view t1, t2;
   mpz_t mp_r;
   mpz_init(mp_r);
   // TODO: check for potential overflow
-  mpz_fdiv_q_2exp(mp_r, _n, mpz_get_ui(x._n));
+  mpz_fdiv_q_2exp(mp_r, get_mpz_srcptr(t1), mpz_get_ui(x.get_mpz_srcptr(t2)));
   z_number res = from_mpz_t(mp_r);
   mpz_clear(mp_r);
   return res;
@@ -369,13 +676,15 @@ q_number::q_number(const std::string &s, unsigned base) {
 }
 
 q_number::q_number(const z_number &z) {
+  bignums_impl::mpz_int64_view tmp;
   mpq_init(_n);
-  mpq_set_z(_n, z._n);
+  mpq_set_z(_n, z.get_mpz_srcptr(tmp));
 }
 
 q_number::q_number(const z_number &num, const z_number &den) {
-  mpz_init_set(mpq_numref(_n), num._n);
-  mpz_init_set(mpq_denref(_n), den._n);
+  bignums_impl::mpz_int64_view t1, t2;
+  mpz_init_set(mpq_numref(_n), num.get_mpz_srcptr(t1));
+  mpz_init_set(mpq_denref(_n), den.get_mpz_srcptr(t2));
 }
 
 q_number q_number::from_mpq_t(mpq_t mp) {
@@ -607,7 +916,8 @@ q_number q_number::operator<<(q_number x) const {
   mpq_init(mp_r); 
   z_number shift = to_z_number(x);
   // TODO: check for potential overflow  
-  mpq_mul_2exp(mp_r, _n, mpz_get_ui(shift._n));
+  bignums_impl::mpz_int64_view tmp;
+  mpq_mul_2exp(mp_r, _n, mpz_get_ui(shift.get_mpz_srcptr(tmp)));
   q_number res = from_mpq_t(mp_r);
   mpq_clear(mp_r);
   return res;
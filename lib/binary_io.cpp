@@ -0,0 +1,139 @@
+#include <crab/support/binary_io.hpp>
+#include <crab/support/debug.hpp>
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CRAB_HAVE_MMAP 1
+#endif
+
+namespace crab {
+
+void binary_output::put_varint(uint64_t v) {
+  while (v >= 0x80) {
+    m_buf.push_back(static_cast<char>((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  m_buf.push_back(static_cast<char>(v));
+}
+
+void binary_output::put_svarint(int64_t v) {
+  put_varint((static_cast<uint64_t>(v) << 1) ^
+             static_cast<uint64_t>(v >> 63));
+}
+
+void binary_output::put_bytes(const char *data, std::size_t size) {
+  m_buf.insert(m_buf.end(), data, data + size);
+}
+
+void binary_output::put_string(const std::string &s) {
+  put_varint(s.size());
+  put_bytes(s.data(), s.size());
+}
+
+void binary_output::append(const binary_output &o) {
+  m_buf.insert(m_buf.end(), o.m_buf.begin(), o.m_buf.end());
+}
+
+bool binary_output::write_to_file(const std::string &filename) const {
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out.write(m_buf.data(), m_buf.size());
+  return static_cast<bool>(out);
+}
+
+void binary_input::check(std::size_t n) const {
+  if (static_cast<std::size_t>(m_end - m_cur) < n) {
+    CRAB_ERROR("binary_input: unexpected end of input");
+  }
+}
+
+uint64_t binary_input::get_varint() {
+  uint64_t res = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    uint8_t byte = get_u8();
+    res |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return res;
+    }
+  }
+  CRAB_ERROR("binary_input: malformed varint");
+}
+
+int64_t binary_input::get_svarint() {
+  uint64_t v = get_varint();
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+const char *binary_input::get_bytes(std::size_t size) {
+  check(size);
+  const char *res = m_cur;
+  m_cur += size;
+  return res;
+}
+
+std::pair<const char *, std::size_t> binary_input::get_string_ref() {
+  std::size_t size = get_varint();
+  return {get_bytes(size), size};
+}
+
+std::string binary_input::get_string() {
+  auto ref = get_string_ref();
+  return std::string(ref.first, ref.second);
+}
+
+bool mapped_file::open(const std::string &filename) {
+  close();
+#ifdef CRAB_HAVE_MMAP
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      ::close(fd);
+      m_data = static_cast<const char *>(addr);
+      m_size = st.st_size;
+      m_is_mapped = true;
+      m_is_open = true;
+      return true;
+    }
+  }
+  ::close(fd);
+#endif
+  // fallback: read the whole file
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  m_buf.assign(std::istreambuf_iterator<char>(in),
+               std::istreambuf_iterator<char>());
+  m_data = m_buf.data();
+  m_size = m_buf.size();
+  m_is_open = true;
+  return true;
+}
+
+void mapped_file::close() {
+#ifdef CRAB_HAVE_MMAP
+  if (m_is_mapped) {
+    ::munmap(const_cast<char *>(m_data), m_size);
+  }
+#endif
+  m_buf.clear();
+  m_data = nullptr;
+  m_size = 0;
+  m_is_open = false;
+  m_is_mapped = false;
+}
+
+} // end namespace crab
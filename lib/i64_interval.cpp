@@ -0,0 +1,217 @@
+#include <crab/domains/i64_interval.hpp>
+
+namespace crab {
+namespace domains {
+
+int64_t i64_interval::from_z_lb(const z_bound_t &b) {
+  if (b.is_minus_infinity()) {
+    return minus_inf();
+  } else if (b.is_plus_infinity()) {
+    return plus_inf();
+  } else {
+    ikos::z_number n = *b.number();
+    if (n.fits_int64()) {
+      return round_lb(static_cast<int64_t>(n));
+    } else {
+      return (n > 0 ? max_finite() : minus_inf());
+    }
+  }
+}
+
+int64_t i64_interval::from_z_ub(const z_bound_t &b) {
+  if (b.is_minus_infinity()) {
+    return minus_inf();
+  } else if (b.is_plus_infinity()) {
+    return plus_inf();
+  } else {
+    ikos::z_number n = *b.number();
+    if (n.fits_int64()) {
+      return round_ub(static_cast<int64_t>(n));
+    } else {
+      return (n > 0 ? plus_inf() : min_finite());
+    }
+  }
+}
+
+i64_interval::z_bound_t i64_interval::to_z_bound(int64_t b) {
+  if (b == minus_inf()) {
+    return z_bound_t::minus_infinity();
+  } else if (b == plus_inf()) {
+    return z_bound_t::plus_infinity();
+  } else {
+    return z_bound_t(ikos::z_number(b));
+  }
+}
+
+i64_interval::i64_interval(const ikos::z_number &n) {
+  if (n.fits_int64()) {
+    int64_t v = static_cast<int64_t>(n);
+    m_lb = round_lb(v);
+    m_ub = round_ub(v);
+  } else if (n > 0) {
+    m_lb = max_finite();
+    m_ub = plus_inf();
+  } else {
+    m_lb = minus_inf();
+    m_ub = min_finite();
+  }
+}
+
+i64_interval::i64_interval(const z_interval_t &i) {
+  if (i.is_bottom()) {
+    m_lb = 1;
+    m_ub = 0;
+  } else {
+    m_lb = from_z_lb(i.lb());
+    m_ub = from_z_ub(i.ub());
+  }
+}
+
+i64_interval::z_interval_t i64_interval::to_interval() const {
+  if (is_bottom()) {
+    return z_interval_t::bottom();
+  } else {
+    return z_interval_t(to_z_bound(m_lb), to_z_bound(m_ub));
+  }
+}
+
+i64_interval i64_interval::mul_non_singleton(const i64_interval &x) const {
+  int64_t ll = mul(m_lb, x.m_lb);
+  int64_t lu = mul(m_lb, x.m_ub);
+  int64_t ul = mul(m_ub, x.m_lb);
+  int64_t uu = mul(m_ub, x.m_ub);
+  return i64_interval(round_lb(min(ll, lu, ul, uu)),
+                      round_ub(max(ll, lu, ul, uu)));
+}
+
+// Same algorithm than ikos::interval<z_number>::operator/
+i64_interval i64_interval::div_non_singleton(const i64_interval &x) const {
+  if (x[0]) {
+    i64_interval l(x.m_lb, -1);
+    i64_interval u(1, x.m_ub);
+    return (operator/(l) | operator/(u));
+  } else if (operator[](0)) {
+    i64_interval l(m_lb, -1);
+    i64_interval u(1, m_ub);
+    return ((l / x) | (u / x) | i64_interval(0));
+  } else {
+    // Neither the dividend nor the divisor contains 0
+    i64_interval a =
+        (m_ub < 0)
+            ? (*this + ((x.m_ub < 0) ? (x + i64_interval(1))
+                                     : (i64_interval(1) - x)))
+            : *this;
+    int64_t ll = div(a.m_lb, x.m_lb);
+    int64_t lu = div(a.m_lb, x.m_ub);
+    int64_t ul = div(a.m_ub, x.m_lb);
+    int64_t uu = div(a.m_ub, x.m_ub);
+    return i64_interval(round_lb(min(ll, lu, ul, uu)),
+                        round_ub(max(ll, lu, ul, uu)));
+  }
+}
+
+i64_interval i64_interval::widening_thresholds(
+    const i64_interval &x, const crab::thresholds<ikos::z_number> &ts) const {
+  if (is_bottom()) {
+    return x;
+  } else if (x.is_bottom()) {
+    return *this;
+  } else {
+    int64_t lb =
+        (x.m_lb < m_lb ? from_z_lb(ts.get_prev(to_z_bound(x.m_lb))) : m_lb);
+    int64_t ub =
+        (m_ub < x.m_ub ? from_z_ub(ts.get_next(to_z_bound(x.m_ub))) : m_ub);
+    return i64_interval(lb, ub);
+  }
+}
+
+// The remaining operations are rare so we reuse the z_number
+// implementation.
+
+i64_interval i64_interval::UDiv(const i64_interval &x) const {
+  return i64_interval(to_interval().UDiv(x.to_interval()));
+}
+
+i64_interval i64_interval::SRem(const i64_interval &x) const {
+  return i64_interval(to_interval().SRem(x.to_interval()));
+}
+
+i64_interval i64_interval::URem(const i64_interval &x) const {
+  return i64_interval(to_interval().URem(x.to_interval()));
+}
+
+i64_interval i64_interval::And(const i64_interval &x) const {
+  return i64_interval(to_interval().And(x.to_interval()));
+}
+
+i64_interval i64_interval::Or(const i64_interval &x) const {
+  return i64_interval(to_interval().Or(x.to_interval()));
+}
+
+i64_interval i64_interval::Xor(const i64_interval &x) const {
+  return i64_interval(to_interval().Xor(x.to_interval()));
+}
+
+i64_interval i64_interval::Shl(const i64_interval &x) const {
+  return i64_interval(to_interval().Shl(x.to_interval()));
+}
+
+i64_interval i64_interval::LShr(const i64_interval &x) const {
+  return i64_interval(to_interval().LShr(x.to_interval()));
+}
+
+i64_interval i64_interval::AShr(const i64_interval &x) const {
+  return i64_interval(to_interval().AShr(x.to_interval()));
+}
+
+void i64_interval::write(crab::crab_os &o) const {
+  if (is_bottom()) {
+    o << "_|_";
+  } else {
+    o << "[";
+    if (m_lb == minus_inf()) {
+      o << "-oo";
+    } else {
+      o << static_cast<long long>(m_lb);
+    }
+    o << ", ";
+    if (m_ub == plus_inf()) {
+      o << "+oo";
+    } else {
+      o << static_cast<long long>(m_ub);
+    }
+    o << "]";
+  }
+}
+
+} // end namespace domains
+} // end namespace crab
+
+namespace ikos {
+namespace linear_interval_solver_impl {
+using crab::domains::i64_interval;
+
+template <>
+i64_interval trim_interval(const i64_interval &i, const i64_interval &j) {
+  if (boost::optional<int64_t> c = j.singleton()) {
+    // c+1 and c-1 must be finite bounds
+    if (i.lb() == *c && *c < std::numeric_limits<int64_t>::max() - 1) {
+      return i64_interval(*c + 1, i.ub());
+    } else if (i.ub() == *c && *c > std::numeric_limits<int64_t>::min() + 1) {
+      return i64_interval(i.lb(), *c - 1);
+    }
+  }
+  return i;
+}
+
+template <>
+i64_interval lower_half_line(const i64_interval &i, bool /*is_signed*/) {
+  return i.lower_half_line();
+}
+
+template <>
+i64_interval upper_half_line(const i64_interval &i, bool /*is_signed*/) {
+  return i.upper_half_line();
+}
+} // namespace linear_interval_solver_impl
+} // end namespace ikos
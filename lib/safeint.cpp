@@ -8,51 +8,6 @@
 
 namespace crab {
 
-int64_t safe_i64::get_max() {
-  return std::numeric_limits<int64_t>::max();
-}
-
-int64_t safe_i64::get_min() {
-  return std::numeric_limits<int64_t>::min();
-}
-
-int safe_i64::checked_add(int64_t a, int64_t b, int64_t *rp) {
-#if 1
-  wideint_t lr = (wideint_t)a + (wideint_t)b;
-  *rp = lr;
-  return lr > get_max() || lr < get_min();
-#else
-  // without wider integers
-  if (b > 0 && a > get_max() - b) {
-    return 1;
-  }
-  if (b < 0 && a < get_min() - b) {
-    return 1;
-  }
-  int64_t lr = a + b;
-  *rp = lr;
-  return 0;
-#endif
-}
-
-int safe_i64::checked_sub(int64_t a, int64_t b, int64_t *rp) {
-  wideint_t lr = (wideint_t)a - (wideint_t)b;
-  *rp = lr;
-  return lr > get_max() || lr < get_min();
-}
-
-int safe_i64::checked_mul(int64_t a, int64_t b, int64_t *rp) {
-  wideint_t lr = (wideint_t)a * (wideint_t)b;
-  *rp = lr;
-  return lr > get_max() || lr < get_min();
-}
-
-int safe_i64::checked_div(int64_t a, int64_t b, int64_t *rp) {
-  wideint_t lr = (wideint_t)a / (wideint_t)b;
-  *rp = lr;
-  return lr > get_max() || lr < get_min();
-}
-
 safe_i64::safe_i64() : m_num(0) {}
 
 safe_i64::safe_i64(int64_t num) : m_num(num) {}
@@ -42,8 +42,16 @@ void CrabStats::PrintBrunch(crab_os &OS) {
   OS << "************** BRUNCH STATS END ***************** \n";
 }
 
+CrabStatsId::CrabStatsId(const std::string &name) : m_id(0) {}
+void CrabStats::count(const CrabStatsId &id) {}
+void CrabStats::start(const CrabStatsId &id) {}
+void CrabStats::stop(const CrabStatsId &id) {}
+void CrabStats::resume(const CrabStatsId &id) {}
+
 ScopedCrabStats::ScopedCrabStats(const std::string &name, bool reset)
-    : m_name("") {}
+    : m_name(""), m_id(nullptr) {}
+ScopedCrabStats::ScopedCrabStats(const CrabStatsId &id)
+    : m_name(""), m_id(nullptr) {}
 ScopedCrabStats::~ScopedCrabStats() {}
 } // namespace crab
 #else
@@ -51,6 +59,11 @@ ScopedCrabStats::~ScopedCrabStats() {}
 #include <sys/resource.h>
 #include <sys/time.h>
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 namespace crab {
 
 long Stopwatch::systemTime() const {
@@ -94,8 +107,7 @@ double Stopwatch::toSeconds() {
   return time;
 }
 
-void Stopwatch::Print(crab_os &out) const {
-  long time = getTimeElapsed();
+static void printTime(crab_os &out, long time) {
   long h = time / 3600000000L;
   long m = time / 60000000L - h * 60;
   float s = ((float)time / 1000000L) - m * 60 - h * 3600;
@@ -107,6 +119,8 @@ void Stopwatch::Print(crab_os &out) const {
   out << s << "s";
 }
 
+void Stopwatch::Print(crab_os &out) const { printTime(out, getTimeElapsed()); }
+
 std::map<std::string, unsigned> &CrabStats::getCounters() {
   static std::map<std::string, unsigned> counters;
   return counters;
@@ -117,79 +131,291 @@ std::map<std::string, Stopwatch> &CrabStats::getTimers() {
   return timers;
 }
 
+// The fixpoint can run on several threads so all accesses to the
+// counters and timers are serialized.
+static std::mutex &getStatsMutex() {
+  static std::mutex m;
+  return m;
+}
+
+namespace {
+// Counters and stop watches of interned names, indexed by the
+// identifier of the name.
+struct IdStats {
+  std::vector<unsigned> counters;
+  std::vector<Stopwatch> timers;
+  // whether timers[i] has been used
+  std::vector<bool> used_timers;
+
+  void growCounters(unsigned id) {
+    if (id >= counters.size()) {
+      counters.resize(std::max(2 * counters.size(), (std::size_t)id + 1), 0);
+    }
+  }
+
+  // Return the timer of id. It starts the first time it is used.
+  Stopwatch &getTimer(unsigned id) {
+    if (id >= timers.size()) {
+      std::size_t n = std::max(2 * timers.size(), (std::size_t)id + 1);
+      timers.resize(n);
+      used_timers.resize(n, false);
+    }
+    if (!used_timers[id]) {
+      timers[id].start();
+      used_timers[id] = true;
+    }
+    return timers[id];
+  }
+
+  void clear() {
+    counters.clear();
+    timers.clear();
+    used_timers.clear();
+  }
+
+  // Add the counters and the elapsed times of the used timers to
+  // out. The out vectors must have one entry per interned name.
+  void aggregate(std::vector<unsigned> &out_counters,
+                 std::vector<long> &out_times,
+                 std::vector<bool> &out_used_timers) const {
+    // the tables can be larger than the number of interned names
+    for (unsigned i = 0,
+                  e = std::min(counters.size(), out_counters.size());
+         i < e; ++i) {
+      out_counters[i] += counters[i];
+    }
+    for (unsigned i = 0, e = std::min(timers.size(), out_times.size());
+         i < e; ++i) {
+      if (used_timers[i]) {
+        out_times[i] += timers[i].getTimeElapsed();
+        out_used_timers[i] = true;
+      }
+    }
+  }
+};
+
+// Interned names and statistics of all threads. Protected by
+// getStatsMutex().
+struct IdStatsRegistry {
+  std::vector<std::string> names;
+  std::unordered_map<std::string, unsigned> ids;
+  // statistics of the running threads
+  std::vector<IdStats *> live;
+  // statistics of the threads that already finished
+  std::vector<unsigned> finished_counters;
+  std::vector<long> finished_times;
+  std::vector<bool> finished_used_timers;
+
+  void resizeFinished() {
+    finished_counters.resize(names.size(), 0);
+    finished_times.resize(names.size(), 0);
+    finished_used_timers.resize(names.size(), false);
+  }
+};
+
+IdStatsRegistry &getIdStatsRegistry() {
+  static IdStatsRegistry registry;
+  return registry;
+}
+
+// The statistics of the current thread. They are added to the
+// registry when the thread finishes.
+struct ThreadIdStats {
+  IdStats stats;
+
+  ThreadIdStats() {
+    std::lock_guard<std::mutex> lock(getStatsMutex());
+    getIdStatsRegistry().live.push_back(&stats);
+  }
+
+  ~ThreadIdStats() {
+    std::lock_guard<std::mutex> lock(getStatsMutex());
+    IdStatsRegistry &registry = getIdStatsRegistry();
+    registry.resizeFinished();
+    stats.aggregate(registry.finished_counters, registry.finished_times,
+                    registry.finished_used_timers);
+    registry.live.erase(
+        std::remove(registry.live.begin(), registry.live.end(), &stats),
+        registry.live.end());
+  }
+};
+
+IdStats &getThreadIdStats() {
+  static thread_local ThreadIdStats stats;
+  return stats.stats;
+}
+} // end namespace
+
+// Collect all counters and the elapsed times of all timers
+// Pre: getStatsMutex() is held
+static void
+collectStats(const std::map<std::string, unsigned> &named_counters,
+             const std::map<std::string, Stopwatch> &named_timers,
+             std::map<std::string, unsigned> &counters,
+             std::map<std::string, long> &times) {
+  for (auto &kv : named_counters) {
+    counters[kv.first] += kv.second;
+  }
+  for (auto &kv : named_timers) {
+    times[kv.first] += kv.second.getTimeElapsed();
+  }
+
+  IdStatsRegistry &registry = getIdStatsRegistry();
+  registry.resizeFinished();
+  std::vector<unsigned> id_counters(registry.finished_counters);
+  std::vector<long> id_times(registry.finished_times);
+  std::vector<bool> id_used_timers(registry.finished_used_timers);
+  for (IdStats *stats : registry.live) {
+    stats->aggregate(id_counters, id_times, id_used_timers);
+  }
+  for (unsigned i = 0, e = registry.names.size(); i < e; ++i) {
+    if (id_counters[i] > 0) {
+      counters[registry.names[i]] += id_counters[i];
+    }
+    if (id_used_timers[i]) {
+      times[registry.names[i]] += id_times[i];
+    }
+  }
+}
+
+CrabStatsId::CrabStatsId(const std::string &name) {
+  std::lock_guard<std::mutex> lock(getStatsMutex());
+  IdStatsRegistry &registry = getIdStatsRegistry();
+  auto it = registry.ids.find(name);
+  if (it != registry.ids.end()) {
+    m_id = it->second;
+  } else {
+    m_id = registry.names.size();
+    registry.names.push_back(name);
+    registry.ids.insert({name, m_id});
+  }
+}
+
 void CrabStats::reset() {
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   getCounters().clear();
   getTimers().clear();
+  IdStatsRegistry &registry = getIdStatsRegistry();
+  registry.finished_counters.clear();
+  registry.finished_times.clear();
+  registry.finished_used_timers.clear();
+  for (IdStats *stats : registry.live) {
+    stats->clear();
+  }
 }
 
 void CrabStats::count(const std::string &name) {
   if (!crab::CrabStatsFlag)
     return;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   ++getCounters()[name];
 }
 void CrabStats::count_max(const std::string &name, unsigned v) {
   if (!crab::CrabStatsFlag)
     return;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   getCounters()[name] = std::max(getCounters()[name], v);
 }
 
 unsigned CrabStats::uset(const std::string &n, unsigned v) {
   if (!crab::CrabStatsFlag)
     return 0;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   return getCounters()[n] = v;
 }
 unsigned CrabStats::get(const std::string &n) {
   if (!crab::CrabStatsFlag)
     return 0;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   return getCounters()[n];
 }
 
 void CrabStats::start(const std::string &name) {
   if (!crab::CrabStatsFlag)
     return;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   getTimers()[name].start();
 }
 void CrabStats::stop(const std::string &name) {
   if (!crab::CrabStatsFlag)
     return;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   getTimers()[name].stop();
 }
 void CrabStats::resume(const std::string &name) {
   if (!crab::CrabStatsFlag)
     return;
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   getTimers()[name].resume();
 }
 
+void CrabStats::count(const CrabStatsId &id) {
+  if (!crab::CrabStatsFlag)
+    return;
+  IdStats &stats = getThreadIdStats();
+  stats.growCounters(id.get());
+  ++stats.counters[id.get()];
+}
+
+void CrabStats::start(const CrabStatsId &id) {
+  if (!crab::CrabStatsFlag)
+    return;
+  getThreadIdStats().getTimer(id.get()).start();
+}
+
+void CrabStats::stop(const CrabStatsId &id) {
+  if (!crab::CrabStatsFlag)
+    return;
+  getThreadIdStats().getTimer(id.get()).stop();
+}
+
+void CrabStats::resume(const CrabStatsId &id) {
+  if (!crab::CrabStatsFlag)
+    return;
+  getThreadIdStats().getTimer(id.get()).resume();
+}
+
 /** Outputs all statistics to std output */
 void CrabStats::Print(crab_os &OS) {
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   OS << "\n\n************** STATS ***************** \n";
   if (!crab::CrabStatsFlag) {
     OS << "Need to call CrabEnableStats()\n";
   } else {
-    for (auto &kv : getCounters())
-      OS << kv.first << ": " << kv.second << "\n";
-    for (auto &kv : getTimers())
+    std::map<std::string, unsigned> counters;
+    std::map<std::string, long> times;
+    collectStats(getCounters(), getTimers(), counters, times);
+    for (auto &kv : counters)
       OS << kv.first << ": " << kv.second << "\n";
+    for (auto &kv : times) {
+      OS << kv.first << ": ";
+      printTime(OS, kv.second);
+      OS << "\n";
+    }
   }
   OS << "************** STATS END ***************** \n";
 }
 
 void CrabStats::PrintBrunch(crab_os &OS) {
+  std::lock_guard<std::mutex> lock(getStatsMutex());
   OS << "\n\n************** BRUNCH STATS ***************** \n";
   if (!crab::CrabStatsFlag) {
     OS << "Need to call CrabEnableStats()\n";
   } else {
-    for (auto &kv : getCounters())
+    std::map<std::string, unsigned> counters;
+    std::map<std::string, long> times;
+    collectStats(getCounters(), getTimers(), counters, times);
+    for (auto &kv : counters)
       OS << "BRUNCH_STAT " << kv.first << " " << kv.second << "\n";
-    for (auto &kv : getTimers())
-      OS << "BRUNCH_STAT " << kv.first << " " << (kv.second).toSeconds()
-         << "sec \n";
+    for (auto &kv : times)
+      OS << "BRUNCH_STAT " << kv.first << " "
+         << ((double)kv.second / 1000000) << "sec \n";
   }
   OS << "************** BRUNCH STATS END ***************** \n";
 }
 
 ScopedCrabStats::ScopedCrabStats(const std::string &name, bool reset)
-    : m_name("") {
+    : m_name(""), m_id(nullptr) {
   if (crab::CrabStatsFlag) {
     m_name = name;
     if (reset) {
@@ -201,9 +427,21 @@ ScopedCrabStats::ScopedCrabStats(const std::string &name, bool reset)
   }
 }
 
+ScopedCrabStats::ScopedCrabStats(const CrabStatsId &id)
+    : m_name(""), m_id(nullptr) {
+  if (crab::CrabStatsFlag) {
+    m_id = &id;
+    CrabStats::resume(id);
+  }
+}
+
 ScopedCrabStats::~ScopedCrabStats() {
   if (crab::CrabStatsFlag) {
-    CrabStats::stop(m_name);
+    if (m_id) {
+      CrabStats::stop(*m_id);
+    } else {
+      CrabStats::stop(m_name);
+    }
   }
 }
 } // namespace crab
@@ -0,0 +1,556 @@
+/**
+ * Benchmarks for the abstract domains.
+ *
+ * Synthetic CFGs of parameterized size are analyzed with each
+ * selected abstract domain. For each pair (domain, generator) we
+ * report the time of the whole analysis, the mean latency of the
+ * lattice operations (join, meet, widening, inclusion), closure and
+ * transfer functions measured on the invariants of the analysis, and
+ * the peak resident set size of the process. The results are printed
+ * in JSON.
+ *
+ * Note that the peak RSS is the one of the whole process so far. Run
+ * a single domain and generator per process to compare it.
+ **/
+#include "../crab_dom.hpp"
+#include "../crab_lang.hpp"
+
+#include <crab/analysis/abs_transformer.hpp>
+#include <crab/analysis/fwd_analyzer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+namespace {
+
+struct generator_params {
+  // number of variables, arrays or references
+  unsigned size;
+  // nesting depth of loops or number of branches
+  unsigned depth;
+};
+
+z_var mk_int(variable_factory_t &vfac, const std::string &name) {
+  return z_var(vfac[name], crab::INT_TYPE, 32);
+}
+
+std::vector<z_var> mk_ints(variable_factory_t &vfac, const std::string &prefix,
+                           unsigned n) {
+  std::vector<z_var> res;
+  for (unsigned k = 0; k < n; ++k) {
+    res.push_back(mk_int(vfac, prefix + std::to_string(k)));
+  }
+  return res;
+}
+
+// The body of a loop "i := 0; while (i <= bound) { body; i++; }". The
+// caller must connect the last block of the body to latch.
+struct loop_blocks {
+  z_basic_block_t *body;
+  z_basic_block_t *latch;
+  z_basic_block_t *exit;
+};
+
+// Add a loop after pred
+loop_blocks add_loop(z_cfg_t &cfg, z_basic_block_t &pred, const z_var &i,
+                     const std::string &name, int bound) {
+  z_basic_block_t &head = cfg.insert(name + "_head");
+  z_basic_block_t &body = cfg.insert(name + "_body");
+  z_basic_block_t &latch = cfg.insert(name + "_latch");
+  z_basic_block_t &exit = cfg.insert(name + "_exit");
+  pred.assign(i, 0);
+  pred >> head;
+  head >> body;
+  head >> exit;
+  latch >> head;
+  body.assume(i <= bound);
+  latch.add(i, i, 1);
+  exit.assume(i >= bound + 1);
+  return {&body, &latch, &exit};
+}
+
+/*
+  x0 := 0; ...; xn := 0;
+  i0 := 0;
+  while (i0 <= 9) {
+    i1 := 0;
+    while (i1 <= 9) {
+      ...
+        x0 := x0 + 1; ... xn := xn + x(n-1);
+      ...
+      i1++;
+    }
+    i0++;
+  }
+ */
+z_cfg_t *nested_loops(variable_factory_t &vfac, generator_params p) {
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &ret = cfg->insert("ret");
+  std::vector<z_var> xs = mk_ints(vfac, "x", p.size);
+  std::vector<z_var> is = mk_ints(vfac, "i", std::max(p.depth, 1u));
+  for (auto &x : xs) {
+    entry.assign(x, 0);
+  }
+  z_basic_block_t *pred = &entry;
+  std::vector<loop_blocks> loops;
+  for (unsigned k = 0; k < is.size(); ++k) {
+    loops.push_back(add_loop(*cfg, *pred, is[k], "loop" + std::to_string(k), 9));
+    pred = loops.back().body;
+  }
+  z_basic_block_t &inner = *loops.back().body;
+  for (unsigned k = 0; k < xs.size(); ++k) {
+    if (k == 0) {
+      inner.add(xs[k], xs[k], 1);
+    } else {
+      inner.add(xs[k], xs[k], xs[k - 1]);
+    }
+  }
+  inner >> *loops.back().latch;
+  for (unsigned k = loops.size() - 1; k > 0; --k) {
+    *loops[k].exit >> *loops[k - 1].latch;
+  }
+  *loops[0].exit >> ret;
+  return cfg;
+}
+
+/*
+  i := 0;
+  while (i <= 99) {
+    if (x0 <= i) x0 := x0 + 1; else x1 := i;
+    if (x1 <= i) x1 := x1 + 1; else x2 := i;
+    ...
+    i++;
+  }
+ */
+z_cfg_t *wide_branching(variable_factory_t &vfac, generator_params p) {
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &ret = cfg->insert("ret");
+  unsigned n = std::max(p.size, 1u);
+  std::vector<z_var> xs = mk_ints(vfac, "x", n);
+  z_var i = mk_int(vfac, "i");
+  for (auto &x : xs) {
+    entry.assign(x, 0);
+  }
+  loop_blocks loop = add_loop(*cfg, entry, i, "loop", 99);
+  z_basic_block_t *pred = loop.body;
+  for (unsigned k = 0; k < p.depth; ++k) {
+    std::string name = "br" + std::to_string(k);
+    const z_var &x = xs[k % n];
+    const z_var &y = xs[(k + 1) % n];
+    z_basic_block_t &then_bb = cfg->insert(name + "_then");
+    z_basic_block_t &else_bb = cfg->insert(name + "_else");
+    z_basic_block_t &join_bb = cfg->insert(name + "_join");
+    *pred >> then_bb;
+    *pred >> else_bb;
+    then_bb >> join_bb;
+    else_bb >> join_bb;
+    then_bb.assume(x <= i);
+    then_bb.add(x, x, 1);
+    else_bb.assume(x >= i + 1);
+    else_bb.assign(y, i);
+    pred = &join_bb;
+  }
+  *pred >> *loop.latch;
+  *loop.exit >> ret;
+  return cfg;
+}
+
+/*
+  x0 := 0; x1 := 1; ...
+  i := 0;
+  while (i <= 99) {
+    x0 := i; x1 := x0 + 1; ...; xn := x(n-1) + 1;
+    i++;
+  }
+ */
+z_cfg_t *many_variables(variable_factory_t &vfac, generator_params p) {
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &ret = cfg->insert("ret");
+  std::vector<z_var> xs = mk_ints(vfac, "x", p.size);
+  z_var i = mk_int(vfac, "i");
+  for (unsigned k = 0; k < xs.size(); ++k) {
+    entry.assign(xs[k], k);
+  }
+  loop_blocks loop = add_loop(*cfg, entry, i, "loop", 99);
+  for (unsigned k = 0; k < xs.size(); ++k) {
+    if (k == 0) {
+      loop.body->assign(xs[k], i);
+    } else {
+      loop.body->add(xs[k], xs[k - 1], 1);
+    }
+  }
+  *loop.body >> *loop.latch;
+  *loop.exit >> ret;
+  return cfg;
+}
+
+/*
+  A0[0..99] := 0; ...
+  i := 0;
+  while (i <= 99) {
+    A0[i] := i; t0 := A0[i]; ...
+    i++;
+  }
+ */
+z_cfg_t *array_heavy(variable_factory_t &vfac, generator_params p) {
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &ret = cfg->insert("ret");
+  std::vector<z_var> as, ts = mk_ints(vfac, "t", p.size);
+  for (unsigned k = 0; k < p.size; ++k) {
+    as.push_back(z_var(vfac["A" + std::to_string(k)], crab::ARR_INT_TYPE));
+  }
+  z_var i = mk_int(vfac, "i");
+  const uint64_t elem_size = 4;
+  for (auto &a : as) {
+    entry.array_init(a, 0, 99, 0, elem_size);
+  }
+  loop_blocks loop = add_loop(*cfg, entry, i, "loop", 99);
+  for (unsigned k = 0; k < as.size(); ++k) {
+    loop.body->array_store(as[k], i, i, elem_size);
+    loop.body->array_load(ts[k], as[k], i, elem_size);
+  }
+  *loop.body >> *loop.latch;
+  *loop.exit >> ret;
+  return cfg;
+}
+
+/*
+  p0 := malloc(4); *p0 := 0; ...
+  i := 0;
+  while (i <= 99) {
+    v0 := *p0; v0 := v0 + 1; *p0 := v0; ...
+    i++;
+  }
+ */
+z_cfg_t *pointer_heavy(variable_factory_t &vfac, generator_params p) {
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &ret = cfg->insert("ret");
+  std::vector<z_var> refs, regions, vs = mk_ints(vfac, "v", p.size);
+  for (unsigned k = 0; k < p.size; ++k) {
+    refs.push_back(z_var(vfac["p" + std::to_string(k)], crab::REF_TYPE));
+    regions.push_back(z_var(vfac["region_" + std::to_string(k)],
+                            crab::REG_INT_TYPE, 32));
+  }
+  z_var i = mk_int(vfac, "i");
+  z_var_or_cst_t zero32(z_number(0), crab::variable_type(crab::INT_TYPE, 32));
+  z_var_or_cst_t size4(z_number(4), crab::variable_type(crab::INT_TYPE, 32));
+  crab::tag_manager as_man;
+  for (unsigned k = 0; k < refs.size(); ++k) {
+    entry.region_init(regions[k]);
+    entry.make_ref(refs[k], regions[k], size4, as_man.mk_tag());
+    entry.store_to_ref(refs[k], regions[k], zero32);
+  }
+  loop_blocks loop = add_loop(*cfg, entry, i, "loop", 99);
+  for (unsigned k = 0; k < refs.size(); ++k) {
+    loop.body->load_from_ref(vs[k], refs[k], regions[k]);
+    loop.body->add(vs[k], vs[k], 1);
+    loop.body->store_to_ref(refs[k], regions[k], z_var_or_cst_t(vs[k]));
+  }
+  *loop.body >> *loop.latch;
+  *loop.exit >> ret;
+  return cfg;
+}
+
+using generator_t = std::function<z_cfg_t *(variable_factory_t &,
+                                            generator_params)>;
+
+const std::map<std::string, generator_t> &get_generators() {
+  static std::map<std::string, generator_t> generators = {
+      {"nested-loops", nested_loops},
+      {"wide-branching", wide_branching},
+      {"many-variables", many_variables},
+      {"array-heavy", array_heavy},
+      {"pointer-heavy", pointer_heavy}};
+  return generators;
+}
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ns(clock_type::time_point start) {
+  return std::chrono::duration<double, std::nano>(clock_type::now() - start)
+      .count();
+}
+
+long peak_rss_kb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+  return usage.ru_maxrss;
+}
+
+struct op_stats {
+  unsigned long count = 0;
+  double total_ns = 0;
+
+  double mean_ns() const { return count == 0 ? 0 : total_ns / count; }
+};
+
+struct bench_result {
+  std::string domain;
+  std::string generator;
+  generator_params params;
+  unsigned num_blocks;
+  std::vector<double> analysis_ms;
+  std::map<std::string, op_stats> ops;
+  long peak_rss_kb;
+};
+
+// Measure op over all pairs of consecutive invariants
+template <typename Dom, typename Op>
+void measure(op_stats &stats, const std::vector<Dom> &invs, unsigned repeat,
+             Op op) {
+  if (invs.empty()) {
+    return;
+  }
+  for (unsigned r = 0; r < repeat; ++r) {
+    for (unsigned k = 0, n = invs.size(); k < n; ++k) {
+      const Dom &x = invs[k];
+      const Dom &y = invs[(k + 1) % n];
+      auto start = clock_type::now();
+      op(x, y);
+      stats.total_ns += elapsed_ns(start);
+      stats.count++;
+    }
+  }
+}
+
+template <typename Dom>
+bench_result run_bench(const std::string &domain, const std::string &gen_name,
+                       generator_params params, unsigned repeat) {
+  using analyzer_t = intra_fwd_analyzer<z_cfg_ref_t, Dom>;
+  using abs_tr_t = intra_abs_transformer<z_basic_block_t, Dom>;
+
+  variable_factory_t vfac;
+  std::unique_ptr<z_cfg_t> cfg(get_generators().at(gen_name)(vfac, params));
+  z_cfg_ref_t cfg_ref(*cfg);
+
+  bench_result res;
+  res.domain = domain;
+  res.generator = gen_name;
+  res.params = params;
+  res.num_blocks = cfg->size();
+
+  Dom absval_fac;
+  crab::fixpoint_parameters fixpo_params;
+  std::vector<Dom> pres, posts;
+  for (unsigned r = 0; r < repeat; ++r) {
+    analyzer_t a(cfg_ref, absval_fac, nullptr, fixpo_params);
+    auto start = clock_type::now();
+    a.run(absval_fac.make_top());
+    res.analysis_ms.push_back(elapsed_ns(start) / 1e6);
+    if (r + 1 == repeat) {
+      for (auto &b : *cfg) {
+        pres.push_back(a.get_pre(b.label()));
+        posts.push_back(a.get_post(b.label()));
+      }
+    }
+  }
+
+  volatile bool sink = false;
+  measure(res.ops["join"], pres, repeat,
+          [](const Dom &x, const Dom &y) { Dom z = x | y; });
+  measure(res.ops["meet"], pres, repeat,
+          [](const Dom &x, const Dom &y) { Dom z = x & y; });
+  measure(res.ops["widening"], pres, repeat,
+          [](const Dom &x, const Dom &y) { Dom z = x || y; });
+  measure(res.ops["leq"], pres, repeat,
+          [&sink](const Dom &x, const Dom &y) { sink = (x <= y); });
+  // The closure is measured on the result of a join, which is not
+  // normalized by every domain.
+  std::vector<Dom> joins;
+  for (unsigned k = 0, n = pres.size(); k < n; ++k) {
+    joins.push_back(pres[k] | posts[k]);
+  }
+  measure(res.ops["closure"], joins, repeat, [](const Dom &x, const Dom &y) {
+    Dom z(x);
+    z.normalize();
+  });
+  // transfer function of each block, from its pre invariant
+  op_stats &transfer = res.ops["transfer"];
+  for (unsigned r = 0; r < repeat; ++r) {
+    unsigned k = 0;
+    for (auto &b : *cfg) {
+      abs_tr_t abs_tr(pres[k++]);
+      auto start = clock_type::now();
+      for (auto &s : b) {
+        s.accept(&abs_tr);
+      }
+      transfer.total_ns += elapsed_ns(start);
+      transfer.count += std::max<std::size_t>(b.size(), 1);
+    }
+  }
+  (void)sink;
+  res.peak_rss_kb = peak_rss_kb();
+  return res;
+}
+
+using runner_t = std::function<bench_result(
+    const std::string &, const std::string &, generator_params, unsigned)>;
+
+const std::map<std::string, runner_t> &get_domains() {
+  static std::map<std::string, runner_t> domains = {
+      {"int", run_bench<z_interval_domain_t>},
+      {"i64-int", run_bench<z_i64_interval_domain_t>},
+      {"flat-int", run_bench<z_flat_interval_domain_t>},
+      {"sdbm", run_bench<z_sdbm_domain_t>},
+      {"soct", run_bench<z_soct_domain_t>},
+      {"aa-int", run_bench<z_aa_int_t>},
+      {"aa-sdbm", run_bench<z_aa_sdbm_t>},
+      {"rgn-int", run_bench<z_rgn_int_t>},
+      {"rgn-sdbm", run_bench<z_rgn_sdbm_t>}};
+  return domains;
+}
+
+void write_json(std::ostream &o, const std::vector<bench_result> &results) {
+  o << "{\n  \"benchmarks\": [";
+  for (unsigned k = 0; k < results.size(); ++k) {
+    const bench_result &r = results[k];
+    double min_ms = *std::min_element(r.analysis_ms.begin(),
+                                      r.analysis_ms.end());
+    double total_ms = 0;
+    for (double ms : r.analysis_ms) {
+      total_ms += ms;
+    }
+    o << (k == 0 ? "\n" : ",\n");
+    o << "    {\n";
+    o << "      \"domain\": \"" << r.domain << "\",\n";
+    o << "      \"generator\": \"" << r.generator << "\",\n";
+    o << "      \"size\": " << r.params.size << ",\n";
+    o << "      \"depth\": " << r.params.depth << ",\n";
+    o << "      \"blocks\": " << r.num_blocks << ",\n";
+    o << "      \"analysis_ms\": {\"min\": " << min_ms
+      << ", \"mean\": " << total_ms / r.analysis_ms.size()
+      << ", \"runs\": " << r.analysis_ms.size() << "},\n";
+    o << "      \"operations_ns\": {";
+    bool first = true;
+    for (auto &kv : r.ops) {
+      o << (first ? "\n" : ",\n");
+      o << "        \"" << kv.first << "\": {\"mean\": " << kv.second.mean_ns()
+        << ", \"count\": " << kv.second.count << "}";
+      first = false;
+    }
+    o << "\n      },\n";
+    o << "      \"peak_rss_kb\": " << r.peak_rss_kb << "\n";
+    o << "    }";
+  }
+  o << "\n  ]\n}\n";
+}
+
+std::vector<std::string> select(const std::vector<std::string> &requested,
+                                const std::vector<std::string> &all) {
+  if (requested.empty() ||
+      std::find(requested.begin(), requested.end(), "all") !=
+          requested.end()) {
+    return all;
+  }
+  return requested;
+}
+
+} // end namespace
+
+int main(int argc, char **argv) {
+  namespace po = boost::program_options;
+
+  std::vector<std::string> all_domains, all_generators;
+  for (auto &kv : get_domains()) {
+    all_domains.push_back(kv.first);
+  }
+  for (auto &kv : get_generators()) {
+    all_generators.push_back(kv.first);
+  }
+
+  std::vector<std::string> domains, generators;
+  generator_params params;
+  unsigned repeat;
+  std::string output;
+  po::options_description desc("crab-bench options");
+  desc.add_options()("help", "Print help message and exit");
+  desc.add_options()("domain", po::value<std::vector<std::string>>(&domains),
+                     "Abstract domain to benchmark (can be repeated): all, "
+                     "int, i64-int, flat-int, sdbm, soct, aa-int, aa-sdbm, rgn-int, "
+                     "rgn-sdbm");
+  desc.add_options()("generator",
+                     po::value<std::vector<std::string>>(&generators),
+                     "CFG generator (can be repeated): all, nested-loops, "
+                     "wide-branching, many-variables, array-heavy, "
+                     "pointer-heavy");
+  desc.add_options()("size", po::value<unsigned>(&params.size)->default_value(8),
+                     "Number of variables, arrays or references");
+  desc.add_options()("depth",
+                     po::value<unsigned>(&params.depth)->default_value(3),
+                     "Loop nesting depth or number of branches");
+  desc.add_options()("repeat", po::value<unsigned>(&repeat)->default_value(3),
+                     "Number of times each measure is repeated");
+  desc.add_options()("output", po::value<std::string>(&output),
+                     "Write the JSON results to this file instead of stdout");
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+  } catch (po::error &e) {
+    std::cerr << "crab-bench: " << e.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+  repeat = std::max(repeat, 1u);
+  crab::CrabEnableWarningMsg(false);
+
+  domains = select(domains, all_domains);
+  generators = select(generators, all_generators);
+  for (auto &d : domains) {
+    if (!get_domains().count(d)) {
+      std::cerr << "crab-bench: unknown domain " << d << "\n";
+      return 1;
+    }
+  }
+  for (auto &g : generators) {
+    if (!get_generators().count(g)) {
+      std::cerr << "crab-bench: unknown generator " << g << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<bench_result> results;
+  for (auto &d : domains) {
+    for (auto &g : generators) {
+      results.push_back(get_domains().at(d)(d, g, params, repeat));
+    }
+  }
+
+  if (output.empty()) {
+    write_json(std::cout, results);
+  } else {
+    std::ofstream o(output);
+    if (!o) {
+      std::cerr << "crab-bench: cannot open " << output << "\n";
+      return 1;
+    }
+    write_json(o, results);
+  }
+  return 0;
+}
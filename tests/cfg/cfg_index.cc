@@ -0,0 +1,128 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/analysis/fwd_analyzer.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    i := 0;
+    while (i <= 9) {
+      j := 0;
+      while (j <= i) { j++; }
+      i++;
+    }
+   */
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var j(vfac["j"], crab::INT_TYPE, 32);
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &outer = cfg->insert("outer");
+  z_basic_block_t &outer_body = cfg->insert("outer_body");
+  z_basic_block_t &inner = cfg->insert("inner");
+  z_basic_block_t &inner_body = cfg->insert("inner_body");
+  z_basic_block_t &inner_exit = cfg->insert("inner_exit");
+  z_basic_block_t &ret = cfg->insert("ret");
+  entry >> outer;
+  outer >> outer_body;
+  outer >> ret;
+  outer_body >> inner;
+  inner >> inner_body;
+  inner_body >> inner;
+  inner >> inner_exit;
+  inner_exit >> outer;
+  entry.assign(i, 0);
+  outer_body.assume(i <= 9);
+  outer_body.assign(j, 0);
+  inner_body.assume(j <= i);
+  inner_body.add(j, j, 1);
+  inner_exit.assume(j >= i + 1);
+  inner_exit.add(i, i, 1);
+  ret.assume(i >= 10);
+  return cfg;
+}
+
+template <typename Dom> void run(z_cfg_t *cfg) {
+  using analyzer_t = intra_fwd_analyzer<z_cfg_ref_t, Dom>;
+
+  // The same CFG without index
+  std::unique_ptr<z_cfg_t> copy(cfg->clone());
+  Dom absval_fac, init;
+  crab::fixpoint_parameters params;
+  analyzer_t a(*cfg, absval_fac, nullptr, params);
+  a.run(init);
+  analyzer_t b(*copy, absval_fac, nullptr, params);
+  b.run(init);
+
+  crab::outs() << "Analysis using " << init.domain_name() << "\n";
+  bool same = true;
+  for (auto &bb : *cfg) {
+    auto a_pre = a.get_pre(bb.label());
+    auto a_post = a.get_post(bb.label());
+    auto b_pre = b.get_pre(bb.label());
+    auto b_post = b.get_post(bb.label());
+    same &= (a_pre <= b_pre && b_pre <= a_pre && a_post <= b_post &&
+             b_post <= a_post);
+  }
+  crab::outs() << "ret=" << a.get_post(cfg->exit()) << "\n";
+  crab::outs() << "Invariants with and without index are "
+               << (same ? "equal" : "different") << "\n";
+}
+
+void print_index(z_cfg_t *cfg) {
+  for (unsigned id = 0; id < cfg->size(); ++id) {
+    crab::outs() << id << ": " << cfg->block_label(id) << " succs={";
+    for (unsigned s : cfg->next_ids(id)) {
+      crab::outs() << " " << s;
+    }
+    crab::outs() << " } preds={";
+    for (unsigned p : cfg->prev_ids(id)) {
+      crab::outs() << " " << p;
+    }
+    crab::outs() << " }\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+  cfg->build_index();
+  print_index(cfg);
+
+  run<z_interval_domain_t>(cfg);
+  run<z_sdbm_domain_t>(cfg);
+
+  // Edits made directly through the blocks drop the index
+  z_basic_block_t &outer = cfg->get_node("outer");
+  z_basic_block_t &ret = cfg->get_node("ret");
+  outer -= ret;
+  crab::outs() << "Indexed after removing an edge: "
+               << (cfg->is_indexed() ? "yes" : "no") << "\n";
+  cfg->build_index();
+  print_index(cfg);
+  outer >> ret;
+  crab::outs() << "Indexed after adding an edge: "
+               << (cfg->is_indexed() ? "yes" : "no") << "\n";
+  cfg->build_index();
+  print_index(cfg);
+  z_var k(vfac["k"], crab::INT_TYPE, 32);
+  ret.assign(k, 1);
+  crab::outs() << "Indexed after adding a statement: "
+               << (cfg->is_indexed() ? "yes" : "no") << "\n";
+  cfg->build_index();
+  run<z_interval_domain_t>(cfg);
+
+  cfg->insert("unreachable");
+  crab::outs() << "Indexed after insert: "
+               << (cfg->is_indexed() ? "yes" : "no") << "\n";
+  delete cfg;
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/cfg/cfg_serialization.hpp>
+
+#include <cstdio>
+
+using namespace std;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace ikos;
+
+z_cfg_t *prog(variable_factory_t &vfac, crab::tag_manager &as_man) {
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 8);
+  z_var b(vfac["b"], crab::BOOL_TYPE, 1);
+  z_var c(vfac["c"], crab::BOOL_TYPE, 1);
+  z_var a(vfac["a"], crab::ARR_INT_TYPE);
+  z_var p(vfac["p"], crab::REF_TYPE);
+  z_var q(vfac["q"], crab::REF_TYPE);
+  z_var mem(vfac["region_0"], crab::REG_INT_TYPE, 32);
+  z_var_or_cst_t size8(z_number(8), crab::variable_type(crab::INT_TYPE, 32));
+
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret",
+                             z_cfg_t::fdecl_t("foo", {i}, {x}));
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &loop = cfg->insert("loop");
+  z_basic_block_t &body = cfg->insert("body");
+  z_basic_block_t &ret = cfg->insert("ret");
+  entry >> loop;
+  loop >> body;
+  body >> loop;
+  loop >> ret;
+
+  entry.assign(x, 0);
+  entry.havoc(y, "unknown");
+  entry.region_init(mem);
+  entry.make_ref(p, mem, size8, as_man.mk_tag());
+  entry.array_init(a, 0, 9, 0, 4);
+  entry.bool_assign(b, x <= i);
+  entry.bool_assign(c, z_ref_cst_t::mk_not_null(p));
+  body.assume(x <= z_number("123456789012345678901234567890"));
+  body.mul(x, x, 2);
+  body.truncate(x, y);
+  body.select(i, x >= 1, x, 5);
+  body.array_store(a, x, i, 4);
+  body.array_load(i, a, x, 4);
+  body.store_to_ref(p, mem, x);
+  body.load_from_ref(i, p, mem);
+  body.gep_ref(q, mem, p, mem, z_number(4));
+  body.bool_and(b, b, c);
+  body.bool_select(c, b, b, c);
+  body.bool_assume(b);
+  body.callsite("bar", {i}, {x, i});
+  ret.assume(x >= 10);
+  ret.assume_ref(z_ref_cst_t::mk_eq(p, q, z_number(-4)));
+  ret.assertion(x >= y, crab::cfg::debug_info("foo.c", 10, 3, 7));
+  ret.bool_assert(c);
+  return cfg;
+}
+
+static std::string to_string(const z_cfg_t &cfg) {
+  crab::crab_string_os os;
+  os << cfg;
+  return os.str();
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  crab::tag_manager as_man;
+  std::unique_ptr<z_cfg_t> cfg(prog(vfac, as_man));
+
+  std::string filename = "cfg_serialization.crabir";
+  cfg_binary_writer<z_cfg_t> writer;
+  writer.add(*cfg);
+  if (!writer.write(filename)) {
+    crab::outs() << "Cannot write " << filename << "\n";
+    return 1;
+  }
+
+  crab::tag_manager as_man2;
+  cfg_binary_reader<z_cfg_t> reader(
+      [&vfac](const std::string &s) { return vfac[s]; },
+      [](const std::string &s) { return s; }, &as_man2);
+  auto cfgs = reader.read(filename);
+  std::remove(filename.c_str());
+
+  crab::outs() << "Read " << cfgs.size() << " cfg\n";
+  crab::outs() << *cfgs[0] << "\n";
+  crab::outs() << "Written and read CFGs are "
+               << (to_string(*cfg) == to_string(*cfgs[0]) ? "equal"
+                                                          : "different")
+               << "\n";
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/checkers/assertion.hpp>
+#include <crab/checkers/base_property.hpp>
+#include <crab/checkers/checker.hpp>
+#include <crab/checkers/div_zero.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+using namespace crab::checker;
+
+z_cfg_t *prog(variable_factory_t &vfac, unsigned n) {
+  /*
+    x := 0;
+    bi: x := x + 1; assert(x <= i);
+        havoc(t); assume(t >= 0); if (i % 3 != 0) assume(t >= 1);
+        y := x / t;
+        assert(t >= 1);
+    ret: assert(x <= n - 1);
+   */
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  z_var t(vfac["t"], crab::INT_TYPE, 32);
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t *prev = &cfg->insert("entry");
+  prev->assign(x, 0);
+  for (unsigned i = 1; i <= n; ++i) {
+    z_basic_block_t &b = cfg->insert("b" + std::to_string(i));
+    *prev >> b;
+    b.add(x, x, 1);
+    b.assertion(x <= i, debug_info("prog.c", i, 1, 2 * i));
+    b.havoc(t);
+    b.assume(t >= 0);
+    if (i % 3 != 0) {
+      b.assume(t >= 1);
+    }
+    b.div(y, x, t);
+    b.assertion(t >= 1, debug_info("prog.c", i, 2, 2 * i + 1));
+    prev = &b;
+  }
+  z_basic_block_t &ret = cfg->insert("ret");
+  *prev >> ret;
+  ret.assertion(x <= n - 1, debug_info("prog.c", n + 1, 1, 2 * n + 2));
+  return cfg;
+}
+
+template <typename Analyzer>
+std::string check(Analyzer &a, unsigned num_threads) {
+  using checker_t = intra_checker<Analyzer>;
+  typename checker_t::prop_checker_ptr prop1(
+      new div_zero_property_checker<Analyzer>(0));
+  typename checker_t::prop_checker_ptr prop2(
+      new assert_property_checker<Analyzer>(0));
+  checker_t checker(a, {prop1, prop2}, num_threads);
+  checker.run();
+  crab::crab_string_os os;
+  checker.show(os);
+  checker.get_all_checks().write(os, true);
+  return os.str();
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  std::unique_ptr<z_cfg_t> cfg(prog(vfac, 12));
+  using analyzer_t = intra_fwd_analyzer<z_cfg_ref_t, z_interval_domain_t>;
+  z_interval_domain_t absval_fac, init;
+  crab::fixpoint_parameters params;
+  analyzer_t a(*cfg, absval_fac, nullptr, params);
+  a.run(init);
+
+  std::string seq = check(a, 1);
+  std::string par = check(a, 4);
+  crab::outs() << seq;
+  crab::outs() << "Checks with 1 and 4 threads are "
+               << (seq == par ? "equal" : "different") << "\n";
+  return 0;
+}
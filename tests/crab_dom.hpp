@@ -14,8 +14,10 @@
 #include <crab/domains/fixed_tvpi_domain.hpp>
 #include <crab/domains/flat_boolean_domain.hpp>
 #include <crab/domains/generic_abstract_domain.hpp>
+#include <crab/domains/i64_intervals.hpp>
 #include <crab/domains/intervals.hpp>
 #include <crab/domains/lookahead_widening_domain.hpp>
+#include <crab/domains/numerical_packing.hpp>
 #include <crab/domains/powerset_domain.hpp>
 #include <crab/domains/region_domain.hpp>
 #include <crab/domains/sign_domain.hpp>
@@ -44,11 +46,17 @@ using q_interval_t = interval<q_number>;
 // Numerical domains over integers
 /*===================================================================*/
 using z_interval_domain_t = interval_domain<z_number, varname_t>;
+using z_i64_interval_domain_t = i64_interval_domain<z_number, varname_t>;
+using z_flat_interval_domain_t = i64_interval_domain<
+    z_number, varname_t, 10, flat_interval_env<variable<z_number, varname_t>>>;
 using z_constant_domain_t = constant_domain<z_number, varname_t>;  
 using z_ric_domain_t = numerical_congruence_domain<z_interval_domain_t>;
 using z_dbm_graph_t = DBM_impl::DefaultParams<z_number, DBM_impl::GraphRep::adapt_ss>;
 using z_dbm_domain_t = sparse_dbm_domain<z_number, varname_t, z_dbm_graph_t>;
 using z_sdbm_domain_t = split_dbm_domain<z_number, varname_t, z_dbm_graph_t>;
+using z_dense_dbm_graph_t = DBM_impl::DefaultParams<z_number, DBM_impl::GraphRep::dense>;
+using z_dense_dbm_domain_t = sparse_dbm_domain<z_number, varname_t, z_dense_dbm_graph_t>;
+using z_dense_sdbm_domain_t = split_dbm_domain<z_number, varname_t, z_dense_dbm_graph_t>;
 using z_soct_domain_t = split_oct_domain<z_number, varname_t, z_dbm_graph_t>;  
 using z_boxes_domain_t = boxes_domain<z_number, varname_t>;
 using z_dis_interval_domain_t = dis_interval_domain<z_number, varname_t>;
@@ -71,6 +79,7 @@ using z_num_domain_t =
     reduced_numerical_domain_product2<z_term_dis_int_t, z_sdbm_domain_t>;
 //using z_fixed_tvpi_domain_t = fixed_tvpi_domain<z_soct_domain_t>;
 using z_fixed_tvpi_domain_t = fixed_tvpi_domain<z_sdbm_domain_t>;  
+using z_packing_sdbm_domain_t = numerical_packing_domain<z_sdbm_domain_t>;
 // Boolean-numerical domain over integers
 using z_bool_num_domain_t = flat_boolean_numerical_domain<z_dbm_domain_t>;
 using z_bool_interval_domain_t =
@@ -19,13 +19,18 @@ Z_RUNNER(crab::domain_impl::z_abs_domain_t)
 Q_RUNNER(crab::domain_impl::q_abs_domain_t)
 #else
 Z_RUNNER(crab::domain_impl::z_interval_domain_t)
+Z_RUNNER(crab::domain_impl::z_i64_interval_domain_t)
+Z_RUNNER(crab::domain_impl::z_flat_interval_domain_t)
 Z_RUNNER(crab::domain_impl::z_constant_domain_t)
 Z_RUNNER(crab::domain_impl::z_ric_domain_t)
 Z_RUNNER(crab::domain_impl::z_dbm_domain_t)
 Z_RUNNER(crab::domain_impl::z_sdbm_domain_t)
+Z_RUNNER(crab::domain_impl::z_dense_dbm_domain_t)
+Z_RUNNER(crab::domain_impl::z_dense_sdbm_domain_t)
 Z_RUNNER(crab::domain_impl::z_soct_domain_t)
 Z_RUNNER(crab::domain_impl::z_soct_domain_lw_t)
 Z_RUNNER(crab::domain_impl::z_fixed_tvpi_domain_t)
+Z_RUNNER(crab::domain_impl::z_packing_sdbm_domain_t)
 Z_RUNNER(crab::domain_impl::z_term_domain_t)
 Z_RUNNER(crab::domain_impl::z_term_dis_int_t)
 Z_RUNNER(crab::domain_impl::z_num_domain_t)
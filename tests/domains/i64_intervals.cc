@@ -0,0 +1,79 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+using namespace std;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    i := 0;
+    x := 0;
+    while (i <= 99) {
+      i := i + 1;
+      x := i * 2;
+    }
+    y := x / 3;
+    z := i * 4611686018427387904;  // 2^62
+    w := z * 4;                    // overflows int64_t
+    assume (y != 66);
+   */
+  z_var i(vfac["i"], crab::INT_TYPE, 64);
+  z_var x(vfac["x"], crab::INT_TYPE, 64);
+  z_var y(vfac["y"], crab::INT_TYPE, 64);
+  z_var z(vfac["z"], crab::INT_TYPE, 64);
+  z_var w(vfac["w"], crab::INT_TYPE, 64);
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit");
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &loop = cfg->insert("loop");
+  z_basic_block_t &body = cfg->insert("body");
+  z_basic_block_t &ret = cfg->insert("ret");
+  z_basic_block_t &exit = cfg->insert("exit");
+  // adding control flow
+  entry >> loop;
+  loop >> body;
+  body >> loop;
+  loop >> ret;
+  ret >> exit;
+  // adding statements
+  entry.assign(i, 0);
+  entry.assign(x, 0);
+  body.assume(i <= 99);
+  body.add(i, i, 1);
+  body.mul(x, i, 2);
+  ret.assume(i >= 100);
+  ret.div(y, x, 3);
+  ret.mul(z, i, z_number(int64_t(1) << 62));
+  ret.mul(w, z, 4);
+  ret.assume(y != 66);
+  return cfg;
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+  crab::outs() << *cfg << "\n";
+
+  {
+    z_interval_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+  {
+    z_i64_interval_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+  {
+    z_flat_interval_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+
+  delete cfg;
+  return 0;
+}
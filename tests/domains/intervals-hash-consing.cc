@@ -0,0 +1,126 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+// Environments whose patricia trees are hash-consed: equal
+// environments must be represented by the very same tree.
+using hc_env_t = separate_domain<z_var, z_interval_t, std::equal_to<z_interval_t>,
+                                 boost::hash<z_interval_t>>;
+using env_t = separate_domain<z_var, z_interval_t>;
+using z_hc_interval_domain_t = hc_interval_domain<z_number, varname_t>;
+
+template <typename Env>
+static void check_env(const char *name, variable_factory_t &vfac) {
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  z_var z(vfac["z"], crab::INT_TYPE, 32);
+
+  Env e1, e2;
+  e1.set(x, z_interval_t(1, 5));
+  e1.set(y, z_interval_t(0, 10));
+  e1.set(z, z_interval_t(3, 3));
+  // same bindings in the reverse order
+  e2.set(z, z_interval_t(3, 3));
+  e2.set(y, z_interval_t(0, 10));
+  e2.set(x, z_interval_t(1, 5));
+  crab::outs() << name << ": e1=" << e1 << " e2=" << e2 << "\n";
+  crab::outs() << "  e1 == e2: " << (e1 == e2)
+               << " identical: " << e1.is_identical(e2) << "\n";
+
+  Env j = e1 | e2;
+  crab::outs() << "  e1 | e2 identical to e1: " << j.is_identical(e1) << "\n";
+
+  // modify and restore a binding
+  Env e3(e1);
+  e3.set(y, z_interval_t(0, 20));
+  crab::outs() << "  after update identical: " << e3.is_identical(e1) << "\n";
+  e3.set(y, z_interval_t(0, 10));
+  crab::outs() << "  after restore identical: " << e3.is_identical(e1)
+               << " equal: " << (e3 == e1) << "\n";
+
+  // remove and re-insert a binding
+  Env e4(e2);
+  e4 -= x;
+  e4.set(x, z_interval_t(1, 5));
+  crab::outs() << "  after remove/insert identical: " << e4.is_identical(e1)
+               << "\n";
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  check_env<env_t>("not hash-consed", vfac);
+  check_env<hc_env_t>("hash-consed", vfac);
+
+  {
+    z_var x(vfac["x"], crab::INT_TYPE, 32);
+    z_var y(vfac["y"], crab::INT_TYPE, 32);
+    z_var z(vfac["z"], crab::INT_TYPE, 32);
+
+    z_hc_interval_domain_t inv1, inv2;
+    inv1.assign(x, 5);
+    inv1 += (y >= 0);
+    inv1 += (y <= x);
+    inv1.apply(crab::domains::OP_ADDITION, z, x, y);
+    inv2.assign(x, 5);
+    inv2 += (y <= 5);
+    inv2 += (y >= 0);
+    inv2.apply(crab::domains::OP_ADDITION, z, x, y);
+    crab::outs() << "inv1=" << inv1 << "\n";
+    crab::outs() << "inv2=" << inv2 << "\n";
+    crab::outs() << "inv1 <= inv2: " << (inv1 <= inv2)
+                 << " inv2 <= inv1: " << (inv2 <= inv1) << "\n";
+    z_hc_interval_domain_t inv3 = inv1 | inv2;
+    crab::outs() << "inv1 | inv2=" << inv3 << "\n";
+    z_hc_interval_domain_t inv4 = inv1 || inv2;
+    crab::outs() << "inv1 || inv2=" << inv4 << "\n";
+    inv2 += (x >= 6);
+    crab::outs() << "inv2 after x >= 6: " << inv2 << "\n";
+  }
+
+  {
+    // Hash-consed environments built on different threads are
+    // identical, and can be released on a thread other than the one
+    // that built them.
+    z_var x(vfac["x"], crab::INT_TYPE, 32);
+    z_var y(vfac["y"], crab::INT_TYPE, 32);
+    const unsigned num_threads = 4;
+    std::vector<hc_env_t> envs(num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&envs, &x, &y, i]() {
+        hc_env_t e;
+        for (unsigned k = 0; k < 1000; ++k) {
+          e.set(x, z_interval_t(k, k + i));
+          e.set(y, z_interval_t(i, k + i));
+        }
+        e.set(y, z_interval_t(0, 10));
+        e.set(x, z_interval_t(1, 5));
+        envs[i] = e;
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    bool identical = true;
+    for (unsigned i = 1; i < num_threads; ++i) {
+      identical &= envs[0].is_identical(envs[i]);
+    }
+    crab::outs() << "identical across threads: " << identical << "\n";
+    envs.clear();
+    hc_env_t e;
+    e.set(x, z_interval_t(1, 5));
+    e.set(y, z_interval_t(0, 10));
+    crab::outs() << "rebuilt after release: " << e << "\n";
+  }
+  return 0;
+}
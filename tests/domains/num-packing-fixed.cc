@@ -0,0 +1,85 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/analysis/dataflow/var_packing.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    i := 0;
+    a := 0;
+    b := 0;
+    while (i <= 99) {
+      i := i + 1;
+      a := a + 1;
+      b := b + 3;
+      assume (a <= i);
+    }
+    x := a - i;
+    y := b - a;
+   */
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var a(vfac["a"], crab::INT_TYPE, 32);
+  z_var b(vfac["b"], crab::INT_TYPE, 32);
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit");
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &loop = cfg->insert("loop");
+  z_basic_block_t &body = cfg->insert("body");
+  z_basic_block_t &ret = cfg->insert("ret");
+  z_basic_block_t &exit = cfg->insert("exit");
+  // adding control flow
+  entry >> loop;
+  loop >> body;
+  body >> loop;
+  loop >> ret;
+  ret >> exit;
+  // adding statements
+  entry.assign(i, 0);
+  entry.assign(a, 0);
+  entry.assign(b, 0);
+  body.assume(i <= 99);
+  body.add(i, i, 1);
+  body.add(a, a, 1);
+  body.add(b, b, 3);
+  body.assume(a <= i);
+  ret.assume(i >= 100);
+  ret.sub(x, a, i);
+  ret.sub(y, b, a);
+  return cfg;
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+  crab::outs() << *cfg << "\n";
+
+  {
+    // packs are computed dynamically
+    z_packing_sdbm_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+  {
+    // packs are computed before the analysis with at most 2
+    // variables per pack
+    var_packing_analysis<z_cfg_ref_t> packing(*cfg, 2);
+    packing.exec();
+    crab::outs() << "Fixed packs=" << packing << "\n";
+    z_packing_sdbm_domain_t init(packing.get_packs());
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+
+  delete cfg;
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <crab/support/stats.hpp>
+
+#include <string>
+
+using namespace std;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+// With zones.copy_on_write, copies of a split DBM share their state
+// until one of them is modified. Only the first write to a shared state copies it
+// (SplitDBM.count.detach). Queries and operations that replace the
+// whole state (in-place join and meet) must not copy it.
+
+static unsigned num_detach() {
+  crab::crab_string_os os;
+  crab::CrabStats::Print(os);
+  std::string s = os.str();
+  const std::string key = "\nSplitDBM.count.detach: ";
+  std::size_t pos = s.find(key);
+  if (pos == std::string::npos) {
+    return 0;
+  }
+  return std::stoul(s.substr(pos + key.size()));
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  crab::CrabEnableStats(true);
+  crab::domains::crab_domain_params_man::get().set_param("zones.copy_on_write",
+                                                         "true");
+  variable_factory_t vfac;
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  z_var z(vfac["z"], crab::INT_TYPE, 32);
+
+  z_sdbm_domain_t a;
+  a += (x >= 0);
+  a += (x <= 10);
+  a += (y - x <= 2);
+  a += (z - y <= 0);
+  crab::CrabStats::reset();
+
+  z_sdbm_domain_t b(a);
+  crab::outs() << "copy: detach=" << num_detach() << "\n";
+
+  // queries do not copy the shared state
+  crab::outs() << "b[y]=" << b[y] << " b.at(z)=" << b.at(z) << "\n";
+  z_lin_cst_sys_t csts;
+  b.extract(x, csts, false);
+  crab::outs() << "extract(x)=" << csts << "\n";
+  crab::outs() << "b <= a: " << (b <= a) << "\n";
+  crab::outs() << "after queries: detach=" << num_detach() << "\n";
+
+  // the first write copies the shared state, the next ones do not
+  b += (x <= 3);
+  crab::outs() << "after first write: detach=" << num_detach() << "\n";
+  b += (y >= 1);
+  crab::outs() << "after second write: detach=" << num_detach() << "\n";
+  crab::outs() << "a=" << a << "\n";
+  crab::outs() << "b=" << b << "\n";
+
+  // in-place join and meet replace the state without copying it
+  z_sdbm_domain_t c(a);
+  z_sdbm_domain_t d;
+  d += (x >= 20);
+  d += (x <= 30);
+  d += (y - x <= 1);
+  c |= d;
+  crab::outs() << "after join: detach=" << num_detach() << "\n";
+  z_sdbm_domain_t e(a);
+  e &= b;
+  crab::outs() << "after meet: detach=" << num_detach() << "\n";
+  crab::outs() << "a=" << a << "\n";
+  crab::outs() << "a | d=" << c << "\n";
+  crab::outs() << "a & b=" << e << "\n";
+
+  // a is the only owner of its state again after c and e were reset
+  z_sdbm_domain_t f(a);
+  f.set_to_bottom();
+  a += (z >= -5);
+  crab::outs() << "after bottom and write to a: detach=" << num_detach()
+               << "\n";
+  crab::outs() << "a=" << a << "\n";
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <map>
+#include <vector>
+
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+using namespace ikos;
+
+// The terms of a linear expression are kept sorted in a small vector
+// with three inline slots. Addition and subtraction merge the two
+// sorted sequences. Check expressions with more terms than the inline
+// capacity and with terms that cancel out, against a std::map-based
+// reference.
+
+using ref_t = std::map<ikos::index_t, z_number>;
+
+static ref_t to_ref(const z_lin_exp_t &e) {
+  ref_t r;
+  for (auto const &kv : e) {
+    r[kv.second.index()] = kv.first;
+  }
+  return r;
+}
+
+static ref_t ref_add(const ref_t &a, const ref_t &b, bool negate) {
+  ref_t r(a);
+  for (auto const &kv : b) {
+    z_number c = r[kv.first] + (negate ? -kv.second : kv.second);
+    if (c == 0) {
+      r.erase(kv.first);
+    } else {
+      r[kv.first] = c;
+    }
+  }
+  return r;
+}
+
+static bool is_sorted_without_zeros(const z_lin_exp_t &e) {
+  bool first = true;
+  ikos::index_t prev = 0;
+  for (auto const &kv : e) {
+    if (kv.first == 0 || (!first && kv.second.index() <= prev)) {
+      return false;
+    }
+    prev = kv.second.index();
+    first = false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  std::vector<z_var> vars;
+  for (auto name : {"x", "y", "z", "w", "v", "u"}) {
+    vars.push_back(z_var(vfac[name], crab::INT_TYPE, 32));
+  }
+  z_var x = vars[0], y = vars[1], z = vars[2], w = vars[3], v = vars[4],
+        u = vars[5];
+
+  {
+    // more terms than the inline capacity
+    z_lin_exp_t e1 = x + 2 * y + 3 * z + 4 * w + 5 * v;
+    z_lin_exp_t e2 = x + 2 * y + 3 * z + 4 * w + 7;
+    crab::outs() << "e1=" << e1 << " size=" << e1.size() << "\n";
+    crab::outs() << "e2=" << e2 << " size=" << e2.size() << "\n";
+    // everything but v cancels out
+    crab::outs() << "e1-e2=" << (e1 - e2) << " size=" << (e1 - e2).size()
+                 << "\n";
+    crab::outs() << "e1+e2=" << (e1 + e2) << " size=" << (e1 + e2).size()
+                 << "\n";
+    // all the terms cancel out
+    z_lin_exp_t e3 = e1 - e1;
+    crab::outs() << "e1-e1=" << e3 << " is_constant=" << e3.is_constant()
+                 << "\n";
+    z_lin_exp_t e4 = e1 + (e1 * -1) + 3;
+    crab::outs() << "e1+(-e1)+3=" << e4 << " is_constant=" << e4.is_constant()
+                 << "\n";
+    // terms inserted out of order
+    z_lin_exp_t e5 = u + v - w + z - y + x;
+    crab::outs() << "e5=" << e5 << " size=" << e5.size()
+                 << " e5[w]=" << e5[w] << " e5[u]=" << e5[u] << "\n";
+    z_lin_exp_t e6 = e5 + w - u - x;
+    crab::outs() << "e5+w-u-x=" << e6 << " size=" << e6.size() << "\n";
+    crab::outs() << "e5*0=" << (e5 * z_number(0)) << " e5*-2=" << (e5 * -2)
+                 << "\n";
+  }
+
+  {
+    // random sums and differences against the reference
+    uint64_t seed = 42;
+    auto next = [&seed]() {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return (unsigned)(seed >> 33);
+    };
+    auto random_exp = [&]() {
+      z_lin_exp_t e(z_number((int64_t)(next() % 11) - 5));
+      unsigned n = next() % 7;
+      for (unsigned i = 0; i < n; ++i) {
+        e = e + z_number((int64_t)(next() % 5) - 2) * vars[next() % vars.size()];
+      }
+      return e;
+    };
+    unsigned num_ok = 0, num_tests = 1000;
+    for (unsigned i = 0; i < num_tests; ++i) {
+      z_lin_exp_t a = random_exp();
+      z_lin_exp_t b = random_exp();
+      bool ok = true;
+      z_lin_exp_t s = a + b;
+      z_lin_exp_t d = a - b;
+      ok &= (to_ref(s) == ref_add(to_ref(a), to_ref(b), false));
+      ok &= (to_ref(d) == ref_add(to_ref(a), to_ref(b), true));
+      ok &= (s.constant() == a.constant() + b.constant());
+      ok &= (d.constant() == a.constant() - b.constant());
+      ok &= is_sorted_without_zeros(s) && is_sorted_without_zeros(d);
+      ok &= (d + b).equal(a);
+      if (ok) {
+        ++num_ok;
+      } else {
+        crab::outs() << "FAILED: a=" << a << " b=" << b << " a+b=" << s
+                     << " a-b=" << d << "\n";
+      }
+    }
+    crab::outs() << num_ok << "/" << num_tests << " random sums are correct\n";
+  }
+  return 0;
+}
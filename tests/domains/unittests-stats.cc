@@ -0,0 +1,87 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <crab/support/stats.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Counters and stop watches updated through interned names must be
+// reported together with the ones updated by name, including the
+// updates done by threads that already finished.
+
+static void print_test_stats() {
+  crab::crab_string_os os;
+  crab::CrabStats::Print(os);
+  std::string s = os.str();
+  std::size_t pos = 0;
+  while (pos < s.size()) {
+    std::size_t end = s.find('\n', pos);
+    if (end == std::string::npos) {
+      end = s.size();
+    }
+    std::string line = s.substr(pos, end - pos);
+    pos = end + 1;
+    if (line.compare(0, 5, "test.") != 0) {
+      continue;
+    }
+    std::size_t colon = line.find(": ");
+    if (line.back() == 's') {
+      // the elapsed time of a stop watch is not deterministic
+      crab::outs() << line.substr(0, colon) << ": <time>\n";
+    } else {
+      crab::outs() << line << "\n";
+    }
+  }
+}
+
+static void update(unsigned n) {
+  for (unsigned i = 0; i < n; ++i) {
+    crab::CrabStats::count(CRAB_STATS_ID("test.interned"));
+    crab::ScopedCrabStats __st__(CRAB_STATS_ID("test.interned.timer"));
+  }
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  crab::CrabEnableStats(true);
+
+  // the same name always gets the same identifier
+  crab::CrabStatsId id1("test.id");
+  crab::CrabStatsId id2("test.id");
+  crab::CrabStatsId id3("test.other.id");
+  crab::outs() << "same id: " << (id1.get() == id2.get())
+               << " different id: " << (id1.get() != id3.get()) << "\n";
+
+  // an interned name and the same name used as a string are merged
+  crab::CrabStats::count(id1);
+  crab::CrabStats::count(id1);
+  crab::CrabStats::count("test.id");
+  crab::CrabStats::count("test.named");
+  update(10);
+
+  {
+    const unsigned num_threads = 4;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+      threads.emplace_back([]() { update(100); });
+    }
+    for (auto &th : threads) {
+      th.join();
+    }
+  }
+  crab::outs() << "== after the threads finished\n";
+  print_test_stats();
+
+  crab::CrabStats::reset();
+  update(3);
+  crab::outs() << "== after reset\n";
+  print_test_stats();
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+using namespace crab::cfg_impl;
+
+// Variable names are a 32-bit index plus the 32-bit identifier of
+// their factory in variable_factory_registry.
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+
+  crab::outs() << "sizeof(varname_t)=" << sizeof(varname_t)
+               << " trivially copyable="
+               << std::is_trivially_copyable<varname_t>::value << "\n";
+  crab::outs() << "sizeof(z_var)=" << sizeof(z_var) << " trivially copyable="
+               << std::is_trivially_copyable<z_var>::value << "\n";
+
+  variable_factory_t vfac1;
+  variable_factory_t vfac2;
+  varname_t x1 = vfac1["x"];
+  varname_t y1 = vfac1["y"];
+  varname_t x2 = vfac2["x"];
+  varname_t x1_shadow = vfac1.get(x1, ".shadow");
+  varname_t fresh = vfac1.get("fresh");
+  crab::outs() << x1 << " " << y1 << " " << x2 << " " << x1_shadow << " "
+               << fresh << "\n";
+  crab::outs() << "x1 == vfac1[x]: " << (x1 == vfac1["x"])
+               << " x1.get()=" << *x1.get()
+               << " fresh.get() is none=" << !fresh.get() << "\n";
+  crab::outs() << "x1 from vfac1: " << (&x1.get_var_factory() == &vfac1)
+               << " x2 from vfac2: " << (&x2.get_var_factory() == &vfac2)
+               << "\n";
+
+  // Create more factories than fit in one chunk of the registry. The
+  // names of the variables of the live factories are still found.
+  {
+    std::vector<std::unique_ptr<variable_factory_t>> live;
+    std::vector<varname_t> vars;
+    bool ok = true;
+    for (unsigned i = 0; i < 10000; ++i) {
+      std::unique_ptr<variable_factory_t> vfac(new variable_factory_t());
+      varname_t v = (*vfac)["v" + std::to_string(i)];
+      ok &= (v.str() == "v" + std::to_string(i));
+      if (i % 1000 == 0) {
+        live.push_back(std::move(vfac));
+        vars.push_back(v);
+      }
+    }
+    for (unsigned i = 0; i < vars.size(); ++i) {
+      ok &= (vars[i].str() == "v" + std::to_string(i * 1000));
+      ok &= (&vars[i].get_var_factory() == live[i].get());
+    }
+    crab::outs() << "many factories: " << ok << "\n";
+  }
+
+  // The slots of destroyed factories are reused so creating more
+  // factories over time than the registry has slots is fine as long
+  // as few of them are alive at the same time.
+  {
+    bool ok = true;
+    for (unsigned i = 0; i < 4096 * 1024 + 1; ++i) {
+      variable_factory_t vfac;
+      ok &= (&vfac["v"].get_var_factory() == &vfac);
+    }
+    crab::outs() << "reused factory slots: " << ok << "\n";
+  }
+
+  // Look up names from several threads while other factories are
+  // created and destroyed.
+  {
+    std::vector<varname_t> vars;
+    for (unsigned i = 0; i < 100; ++i) {
+      vars.push_back(vfac1["z" + std::to_string(i)]);
+    }
+    const unsigned num_threads = 4;
+    std::vector<int> ok(num_threads, 1);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (unsigned k = 0; k < 100; ++k) {
+          variable_factory_t vfac;
+          varname_t v = vfac["t" + std::to_string(t)];
+          ok[t] &= (v.str() == "t" + std::to_string(t));
+          for (unsigned i = 0; i < vars.size(); ++i) {
+            ok[t] &= (vars[i].str() == "z" + std::to_string(i));
+          }
+        }
+      });
+    }
+    for (auto &th : threads) {
+      th.join();
+    }
+    for (unsigned t = 0; t < num_threads; ++t) {
+      crab::outs() << "thread " << t << ": " << ok[t] << "\n";
+    }
+  }
+  return 0;
+}
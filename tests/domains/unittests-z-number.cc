@@ -0,0 +1,97 @@
+#include <crab/numbers/bignums.hpp>
+#include <crab/support/os.hpp>
+
+#include <cstdint>
+#include <limits>
+
+using namespace ikos;
+
+// z_number keeps values that fit in int64_t inline and promotes them
+// to GMP on overflow. Check the results at the int64_t boundaries.
+
+static void print(const char *what, const z_number &n) {
+  crab::outs() << what << " = " << n << " (fits_int64=" << n.fits_int64()
+               << ")\n";
+}
+
+int main(int argc, char **argv) {
+  const z_number max(std::numeric_limits<int64_t>::max());
+  const z_number min(std::numeric_limits<int64_t>::min());
+  const z_number one(1);
+
+  // addition and subtraction
+  print("max+1", max + one);
+  print("max+1-1", (max + one) - one);
+  print("min-1", min - one);
+  print("min-1+1", (min - one) + one);
+  print("max+max", max + max);
+  print("min+min", min + min);
+  print("min+max", min + max);
+  {
+    z_number n(max);
+    ++n;
+    print("++max", n);
+    --n;
+    print("--(++max)", n);
+  }
+  {
+    z_number n(min);
+    n -= one;
+    print("min-=1", n);
+    n += one;
+    print("min-=1+=1", n);
+  }
+
+  // negation
+  print("-min", -min);
+  print("-max", -max);
+  print("-(-min)", -(-min));
+
+  // multiplication
+  print("2^32*2^32", z_number(4294967296) * z_number(4294967296));
+  print("3037000499^2", z_number(3037000499) * z_number(3037000499));
+  print("3037000500^2", z_number(3037000500) * z_number(3037000500));
+  print("min*-1", min * z_number(-1));
+  print("min*1", min * one);
+  print("(max+1)*0", (max + one) * z_number(0));
+
+  // division and remainder
+  print("min/-1", min / z_number(-1));
+  print("min%-1", min % z_number(-1));
+  print("-7/2", z_number(-7) / z_number(2));
+  print("-7%2", z_number(-7) % z_number(2));
+  print("(max+1)/2", (max + one) / z_number(2));
+  print("(min-1)%max", (min - one) % max);
+
+  // shifts and bitwise operators
+  print("1<<62", one << z_number(62));
+  print("1<<63", one << z_number(63));
+  print("1<<64", one << z_number(64));
+  print("-1<<63", z_number(-1) << z_number(63));
+  print("-1>>1", z_number(-1) >> z_number(1));
+  print("(1<<64)>>1", (one << z_number(64)) >> z_number(1));
+  print("(1<<64)|1", (one << z_number(64)) | one);
+  print("(1<<64)&max", (one << z_number(64)) & max);
+  print("((1<<64)+5)&7", ((one << z_number(64)) + z_number(5)) & z_number(7));
+  print("max^min", max ^ min);
+
+  // comparisons between small and big numbers
+  z_number big = max + one;
+  crab::outs() << "max<max+1=" << (max < big) << " max+1>max=" << (big > max)
+               << " min-1<min=" << ((min - one) < min)
+               << " max+1==2^63=" << (big == (one << z_number(63)))
+               << " max+1!=max=" << (big != max) << "\n";
+
+  // demoted numbers are equal and hash the same as small ones
+  z_number demoted = (big + z_number(5)) - big;
+  crab::outs() << "demoted==5=" << (demoted == z_number(5))
+               << " same hash=" << (demoted.hash() == z_number(5).hash())
+               << "\n";
+
+  // strings
+  print("from string 2^63", z_number("9223372036854775808"));
+  print("from string -2^63", z_number("-9223372036854775808"));
+  crab::outs() << "int64_t(max+1-1)=" << static_cast<int64_t>(big - one)
+               << "\n";
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+using namespace ikos;
+
+// Deterministic across platforms unlike std::uniform_int_distribution
+class lcg {
+  uint64_t m_state;
+
+public:
+  lcg(uint64_t seed) : m_state(seed) {}
+  // Return a number in [lb, ub]
+  int next(int lb, int ub) {
+    m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lb + static_cast<int>((m_state >> 33) % (ub - lb + 1));
+  }
+};
+
+z_lin_cst_t random_cst(lcg &rng, const std::vector<z_var> &vars) {
+  const z_var &x = vars[rng.next(0, vars.size() - 1)];
+  const z_var &y = vars[rng.next(0, vars.size() - 1)];
+  z_number k(rng.next(-4, 12));
+  switch (rng.next(0, 6)) {
+  case 0:
+    return z_lin_exp_t(x) <= k;
+  case 1:
+    return z_lin_exp_t(x) >= k;
+  case 2:
+    return z_lin_exp_t(x) - y == k;
+  case 3:
+    return z_lin_exp_t(x) - y < k;
+  case 4:
+    return z_number(2) * x + y <= k;
+  default:
+    return z_lin_exp_t(x) - y <= k;
+  }
+}
+
+// Unlike leq, it ignores redundant edges such as x-x<=k
+bool entails(z_sdbm_domain_t &x, z_sdbm_domain_t &y) {
+  if (x.is_bottom() || y.is_bottom()) {
+    return x.is_bottom();
+  }
+  for (auto const &cst : y.to_linear_constraint_system()) {
+    if (!x.entails(cst)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Add csts at once and one by one. Return true if both agree.
+bool check(const z_sdbm_domain_t &init, const z_lin_cst_sys_t &csts,
+           z_sdbm_domain_t &batched) {
+  batched = init;
+  batched += csts;
+  z_sdbm_domain_t seq(init);
+  for (auto const &cst : csts) {
+    seq += cst;
+  }
+  return entails(batched, seq) && entails(seq, batched);
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  z_var z(vfac["z"], crab::INT_TYPE, 32);
+  z_var w(vfac["w"], crab::INT_TYPE, 32);
+  z_var u(vfac["u"], crab::INT_TYPE, 32);
+  z_var v(vfac["v"], crab::INT_TYPE, 32);
+
+  {
+    z_sdbm_domain_t init;
+    init += (z_lin_exp_t(x) - y <= z_number(2));
+    init += (z_lin_exp_t(y) <= z_number(5));
+    z_lin_cst_sys_t csts;
+    csts += (z_lin_exp_t(z) - x <= z_number(1));
+    csts += (z_lin_exp_t(y) - z <= z_number(-1));
+    csts += (z_lin_exp_t(x) >= z_number(0));
+    csts += (z_lin_exp_t(w) == z_lin_exp_t(z));
+    // not a difference constraint
+    csts += (z_number(2) * x + y <= z_number(10));
+    csts += (z_lin_exp_t(x) - w < z_number(3));
+    z_sdbm_domain_t res;
+    bool ok = check(init, csts, res);
+    crab::outs() << init << " + " << csts << "\n"
+                 << "=" << res << "\n"
+                 << "same as one by one: " << (ok ? "yes" : "no") << "\n";
+  }
+
+  {
+    z_sdbm_domain_t init;
+    init += (z_lin_exp_t(x) - y <= z_number(0));
+    z_lin_cst_sys_t csts;
+    csts += (z_lin_exp_t(y) - z <= z_number(0));
+    csts += (z_lin_exp_t(z) - x <= z_number(-1));
+    z_sdbm_domain_t res;
+    bool ok = check(init, csts, res);
+    crab::outs() << init << " + " << csts << "\n"
+                 << "=" << res << "\n"
+                 << "same as one by one: " << (ok ? "yes" : "no") << "\n";
+  }
+
+  // Compare with adding the constraints one by one with all the
+  // closure algorithms.
+  std::vector<z_var> vars = {x, y, z, w, u, v};
+  for (auto const &chrome : {"true", "false"}) {
+    for (auto const &dense : {"64", "0"}) {
+      crab::domains::crab_domain_params_man::get().set_param(
+          "zones.chrome_dijkstra", chrome);
+      crab::domains::crab_domain_params_man::get().set_param(
+          "zones.dense_closure_max_size", dense);
+      lcg rng(42);
+      unsigned mismatches = 0, num_bottom = 0;
+      for (unsigned i = 0; i < 500; ++i) {
+        z_sdbm_domain_t init;
+        for (int j = 0, n = rng.next(0, 8); j < n; ++j) {
+          init += random_cst(rng, vars);
+        }
+        z_lin_cst_sys_t csts;
+        for (int j = 0, n = rng.next(1, 8); j < n; ++j) {
+          csts += random_cst(rng, vars);
+        }
+        z_sdbm_domain_t res;
+        if (!check(init, csts, res)) {
+          mismatches++;
+          crab::outs() << "Mismatch: " << init << " + " << csts << "\n";
+        }
+        if (res.is_bottom()) {
+          num_bottom++;
+        }
+      }
+      crab::outs() << "chrome_dijkstra=" << chrome
+                   << " dense_closure_max_size=" << dense
+                   << ": mismatches=" << mismatches
+                   << " bottom=" << num_bottom << "\n";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+using namespace std;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+// Zones with the dense graph representation and with the dense
+// closure kernel. The invariants must be the same as with the
+// adaptive graph representation (see test2 and test4).
+
+z_cfg_t *prog1(variable_factory_t &vfac) {
+
+  /*
+    i := 0;
+    k := 30;
+    while (i <= 9) {
+      i := i + 1;
+    }
+    j := 0;
+    while (j <= 9) {
+      j := i + 1;
+    }
+ */
+
+  z_cfg_t *cfg = new z_cfg_t("loop1_entry", "ret");
+  z_basic_block_t &loop1_entry = cfg->insert("loop1_entry");
+  z_basic_block_t &loop1_bb1 = cfg->insert("loop1_bb1");
+  z_basic_block_t &loop1_bb1_t = cfg->insert("loop1_bb1_t");
+  z_basic_block_t &loop1_bb1_f = cfg->insert("loop1_bb1_f");
+  z_basic_block_t &loop1_bb2 = cfg->insert("loop1_bb2");
+  z_basic_block_t &loop2_entry = cfg->insert("loop2_entry");
+  z_basic_block_t &loop2_bb1 = cfg->insert("loop2_bb1");
+  z_basic_block_t &loop2_bb1_t = cfg->insert("loop2_bb1_t");
+  z_basic_block_t &loop2_bb1_f = cfg->insert("loop2_bb1_f");
+  z_basic_block_t &loop2_bb2 = cfg->insert("loop2_bb2");
+  z_basic_block_t &ret = cfg->insert("ret");
+
+  loop1_entry >> loop1_bb1;
+  loop1_bb1 >> loop1_bb1_t;
+  loop1_bb1 >> loop1_bb1_f;
+  loop1_bb1_t >> loop1_bb2;
+  loop1_bb2 >> loop1_bb1;
+  loop1_bb1_f >> loop2_entry;
+
+  loop2_entry >> loop2_bb1;
+  loop2_bb1 >> loop2_bb1_t;
+  loop2_bb1 >> loop2_bb1_f;
+  loop2_bb1_t >> loop2_bb2;
+  loop2_bb2 >> loop2_bb1;
+  loop2_bb1_f >> ret;
+
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var j(vfac["j"], crab::INT_TYPE, 32);
+  z_var k(vfac["k"], crab::INT_TYPE, 32);
+
+  loop1_entry.assign(i, 0);
+  loop1_entry.assign(k, 30);
+  loop1_bb1_t.assume(i <= 9);
+  loop1_bb1_f.assume(i >= 10);
+  loop1_bb2.add(i, i, 1);
+
+  loop2_entry.assign(j, 0);
+  loop2_bb1_t.assume(j <= 9);
+  loop2_bb1_f.assume(j >= 10);
+  loop2_bb2.add(j, j, 1);
+  return cfg;
+}
+
+z_cfg_t *prog2(variable_factory_t &vfac) {
+
+  /*
+     i:=0;
+     p:=0;
+     while (i <= 9) {
+        i := i + 1;
+        p := p + 4;
+     }
+   */
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &loop_head = cfg->insert("loop_head");
+  z_basic_block_t &loop_t = cfg->insert("loop_t");
+  z_basic_block_t &loop_f = cfg->insert("loop_f");
+  z_basic_block_t &loop_body = cfg->insert("loop_body");
+  z_basic_block_t &ret = cfg->insert("ret");
+
+  entry >> loop_head;
+  loop_head >> loop_t;
+  loop_head >> loop_f;
+  loop_t >> loop_body;
+  loop_body >> loop_head;
+  loop_f >> ret;
+
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var p(vfac["p"], crab::INT_TYPE, 32);
+
+  entry.assign(i, 0);
+  entry.assign(p, 0);
+  loop_t.assume(i <= 9);
+  loop_f.assume(i >= 10);
+  loop_body.add(i, i, 1);
+  loop_body.add(p, p, 4);
+
+  return cfg;
+}
+
+static void analyze(z_cfg_t *cfg, bool stats_enabled) {
+  {
+    z_dense_dbm_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+  {
+    z_dense_sdbm_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+  }
+  {
+    // adaptive graph representation but dense closure
+    crab::domains::crab_domain_params_man::get().set_param(
+        "zones.dense_closure_max_size", "64");
+    z_sdbm_domain_t init;
+    run(cfg, cfg->entry(), init, false, 1, 2, 20, stats_enabled);
+    crab::domains::crab_domain_params_man::get().set_param(
+        "zones.dense_closure_max_size", "0");
+  }
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  {
+    variable_factory_t vfac;
+    z_cfg_t *cfg = prog1(vfac);
+    cfg->simplify();
+    crab::outs() << *cfg << "\n";
+    analyze(cfg, stats_enabled);
+    delete cfg;
+  }
+  {
+    variable_factory_t vfac;
+    z_cfg_t *cfg = prog2(vfac);
+    cfg->simplify();
+    crab::outs() << *cfg << "\n";
+    analyze(cfg, stats_enabled);
+    delete cfg;
+  }
+  return 0;
+}
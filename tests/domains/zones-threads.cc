@@ -0,0 +1,96 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <crab/domains/graphs/graph_ops.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+// The scratch space of GraphOps is thread-local: each thread has its
+// own buffers which are reused by all the graph operations of that
+// thread. Run the same zone operations on several threads and check
+// that they produce the same result as on the main thread.
+
+using graph_ops_t = crab::GraphOps<z_dbm_graph_t::graph_t>;
+
+static std::string compute(unsigned n) {
+  variable_factory_t vfac;
+  std::vector<z_var> xs;
+  for (unsigned i = 0; i < n; ++i) {
+    xs.push_back(z_var(vfac["x" + std::to_string(i)], crab::INT_TYPE, 32));
+  }
+  z_sdbm_domain_t inv1, inv2;
+  inv1.assign(xs[0], 0);
+  inv2.assign(xs[0], 0);
+  for (unsigned i = 1; i < n; ++i) {
+    inv1 += (xs[i] - xs[i - 1] <= 1);
+    inv1 += (xs[i - 1] - xs[i] <= 0);
+    inv2 += (xs[i] - xs[i - 1] <= 2);
+    inv2 += (xs[i - 1] - xs[i] <= -1);
+  }
+  z_sdbm_domain_t j = inv1 | inv2;
+  z_sdbm_domain_t m = inv1 & inv2;
+  z_sdbm_domain_t w = inv1 || j;
+  j += (xs[n - 1] <= 100);
+  crab::crab_string_os s;
+  s << j << " " << m << " " << w;
+  return s.str();
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+
+  const unsigned sizes[] = {5, 20, 40};
+  std::vector<std::string> expected;
+  for (unsigned n : sizes) {
+    expected.push_back(compute(n));
+  }
+  crab::outs() << compute(5) << "\n";
+
+  // The main thread reuses its scratch space once it is large enough.
+  const graph_ops_t::scratch_t *main_scratch = &graph_ops_t::scratch();
+  unsigned main_sz = graph_ops_t::scratch().scratch_sz;
+  compute(40);
+  crab::outs() << "main thread reuses its scratch space: "
+               << (&graph_ops_t::scratch() == main_scratch &&
+                   graph_ops_t::scratch().scratch_sz == main_sz)
+               << "\n";
+
+  const unsigned num_threads = 4;
+  std::vector<std::thread> threads;
+  std::vector<int> ok(num_threads, 0);
+  std::vector<int> own_scratch(num_threads, 0);
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      int res = 1;
+      // Each thread runs the operations several times with
+      // different sizes so that its scratch space grows and is
+      // reused while the other threads are running.
+      for (unsigned k = 0; k < 3; ++k) {
+        for (unsigned i = 0; i < 3; ++i) {
+          unsigned idx = (i + t) % 3;
+          res &= (compute(sizes[idx]) == expected[idx]);
+        }
+      }
+      ok[t] = res;
+      own_scratch[t] = (&graph_ops_t::scratch() != main_scratch);
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  for (unsigned t = 0; t < num_threads; ++t) {
+    crab::outs() << "thread " << t << ": same results=" << ok[t]
+                 << " own scratch space=" << own_scratch[t] << "\n";
+  }
+  return 0;
+}
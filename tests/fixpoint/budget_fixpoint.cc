@@ -0,0 +1,114 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/analysis/fwd_analyzer.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    i := 0;
+    x := 0;
+    while (i <= 9) {
+      j := 0;
+      while (j <= 9) { j++; x++; }
+      i++;
+    }
+   */
+
+  // Definining program variables
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var j(vfac["j"], crab::INT_TYPE, 32);
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &outer = cfg->insert("outer");
+  z_basic_block_t &outer_body = cfg->insert("outer_body");
+  z_basic_block_t &inner = cfg->insert("inner");
+  z_basic_block_t &inner_body = cfg->insert("inner_body");
+  z_basic_block_t &inner_exit = cfg->insert("inner_exit");
+  z_basic_block_t &ret = cfg->insert("ret");
+  // adding control flow
+  entry >> outer;
+  outer >> outer_body;
+  outer_body >> inner;
+  inner >> inner_body;
+  inner_body >> inner;
+  inner >> inner_exit;
+  inner_exit >> outer;
+  outer >> ret;
+  // adding statements
+  entry.assign(i, 0);
+  entry.assign(x, 0);
+  outer_body.assume(i <= 9);
+  outer_body.assign(j, 0);
+  inner_body.assume(j <= 9);
+  inner_body.add(j, j, 1);
+  inner_body.add(x, x, 1);
+  inner_exit.assume(j >= 10);
+  inner_exit.add(i, i, 1);
+  ret.assume(i >= 10);
+  return cfg;
+}
+
+template <typename Dom>
+void run(z_cfg_ref_t cfg, std::string name, crab::fixpoint_parameters params) {
+  using analyzer_t = intra_fwd_analyzer<z_cfg_ref_t, Dom>;
+
+  Dom absval_fac, init;
+  crab::fixpoint_parameters default_params;
+  analyzer_t a(cfg, absval_fac, nullptr, default_params);
+  a.run(init);
+
+  crab::analysis_budget budget;
+  params.get_global_budget() = &budget;
+  analyzer_t b(cfg, absval_fac, nullptr, params);
+  b.run(init);
+
+  crab::outs() << "Analysis using " << init.domain_name() << " with " << name
+               << "\n";
+  bool sound = true;
+  for (auto &bb : cfg) {
+    sound &= (a.get_pre(bb.label()) <= b.get_pre(bb.label()));
+    sound &= (a.get_post(bb.label()) <= b.get_post(bb.label()));
+  }
+  crab::outs() << "ret=" << b.get_post(cfg.exit()) << "\n";
+  crab::outs() << "degraded=" << b.is_degraded() << " recorded="
+               << budget.get_degraded().size() << "\n";
+  crab::outs() << "Invariants are " << (sound ? "" : "not ")
+               << "weaker than without budget\n";
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+  crab::outs() << *cfg << "\n";
+
+  {
+    crab::fixpoint_parameters params;
+    run<z_interval_domain_t>(*cfg, "no budget", params);
+  }
+  {
+    crab::fixpoint_parameters params;
+    params.get_max_cycle_iterations() = 1;
+    run<z_interval_domain_t>(*cfg, "max_cycle_iterations=1", params);
+    run<z_sdbm_domain_t>(*cfg, "max_cycle_iterations=1", params);
+  }
+  {
+    crab::fixpoint_parameters params;
+    params.get_max_state_size() = 2;
+    run<z_sdbm_domain_t>(*cfg, "max_state_size=2", params);
+  }
+
+  delete cfg;
+  return 0;
+}
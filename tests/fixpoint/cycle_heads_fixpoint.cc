@@ -0,0 +1,120 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/analysis/fwd_analyzer.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    i := 0;
+    x := 0;
+    while (i <= 9) {
+      j := 0;
+      while (j <= i) { j++; x++; }
+      i++;
+    }
+    y := x;
+   */
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var j(vfac["j"], crab::INT_TYPE, 32);
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &outer = cfg->insert("outer");
+  z_basic_block_t &outer_body = cfg->insert("outer_body");
+  z_basic_block_t &inner = cfg->insert("inner");
+  z_basic_block_t &inner_body = cfg->insert("inner_body");
+  z_basic_block_t &inner_exit = cfg->insert("inner_exit");
+  z_basic_block_t &outer_exit = cfg->insert("outer_exit");
+  z_basic_block_t &ret = cfg->insert("ret");
+  entry >> outer;
+  outer >> outer_body;
+  outer >> outer_exit;
+  outer_body >> inner;
+  inner >> inner_body;
+  inner_body >> inner;
+  inner >> inner_exit;
+  inner_exit >> outer;
+  outer_exit >> ret;
+  entry.assign(i, 0);
+  entry.assign(x, 0);
+  outer_body.assume(i <= 9);
+  outer_body.assign(j, 0);
+  inner_body.assume(j <= i);
+  inner_body.add(j, j, 1);
+  inner_body.add(x, x, 1);
+  inner_exit.assume(j >= i + 1);
+  inner_exit.add(i, i, 1);
+  outer_exit.assume(i >= 10);
+  ret.assign(y, x);
+  return cfg;
+}
+
+template <typename Dom>
+void run(z_cfg_ref_t cfg, unsigned descending_iterations) {
+  using analyzer_t = intra_fwd_analyzer<z_cfg_ref_t, Dom>;
+
+  Dom absval_fac, init;
+  crab::fixpoint_parameters params;
+  params.get_descending_iterations() = descending_iterations;
+  analyzer_t full_a(cfg, absval_fac, nullptr, params);
+  full_a.run(init);
+
+  crab::fixpoint_parameters heads_params(params);
+  heads_params.get_keep_only_cycle_heads() = true;
+  analyzer_t heads_a(cfg, absval_fac, nullptr, heads_params);
+  heads_a.keep_invariants_at("inner_exit");
+  heads_a.run(init);
+
+  crab::fixpoint_parameters cache_params(heads_params);
+  cache_params.get_invariant_cache_size() = 2;
+  analyzer_t cache_a(cfg, absval_fac, nullptr, cache_params);
+  cache_a.run(init);
+
+  crab::outs() << "Analysis using " << init.domain_name()
+               << " with " << descending_iterations
+               << " descending iterations\n";
+  crab::outs() << "Stored invariants: " << heads_a.get_pre_invariants().size()
+               << " out of " << cfg.size() << "\n";
+  bool same = true;
+  // twice to read from the cache
+  for (unsigned k = 0; k < 2; ++k) {
+    for (auto &b : cfg) {
+      auto full_pre = full_a.get_pre(b.label());
+      auto full_post = full_a.get_post(b.label());
+      auto heads_pre = heads_a.get_pre(b.label());
+      auto heads_post = heads_a.get_post(b.label());
+      auto cache_pre = cache_a.get_pre(b.label());
+      auto cache_post = cache_a.get_post(b.label());
+      same &= (full_pre <= heads_pre && heads_pre <= full_pre &&
+               full_post <= heads_post && heads_post <= full_post &&
+               full_pre <= cache_pre && cache_pre <= full_pre &&
+               full_post <= cache_post && cache_post <= full_post);
+    }
+  }
+  crab::outs() << "ret=" << heads_a.get_post(cfg.exit()) << "\n";
+  crab::outs() << "Invariants with and without recomputation are "
+               << (same ? "equal" : "different") << "\n";
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+  crab::outs() << *cfg << "\n";
+
+  run<z_interval_domain_t>(*cfg, 1);
+  run<z_interval_domain_t>(*cfg, 0);
+  run<z_sdbm_domain_t>(*cfg, 1);
+
+  delete cfg;
+  return 0;
+}
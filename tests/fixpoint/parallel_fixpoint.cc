@@ -0,0 +1,125 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/analysis/fwd_analyzer.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    x := 0;
+    if (*) {
+      i := 0;
+      while (i <= 9) { i++; x++; }
+    } else {
+      j := 0;
+      while (j <= 19) { j := j + 2; x := x + 2; }
+    }
+    k := 0;
+    while (k <= x) { k++; }
+   */
+
+  // Definining program variables
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var j(vfac["j"], crab::INT_TYPE, 32);
+  z_var k(vfac["k"], crab::INT_TYPE, 32);
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &then_init = cfg->insert("then_init");
+  z_basic_block_t &loop1 = cfg->insert("loop1");
+  z_basic_block_t &loop1_body = cfg->insert("loop1_body");
+  z_basic_block_t &loop1_exit = cfg->insert("loop1_exit");
+  z_basic_block_t &else_init = cfg->insert("else_init");
+  z_basic_block_t &loop2 = cfg->insert("loop2");
+  z_basic_block_t &loop2_body = cfg->insert("loop2_body");
+  z_basic_block_t &loop2_exit = cfg->insert("loop2_exit");
+  z_basic_block_t &join = cfg->insert("join");
+  z_basic_block_t &loop3 = cfg->insert("loop3");
+  z_basic_block_t &loop3_body = cfg->insert("loop3_body");
+  z_basic_block_t &ret = cfg->insert("ret");
+  // adding control flow
+  entry >> then_init;
+  entry >> else_init;
+  then_init >> loop1;
+  loop1 >> loop1_body;
+  loop1_body >> loop1;
+  loop1 >> loop1_exit;
+  else_init >> loop2;
+  loop2 >> loop2_body;
+  loop2_body >> loop2;
+  loop2 >> loop2_exit;
+  loop1_exit >> join;
+  loop2_exit >> join;
+  join >> loop3;
+  loop3 >> loop3_body;
+  loop3_body >> loop3;
+  loop3 >> ret;
+  // adding statements
+  entry.assign(x, 0);
+  then_init.assign(i, 0);
+  loop1_body.assume(i <= 9);
+  loop1_body.add(i, i, 1);
+  loop1_body.add(x, x, 1);
+  loop1_exit.assume(i >= 10);
+  else_init.assign(j, 0);
+  loop2_body.assume(j <= 19);
+  loop2_body.add(j, j, 2);
+  loop2_body.add(x, x, 2);
+  loop2_exit.assume(j >= 20);
+  join.assign(k, 0);
+  loop3_body.assume(k <= x);
+  loop3_body.add(k, k, 1);
+  ret.assume(k >= x + 1);
+  return cfg;
+}
+
+template <typename Dom> void run(z_cfg_ref_t cfg) {
+  using analyzer_t = intra_fwd_analyzer<z_cfg_ref_t, Dom>;
+
+  Dom absval_fac, init;
+  crab::fixpoint_parameters seq_params;
+  analyzer_t seq_a(cfg, absval_fac, nullptr, seq_params);
+  seq_a.run(init);
+
+  crab::fixpoint_parameters par_params;
+  par_params.get_num_threads() = 4;
+  analyzer_t par_a(cfg, absval_fac, nullptr, par_params);
+  par_a.run(init);
+
+  crab::outs() << "Analysis using " << init.domain_name() << "\n";
+  bool same = true;
+  for (auto &b : cfg) {
+    auto seq_pre = seq_a.get_pre(b.label());
+    auto seq_post = seq_a.get_post(b.label());
+    auto par_pre = par_a.get_pre(b.label());
+    auto par_post = par_a.get_post(b.label());
+    same &= (seq_pre <= par_pre && par_pre <= seq_pre &&
+             seq_post <= par_post && par_post <= seq_post);
+  }
+  auto ret_post = par_a.get_post(cfg.exit());
+  crab::outs() << "ret=" << ret_post << "\n";
+  crab::outs() << "Sequential and parallel invariants are "
+               << (same ? "equal" : "different") << "\n";
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+  crab::outs() << *cfg << "\n";
+
+  run<z_interval_domain_t>(*cfg);
+  run<z_sdbm_domain_t>(*cfg);
+
+  delete cfg;
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/cfg/cfg_bgl.hpp>
+#include <crab/fixpoint/wto.hpp>
+
+using namespace std;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+    i := 0;
+    while (i <= 9) {
+      j := 0;
+      while (j <= i) { j++; }
+      i++;
+    }
+   */
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var j(vfac["j"], crab::INT_TYPE, 32);
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &outer = cfg->insert("outer");
+  z_basic_block_t &outer_body = cfg->insert("outer_body");
+  z_basic_block_t &inner = cfg->insert("inner");
+  z_basic_block_t &inner_body = cfg->insert("inner_body");
+  z_basic_block_t &inner_exit = cfg->insert("inner_exit");
+  z_basic_block_t &ret = cfg->insert("ret");
+  cfg->insert("unreachable");
+  entry >> outer;
+  outer >> outer_body;
+  outer >> ret;
+  outer_body >> inner;
+  inner >> inner_body;
+  inner_body >> inner;
+  inner >> inner_exit;
+  inner_exit >> outer;
+  entry.assign(i, 0);
+  outer_body.assume(i <= 9);
+  outer_body.assign(j, 0);
+  inner_body.assume(j <= i);
+  inner_body.add(j, j, 1);
+  inner_exit.assume(j >= i + 1);
+  inner_exit.add(i, i, 1);
+  ret.assume(i >= 10);
+  return cfg;
+}
+
+using wto_t = ikos::wto<z_cfg_ref_t>;
+using wto_nesting_t = typename wto_t::wto_nesting_t;
+
+const char *labels[] = {"entry",      "outer",      "outer_body", "inner",
+                        "inner_body", "inner_exit", "ret",        "unreachable"};
+
+std::string nestings(const wto_t &wto) {
+  crab::crab_string_os o;
+  for (const char *l : labels) {
+    boost::optional<wto_nesting_t> n = wto.nesting(l);
+    o << l << "=";
+    if (n) {
+      o << *n;
+    } else {
+      o << "none";
+    }
+    o << " ";
+  }
+  return o.str();
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+
+  wto_t plain(*cfg);
+  crab::outs() << "WTO: " << plain << "\n";
+  crab::outs() << "Nestings: " << nestings(plain) << "\n";
+
+  cfg->build_index();
+  wto_t indexed(*cfg);
+  crab::outs() << "WTO with index: " << indexed << "\n";
+  crab::outs() << "Same nestings with index: "
+               << (nestings(plain) == nestings(indexed) ? "yes" : "no")
+               << "\n";
+
+  boost::optional<wto_nesting_t> inner_body = indexed.nesting("inner_body");
+  boost::optional<wto_nesting_t> inner_exit = indexed.nesting("inner_exit");
+  boost::optional<wto_nesting_t> ret = indexed.nesting("ret");
+  crab::outs() << "inner_body > inner_exit: "
+               << (*inner_body > *inner_exit ? "yes" : "no") << "\n";
+  crab::outs() << "inner_body ^ inner_exit = " << (*inner_body ^ *inner_exit)
+               << "\n";
+  crab::outs() << "inner_body ^ ret = " << (*inner_body ^ *ret) << "\n";
+
+  // Drop the index: the nestings of the wto must not change
+  z_var k(vfac["k"], crab::INT_TYPE, 32);
+  cfg->get_node("ret").assign(k, 0);
+  crab::outs() << "Same nestings without index: "
+               << (nestings(plain) == nestings(indexed) ? "yes" : "no")
+               << "\n";
+
+  // A nesting stays valid after the wto that built it is destroyed
+  boost::optional<wto_nesting_t> kept;
+  {
+    wto_t copy = indexed.clone();
+    crab::outs() << "Same nestings in the clone: "
+                 << (nestings(plain) == nestings(copy) ? "yes" : "no")
+                 << "\n";
+    kept = copy.nesting("inner_body");
+  }
+  crab::outs() << "Kept nesting of inner_body: " << *kept << "\n";
+
+  delete cfg;
+  return 0;
+}
@@ -0,0 +1,159 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <crab/analysis/inter/bottom_up_inter_analyzer.hpp>
+#include <crab/analysis/inter/inter_params.hpp>
+#include <crab/cg/cg_bgl.hpp>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+using namespace crab::cg;
+
+// k1 and k2 are the constants added to x
+z_cfg_t *foo(variable_factory_t &vfac, int k1, int k2) {
+  // Defining program variables
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  z_var z(vfac["z"], crab::INT_TYPE, 32);
+
+  function_decl<z_number, varname_t> decl("foo", {x}, {z});
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  // adding control flow
+  entry >> exit;
+  // adding statements
+  entry.add(y, x, k1);
+  exit.add(z, y, k2);
+  return cfg;
+}
+
+z_cfg_t *bar(variable_factory_t &vfac) {
+  // Defining program variables
+  z_var a(vfac["a"], crab::INT_TYPE, 32);
+  z_var x(vfac["x1"], crab::INT_TYPE, 32);
+  z_var y(vfac["y1"], crab::INT_TYPE, 32);
+
+  function_decl<z_number, varname_t> decl("bar", {a}, {y});
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  // adding control flow
+  entry >> exit;
+  // adding statements
+  entry.add(x, a, 2);
+  exit.callsite("foo", {y}, {x});
+  return cfg;
+}
+
+z_cfg_t *m(variable_factory_t &vfac) {
+  // Defining program variables
+  z_var x(vfac["x2"], crab::INT_TYPE, 32);
+  z_var y(vfac["y2"], crab::INT_TYPE, 32);
+
+  function_decl<z_number, varname_t> decl("main", {}, {y});
+  // entry and exit block
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  // adding blocks
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  // adding control flow
+  entry >> exit;
+  // adding statements
+  entry.assign(x, 3);
+  exit.callsite("bar", {y}, {x});
+  return cfg;
+}
+
+using callgraph_t = call_graph<z_cfg_ref_t>;
+using inter_params_t = inter_analyzer_parameters<callgraph_t>;
+using inter_analyzer_t =
+    bottom_up_inter_analyzer<callgraph_t, z_dbm_domain_t, z_interval_domain_t>;
+
+void run(vector<z_cfg_ref_t> &cfgs, const string &cache_dir) {
+  callgraph_t cg(cfgs);
+  inter_params_t params;
+  params.widening_delay = 2;
+  params.descending_iters = 2;
+  params.thresholds_size = 20;
+  params.summary_cache_dir = cache_dir;
+  z_dbm_domain_t bu_top;
+  z_interval_domain_t td_top;
+  inter_analyzer_t a(cg, td_top, bu_top, params);
+  a.run(td_top);
+  for (auto &cfg : cfgs) {
+    crab::outs() << a.get_summary(cfg) << "\n";
+  }
+  crab::outs() << "Cache hits=" << a.get_num_summary_cache_hits()
+               << " misses=" << a.get_num_summary_cache_misses() << "\n";
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+
+  char dir_template[] = "/tmp/crab-summaries-XXXXXX";
+  if (!mkdtemp(dir_template)) {
+    crab::outs() << "cannot create temporary directory\n";
+    return 1;
+  }
+  string cache_dir(dir_template);
+
+  variable_factory_t vfac;
+  z_cfg_t *t1 = foo(vfac, 1, 2);
+  z_cfg_t *t2 = bar(vfac);
+  z_cfg_t *t3 = m(vfac);
+  // same summary as t1
+  z_cfg_t *t4 = foo(vfac, 2, 1);
+  // different summary
+  z_cfg_t *t5 = foo(vfac, 2, 2);
+
+  vector<z_cfg_ref_t> cfgs = {*t1, *t2, *t3};
+  crab::outs() << "=== Empty cache ===\n";
+  run(cfgs, cache_dir);
+  crab::outs() << "=== Same program ===\n";
+  run(cfgs, cache_dir);
+
+  // foo is analyzed again but its summary does not change so the
+  // summaries of bar and main are reused.
+  cfgs = {*t4, *t2, *t3};
+  crab::outs() << "=== foo changed, same summary ===\n";
+  run(cfgs, cache_dir);
+
+  // all summaries are computed again
+  cfgs = {*t5, *t2, *t3};
+  crab::outs() << "=== foo changed, different summary ===\n";
+  run(cfgs, cache_dir);
+
+  if (DIR *d = opendir(cache_dir.c_str())) {
+    while (struct dirent *entry = readdir(d)) {
+      string name(entry->d_name);
+      if (name != "." && name != "..") {
+        unlink((cache_dir + "/" + name).c_str());
+      }
+    }
+    closedir(d);
+  }
+  rmdir(cache_dir.c_str());
+
+  delete t1;
+  delete t2;
+  delete t3;
+  delete t4;
+  delete t5;
+
+  return 0;
+}
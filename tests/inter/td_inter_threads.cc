@@ -0,0 +1,131 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+
+#include <crab/analysis/graphs/sccg_bgl.hpp>
+#include <crab/analysis/inter/inter_params.hpp>
+#include <crab/cg/cg_bgl.hpp>
+
+using namespace std;
+using namespace crab::analyzer;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+using namespace crab::cg;
+using namespace crab::cg_impl;
+
+/*
+inc(x) {
+  return x + 1;
+}
+
+entry1() {
+  y := inc(0);
+  assert(y == 1);
+}
+
+entry2() {
+  y := inc(5);
+  z := inc(y);
+  assert(z == 7);
+}
+
+entry3() {
+  y := *;
+  assume(y >= 0);
+  z := inc(y);
+  assert(z >= 2);
+}
+ */
+
+z_cfg_t *inc(variable_factory_t &vfac) {
+  z_var x(vfac["x"], crab::INT_TYPE, 32);
+  z_var r(vfac["r"], crab::INT_TYPE, 32);
+  function_decl<z_number, varname_t> decl("inc", {x}, {r});
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  entry >> exit;
+  entry.add(r, x, 1);
+  return cfg;
+}
+
+z_cfg_t *entry1(variable_factory_t &vfac) {
+  z_var x(vfac["x1"], crab::INT_TYPE, 32);
+  z_var y(vfac["y1"], crab::INT_TYPE, 32);
+  function_decl<z_number, varname_t> decl("entry1", {}, {y});
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  entry >> exit;
+  entry.assign(x, 0);
+  entry.callsite("inc", {y}, {x});
+  exit.assertion(y == 1);
+  return cfg;
+}
+
+z_cfg_t *entry2(variable_factory_t &vfac) {
+  z_var x(vfac["x2"], crab::INT_TYPE, 32);
+  z_var y(vfac["y2"], crab::INT_TYPE, 32);
+  z_var z(vfac["z2"], crab::INT_TYPE, 32);
+  function_decl<z_number, varname_t> decl("entry2", {}, {z});
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  entry >> exit;
+  entry.assign(x, 5);
+  entry.callsite("inc", {y}, {x});
+  entry.callsite("inc", {z}, {y});
+  exit.assertion(z == 7);
+  return cfg;
+}
+
+z_cfg_t *entry3(variable_factory_t &vfac) {
+  z_var y(vfac["y3"], crab::INT_TYPE, 32);
+  z_var z(vfac["z3"], crab::INT_TYPE, 32);
+  function_decl<z_number, varname_t> decl("entry3", {}, {z});
+  z_cfg_t *cfg = new z_cfg_t("entry", "exit", decl);
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &exit = cfg->insert("exit");
+  entry >> exit;
+  entry.havoc(y);
+  entry.assume(y >= 0);
+  entry.callsite("inc", {z}, {y});
+  exit.assertion(z >= 2);
+  return cfg;
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+
+  using inter_params_t = inter_analyzer_parameters<z_cg_t>;
+
+  variable_factory_t vfac;
+  z_cfg_t *t1 = inc(vfac);
+  z_cfg_t *t2 = entry1(vfac);
+  z_cfg_t *t3 = entry2(vfac);
+  z_cfg_t *t4 = entry3(vfac);
+
+  vector<z_cfg_ref_t> cfgs({*t1, *t2, *t3, *t4});
+  z_cg_t cg(cfgs);
+
+  // The three entries are analyzed concurrently. The invariants and
+  // the checks must be the same as when the entries are analyzed one
+  // after the other.
+  for (unsigned num_threads : {1, 4}) {
+    crab::outs() << "Threads: " << num_threads << "\n";
+    inter_params_t params;
+    params.num_threads = num_threads;
+    z_sdbm_domain_t init;
+    td_inter_run(cg, init, params, true, true, false);
+  }
+
+  delete t1;
+  delete t2;
+  delete t3;
+  delete t4;
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+#include "../common.hpp"
+#include "../program_options.hpp"
+#include <crab/analysis/dataflow/liveness.hpp>
+
+using namespace std;
+using namespace crab::cfg;
+using namespace crab::cfg_impl;
+using namespace crab::domain_impl;
+
+// More variables than bits in a word of a bit vector
+const unsigned num_wide_vars = 70;
+
+z_cfg_t *prog(variable_factory_t &vfac) {
+  /*
+     i := 0;
+     s := 0;
+     r := 0;
+     v0 := 0; ...; v69 := 69;
+     while (i <= 9) {
+       s := s + i;
+       i := i + 1;
+     }
+     r := r + v0; ...; r := r + v69;
+     if (*) {
+       y := y + 1;
+       unreachable;
+     }
+     assume(s >= r);
+   */
+  z_var i(vfac["i"], crab::INT_TYPE, 32);
+  z_var s(vfac["s"], crab::INT_TYPE, 32);
+  z_var r(vfac["r"], crab::INT_TYPE, 32);
+  z_var y(vfac["y"], crab::INT_TYPE, 32);
+  std::vector<z_var> vs;
+  for (unsigned k = 0; k < num_wide_vars; ++k) {
+    vs.push_back(z_var(vfac["v" + std::to_string(k)], crab::INT_TYPE, 32));
+  }
+  z_cfg_t *cfg = new z_cfg_t("entry", "ret");
+  z_basic_block_t &entry = cfg->insert("entry");
+  z_basic_block_t &loop = cfg->insert("loop");
+  z_basic_block_t &body = cfg->insert("body");
+  z_basic_block_t &exit = cfg->insert("exit");
+  z_basic_block_t &dead = cfg->insert("dead");
+  z_basic_block_t &ret = cfg->insert("ret");
+  entry >> loop;
+  loop >> body;
+  body >> loop;
+  loop >> exit;
+  exit >> dead;
+  exit >> ret;
+  entry.assign(i, 0);
+  entry.assign(s, 0);
+  entry.assign(r, 0);
+  for (unsigned k = 0; k < num_wide_vars; ++k) {
+    entry.assign(vs[k], k);
+  }
+  body.assume(i <= 9);
+  body.add(s, s, i);
+  body.add(i, i, 1);
+  exit.assume(i >= 10);
+  for (unsigned k = 0; k < num_wide_vars; ++k) {
+    exit.add(r, r, vs[k]);
+  }
+  dead.add(y, y, 1);
+  dead.unreachable();
+  ret.assume(s >= r);
+  return cfg;
+}
+
+int main(int argc, char **argv) {
+  bool stats_enabled = false;
+  if (!crab_tests::parse_user_options(argc, argv, stats_enabled)) {
+    return 0;
+  }
+  variable_factory_t vfac;
+  z_cfg_t *cfg = prog(vfac);
+
+  using varset_domain_t = crab::analyzer::varset_domain<z_var>;
+  using liveness_t = crab::analyzer::liveness_analysis<z_cfg_ref_t>;
+  using liveness_ops_t =
+      crab::analyzer::liveness_analysis_operations<z_cfg_ref_t>;
+  using killgen_liveness_t =
+      crab::killgen_fixpoint_iterator<z_cfg_ref_t, liveness_ops_t>;
+
+  // Liveness over bit vectors
+  liveness_t live(*cfg, false /*keep IN sets*/);
+  live.exec();
+
+  // Liveness over sets of variables
+  liveness_ops_t ops(*cfg);
+  killgen_liveness_t killgen_live(*cfg, ops);
+  killgen_live.run();
+
+  auto same = [](const varset_domain_t &s1, const varset_domain_t *s2) {
+    varset_domain_t s = s2 ? *s2 : varset_domain_t::bottom();
+    return s1 <= s && s <= s1;
+  };
+
+  const char *labels[] = {"entry", "loop", "body", "exit", "dead", "ret"};
+  bool all_same = true;
+  for (const char *l : labels) {
+    varset_domain_t out = live.get(l);
+    boost::optional<varset_domain_t> in = live.get_live_in(l);
+    all_same &= same(out, killgen_live.get_out(l));
+    all_same &= in && same(*in, killgen_live.get_in(l));
+    crab::outs() << l << ": " << out.size() << " live out variables";
+    if (out.size() <= 4) {
+      crab::outs() << " " << out;
+    }
+    crab::outs() << "\n";
+  }
+  crab::outs() << "Same as the set-based liveness: "
+               << (all_same ? "yes" : "no") << "\n";
+
+  delete cfg;
+  return 0;
+}